@@ -0,0 +1,129 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_ALIGNEDBUFFER_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_ALIGNEDBUFFER_HPP 1
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include "temblor/private/bufferPool.hpp"
+
+namespace Temblor::Private
+{
+/*!
+ * @brief An untyped buffer whose memory is aligned to a cache line so that
+ *        it can hold samples of any precision and be processed with
+ *        aligned vector loads.  The memory is drawn from and returned to
+ *        the \c BufferPool.
+ */
+class AlignedBuffer
+{
+public:
+    /*! @brief The alignment of the buffer in bytes. */
+    static constexpr size_t ALIGNMENT = BufferPool::ALIGNMENT;
+    /*!
+     * @brief Default constructor.
+     */
+    AlignedBuffer() = default;
+    /*!
+     * @brief Copy constructor.
+     * @param[in] buffer  The buffer to copy.
+     */
+    AlignedBuffer(const AlignedBuffer &buffer)
+    {
+        *this = buffer;
+    }
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] buffer  The buffer to move.  On exit it is empty.
+     */
+    AlignedBuffer(AlignedBuffer &&buffer) noexcept
+    {
+        *this = std::move(buffer);
+    }
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] buffer  The buffer to copy.
+     * @result A deep copy of the buffer.
+     */
+    AlignedBuffer& operator=(const AlignedBuffer &buffer)
+    {
+        if (&buffer == this){return *this;}
+        allocate(buffer.mSize);
+        if (mSize > 0){std::memcpy(mData, buffer.mData, mSize);}
+        return *this;
+    }
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] buffer  The buffer to move.  On exit it is empty.
+     * @result The memory of buffer moved to this.
+     */
+    AlignedBuffer& operator=(AlignedBuffer &&buffer) noexcept
+    {
+        if (&buffer == this){return *this;}
+        clear();
+        std::swap(mData, buffer.mData);
+        std::swap(mSize, buffer.mSize);
+        std::swap(mCapacity, buffer.mCapacity);
+        return *this;
+    }
+    /*!
+     * @brief Destructor.
+     */
+    ~AlignedBuffer()
+    {
+        clear();
+    }
+    /*!
+     * @brief Sizes the buffer.  The existing memory is reused when it is
+     *        large enough.
+     * @param[in] nBytes  The number of bytes.
+     * @throws std::bad_alloc if the memory cannot be allocated.
+     * @note The contents of the buffer are undefined on exit.
+     */
+    void allocate(const size_t nBytes)
+    {
+        if (nBytes > mCapacity)
+        {
+            clear();
+            mData = BufferPool::instance().acquire(nBytes);
+            mCapacity = BufferPool::getCapacity(nBytes);
+        }
+        mSize = nBytes;
+    }
+    /*!
+     * @brief Returns the memory to the pool.
+     */
+    void clear() noexcept
+    {
+        if (mData){BufferPool::instance().release(mData, mCapacity);}
+        mData = nullptr;
+        mSize = 0;
+        mCapacity = 0;
+    }
+    /*!
+     * @result The size of the buffer in bytes.
+     */
+    size_t size() const noexcept
+    {
+        return mSize;
+    }
+    /*!
+     * @result A pointer to the buffer viewed as an array of T.  This is
+     *         NULL if the buffer was never allocated.
+     */
+    template<typename T>
+    T *data() noexcept
+    {
+        return reinterpret_cast<T *> (mData);
+    }
+    template<typename T>
+    const T *data() const noexcept
+    {
+        return reinterpret_cast<const T *> (mData);
+    }
+private:
+    char *mData = nullptr;
+    size_t mSize = 0;
+    size_t mCapacity = 0;
+};
+}
+#endif
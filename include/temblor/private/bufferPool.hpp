@@ -0,0 +1,325 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_BUFFERPOOL_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_BUFFERPOOL_HPP 1
+#include <cstdlib>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Usage statistics of the buffer pool.
+ */
+struct BufferPoolStatistics
+{
+    /*! @brief The bytes held by buffers that are in use. */
+    size_t bytesLive = 0;
+    /*! @brief The largest value of bytesLive. */
+    size_t peakBytesLive = 0;
+    /*! @brief The bytes held by the pool for reuse. */
+    size_t bytesCached = 0;
+    /*! @brief The number of buffers handed out by the pool. */
+    uint64_t nAcquired = 0;
+    /*! @brief The number of buffers that were reused rather than obtained
+               from the system allocator. */
+    uint64_t nReused = 0;
+    /*!
+     * @result The fraction of buffers that were reused.
+     */
+    double getReuseRate() const noexcept
+    {
+        if (nAcquired == 0){return 0;}
+        return static_cast<double> (nReused)/static_cast<double> (nAcquired);
+    }
+};
+
+/*!
+ * @brief A process-wide pool of cache line aligned buffers.  Requests are
+ *        rounded up to one of four size classes per power of two so that
+ *        at most a fifth of a pooled buffer beyond the first 256 bytes is
+ *        unused.  Released buffers are kept in a small per-thread cache and
+ *        then in a shared, bounded cache so that repeatedly loading,
+ *        processing, and discarding traces does not go to the system
+ *        allocator.
+ * @note Buffers larger than MAXIMUM_POOLED_BYTES are allocated with their
+ *       requested size rounded to the alignment and are not pooled.  They
+ *       would not fit in the shared cache anyway.
+ */
+class BufferPool
+{
+public:
+    /*! @brief The alignment of every buffer in bytes. */
+    static constexpr size_t ALIGNMENT = 64;
+    /*! @brief The number of size classes, i.e., 64 B through 256 MB. */
+    static constexpr int N_SIZE_CLASSES = 84;
+    /*! @brief The largest buffer that is pooled. */
+    static constexpr size_t MAXIMUM_POOLED_BYTES = ALIGNMENT << 22;
+    /*! @brief The number of buffers of each size a thread keeps. */
+    static constexpr size_t MAXIMUM_THREAD_BUFFERS = 8;
+    /*! @brief The bytes each thread keeps. */
+    static constexpr size_t MAXIMUM_THREAD_BYTES = 32*1024*1024;
+
+    /*!
+     * @result The pool.  The pool is never destroyed so that buffers can
+     *         be released during static destruction.
+     */
+    static BufferPool &instance()
+    {
+        static auto pool = new BufferPool();
+        return *pool;
+    }
+    /*!
+     * @param[in] nBytes  The requested number of bytes.
+     * @result The number of bytes that the pool will allocate to satisfy
+     *         the request.
+     */
+    static size_t getCapacity(const size_t nBytes) noexcept
+    {
+        if (nBytes > MAXIMUM_POOLED_BYTES)
+        {
+            return (nBytes + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT;
+        }
+        return getClassCapacity(getSizeClass(nBytes));
+    }
+    /*!
+     * @brief Acquires a buffer.
+     * @param[in] nBytes  The number of bytes.  This must be positive.
+     * @result A buffer of \c getCapacity(nBytes) bytes aligned to
+     *         ALIGNMENT.  This must be returned with \c release().
+     * @throws std::bad_alloc if the memory cannot be allocated.
+     */
+    char *acquire(const size_t nBytes)
+    {
+        auto capacity = getCapacity(nBytes);
+        char *data = nullptr;
+        if (nBytes <= MAXIMUM_POOLED_BYTES)
+        {
+            auto sizeClass = getSizeClass(nBytes);
+            auto cache = getThreadCache();
+            if (cache && !cache->mBuffers[sizeClass].empty())
+            {
+                data = cache->mBuffers[sizeClass].back();
+                cache->mBuffers[sizeClass].pop_back();
+                cache->mBytes = cache->mBytes - capacity;
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mBuffers[sizeClass].empty())
+                {
+                    data = mBuffers[sizeClass].back();
+                    mBuffers[sizeClass].pop_back();
+                    mBytes = mBytes - capacity;
+                }
+            }
+            if (data)
+            {
+                mBytesCached.fetch_sub(capacity, std::memory_order_relaxed);
+                mReused.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (data == nullptr)
+        {
+            data = static_cast<char *> (std::aligned_alloc(ALIGNMENT,
+                                                           capacity));
+            if (data == nullptr){throw std::bad_alloc();}
+        }
+        mAcquired.fetch_add(1, std::memory_order_relaxed);
+        auto live = mBytesLive.fetch_add(capacity, std::memory_order_relaxed)
+                  + capacity;
+        auto peak = mPeakBytesLive.load(std::memory_order_relaxed);
+        while (live > peak &&
+               !mPeakBytesLive.compare_exchange_weak(
+                   peak, live, std::memory_order_relaxed))
+        {
+        }
+        return data;
+    }
+    /*!
+     * @brief Returns a buffer to the pool.
+     * @param[in] data      The buffer obtained from \c acquire().
+     * @param[in] capacity  The capacity of the buffer, i.e.,
+     *                      \c getCapacity() of the requested size.
+     */
+    void release(char *data, const size_t capacity) noexcept
+    {
+        if (data == nullptr){return;}
+        mBytesLive.fetch_sub(capacity, std::memory_order_relaxed);
+        if (capacity > MAXIMUM_POOLED_BYTES)
+        {
+            std::free(data);
+            return;
+        }
+        auto sizeClass = getSizeClass(capacity);
+        auto cache = getThreadCache();
+        if (cache &&
+            cache->mBuffers[sizeClass].size() < MAXIMUM_THREAD_BUFFERS &&
+            cache->mBytes + capacity <= MAXIMUM_THREAD_BYTES)
+        {
+            cache->mBuffers[sizeClass].push_back(data);
+            cache->mBytes = cache->mBytes + capacity;
+            mBytesCached.fetch_add(capacity, std::memory_order_relaxed);
+            return;
+        }
+        releaseShared(data, capacity);
+    }
+    /*!
+     * @brief Sets the number of bytes that the shared cache may hold.
+     * @param[in] nBytes  The number of bytes.  By default this is 256 MB.
+     *                    Buffers beyond this are returned to the system.
+     */
+    void setMaximumCachedBytes(const size_t nBytes) noexcept
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaximumBytes = nBytes;
+    }
+    /*!
+     * @brief Returns the buffers cached by the calling thread and the
+     *        shared cache to the system.
+     */
+    void trim() noexcept
+    {
+        auto cache = getThreadCache();
+        if (cache){cache->flush();}
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto &buffers : mBuffers)
+        {
+            for (auto &data : buffers){std::free(data);}
+            buffers.clear();
+        }
+        mBytesCached.fetch_sub(mBytes, std::memory_order_relaxed);
+        mBytes = 0;
+    }
+    /*!
+     * @result The pool's usage statistics.
+     */
+    BufferPoolStatistics getStatistics() const noexcept
+    {
+        BufferPoolStatistics statistics;
+        statistics.bytesLive = mBytesLive.load(std::memory_order_relaxed);
+        statistics.peakBytesLive
+            = mPeakBytesLive.load(std::memory_order_relaxed);
+        statistics.bytesCached = mBytesCached.load(std::memory_order_relaxed);
+        statistics.nAcquired = mAcquired.load(std::memory_order_relaxed);
+        statistics.nReused = mReused.load(std::memory_order_relaxed);
+        return statistics;
+    }
+private:
+    /// The buffers held by one thread.  These are handed to the shared
+    /// cache when the thread exits.
+    struct ThreadCache
+    {
+        ThreadCache()
+        {
+            for (auto &buffers : mBuffers)
+            {
+                buffers.reserve(MAXIMUM_THREAD_BUFFERS);
+            }
+        }
+        ~ThreadCache()
+        {
+            flush();
+            isThreadCacheDestroyed() = true;
+        }
+        void flush() noexcept
+        {
+            auto &pool = BufferPool::instance();
+            for (int sizeClass=0; sizeClass<N_SIZE_CLASSES; ++sizeClass)
+            {
+                auto capacity = getClassCapacity(sizeClass);
+                for (auto &data : mBuffers[sizeClass])
+                {
+                    pool.mBytesCached.fetch_sub(capacity,
+                                                std::memory_order_relaxed);
+                    pool.releaseShared(data, capacity);
+                }
+                mBuffers[sizeClass].clear();
+            }
+            mBytes = 0;
+        }
+        std::array<std::vector<char *>, N_SIZE_CLASSES> mBuffers;
+        size_t mBytes = 0;
+    };
+
+    BufferPool() = default;
+    /// The size class of a request.  Classes 0 through 3 hold 1 through 4
+    /// lines of ALIGNMENT bytes.  After that each octave (2^k, 2^(k+1)]
+    /// of lines is split into 4 classes that are 2^(k-2) lines apart.
+    static int getSizeClass(const size_t nBytes) noexcept
+    {
+        auto nLines = static_cast<unsigned long long>
+                      ((nBytes + ALIGNMENT - 1)/ALIGNMENT);
+        if (nLines <= 1){return 0;}
+        if (nLines <= 4){return static_cast<int> (nLines) - 1;}
+        int k = 63 - __builtin_clzll(nLines - 1);
+        auto step = 1ULL << (k - 2);
+        auto sub = static_cast<int> (((nLines - (1ULL << k)) + step - 1)/step);
+        return 4 + 4*(k - 2) + (sub - 1);
+    }
+    /// The number of bytes in a size class
+    static size_t getClassCapacity(const int sizeClass) noexcept
+    {
+        if (sizeClass < 4)
+        {
+            return ALIGNMENT*static_cast<size_t> (sizeClass + 1);
+        }
+        auto k = 2 + (sizeClass - 4)/4;
+        auto sub = static_cast<size_t> ((sizeClass - 4)%4 + 1);
+        return ALIGNMENT*((size_t {1} << k) + sub*(size_t {1} << (k - 2)));
+    }
+    /// A thread's cache may be used during static destruction after it was
+    /// destroyed.  The flag is trivially destructible so it outlives it.
+    static bool &isThreadCacheDestroyed() noexcept
+    {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+    static ThreadCache *getThreadCache() noexcept
+    {
+        if (isThreadCacheDestroyed()){return nullptr;}
+        try
+        {
+            thread_local ThreadCache cache;
+            return &cache;
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+    /// Keeps a buffer in the shared cache or returns it to the system
+    void releaseShared(char *data, const size_t capacity) noexcept
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mBytes + capacity <= mMaximumBytes)
+        {
+            try
+            {
+                mBuffers[getSizeClass(capacity)].push_back(data);
+                mBytes = mBytes + capacity;
+                mBytesCached.fetch_add(capacity, std::memory_order_relaxed);
+                return;
+            }
+            catch (...)
+            {
+            }
+        }
+        lock.unlock();
+        std::free(data);
+    }
+
+    mutable std::mutex mMutex;
+    std::array<std::vector<char *>, N_SIZE_CLASSES> mBuffers;
+    size_t mBytes = 0;
+    size_t mMaximumBytes = 256*1024*1024;
+    std::atomic<size_t> mBytesLive{0};
+    std::atomic<size_t> mPeakBytesLive{0};
+    std::atomic<size_t> mBytesCached{0};
+    std::atomic<uint64_t> mAcquired{0};
+    std::atomic<uint64_t> mReused{0};
+};
+}
+#endif
@@ -0,0 +1,375 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_BYTESWAP_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_BYTESWAP_HPP 1
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include "temblor/private/cpuFeatures.hpp"
+#ifdef TEMBLOR_USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Unpacks a scalar, e.g., a header word.
+ * @param[in] x      The bytes of the scalar.  This is an array of
+ *                   dimension [sizeof(T)].
+ * @param[in] lswap  If true then the bytes are reversed.
+ * @result The scalar in the machine's byte order.
+ */
+template<typename T>
+T unpackScalar(const char x[], const bool lswap) noexcept
+{
+    char c[sizeof(T)];
+    std::memcpy(c, x, sizeof(T));
+    if (lswap)
+    {
+        for (size_t i=0; i<sizeof(T)/2; ++i)
+        {
+            std::swap(c[i], c[sizeof(T) - 1 - i]);
+        }
+    }
+    T value;
+    std::memcpy(&value, c, sizeof(T));
+    return value;
+}
+/*!
+ * @brief Packs a scalar, e.g., a header word.
+ * @param[in] value  The scalar in the machine's byte order.
+ * @param[out] y     The bytes of the scalar.  This is an array of
+ *                   dimension [sizeof(T)].
+ * @param[in] lswap  If true then the bytes are reversed.
+ */
+template<typename T>
+void packScalar(const T value, char y[], const bool lswap) noexcept
+{
+    std::memcpy(y, &value, sizeof(T));
+    if (lswap)
+    {
+        for (size_t i=0; i<sizeof(T)/2; ++i)
+        {
+            std::swap(y[i], y[sizeof(T) - 1 - i]);
+        }
+    }
+}
+/*!
+ * @brief Unpacks byte swapped 64-bit floats and converts them to T.
+ * @param[in] n   The number of samples.
+ * @param[in] x   The byte swapped samples.  This is an array of
+ *                dimension [8*n].
+ * @param[out] y  The samples in the machine's byte order.  This is an
+ *                array of dimension [n].
+ */
+template<typename T>
+void unpackSwapped64(const int64_t n, const char x[], T y[]) noexcept
+{
+    for (int64_t i=0; i<n; ++i)
+    {
+        uint64_t u8;
+        std::memcpy(&u8, x + 8*i, sizeof(uint64_t));
+        u8 = __builtin_bswap64(u8);
+        double f8;
+        std::memcpy(&f8, &u8, sizeof(double));
+        y[i] = static_cast<T> (f8);
+    }
+}
+/*!
+ * @brief Unpacks byte swapped 32-bit floats and converts them to T.
+ * @param[in] n   The number of samples.
+ * @param[in] x   The byte swapped samples.  This is an array of
+ *                dimension [4*n].
+ * @param[out] y  The samples in the machine's byte order.  This is an
+ *                array of dimension [n].
+ */
+template<typename T>
+void unpackSwapped32(const int64_t n, const char x[], T y[]) noexcept
+{
+    for (int64_t i=0; i<n; ++i)
+    {
+        uint32_t u4;
+        std::memcpy(&u4, x + 4*i, sizeof(uint32_t));
+        u4 = __builtin_bswap32(u4);
+        float f4;
+        std::memcpy(&f4, &u4, sizeof(float));
+        y[i] = static_cast<T> (f4);
+    }
+}
+/*!
+ * @brief Converts samples to 32-bit floats and packs them byte swapped.
+ * @param[in] n   The number of samples.
+ * @param[in] x   The samples in the machine's byte order.  This is an
+ *                array of dimension [n].
+ * @param[out] y  The byte swapped samples.  This is an array of
+ *                dimension [4*n].
+ */
+template<typename T>
+void packSwapped32(const int64_t n, const T x[], char y[]) noexcept
+{
+    for (int64_t i=0; i<n; ++i)
+    {
+        auto f4 = static_cast<float> (x[i]);
+        uint32_t u4;
+        std::memcpy(&u4, &f4, sizeof(uint32_t));
+        u4 = __builtin_bswap32(u4);
+        std::memcpy(y + 4*i, &u4, sizeof(uint32_t));
+    }
+}
+
+#ifdef TEMBLOR_USE_X86_SIMD
+/// Vector kernels that reverse the bytes of each 32-bit word with a byte
+/// shuffle and widen to, or narrow from, double in the same pass.  The
+/// remainder is finished with scalar code.
+__attribute__((target("ssse3")))
+inline __m128i byteSwapMaskSSSE3() noexcept
+{
+    return _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+                        4, 5, 6, 7, 0, 1, 2, 3);
+}
+
+__attribute__((target("avx2")))
+inline __m256i byteSwapMaskAVX2() noexcept
+{
+    return _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+                           4, 5, 6, 7, 0, 1, 2, 3,
+                           12, 13, 14, 15, 8, 9, 10, 11,
+                           4, 5, 6, 7, 0, 1, 2, 3);
+}
+
+__attribute__((target("ssse3")))
+inline int64_t unpackSwapped32SSSE3(const int64_t n, const char x[],
+                                    float y[]) noexcept
+{
+    const auto mask = byteSwapMaskSSSE3();
+    int64_t i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                 (x + 4*i));
+        _mm_storeu_ps(y + i, _mm_castsi128_ps(_mm_shuffle_epi8(v, mask)));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+inline int64_t unpackSwapped32SSSE3(const int64_t n, const char x[],
+                                    double y[]) noexcept
+{
+    const auto mask = byteSwapMaskSSSE3();
+    int64_t i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                 (x + 4*i));
+        auto f = _mm_castsi128_ps(_mm_shuffle_epi8(v, mask));
+        _mm_storeu_pd(y + i, _mm_cvtps_pd(f));
+        _mm_storeu_pd(y + i + 2, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+inline int64_t packSwapped32SSSE3(const int64_t n, const float x[],
+                                  char y[]) noexcept
+{
+    const auto mask = byteSwapMaskSSSE3();
+    int64_t i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        auto v = _mm_castps_si128(_mm_loadu_ps(x + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i),
+                         _mm_shuffle_epi8(v, mask));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3")))
+inline int64_t packSwapped32SSSE3(const int64_t n, const double x[],
+                                  char y[]) noexcept
+{
+    const auto mask = byteSwapMaskSSSE3();
+    int64_t i = 0;
+    for (; i + 4 <= n; i = i + 4)
+    {
+        auto f = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(x + i)),
+                               _mm_cvtpd_ps(_mm_loadu_pd(x + i + 2)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i),
+                         _mm_shuffle_epi8(_mm_castps_si128(f), mask));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t unpackSwapped32AVX2(const int64_t n, const char x[],
+                                   float y[]) noexcept
+{
+    const auto mask = byteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                                    (x + 4*i));
+        _mm256_storeu_ps(y + i,
+                         _mm256_castsi256_ps(_mm256_shuffle_epi8(v, mask)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t unpackSwapped32AVX2(const int64_t n, const char x[],
+                                   double y[]) noexcept
+{
+    const auto mask = byteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>
+                                    (x + 4*i));
+        auto f = _mm256_castsi256_ps(_mm256_shuffle_epi8(v, mask));
+        _mm256_storeu_pd(y + i, _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+        _mm256_storeu_pd(y + i + 4,
+                         _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t packSwapped32AVX2(const int64_t n, const float x[],
+                                 char y[]) noexcept
+{
+    const auto mask = byteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_castps_si256(_mm256_loadu_ps(x + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *> (y + 4*i),
+                            _mm256_shuffle_epi8(v, mask));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t packSwapped32AVX2(const int64_t n, const double x[],
+                                 char y[]) noexcept
+{
+    const auto mask = byteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto f = _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(x + i + 4)),
+                                 _mm256_cvtpd_ps(_mm256_loadu_pd(x + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *> (y + 4*i),
+                            _mm256_shuffle_epi8(_mm256_castps_si256(f),
+                                                mask));
+    }
+    return i;
+}
+#endif
+
+/*!
+ * @brief Dispatches the unpacking of byte swapped floats to the widest
+ *        instruction set that the CPU supports.
+ */
+inline void unpackSwapped32(const int64_t n, const char x[],
+                            float y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2())
+    {
+        i = unpackSwapped32AVX2(n, x, y);
+    }
+    else if (haveSSSE3())
+    {
+        i = unpackSwapped32SSSE3(n, x, y);
+    }
+#endif
+    unpackSwapped32<float>(n - i, x + 4*i, y + i);
+}
+
+inline void unpackSwapped32(const int64_t n, const char x[],
+                            double y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2())
+    {
+        i = unpackSwapped32AVX2(n, x, y);
+    }
+    else if (haveSSSE3())
+    {
+        i = unpackSwapped32SSSE3(n, x, y);
+    }
+#endif
+    unpackSwapped32<double>(n - i, x + 4*i, y + i);
+}
+
+/*!
+ * @brief Dispatches the packing of byte swapped floats to the widest
+ *        instruction set that the CPU supports.
+ */
+inline void packSwapped32(const int64_t n, const float x[],
+                          char y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2())
+    {
+        i = packSwapped32AVX2(n, x, y);
+    }
+    else if (haveSSSE3())
+    {
+        i = packSwapped32SSSE3(n, x, y);
+    }
+#endif
+    packSwapped32<float>(n - i, x + i, y + 4*i);
+}
+
+inline void packSwapped32(const int64_t n, const double x[],
+                          char y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2())
+    {
+        i = packSwapped32AVX2(n, x, y);
+    }
+    else if (haveSSSE3())
+    {
+        i = packSwapped32SSSE3(n, x, y);
+    }
+#endif
+    packSwapped32<double>(n - i, x + i, y + 4*i);
+}
+
+/*!
+ * @brief Reverses the byte order of 32-bit words in place.
+ * @param[in] n      The number of words.
+ * @param[in,out] x  The words to swap.  This is an array of dimension
+ *                   [4*n].
+ */
+inline void swapBytes32(const int64_t n, char x[]) noexcept
+{
+    // Each vector is loaded before it is stored so the kernels can run
+    // in place
+    auto y = reinterpret_cast<float *> (x);
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2())
+    {
+        i = unpackSwapped32AVX2(n, x, y);
+    }
+    else if (haveSSSE3())
+    {
+        i = unpackSwapped32SSSE3(n, x, y);
+    }
+#endif
+    for (; i<n; ++i)
+    {
+        uint32_t u4;
+        std::memcpy(&u4, x + 4*i, sizeof(uint32_t));
+        u4 = __builtin_bswap32(u4);
+        std::memcpy(x + 4*i, &u4, sizeof(uint32_t));
+    }
+}
+}
+#endif
@@ -0,0 +1,51 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_CPUFEATURES_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_CPUFEATURES_HPP 1
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+ #define TEMBLOR_USE_X86_SIMD 1
+#endif
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Determines if the CPU supports the SSSE3 instruction set.
+ * @result True indicates that SSSE3 instructions can be used.
+ */
+inline bool haveSSSE3() noexcept
+{
+#ifdef TEMBLOR_USE_X86_SIMD
+    static const bool lhave = __builtin_cpu_supports("ssse3");
+    return lhave;
+#else
+    return false;
+#endif
+}
+/*!
+ * @brief Determines if the CPU supports the SSE4.1 instruction set.
+ * @result True indicates that SSE4.1 instructions can be used.
+ */
+inline bool haveSSE41() noexcept
+{
+#ifdef TEMBLOR_USE_X86_SIMD
+    static const bool lhave = __builtin_cpu_supports("sse4.1");
+    return lhave;
+#else
+    return false;
+#endif
+}
+/*!
+ * @brief Determines if the CPU supports the AVX2 instruction set.
+ * @result True indicates that AVX2 instructions can be used.
+ */
+inline bool haveAVX2() noexcept
+{
+#ifdef TEMBLOR_USE_X86_SIMD
+    static const bool lhave = __builtin_cpu_supports("avx2");
+    return lhave;
+#else
+    return false;
+#endif
+}
+}
+#endif
@@ -0,0 +1,312 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_IBMFLOAT_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_IBMFLOAT_HPP 1
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "temblor/private/cpuFeatures.hpp"
+#ifdef TEMBLOR_USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Converts a 4-byte IBM System/360 float to a double.  The IBM
+ *        format is a sign bit, a 7-bit base 16 exponent biased by 64,
+ *        and a 24-bit fraction.  Every IBM float is exactly representable
+ *        as a double.
+ * @param[in] u4  The IBM float in the machine's byte order.
+ * @result The value of the IBM float.
+ */
+inline double ibmToDouble(const uint32_t u4) noexcept
+{
+    auto fraction = static_cast<double> (u4 & 0x00ffffff);
+    auto exponent = static_cast<int> ((u4 >> 24) & 0x7f);
+    auto value = std::ldexp(fraction, 4*(exponent - 64) - 24);
+    return (u4 & 0x80000000) ? -value : value;
+}
+/*!
+ * @brief Converts a double to a 4-byte IBM System/360 float.  The fraction
+ *        is rounded to nearest with ties to even.  Values beyond the IBM
+ *        range, infinities, and NaNs saturate to the largest IBM magnitude
+ *        while values below the IBM range are denormalized or flushed to
+ *        zero.
+ * @param[in] x  The value to convert.
+ * @result The IBM float in the machine's byte order.
+ */
+inline uint32_t doubleToIBM(const double x) noexcept
+{
+    uint64_t u8;
+    std::memcpy(&u8, &x, sizeof(double));
+    auto sign = static_cast<uint32_t> (u8 >> 32) & 0x80000000;
+    // Writing |x| = m 2^e with m in [0.5, 1) the hexadecimal exponent
+    // is ceil(e/4).  Small values are clamped to the least IBM exponent
+    // which denormalizes the fraction.
+    auto biasedExponent = static_cast<int> ((u8 >> 52) & 0x7ff);
+    auto exponent = std::max(-64, ((biasedExponent + 5) >> 2) - 256);
+    if (exponent > 63){return sign | 0x7fffffff;}
+    auto fraction = static_cast<uint32_t>
+        (std::nearbyint(std::fabs(x)*std::ldexp(1.0, 24 - 4*exponent)));
+    // Rounding may carry into the next hexadecimal digit
+    if (fraction == 0x01000000)
+    {
+        fraction = 0x00100000;
+        exponent = exponent + 1;
+        if (exponent > 63){return sign | 0x7fffffff;}
+    }
+    return sign | (static_cast<uint32_t> (exponent + 64) << 24) | fraction;
+}
+/*!
+ * @brief Unpacks 4-byte IBM floats and converts them to T.
+ * @param[in] n      The number of samples.
+ * @param[in] x      The IBM floats.  This is an array of dimension [4*n].
+ * @param[out] y     The samples.  This is an array of dimension [n].
+ * @param[in] lswap  If true then the bytes of each word are reversed
+ *                   before conversion, e.g., big-endian SEG-Y data on a
+ *                   little-endian machine.
+ */
+template<typename T>
+void unpackIBM32(const int64_t n, const char x[], T y[],
+                 const bool lswap) noexcept
+{
+    for (int64_t i=0; i<n; ++i)
+    {
+        uint32_t u4;
+        std::memcpy(&u4, x + 4*i, sizeof(uint32_t));
+        if (lswap){u4 = __builtin_bswap32(u4);}
+        y[i] = static_cast<T> (ibmToDouble(u4));
+    }
+}
+/*!
+ * @brief Converts samples to 4-byte IBM floats and packs them.
+ * @param[in] n      The number of samples.
+ * @param[in] x      The samples.  This is an array of dimension [n].
+ * @param[out] y     The IBM floats.  This is an array of dimension [4*n].
+ * @param[in] lswap  If true then the bytes of each word are reversed
+ *                   after conversion, e.g., to write big-endian SEG-Y
+ *                   data on a little-endian machine.
+ */
+template<typename T>
+void packIBM32(const int64_t n, const T x[], char y[],
+               const bool lswap) noexcept
+{
+    for (int64_t i=0; i<n; ++i)
+    {
+        auto u4 = doubleToIBM(static_cast<double> (x[i]));
+        if (lswap){u4 = __builtin_bswap32(u4);}
+        std::memcpy(y + 4*i, &u4, sizeof(uint32_t));
+    }
+}
+
+#ifdef TEMBLOR_USE_X86_SIMD
+/// Vector kernels that convert 8 IBM floats per iteration.  The byte swap
+/// is a shuffle on the loaded words.  The arithmetic is carried out in
+/// double precision where scaling by a power of two is exact so the
+/// results are identical to the scalar conversions.  The remainder is
+/// finished with scalar code.
+__attribute__((target("avx2")))
+inline __m128i ibmByteSwapMaskAVX2() noexcept
+{
+    return _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+                        4, 5, 6, 7, 0, 1, 2, 3);
+}
+
+/// Converts 4 IBM floats in the machine's byte order to doubles
+__attribute__((target("avx2")))
+inline __m256d ibmToDoubleAVX2(const __m128i u4) noexcept
+{
+    auto fraction
+        = _mm256_cvtepi32_pd(_mm_and_si128(u4, _mm_set1_epi32(0x00ffffff)));
+    // 16^(e - 64) 2^-24 = 2^(4e - 280) is built in the exponent bits
+    auto exponent = _mm_and_si128(_mm_srli_epi32(u4, 24),
+                                  _mm_set1_epi32(0x7f));
+    auto scaleExponent = _mm_add_epi32(_mm_slli_epi32(exponent, 2),
+                                       _mm_set1_epi32(1023 - 280));
+    auto scale = _mm256_castsi256_pd(
+        _mm256_slli_epi64(_mm256_cvtepu32_epi64(scaleExponent), 52));
+    auto sign = _mm256_slli_epi64(
+        _mm256_cvtepu32_epi64(_mm_srli_epi32(u4, 31)), 63);
+    return _mm256_or_pd(_mm256_mul_pd(fraction, scale),
+                        _mm256_castsi256_pd(sign));
+}
+
+/// Converts 4 doubles to IBM floats in the machine's byte order
+__attribute__((target("avx2")))
+inline __m128i doubleToIBMAVX2(const __m256d x) noexcept
+{
+    // The high words hold the sign and exponent
+    auto bits = _mm256_castpd_si256(x);
+    auto high = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+                    bits, _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7)));
+    auto sign = _mm_and_si128(high, _mm_set1_epi32(0x80000000));
+    auto biasedExponent = _mm_and_si128(_mm_srli_epi32(high, 20),
+                                        _mm_set1_epi32(0x7ff));
+    auto exponent = _mm_sub_epi32(
+        _mm_srli_epi32(_mm_add_epi32(biasedExponent, _mm_set1_epi32(5)), 2),
+        _mm_set1_epi32(256));
+    exponent = _mm_max_epi32(exponent, _mm_set1_epi32(-64));
+    exponent = _mm_min_epi32(exponent, _mm_set1_epi32(64));
+    // |x| 2^(24 - 4e) rounded to nearest even
+    auto scaleExponent = _mm_sub_epi32(_mm_set1_epi32(1023 + 24),
+                                       _mm_slli_epi32(exponent, 2));
+    auto scale = _mm256_castsi256_pd(
+        _mm256_slli_epi64(_mm256_cvtepu32_epi64(scaleExponent), 52));
+    auto magnitude = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    auto fraction = _mm256_cvtpd_epi32(
+        _mm256_round_pd(_mm256_mul_pd(magnitude, scale),
+                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    auto carry = _mm_cmpeq_epi32(fraction, _mm_set1_epi32(0x01000000));
+    fraction = _mm_blendv_epi8(fraction, _mm_set1_epi32(0x00100000), carry);
+    exponent = _mm_sub_epi32(exponent, carry);
+    // Saturate beyond the IBM range.  This includes infinities and NaNs.
+    auto overflow = _mm_cmpgt_epi32(exponent, _mm_set1_epi32(63));
+    auto result = _mm_or_si128(
+        _mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(64)), 24),
+        fraction);
+    result = _mm_blendv_epi8(result, _mm_set1_epi32(0x7fffffff), overflow);
+    return _mm_or_si128(result, sign);
+}
+
+__attribute__((target("avx2")))
+inline int64_t unpackIBM32AVX2(const int64_t n, const char x[], float y[],
+                               const bool lswap) noexcept
+{
+    const auto mask = ibmByteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                  (x + 4*i));
+        auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                  (x + 4*i + 16));
+        if (lswap)
+        {
+            v0 = _mm_shuffle_epi8(v0, mask);
+            v1 = _mm_shuffle_epi8(v1, mask);
+        }
+        auto f0 = _mm256_cvtpd_ps(ibmToDoubleAVX2(v0));
+        auto f1 = _mm256_cvtpd_ps(ibmToDoubleAVX2(v1));
+        _mm256_storeu_ps(y + i, _mm256_set_m128(f1, f0));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t unpackIBM32AVX2(const int64_t n, const char x[], double y[],
+                               const bool lswap) noexcept
+{
+    const auto mask = ibmByteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                  (x + 4*i));
+        auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>
+                                  (x + 4*i + 16));
+        if (lswap)
+        {
+            v0 = _mm_shuffle_epi8(v0, mask);
+            v1 = _mm_shuffle_epi8(v1, mask);
+        }
+        _mm256_storeu_pd(y + i, ibmToDoubleAVX2(v0));
+        _mm256_storeu_pd(y + i + 4, ibmToDoubleAVX2(v1));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t packIBM32AVX2(const int64_t n, const float x[], char y[],
+                             const bool lswap) noexcept
+{
+    const auto mask = ibmByteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto f = _mm256_loadu_ps(x + i);
+        auto d0 = _mm256_cvtps_pd(_mm256_castps256_ps128(f));
+        auto d1 = _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1));
+        auto v0 = doubleToIBMAVX2(d0);
+        auto v1 = doubleToIBMAVX2(d1);
+        if (lswap)
+        {
+            v0 = _mm_shuffle_epi8(v0, mask);
+            v1 = _mm_shuffle_epi8(v1, mask);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i), v0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i + 16), v1);
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t packIBM32AVX2(const int64_t n, const double x[], char y[],
+                             const bool lswap) noexcept
+{
+    const auto mask = ibmByteSwapMaskAVX2();
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v0 = doubleToIBMAVX2(_mm256_loadu_pd(x + i));
+        auto v1 = doubleToIBMAVX2(_mm256_loadu_pd(x + i + 4));
+        if (lswap)
+        {
+            v0 = _mm_shuffle_epi8(v0, mask);
+            v1 = _mm_shuffle_epi8(v1, mask);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i), v0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *> (y + 4*i + 16), v1);
+    }
+    return i;
+}
+#endif
+
+/*!
+ * @brief Dispatches the unpacking of IBM floats to AVX2 when the CPU
+ *        supports it.
+ */
+inline void unpackIBM32(const int64_t n, const char x[], float y[],
+                        const bool lswap) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = unpackIBM32AVX2(n, x, y, lswap);}
+#endif
+    unpackIBM32<float>(n - i, x + 4*i, y + i, lswap);
+}
+
+inline void unpackIBM32(const int64_t n, const char x[], double y[],
+                        const bool lswap) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = unpackIBM32AVX2(n, x, y, lswap);}
+#endif
+    unpackIBM32<double>(n - i, x + 4*i, y + i, lswap);
+}
+
+/*!
+ * @brief Dispatches the packing of IBM floats to AVX2 when the CPU
+ *        supports it.
+ */
+inline void packIBM32(const int64_t n, const float x[], char y[],
+                      const bool lswap) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = packIBM32AVX2(n, x, y, lswap);}
+#endif
+    packIBM32<float>(n - i, x + i, y + 4*i, lswap);
+}
+
+inline void packIBM32(const int64_t n, const double x[], char y[],
+                      const bool lswap) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = packIBM32AVX2(n, x, y, lswap);}
+#endif
+    packIBM32<double>(n - i, x + i, y + 4*i, lswap);
+}
+}
+#endif
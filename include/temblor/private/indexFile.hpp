@@ -0,0 +1,157 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_INDEXFILE_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_INDEXFILE_HPP 1
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace Temblor::Private
+{
+/// The length of the magic string that identifies an index file
+constexpr size_t INDEX_MAGIC_LENGTH = 8;
+/// Detects index files written on a machine with a different byte order
+constexpr uint32_t INDEX_BYTE_ORDER_MARK = 0x01020304;
+
+/*!
+ * @brief Serializes the values of a binary index file in native byte
+ *        order.
+ * @note An index file begins with a preamble of a magic string, a format
+ *       version, and a byte order mark.
+ */
+class IndexWriter
+{
+public:
+    /*!
+     * @brief Appends the preamble.
+     * @param[in] magic    The magic string that identifies the index type.
+     * @param[in] version  The format version of the index.
+     */
+    void putPreamble(const char (&magic)[INDEX_MAGIC_LENGTH],
+                     const uint32_t version)
+    {
+        for (const auto &c : magic){put(c);}
+        put(version);
+        put(INDEX_BYTE_ORDER_MARK);
+    }
+    /*!
+     * @brief Appends a value.
+     * @param[in] value  The value to append.
+     */
+    template<typename T> void put(const T value)
+    {
+        auto bytes = reinterpret_cast<const char *> (&value);
+        mBuffer.insert(mBuffer.end(), bytes, bytes + sizeof(T));
+    }
+    /*!
+     * @brief Appends a string preceded by its length.
+     * @param[in] value  The string to append.
+     */
+    void putString(const std::string &value)
+    {
+        put(static_cast<uint32_t> (value.size()));
+        mBuffer.insert(mBuffer.end(), value.begin(), value.end());
+    }
+    std::vector<char> mBuffer; /*!< The serialized values. */
+};
+
+/*!
+ * @brief Deserializes the values written by \c IndexWriter.
+ * @note The buffer must outlive the reader.
+ */
+class IndexReader
+{
+public:
+    /*!
+     * @brief Constructor.
+     * @param[in] buffer  The contents of the index file.
+     */
+    explicit IndexReader(const std::vector<char> &buffer) :
+        mBuffer(buffer)
+    {
+    }
+    /*!
+     * @brief Reads and checks the preamble.
+     * @param[in] magic     The expected magic string.
+     * @param[in] version   The expected format version.
+     * @param[in] fileName  The name of the index file for error messages.
+     * @throws std::invalid_argument if the file is not an index of this
+     *         type, has a different version, or was written with a
+     *         different byte order.
+     */
+    void checkPreamble(const char (&magic)[INDEX_MAGIC_LENGTH],
+                       const uint32_t version, const std::string &fileName)
+    {
+        for (const auto &c : magic)
+        {
+            if (get<char> () != c)
+            {
+                throw std::invalid_argument(fileName
+                                          + " is not an index file\n");
+            }
+        }
+        if (get<uint32_t> () != version)
+        {
+            throw std::invalid_argument("Unsupported index file version\n");
+        }
+        if (get<uint32_t> () != INDEX_BYTE_ORDER_MARK)
+        {
+            throw std::invalid_argument(
+                "Index file was written with a different byte order\n");
+        }
+    }
+    /*!
+     * @brief Reads a value.
+     * @result The next value.
+     * @throws std::invalid_argument if the buffer is exhausted.
+     */
+    template<typename T> T get()
+    {
+        if (mOffset + sizeof(T) > mBuffer.size())
+        {
+            throw std::invalid_argument("Index file is truncated\n");
+        }
+        T value;
+        std::memcpy(&value, mBuffer.data() + mOffset, sizeof(T));
+        mOffset = mOffset + sizeof(T);
+        return value;
+    }
+    /*!
+     * @brief Reads a string preceded by its length.
+     * @result The next string.
+     * @throws std::invalid_argument if the buffer is exhausted.
+     */
+    std::string getString()
+    {
+        auto length = static_cast<size_t> (get<uint32_t> ());
+        if (mOffset + length > mBuffer.size())
+        {
+            throw std::invalid_argument("Index file is truncated\n");
+        }
+        std::string value(mBuffer.data() + mOffset, length);
+        mOffset = mOffset + length;
+        return value;
+    }
+    /*!
+     * @brief Gets the number of bytes read.
+     * @result The offset of the next value.
+     */
+    size_t getOffset() const noexcept
+    {
+        return mOffset;
+    }
+    /*!
+     * @brief Gets the number of unread bytes.  This guards reserve()
+     *        against corrupt counts.
+     * @result The bytes remaining in the buffer.
+     */
+    size_t getRemaining() const noexcept
+    {
+        return mBuffer.size() - mOffset;
+    }
+private:
+    const std::vector<char> &mBuffer;
+    size_t mOffset = 0;
+};
+}
+#endif
@@ -0,0 +1,96 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_MAPPEDFILE_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_MAPPEDFILE_HPP 1
+#include <string>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Temblor::Private
+{
+/*!
+ * @brief A read-only memory map of a file.  The mapping is released when
+ *        the class goes out of scope.
+ */
+class MappedFile
+{
+public:
+    /*!
+     * @brief Maps the given file into memory.
+     * @param[in] fileName  The name of the file to map.
+     * @throws std::invalid_argument if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string &fileName)
+    {
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::invalid_argument("Could not open file = "
+                                      + fileName + "\n");
+        }
+        struct stat fileStatus;
+        if (fstat(fd, &fileStatus) != 0)
+        {
+            close(fd);
+            throw std::invalid_argument("Could not stat file = "
+                                      + fileName + "\n");
+        }
+        mSize = static_cast<size_t> (fileStatus.st_size);
+        if (mSize > 0)
+        {
+            auto map = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                close(fd);
+                throw std::invalid_argument("Could not map file = "
+                                          + fileName + "\n");
+            }
+            mData = static_cast<const char *> (map);
+        }
+        close(fd);
+    }
+    /*!
+     * @brief Destructor.  Unmaps the file.
+     */
+    ~MappedFile()
+    {
+        if (mData){munmap(const_cast<char *> (mData), mSize);}
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    /*!
+     * @brief Indicates to the kernel that the file will be read sequentially.
+     */
+    void adviseSequential() const noexcept
+    {
+        if (mData)
+        {
+            madvise(const_cast<char *> (mData), mSize, MADV_SEQUENTIAL);
+        }
+    }
+    /*!
+     * @brief Indicates to the kernel that the file will be read randomly.
+     */
+    void adviseRandom() const noexcept
+    {
+        if (mData)
+        {
+            madvise(const_cast<char *> (mData), mSize, MADV_RANDOM);
+        }
+    }
+    /*!
+     * @result A pointer to the start of the file.  This is NULL if the file
+     *         is empty.
+     */
+    const char *data() const noexcept{return mData;}
+    /*!
+     * @result The size of the file in bytes.
+     */
+    size_t size() const noexcept{return mSize;}
+private:
+    const char *mData = nullptr;
+    size_t mSize = 0;
+};
+}
+#endif
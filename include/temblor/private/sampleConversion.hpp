@@ -0,0 +1,125 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_SAMPLECONVERSION_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_SAMPLECONVERSION_HPP 1
+#include <cstdint>
+#include <cstring>
+#include "temblor/private/cpuFeatures.hpp"
+#ifdef TEMBLOR_USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Converts samples from one precision to another.
+ * @param[in] n   The number of samples.
+ * @param[in] x   The samples to convert.  This is an array of dimension [n].
+ * @param[out] y  The converted samples.  This is an array of dimension [n]
+ *                that does not overlap x.
+ */
+template<typename T, typename S>
+void convertSamples(const int64_t n, const T x[], S y[]) noexcept
+{
+    #pragma omp simd
+    for (int64_t i=0; i<n; ++i)
+    {
+        y[i] = static_cast<S> (x[i]);
+    }
+}
+/*!
+ * @brief Copies samples of the same precision.
+ */
+template<typename T>
+void convertSamples(const int64_t n, const T x[], T y[]) noexcept
+{
+    if (n > 0){std::memcpy(y, x, static_cast<size_t> (n)*sizeof(T));}
+}
+
+#ifdef TEMBLOR_USE_X86_SIMD
+/// AVX2 kernels for the conversions used when handing integer counts to
+/// floating point consumers.  The remainder is finished with scalar code.
+__attribute__((target("avx2")))
+inline int64_t convertSamplesAVX2(const int64_t n, const int32_t x[],
+                                  double y[]) noexcept
+{
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (x + i));
+        _mm256_storeu_pd(y + i,
+                         _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)));
+        _mm256_storeu_pd(y + i + 4,
+                         _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t convertSamplesAVX2(const int64_t n, const int32_t x[],
+                                  float y[]) noexcept
+{
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *> (x + i));
+        _mm256_storeu_ps(y + i, _mm256_cvtepi32_ps(v));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+inline int64_t convertSamplesAVX2(const int64_t n, const float x[],
+                                  double y[]) noexcept
+{
+    int64_t i = 0;
+    for (; i + 8 <= n; i = i + 8)
+    {
+        auto v = _mm256_loadu_ps(x + i);
+        _mm256_storeu_pd(y + i, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        _mm256_storeu_pd(y + i + 4,
+                         _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    return i;
+}
+#endif
+
+/*!
+ * @brief Converts 32-bit integer samples to double precision.  AVX2 is used
+ *        when the CPU supports it.
+ */
+inline void convertSamples(const int64_t n, const int32_t x[],
+                           double y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = convertSamplesAVX2(n, x, y);}
+#endif
+    convertSamples<int32_t, double>(n - i, x + i, y + i);
+}
+/*!
+ * @brief Converts 32-bit integer samples to single precision.  AVX2 is used
+ *        when the CPU supports it.
+ */
+inline void convertSamples(const int64_t n, const int32_t x[],
+                           float y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = convertSamplesAVX2(n, x, y);}
+#endif
+    convertSamples<int32_t, float>(n - i, x + i, y + i);
+}
+/*!
+ * @brief Converts single precision samples to double precision.  AVX2 is
+ *        used when the CPU supports it.
+ */
+inline void convertSamples(const int64_t n, const float x[],
+                           double y[]) noexcept
+{
+    int64_t i = 0;
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (haveAVX2()){i = convertSamplesAVX2(n, x, y);}
+#endif
+    convertSamples<float, double>(n - i, x + i, y + i);
+}
+}
+#endif
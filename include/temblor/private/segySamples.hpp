@@ -0,0 +1,136 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_SEGYSAMPLES_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_SEGYSAMPLES_HPP 1
+#include <cstring>
+#include <stdexcept>
+#include "temblor/private/byteSwap.hpp"
+#include "temblor/private/ibmFloat.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Gets the number of bytes in a SEG-Y sample.
+ * @param[in] format  The data sample format code.
+ * @result The size of a sample in bytes.
+ */
+inline int getSEGYBytesPerSample(
+    const Temblor::SeismicDataIO::SEGY::DataFormat format) noexcept
+{
+    if (format == Temblor::SeismicDataIO::SEGY::DataFormat::IEEE_DOUBLE)
+    {
+        return 8;
+    }
+    return 4;
+}
+/*!
+ * @brief Converts the samples of a SEG-Y trace to the machine's byte order
+ *        and precision.
+ * @param[in] n             The number of samples.
+ * @param[in] x             The samples as stored on disk.
+ * @param[in] format        The data sample format code.
+ * @param[in] littleEndian  True indicates the samples are little-endian.
+ * @param[out] y            The converted samples.  This is an array of
+ *                          dimension [n].
+ * @throws std::runtime_error if the data format is not supported.
+ */
+template<typename T>
+void unpackSEGYSamples(const int n, const char x[],
+                       const Temblor::SeismicDataIO::SEGY::DataFormat format,
+                       const bool littleEndian, T y[])
+{
+    using Temblor::SeismicDataIO::SEGY::DataFormat;
+    constexpr bool machineIsLittleEndian
+        = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+    auto lswap = (littleEndian != machineIsLittleEndian);
+    if (format == DataFormat::IBM_FLOAT)
+    {
+        unpackIBM32(n, x, y, lswap);
+    }
+    else if (format == DataFormat::IEEE_FLOAT)
+    {
+        if (lswap)
+        {
+            unpackSwapped32(n, x, y);
+        }
+        else
+        {
+            for (int i=0; i<n; ++i)
+            {
+                float f4;
+                std::memcpy(&f4, x + 4*i, sizeof(float));
+                y[i] = static_cast<T> (f4);
+            }
+        }
+    }
+    else if (format == DataFormat::IEEE_DOUBLE)
+    {
+        if (lswap)
+        {
+            unpackSwapped64(n, x, y);
+        }
+        else
+        {
+            for (int i=0; i<n; ++i)
+            {
+                double f8;
+                std::memcpy(&f8, x + 8*i, sizeof(double));
+                y[i] = static_cast<T> (f8);
+            }
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported data format\n");
+    }
+}
+/*!
+ * @brief Packs samples in the machine's byte order and precision into a
+ *        big-endian SEG-Y trace.
+ * @param[in] n       The number of samples.
+ * @param[in] x       The samples.  This is an array of dimension [n].
+ * @param[in] format  The data sample format code.
+ * @param[out] y      The samples as they will be stored on disk.  This is
+ *                    an array of dimension
+ *                    [n*\c getSEGYBytesPerSample(format)].
+ * @throws std::runtime_error if the data format is not supported.
+ */
+template<typename T>
+void packSEGYSamples(const int n, const T x[],
+                     const Temblor::SeismicDataIO::SEGY::DataFormat format,
+                     char y[])
+{
+    using Temblor::SeismicDataIO::SEGY::DataFormat;
+    constexpr bool lswap = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+    if (format == DataFormat::IBM_FLOAT)
+    {
+        packIBM32(n, x, y, lswap);
+    }
+    else if (format == DataFormat::IEEE_FLOAT)
+    {
+        if (lswap)
+        {
+            packSwapped32(n, x, y);
+        }
+        else
+        {
+            for (int i=0; i<n; ++i)
+            {
+                auto f4 = static_cast<float> (x[i]);
+                std::memcpy(y + 4*i, &f4, sizeof(float));
+            }
+        }
+    }
+    else if (format == DataFormat::IEEE_DOUBLE)
+    {
+        for (int i=0; i<n; ++i)
+        {
+            packScalar(static_cast<double> (x[i]), y + 8*i, lswap);
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported data format\n");
+    }
+}
+}
+#endif
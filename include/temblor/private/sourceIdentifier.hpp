@@ -0,0 +1,44 @@
+#ifndef TEMBLOR_LIBRARY_PRIVATE_SOURCEIDENTIFIER_HPP
+#define TEMBLOR_LIBRARY_PRIVATE_SOURCEIDENTIFIER_HPP 1
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <libmseed.h>
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+
+namespace Temblor::Private
+{
+/*!
+ * @brief Converts a miniSEED source identifier to a SNCL.
+ * @param[in] sid  The source identifier, e.g., FDSN:UU_CTU__H_H_Z.
+ * @result The corresponding SNCL.  The location code is only set if it
+ *         is not blank.
+ * @throws std::invalid_argument if the source identifier cannot be
+ *         unpacked.
+ */
+inline Temblor::SeismicDataIO::MiniSEED::SNCL sid2sncl(const char *sid)
+{
+    std::string network(11, 0);
+    std::string station(11, 0);
+    std::string channel(11, 0);
+    std::string location(11, 0);
+    auto retcode = ms_sid2nslc(const_cast<char *> (sid),
+                               network.data(), station.data(),
+                               location.data(), channel.data());
+    if (retcode != MS_NOERROR)
+    {
+        throw std::invalid_argument("Could not unpack SID = "
+                                  + std::string(sid) + "\n");
+    }
+    Temblor::SeismicDataIO::MiniSEED::SNCL sncl;
+    sncl.setNetwork(network);
+    sncl.setStation(station);
+    sncl.setChannel(channel);
+    if (strnlen(location.c_str(), location.size()) > 0)
+    {
+        sncl.setLocationCode(location);
+    }
+    return sncl;
+}
+}
+#endif
@@ -0,0 +1,191 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_ARCHIVEINDEX_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_ARCHIVEINDEX_HPP 1
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Temblor::Utilities
+{
+class Time;
+}
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+class SNCL;
+/*!
+ * @brief Describes the location and time span of a data record in a
+ *        miniSEED archive.
+ */
+struct ArchiveRecord
+{
+    int64_t startTime = 0;   /*!< The time of the first sample in nanoseconds
+                                  since the epoch. */
+    int64_t endTime = 0;     /*!< The time of the last sample in nanoseconds
+                                  since the epoch. */
+    int64_t offset = 0;      /*!< The byte offset of the record in the
+                                  file. */
+    int32_t length = 0;      /*!< The length of the record in bytes. */
+    int32_t file = 0;        /*!< The index of the record's file in
+                                  \c ArchiveIndex::getFileNames(). */
+    double samplingRate = 0; /*!< The sampling rate in Hz. */
+};
+/*!
+ * @brief Indexes the data records of a SeisComP Data Structure (SDS)
+ *        archive, i.e., a directory tree of day files named
+ *        NET/STA/CHAN.TYPE/NET.STA.LOC.CHAN.TYPE.YEAR.DAY.  The index can be
+ *        saved to a compact binary file, incrementally updated, and
+ *        queried for the records of a SNCL in a time window without
+ *        opening the archive's files.
+ */
+class ArchiveIndex
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    ArchiveIndex();
+    /*!
+     * @brief Copy constructor.
+     * @param[in] index  The archive index from which to initialize this
+     *                   class.
+     */
+    ArchiveIndex(const ArchiveIndex &index);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] index  The archive index from which to initialize this
+     *                       class.  On exit, index's behavior is undefined.
+     */
+    ArchiveIndex(ArchiveIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] index  The archive index to copy.
+     * @result A deep copy of the archive index.
+     */
+    ArchiveIndex& operator=(const ArchiveIndex &index);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] index  The archive index whose memory will be moved to
+     *                       this.  On exit, index's behavior is undefined.
+     * @result The memory from index moved to this.
+     */
+    ArchiveIndex& operator=(ArchiveIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~ArchiveIndex();
+    /*!
+     * @brief Clears the index.
+     * @note The number of threads is not reset.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Sets the number of threads used to index files.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads used to index files.
+     * @result The number of indexing threads.
+     */
+    int getNumberOfThreads() const noexcept;
+
+    /*! @name Indexing
+     * @{
+     */
+    /*!
+     * @brief Scans an SDS archive and indexes the records of its day files.
+     *        If the archive was previously indexed then only the files whose
+     *        modification time or size changed are re-indexed and files
+     *        that were removed are dropped.
+     * @param[in] rootDirectory  The root directory of the SDS archive.
+     * @throws std::invalid_argument if the directory does not exist.
+     * @throws std::runtime_error if the filesystem library is unavailable.
+     * @note Files that cannot be indexed are reported and skipped.
+     */
+    void scan(const std::string &rootDirectory);
+    /*!
+     * @brief Gets the number of files whose records were parsed by the
+     *        last scan.  Unchanged files are not counted.
+     * @result The number of files indexed by the last call to \c scan().
+     */
+    int getNumberOfFilesScanned() const noexcept;
+    /*!
+     * @brief Saves the index to a binary file.
+     * @param[in] fileName  The name of the index file to write.
+     * @throws std::runtime_error if the file cannot be written.
+     * @note The file is written in the native byte order.
+     */
+    void save(const std::string &fileName) const;
+    /*!
+     * @brief Loads an index that was written by \c save().
+     * @param[in] fileName  The name of the index file.
+     * @throws std::invalid_argument if the file does not exist or is not a
+     *         valid index file.
+     */
+    void load(const std::string &fileName);
+    /*! @} */
+
+    /*!
+     * @brief Gets the root directory of the archive.
+     * @result The root directory of the archive.  This is empty if nothing
+     *         has been indexed.
+     */
+    std::string getRootDirectory() const noexcept;
+    /*!
+     * @brief Gets the number of indexed files.
+     * @result The number of day files in the index.
+     */
+    int getNumberOfFiles() const noexcept;
+    /*!
+     * @brief Gets the names of the indexed files.
+     * @result The full path of each indexed file.  A record's file field is
+     *         an index into this vector.
+     */
+    std::vector<std::string> getFileNames() const;
+    /*!
+     * @brief Gets the SNCLs in the archive.
+     * @result The SNCLs in the archive.
+     */
+    std::vector<SNCL> getSNCLs() const noexcept;
+    /*!
+     * @brief Checks if the given SNCL exists in the archive.
+     * @result True indicates that the SNCL exists in the archive.
+     */
+    bool haveSNCL(const SNCL &sncl) const noexcept;
+    /*!
+     * @brief Gets the records for the given SNCL that have samples in
+     *        the time window [t0, t1].
+     * @param[in] sncl  The SNCL.
+     * @param[in] t0    The start time of the window.
+     * @param[in] t1    The end time of the window.
+     * @result The records sorted by start time, file, then byte offset.
+     *         This is empty if there is no data for the SNCL in the window.
+     * @throws std::invalid_argument if t1 is less than t0.
+     */
+    std::vector<ArchiveRecord> getRecords(
+        const SNCL &sncl,
+        const Temblor::Utilities::Time &t0,
+        const Temblor::Utilities::Time &t1) const;
+private:
+    class ArchiveIndexImpl;
+    std::unique_ptr<ArchiveIndexImpl> pImpl;
+};
+}
+#endif
@@ -14,6 +14,49 @@ enum class Precision
     UNKNOWN   /*1< An unknown precision. */
 };
 
+/*!
+ * @brief Defines the instruction set used by the Steim decoders.
+ */
+enum class InstructionSet
+{
+    AUTOMATIC, /*!< Use the fastest instruction set supported by the CPU. */
+    SCALAR,    /*!< Use portable scalar code. */
+    SSE41,     /*!< Use SSE4.1 instructions. */
+    AVX2       /*!< Use AVX2 instructions. */
+};
+
+/*!
+ * @brief Defines the decoder used to unpack miniSEED records.
+ */
+enum class Decoder
+{
+    NATIVE,   /*!< Steim records are decoded with the native decoders and
+                   other encodings with libmseed. */
+    LIBMSEED  /*!< Every record is decoded by libmseed.  This is the
+                   reference decoder. */
+};
+
+/*!
+ * @brief Defines the miniSEED format version of written records.
+ */
+enum class FormatVersion
+{
+    MINISEED2, /*!< miniSEED 2 records with a blockette 1000. */
+    MINISEED3  /*!< miniSEED 3 records. */
+};
+
+/*!
+ * @brief Defines the encoding of the samples in written records.
+ */
+enum class Encoding
+{
+    AUTOMATIC, /*!< Steim2 for integer data otherwise the trace's
+                    floating precision. */
+    STEIM2,    /*!< Steim2 compressed 32-bit integers. */
+    FLOAT32,   /*!< 32-bit IEEE floats. */
+    FLOAT64    /*!< 64-bit IEEE floats. */
+};
+
 }
 
 #endif
@@ -0,0 +1,168 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_PACKETINGEST_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_PACKETINGEST_HPP 1
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+class SNCL;
+class Trace;
+struct Segment;
+/*!
+ * @brief Counters describing the records handled by a packet ingest.
+ */
+struct IngestStatistics
+{
+    uint64_t records = 0;  /*!< The number of records that were decoded and
+                                appended. */
+    uint64_t samples = 0;  /*!< The number of samples that were appended. */
+    uint64_t rejected = 0; /*!< The number of records that could not be
+                                decoded or held no samples. */
+};
+/*!
+ * @brief Ingests a stream of miniSEED records as they arrive, e.g., from a
+ *        pipe or a local socket fed by a SeedLink client.  Each record is
+ *        decoded and appended to its SNCL's ring buffer, which holds the
+ *        most recent samples.  Readers such as plots and detectors take
+ *        snapshots of a SNCL from any thread without blocking the ingest.
+ * @note There is a single producer.  Records are added either by the
+ *       thread started with \c start() or by the caller's thread with
+ *       \c addRecord(), but not both at once.
+ */
+class PacketIngest
+{
+public:
+    /*!
+     * @brief Callback invoked on the producer thread after a record's
+     *        samples have been appended.  The segment describes the
+     *        record's samples.  Its offset is the number of samples that
+     *        were previously appended for the SNCL.
+     */
+    using RecordCallback = std::function<void (const SNCL &sncl,
+                                               const Segment &segment)>;
+
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    PacketIngest();
+    PacketIngest(const PacketIngest &) = delete;
+    PacketIngest& operator=(const PacketIngest &) = delete;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.  The ingest thread is stopped.
+     */
+    ~PacketIngest();
+    /*!
+     * @brief Stops ingesting and releases all the ring buffers.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*! @name Parameters
+     * @{
+     */
+    /*!
+     * @brief Sets how much data is retained for each SNCL.
+     * @param[in] seconds  The duration in seconds.  By default this is
+     *                     600 seconds.
+     * @throws std::invalid_argument if seconds is not positive.
+     * @throws std::runtime_error if the ingest is running.
+     * @note This applies to SNCLs that are subsequently encountered.
+     */
+    void setBufferDuration(double seconds);
+    /*!
+     * @result The duration of data retained for each SNCL in seconds.
+     */
+    double getBufferDuration() const noexcept;
+    /*!
+     * @brief Sets the callback invoked after each record is appended.
+     * @param[in] callback  The callback.  This must be fast as it is run on
+     *                      the producer thread.
+     * @throws std::runtime_error if the ingest is running.
+     */
+    void setRecordCallback(const RecordCallback &callback);
+    /*! @} */
+
+    /*! @name Ingest
+     * @{
+     */
+    /*!
+     * @brief Decodes a miniSEED record and appends its samples to its
+     *        SNCL's ring buffer.
+     * @param[in] length  The length of the record in bytes.
+     * @param[in] record  The miniSEED record.  This is an array of
+     *                    dimension [length].
+     * @result False indicates the record was rejected because it could not
+     *         be decoded or it holds no samples.
+     * @throws std::invalid_argument if record is NULL or length is not
+     *         positive.
+     */
+    bool addRecord(int length, const char record[]);
+    /*!
+     * @brief Starts a thread that reads fixed length records from a file
+     *        descriptor, such as a pipe or socket, until end of file or
+     *        \c stop().
+     * @param[in] fileDescriptor  The file descriptor to read.  This is not
+     *                            closed by the ingest.
+     * @param[in] recordLength    The length of each record in bytes.
+     * @throws std::invalid_argument if the file descriptor is invalid or the
+     *         record length is not in the range [128, 1048576].
+     * @throws std::runtime_error if the ingest is already running.
+     */
+    void start(int fileDescriptor, int recordLength = 512);
+    /*!
+     * @brief Stops the ingest thread.  This waits for the thread to exit.
+     */
+    void stop() noexcept;
+    /*!
+     * @result True indicates that the ingest thread is reading records.
+     *         This becomes false at end of file.
+     */
+    bool isRunning() const noexcept;
+    /*!
+     * @result Counters of the records that were ingested.
+     */
+    IngestStatistics getStatistics() const noexcept;
+    /*! @} */
+
+    /*! @name Snapshots
+     * @{
+     */
+    /*!
+     * @brief Gets the SNCLs that have been ingested.
+     * @result The SNCLs in the order they were first encountered.
+     */
+    std::vector<SNCL> getSNCLs() const;
+    /*!
+     * @brief Checks if the given SNCL has been ingested.
+     * @result True indicates that the SNCL has been ingested.
+     */
+    bool haveSNCL(const SNCL &sncl) const noexcept;
+    /*!
+     * @brief Copies the retained samples of a SNCL.  This can be called
+     *        from any thread while records are ingested.
+     * @param[in] sncl  The SNCL.
+     * @result A trace holding the latest samples of the SNCL.  The trace's
+     *         segments describe any gaps.
+     * @throws std::invalid_argument if the SNCL has not been ingested.
+     * @throws std::runtime_error if a consistent snapshot could not be
+     *         taken because the ingest overwrote the buffer while it was
+     *         being copied.
+     */
+    Trace getSnapshot(const SNCL &sncl) const;
+    /*! @} */
+private:
+    class PacketIngestImpl;
+    std::unique_ptr<PacketIngestImpl> pImpl;
+};
+}
+#endif
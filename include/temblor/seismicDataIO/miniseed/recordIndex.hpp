@@ -0,0 +1,163 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_RECORDINDEX_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_RECORDINDEX_HPP 1
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Temblor::Utilities
+{
+class Time;
+}
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+class SNCL;
+class Trace;
+/*!
+ * @brief Describes the location and time span of a data record in a
+ *        miniSEED file.
+ */
+struct IndexedRecord
+{
+    int64_t startTime = 0; /*!< The time of the first sample in nanoseconds
+                                since the epoch. */
+    int64_t endTime = 0;   /*!< The time of the last sample in nanoseconds
+                                since the epoch. */
+    int64_t offset = 0;    /*!< The byte offset of the record in the file. */
+    int32_t length = 0;    /*!< The length of the record in bytes. */
+    int32_t sncl = 0;      /*!< The index of the record's SNCL in
+                                \c RecordIndex::getSNCLs(). */
+    double samplingRate = 0; /*!< The sampling rate in Hz. */
+};
+/*!
+ * @brief Indexes the data records of a miniSEED file.  The file is memory
+ *        mapped and only the record headers are parsed so that time windows
+ *        can subsequently be extracted without decoding the entire file.
+ */
+class RecordIndex
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    RecordIndex();
+    /*!
+     * @brief Copy constructor.  The memory mapped file is shared.
+     * @param[in] index  The record index from which to initialize this class.
+     */
+    RecordIndex(const RecordIndex &index);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] index  The record index from which to initialize this
+     *                       class.  On exit, index's behavior is undefined.
+     */
+    RecordIndex(RecordIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.  The memory mapped file is shared.
+     * @param[in] index  The record index to copy.
+     * @result A copy of the record index.
+     */
+    RecordIndex& operator=(const RecordIndex &index);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] index  The record index whose memory will be moved to
+     *                       this.  On exit, index's behavior is undefined.
+     * @result The memory from index moved to this.
+     */
+    RecordIndex& operator=(RecordIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~RecordIndex();
+    /*!
+     * @brief Releases the memory mapped file and clears the index.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Memory maps a miniSEED file and indexes its data records.
+     * @param[in] fileName  The name of the miniSEED file.
+     * @throws std::invalid_argument if the file does not exist or a record
+     *         header cannot be parsed.
+     */
+    void load(const std::string &fileName);
+    /*!
+     * @brief Determines if a file was indexed.
+     * @result True indicates that a file was indexed.
+     */
+    bool isLoaded() const noexcept;
+    /*!
+     * @brief Gets the name of the indexed file.
+     * @result The name of the indexed file.
+     * @throws std::runtime_error if a file was not indexed.
+     */
+    std::string getFileName() const;
+
+    /*!
+     * @brief Gets the SNCLs in the file.
+     * @result The SNCLs in the file.  A record's sncl field is an index
+     *         into this vector.
+     */
+    std::vector<SNCL> getSNCLs() const noexcept;
+    /*!
+     * @brief Checks if the given SNCL exists in the file.
+     * @result True indicates that the SNCL exists in the file.
+     */
+    bool haveSNCL(const SNCL &sncl) const noexcept;
+
+    /*!
+     * @brief Gets the number of indexed data records.
+     * @result The number of data records in the file.
+     */
+    int getNumberOfRecords() const noexcept;
+    /*!
+     * @brief Gets the record table.
+     * @result The records sorted by SNCL, then start time, then byte offset.
+     */
+    std::vector<IndexedRecord> getRecords() const noexcept;
+    /*!
+     * @brief Gets the records for the given SNCL.
+     * @param[in] sncl  The SNCL.
+     * @result The records sorted by start time then byte offset.  This is
+     *         empty if the SNCL is not in the file.
+     */
+    std::vector<IndexedRecord> getRecords(const SNCL &sncl) const;
+    /*!
+     * @brief Gets the records for the given SNCL that have samples in
+     *        the time window [t0, t1].
+     * @param[in] sncl  The SNCL.
+     * @param[in] t0    The start time of the window.
+     * @param[in] t1    The end time of the window.
+     * @result The records sorted by start time then byte offset.  This is
+     *         empty if there is no data for the SNCL in the window.
+     * @throws std::invalid_argument if t1 is less than t0.
+     */
+    std::vector<IndexedRecord> getRecords(
+        const SNCL &sncl,
+        const Temblor::Utilities::Time &t0,
+        const Temblor::Utilities::Time &t1) const;
+private:
+    friend class Trace;
+    /// @result A pointer to the start of the memory mapped file.
+    const char *getData() const noexcept;
+
+    class RecordIndexImpl;
+    std::unique_ptr<RecordIndexImpl> pImpl;
+};
+}
+#endif
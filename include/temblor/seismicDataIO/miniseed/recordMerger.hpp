@@ -0,0 +1,143 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_RECORDMERGER_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_RECORDMERGER_HPP 1
+#include <cstdint>
+#include <string>
+#include <memory>
+#include "temblor/seismicDataIO/miniseed/enums.hpp"
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+/*!
+ * @brief Counters describing a merge.
+ */
+struct MergeStatistics
+{
+    int files = 0;                /*!< The number of files read. */
+    uint64_t records = 0;         /*!< The number of data records read. */
+    uint64_t duplicates = 0;      /*!< The number of records dropped
+                                       because they duplicate a previous
+                                       record. */
+    uint64_t overlapped = 0;      /*!< The number of records dropped
+                                       because all of their samples were
+                                       already merged. */
+    uint64_t trimmed = 0;         /*!< The number of records whose leading
+                                       samples overlapped merged data and
+                                       were trimmed. */
+    uint64_t samplesTrimmed = 0;  /*!< The number of samples removed from
+                                       the trimmed records. */
+    uint64_t samples = 0;         /*!< The number of samples written. */
+    int segments = 0;             /*!< The number of contiguous segments
+                                       written. */
+};
+/*!
+ * @brief Merges the records of miniSEED files into clean, contiguous
+ *        segments.  The records are sorted by SNCL and start time.  Exact
+ *        duplicates, i.e., records with the same header and payload CRC,
+ *        are dropped and the leading samples of records that overlap data
+ *        that was already merged are trimmed at sample resolution.
+ * @note The samples are merged in a single streaming pass.  Each segment
+ *       is decoded record by record and its complete output records are
+ *       written as soon as they are packed.  The merge is not bounded in
+ *       memory by the segment, however.  The record headers of every input
+ *       file are indexed and sorted before merging so a few dozen bytes per
+ *       record, i.e., O(records), are held for the whole merge.  An input
+ *       file is memory mapped from the merge of its first record until the
+ *       merge of its last record, so files whose records interleave with
+ *       those of other files stay mapped.
+ */
+class RecordMerger
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    RecordMerger();
+    /*!
+     * @brief Copy constructor.
+     * @param[in] merger  The merger from which to initialize this class.
+     */
+    RecordMerger(const RecordMerger &merger);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] merger  The merger from which to initialize this
+     *                        class.  On exit, merger's behavior is
+     *                        undefined.
+     */
+    RecordMerger(RecordMerger &&merger) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] merger  The merger to copy.
+     * @result A deep copy of the merger.
+     */
+    RecordMerger& operator=(const RecordMerger &merger);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] merger  The merger whose memory will be moved to this.
+     *                        On exit, merger's behavior is undefined.
+     * @result The memory from merger moved to this.
+     */
+    RecordMerger& operator=(RecordMerger &&merger) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~RecordMerger();
+    /*! @} */
+
+    /*!
+     * @brief Sets the number of threads used to index the input files.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads used to index the input files.
+     * @result The number of indexing threads.
+     */
+    int getNumberOfThreads() const noexcept;
+
+    /*!
+     * @brief Merges the records of a miniSEED file or of all the miniSEED
+     *        files in a directory tree into a single file.
+     * @param[in] input          A miniSEED file or a directory.  Files in
+     *                           the directory that cannot be indexed are
+     *                           reported and skipped.
+     * @param[in] outputFile     The name of the miniSEED file to write.
+     *                           An existing file is overwritten.  This is
+     *                           never read as input.
+     * @param[in] recordLength   The record length in bytes.  This must be
+     *                           in the range [128, 1048576] and, for
+     *                           miniSEED 2, a power of 2.
+     * @param[in] formatVersion  The miniSEED format version of the output
+     *                           records.
+     * @result Counters describing the merge.
+     * @throws std::invalid_argument if the input does not exist or the
+     *         record length is invalid.
+     * @throws std::runtime_error if a record cannot be decoded or packed or
+     *         the output cannot be written.
+     * @note Integer samples are Steim2 compressed and floating point
+     *       samples keep their precision.
+     */
+    MergeStatistics merge(const std::string &input,
+                          const std::string &outputFile,
+                          int recordLength = 4096,
+                          FormatVersion formatVersion
+                              = FormatVersion::MINISEED2) const;
+private:
+    class RecordMergerImpl;
+    std::unique_ptr<RecordMergerImpl> pImpl;
+};
+}
+#endif
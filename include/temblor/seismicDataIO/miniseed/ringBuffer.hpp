@@ -0,0 +1,87 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_RINGBUFFER_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_RINGBUFFER_HPP 1
+#include <cstdint>
+#include <memory>
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+class Trace;
+/*!
+ * @brief A single-producer, multi-consumer ring buffer that holds the most
+ *        recent samples of a channel.  One thread appends decoded records
+ *        while any number of threads take snapshots.  Neither side locks:
+ *        the producer never waits on readers and a reader that races the
+ *        producer discards the samples that were overwritten while it was
+ *        copying.
+ * @note Each append is recorded as a segment.  Snapshots merge the
+ *       segments that are contiguous in time.
+ */
+class RingBuffer
+{
+public:
+    /*!
+     * @brief Constructor.
+     * @param[in] sampleCapacity   The number of samples to retain.  This is
+     *                             rounded up to a power of 2.
+     * @param[in] segmentCapacity  The number of appended segments to
+     *                             retain.  This is rounded up to a power
+     *                             of 2.
+     * @throws std::invalid_argument if either capacity is not positive or
+     *         exceeds 2^30.
+     */
+    RingBuffer(int sampleCapacity, int segmentCapacity);
+    /*!
+     * @brief Destructor.
+     */
+    ~RingBuffer();
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer& operator=(const RingBuffer &) = delete;
+
+    /*!
+     * @brief Gets the number of samples retained by the buffer.
+     * @result The sample capacity.
+     */
+    int getSampleCapacity() const noexcept;
+    /*!
+     * @brief Gets the number of segments retained by the buffer.
+     * @result The segment capacity.
+     */
+    int getSegmentCapacity() const noexcept;
+
+    /*!
+     * @brief Appends a contiguous run of samples.  Only one thread may
+     *        append.
+     * @param[in] startTime     The time of the first sample in nanoseconds
+     *                          since the epoch.
+     * @param[in] samplingRate  The sampling rate in Hz.
+     * @param[in] nSamples      The number of samples.  If this exceeds the
+     *                          sample capacity then only the latest samples
+     *                          are retained.
+     * @param[in] x             The samples.  This is an array of dimension
+     *                          [nSamples].
+     * @throws std::invalid_argument if the sampling rate is not positive,
+     *         nSamples is negative, or x is NULL and nSamples is positive.
+     */
+    void append(int64_t startTime, double samplingRate,
+                int nSamples, const double x[]);
+    /*!
+     * @brief Gets the total number of samples that were appended.
+     * @result The number of samples appended since construction.
+     */
+    int64_t getNumberOfSamplesAppended() const noexcept;
+    /*!
+     * @brief Copies the samples in the buffer to a trace.  This may be
+     *        called from any thread while the producer appends.
+     * @param[out] trace  The samples in the buffer.  The trace's segments
+     *                    describe any gaps.  The SNCL is not modified.
+     * @result False indicates that the buffer was empty, or that the
+     *         producer overwrote the entire buffer while it was being
+     *         copied, in which case trace is not modified.
+     */
+    bool getSnapshot(Trace *trace) const;
+private:
+    class RingBufferImpl;
+    std::unique_ptr<RingBufferImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,107 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_SAMPLEVIEW_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_SAMPLEVIEW_HPP 1
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+/*!
+ * @brief A read-only view of contiguous samples.  The view does not own
+ *        the samples so it is invalidated when the trace that owns them is
+ *        modified or destroyed.
+ * @note This mirrors the part of C++20's std::span that is needed to
+ *       iterate over the samples.
+ */
+template<typename T>
+class SampleView
+{
+public:
+    /*!
+     * @brief Default constructor.  The view is empty.
+     */
+    SampleView() = default;
+    /*!
+     * @brief Creates a view of samples.
+     * @param[in] data  The samples.  This is an array of dimension [size].
+     * @param[in] size  The number of samples.
+     */
+    SampleView(const T *data, const size_t size) noexcept :
+        mData(data),
+        mSize(size)
+    {
+    }
+    /*!
+     * @result A pointer to the first sample.
+     */
+    const T *data() const noexcept
+    {
+        return mData;
+    }
+    /*!
+     * @result The number of samples.
+     */
+    size_t size() const noexcept
+    {
+        return mSize;
+    }
+    /*!
+     * @result True indicates that the view has no samples.
+     */
+    bool empty() const noexcept
+    {
+        return (mSize == 0);
+    }
+    /*!
+     * @result The i'th sample.  No bounds checking is performed.
+     */
+    const T &operator[](const size_t i) const noexcept
+    {
+        return mData[i];
+    }
+    /*!
+     * @result The i'th sample.
+     * @throws std::out_of_range if i is not less than \c size().
+     */
+    const T &at(const size_t i) const
+    {
+        if (i >= mSize)
+        {
+            throw std::out_of_range("Sample index = " + std::to_string(i)
+                                  + " must be less than "
+                                  + std::to_string(mSize) + "\n");
+        }
+        return mData[i];
+    }
+    /*!
+     * @brief Iterators over the samples.
+     */
+    const T *begin() const noexcept
+    {
+        return mData;
+    }
+    const T *end() const noexcept
+    {
+        return mData + mSize;
+    }
+    /*!
+     * @brief Creates a view of part of this view.
+     * @param[in] offset    The first sample of the subview.
+     * @param[in] nSamples  The number of samples in the subview.
+     * @result The view of samples [offset, offset + nSamples).
+     * @throws std::out_of_range if the subview exceeds this view.
+     */
+    SampleView subview(const size_t offset, const size_t nSamples) const
+    {
+        if (offset > mSize || nSamples > mSize - offset)
+        {
+            throw std::out_of_range("Subview exceeds view\n");
+        }
+        return SampleView(mData + offset, nSamples);
+    }
+private:
+    const T *mData = nullptr;
+    size_t mSize = 0;
+};
+}
+#endif
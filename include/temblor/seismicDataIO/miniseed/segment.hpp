@@ -0,0 +1,55 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_SEGMENT_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_SEGMENT_HPP 1
+#include <cstdint>
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+/*!
+ * @brief Describes a contiguous run of samples in a trace.  All segments of
+ *        a trace share a single sample buffer and the segment indicates where
+ *        its samples begin in that buffer.
+ */
+struct Segment
+{
+    /*!
+     * @brief Computes the time of the last sample in the segment.
+     * @result The time of the last sample in nanoseconds since the epoch.
+     *         If the segment is empty or the sampling rate is not positive
+     *         then this is the start time.
+     */
+    int64_t getEndTime() const noexcept;
+    /*!
+     * @brief Computes the time at which the sample following this segment
+     *        is expected.
+     * @result The expected time of the next sample in nanoseconds since
+     *         the epoch.  If the sampling rate is not positive then this is
+     *         the start time.
+     */
+    int64_t getNextSampleTime() const noexcept;
+
+    int64_t startTime = 0;    /*!< The time of the first sample in
+                                   nanoseconds since the epoch. */
+    int64_t offset = 0;       /*!< The index of the first sample of this
+                                   segment in the trace's sample buffer. */
+    int64_t nSamples = 0;     /*!< The number of samples in the segment. */
+    double samplingRate = 0;  /*!< The sampling rate in Hz. */
+};
+
+/*!
+ * @brief Describes a gap or overlap between two consecutive segments.
+ *        For a gap the window spans the last sample before the gap to the
+ *        first sample after the gap.  For an overlap the window spans the
+ *        samples that are duplicated by the following segment.
+ */
+struct Discontinuity
+{
+    int64_t startTime = 0; /*!< The start of the gap or overlap in
+                                nanoseconds since the epoch. */
+    int64_t endTime = 0;   /*!< The end of the gap or overlap in
+                                nanoseconds since the epoch. */
+    int segment = 0;       /*!< The index of the segment following the
+                                discontinuity. */
+};
+
+}
+#endif
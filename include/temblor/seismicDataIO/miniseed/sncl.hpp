@@ -1,5 +1,7 @@
 #ifndef TEMBLOR_SEISMICDATAIO_MINISEED_SNCL_HPP
 #define TEMBLOR_SEISMICDATAIO_MINISEED_SNCL_HPP 1
+#include <cstddef>
+#include <functional>
 #include <memory>
 
 namespace Temblor::SeismicDataIO::MiniSEED
@@ -50,14 +52,14 @@ public:
      * @result True indicates that the given SNCL 
      *         equals the SNCL represented by this class.
      */
-    bool operator==(const SNCL &sncl) noexcept;
+    bool operator==(const SNCL &sncl) const noexcept;
     /*!
      * @brief Inequality operator.
      * @param[in] time  Class to test for inequality.
      * @result True indicates that the given  SNCL
      *         does not equal the SNCL represented by this class.
      */
-    bool operator!=(const SNCL &sncl) noexcept;
+    bool operator!=(const SNCL &sncl) const noexcept;
     /*! @} */
 
     /*! @name Destructors
@@ -169,9 +171,31 @@ public:
      *         defined.
      */
     bool isEmpty() const noexcept;
+    /*!
+     * @brief Hashes the network, station, channel, and location code.
+     * @result A hash that is equal for SNCLs that compare equal.
+     * @sa \c std::hash<SNCL>
+     */
+    size_t getHash() const noexcept;
 private:
     class SNCLImpl;
     std::unique_ptr<SNCLImpl> pImpl;
 };
 }
+
+namespace std
+{
+/*!
+ * @brief Allows SNCLs to key unordered containers.
+ */
+template<>
+struct hash<Temblor::SeismicDataIO::MiniSEED::SNCL>
+{
+    size_t operator()(const Temblor::SeismicDataIO::MiniSEED::SNCL &sncl)
+        const noexcept
+    {
+        return sncl.getHash();
+    }
+};
+}
 #endif
@@ -0,0 +1,72 @@
+#ifndef TEMBLOR_SEISMICDATAIO_MINISEED_STEIM_HPP
+#define TEMBLOR_SEISMICDATAIO_MINISEED_STEIM_HPP 1
+#include <cstddef>
+#include <cstdint>
+#include "temblor/seismicDataIO/miniseed/enums.hpp"
+
+namespace Temblor::SeismicDataIO::MiniSEED
+{
+/*!
+ * @brief Determines if the Steim decoders can use the given instruction set
+ *        on this CPU.
+ * @param[in] instructionSet  The instruction set.
+ * @result True indicates that the instruction set is supported.
+ */
+bool isSupported(InstructionSet instructionSet) noexcept;
+/*!
+ * @brief Gets the reverse integration constant of Steim1 or Steim2 frames.
+ * @param[in] nBytes  The number of bytes in frames.
+ * @param[in] frames  The big-endian Steim frames.  This is an array of
+ *                    dimension [nBytes].
+ * @result The reverse integration constant, i.e., the last sample of the
+ *         record.
+ * @throws std::invalid_argument if nBytes is less than a 64 byte frame or
+ *         frames is NULL.
+ */
+int32_t getReverseIntegrationConstant(size_t nBytes, const void *frames);
+/*!
+ * @brief Decodes Steim1 compressed data.
+ * @param[in] nBytes          The number of bytes in frames.  Only complete
+ *                            64 byte frames are decoded.
+ * @param[in] frames          The big-endian Steim1 frames.  This is an
+ *                            array of dimension [nBytes].
+ * @param[in] nSamples        The number of samples to decode.
+ * @param[out] y              The decoded samples.  This is an array of
+ *                            dimension [nSamples].
+ * @param[in] instructionSet  The instruction set to use.  By default the
+ *                            fastest one supported by the CPU is used.
+ * @result The number of decoded samples.  This is less than nSamples if
+ *         the frames are exhausted and -1 if a frame is malformed.
+ * @note Decoding stops at nSamples so words past the last sample are not
+ *       read.  To check the record's integrity compare the last sample
+ *       with \c getReverseIntegrationConstant().
+ * @throws std::invalid_argument if frames or y is NULL and nSamples is
+ *         positive or the instruction set is not supported by the CPU.
+ */
+int64_t decodeSteim1(size_t nBytes, const void *frames,
+                     int64_t nSamples, int32_t y[],
+                     InstructionSet instructionSet = InstructionSet::AUTOMATIC);
+/*!
+ * @brief Decodes Steim2 compressed data.
+ * @param[in] nBytes          The number of bytes in frames.  Only complete
+ *                            64 byte frames are decoded.
+ * @param[in] frames          The big-endian Steim2 frames.  This is an
+ *                            array of dimension [nBytes].
+ * @param[in] nSamples        The number of samples to decode.
+ * @param[out] y              The decoded samples.  This is an array of
+ *                            dimension [nSamples].
+ * @param[in] instructionSet  The instruction set to use.  By default the
+ *                            fastest one supported by the CPU is used.
+ * @result The number of decoded samples.  This is less than nSamples if
+ *         the frames are exhausted and -1 if a frame is malformed.
+ * @note Decoding stops at nSamples so words past the last sample are not
+ *       read.  To check the record's integrity compare the last sample
+ *       with \c getReverseIntegrationConstant().
+ * @throws std::invalid_argument if frames or y is NULL and nSamples is
+ *         positive or the instruction set is not supported by the CPU.
+ */
+int64_t decodeSteim2(size_t nBytes, const void *frames,
+                     int64_t nSamples, int32_t y[],
+                     InstructionSet instructionSet = InstructionSet::AUTOMATIC);
+}
+#endif
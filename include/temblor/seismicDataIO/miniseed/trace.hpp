@@ -4,17 +4,30 @@
 #include <vector>
 #include "temblor/seismicDataIO/abstractBaseClass/trace.hpp"
 #include "temblor/seismicDataIO/miniseed/enums.hpp"
+#include "temblor/seismicDataIO/miniseed/sampleView.hpp"
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
 
 namespace Temblor::Utilities
 {
 class Time;
 }
+// Forward declaration of libmseed's trace identifier
+struct MS3TraceID;
 
 namespace Temblor::SeismicDataIO::MiniSEED
 {
 class SNCL;
+class RecordIndex;
+class TraceGroup;
 /*!
- * @brief Defines a miniSEED trace.
+ * @brief Defines a miniSEED trace.  A trace may be comprised of several
+ *        segments that are separated by gaps or overlaps.  The samples of
+ *        all segments are stored contiguously and the segment table
+ *        indicates where each segment begins in the sample buffer.
+ *        The samples are kept in one cache aligned buffer in the precision
+ *        in which they were read or set.  They can be viewed without
+ *        copying with \c getDataView32i() and friends or converted into a
+ *        caller's buffer with \c getData().
  */
 class Trace : public Temblor::SeismicDataIO::AbstractBaseClass::ITrace
 {
@@ -69,6 +82,40 @@ public:
     void clear() noexcept;
     /*! @} */
 
+    /*! @name Threads
+     * @{
+     */
+    /*!
+     * @brief Sets the number of threads used to decode miniSEED records.
+     *        Records are decoded independently so the decoded time series
+     *        does not depend on the number of threads.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     * @note This is not reset by \c clear().
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads used to decode miniSEED records.
+     * @result The number of decoding threads.
+     */
+    int getNumberOfThreads() const noexcept;
+    /*!
+     * @brief Sets the decoder used to unpack miniSEED records.
+     * @param[in] decoder  The decoder.  By default this is
+     *                     \c Decoder::NATIVE.
+     * @note \c Decoder::LIBMSEED unpacks each segment serially with
+     *       libmseed's record list unpacker.  It is the reference against
+     *       which the native decoders are checked.  This is not reset by
+     *       \c clear().
+     */
+    void setDecoder(Decoder decoder) noexcept;
+    /*!
+     * @brief Gets the decoder used to unpack miniSEED records.
+     * @result The record decoder.
+     */
+    Decoder getDecoder() const noexcept;
+    /*! @} */
+
     /*! @name File IO
      * @{
      */
@@ -80,7 +127,71 @@ public:
      *         or does not contain the given SNCL.
      */
     void read(const std::string &fileName, const SNCL &sncl);
-
+    /*!
+     * @brief Reads the samples of a trace with a given SNCL in the time
+     *        window [t0, t1] from a miniSEED file.  Only the records that
+     *        overlap the window are decoded.
+     * @param[in] fileName  The name of the miniSEED file to read.
+     * @param[in] sncl      The SNCL to read.
+     * @param[in] t0        The start time of the window.
+     * @param[in] t1        The end time of the window.
+     * @throws std::invalid_argument if the file does not exist, cannot be
+     *         indexed, t1 is less than t0, or there is no data for the SNCL
+     *         in the window.
+     * @throws std::runtime_error if a record cannot be decoded.
+     */
+    void read(const std::string &fileName, const SNCL &sncl,
+              const Temblor::Utilities::Time &t0,
+              const Temblor::Utilities::Time &t1);
+    /*!
+     * @brief Reads a trace with a given SNCL from a previously indexed
+     *        miniSEED file.  Only the SNCL's records are decoded.
+     * @param[in] index     The record index of the miniSEED file.
+     * @param[in] sncl      The SNCL to read.
+     * @throws std::invalid_argument if the index was not loaded or there is
+     *         no data for the SNCL.
+     * @throws std::runtime_error if a record cannot be decoded.
+     */
+    void read(const RecordIndex &index, const SNCL &sncl);
+    /*!
+     * @brief Reads the samples of a trace with a given SNCL in the time
+     *        window [t0, t1] from a previously indexed miniSEED file.
+     *        This is useful when extracting many windows from one file.
+     * @param[in] index     The record index of the miniSEED file.
+     * @param[in] sncl      The SNCL to read.
+     * @param[in] t0        The start time of the window.
+     * @param[in] t1        The end time of the window.
+     * @throws std::invalid_argument if the index was not loaded, t1 is less
+     *         than t0, or there is no data for the SNCL in the window.
+     * @throws std::runtime_error if a record cannot be decoded.
+     */
+    void read(const RecordIndex &index, const SNCL &sncl,
+              const Temblor::Utilities::Time &t0,
+              const Temblor::Utilities::Time &t1);
+    /*!
+     * @brief Writes the trace to a miniSEED file.  Each contiguous
+     *        segment is packed into its own sequence of records so only
+     *        its last record may be partially filled.  The segments are
+     *        packed in parallel with \c getNumberOfThreads() threads and
+     *        the file is written with a single buffered write.
+     * @param[in] fileName       The name of the miniSEED file to write.  An
+     *                           existing file is overwritten.
+     * @param[in] recordLength   The record length in bytes.  This must be in
+     *                           the range [128, 1048576] and, for miniSEED 2,
+     *                           a power of 2.
+     * @param[in] formatVersion  The miniSEED format version of the records.
+     * @param[in] encoding       The sample encoding.  Integer data is
+     *                           Steim2 compressed by default.
+     * @throws std::invalid_argument if the record length is invalid, the
+     *         data or sampling rate or SNCL were not set, or Steim2 is
+     *         requested for floating point data.
+     * @throws std::runtime_error if the records cannot be packed or the file
+     *         cannot be written.
+     */
+    void write(const std::string &fileName,
+               int recordLength = 4096,
+               FormatVersion formatVersion = FormatVersion::MINISEED2,
+               Encoding encoding = Encoding::AUTOMATIC) const;
     /*! @} */
 
     /*! @name Start Time and End Time
@@ -88,9 +199,11 @@ public:
      */
     /*!
      * @brief Sets the start time of the trace.
-     * param[in] startTime  The trace start time.
+     * @param[in] startTime  The trace start time.
+     * @note If the trace has multiple segments then all segments are
+     *       shifted so that the first segment begins at the start time.
      */
-    void setStartTime(Temblor::Utilities::Time &startTime) noexcept;
+    void setStartTime(const Temblor::Utilities::Time &startTime) noexcept;
     /*!
      * @brief Gets the start time of the trace.
      * @result The start time of the trace.
@@ -99,7 +212,7 @@ public:
     Temblor::Utilities::Time getStartTime() const noexcept override;
     /*!
      * @brief Gets the end time of the trace.
-     * @result The end time of the trace.
+     * @result The time of the last sample of the trace.
      * @throws std::runtime_error if the sampling rate was not set.
      * @note This is computed relative to the start time.  Hence, the time 
      *       series data and sampling rate must have been set.
@@ -115,6 +228,7 @@ public:
      * @brief Sets the sampling rate.
      * @param[in] samplingRate  The sampling rate in Hz.
      * @throws std::invalid_argument if sampling rate is not positive.
+     * @note This is applied to all segments of the trace.
      */
     void setSamplingRate(double samplingRate);
     /*!
@@ -135,12 +249,67 @@ public:
      * @{
      */
     /*!
-     * @brief Sets the number of samples.
-     * @result The number of samples in the trace.
+     * @brief Gets the number of samples.
+     * @result The number of samples in the trace.  This is summed over all
+     *         segments.
      */
     int getNumberOfSamples() const noexcept override;
     /*! @} */
 
+    /*! @name Segments
+     * @{
+     */
+    /*!
+     * @brief Gets the number of contiguous segments in the trace.
+     * @result The number of segments.  This is 0 if the time series data
+     *         was never set or read from disk.
+     */
+    int getNumberOfSegments() const noexcept;
+    /*!
+     * @brief Gets the segment table.
+     * @result The segments in order of increasing start time.  The samples
+     *         of the i'th segment begin at the segment's offset in the
+     *         time series data.
+     * @sa \c getDataPointer32i(), \c getDataPointer32f(),
+     *     \c getDataPointer64f()
+     */
+    std::vector<Segment> getSegments() const noexcept;
+    /*!
+     * @brief Gets the given segment.
+     * @param[in] segment  The segment index.  This must be in the range
+     *                     [0, \c getNumberOfSegments() - 1].
+     * @result The desired segment.
+     * @throws std::invalid_argument if segment is out of bounds.
+     */
+    Segment getSegment(int segment) const;
+    /*!
+     * @brief Finds the samples in the time window [t0, t1] without copying
+     *        the time series data.
+     * @param[in] t0  The start time of the window.
+     * @param[in] t1  The end time of the window.
+     * @result The parts of the segments that intersect the window.  Each
+     *         result's offset and number of samples can be used to index
+     *         into the data pointer.
+     * @throws std::invalid_argument if t1 is less than t0.
+     */
+    std::vector<Segment> getSegments(const Temblor::Utilities::Time &t0,
+                                     const Temblor::Utilities::Time &t1) const;
+    /*!
+     * @brief Gets the gaps between segments.  A gap is recorded when a
+     *        segment begins more than half a sample after the expected
+     *        time of the next sample.
+     * @result The gaps in the trace.
+     */
+    std::vector<Discontinuity> getGaps() const;
+    /*!
+     * @brief Gets the overlaps between segments.  An overlap is recorded
+     *        when a segment begins more than half a sample before the
+     *        expected time of the next sample.
+     * @result The overlaps in the trace.
+     */
+    std::vector<Discontinuity> getOverlaps() const;
+    /*! @} */
+
     /*! @name Precision
      * @{
      */
@@ -197,6 +366,25 @@ public:
     void getData(int length, double *x[]) const override;
     void getData(int length, float *x[]) const override;
     void getData(int length, int *x[]) const;
+    /*!
+     * @brief Converts the samples [offset, offset + nSamples) into a
+     *        caller's buffer.  Integer counts are converted to floating
+     *        point with vector instructions when the CPU supports them.
+     *        Reusing the buffer avoids an allocation per fetch.
+     * @param[in] offset    The first sample to get.  For example, this can
+     *                      be the offset of a segment.
+     * @param[in] nSamples  The number of samples to get.
+     * @param[out] x        The samples.  This is an array of dimension
+     *                      [nSamples].
+     * @throws std::invalid_argument if the samples exceed the trace or x is
+     *         NULL and nSamples is positive.
+     * @throws std::runtime_error if the time series data was never set
+     *         or read from disk.
+     * @sa \c getSegments()
+     */
+    void getData(int offset, int nSamples, double x[]) const;
+    void getData(int offset, int nSamples, float x[]) const;
+    void getData(int offset, int nSamples, int x[]) const;
     /*!
      * @brief Sets the time series data.
      * @param[in] nSamples  The number of samples in the signal.
@@ -209,6 +397,21 @@ public:
     void setData(size_t nSamples, const double x[]);
     void setData(size_t nSamples, const float x[]);
     void setData(size_t nSamples, const int x[]);
+    /*!
+     * @brief Sets a time series comprised of several segments.
+     * @param[in] segments  The segments in order of increasing start time.
+     *                      The offset of each segment must equal the number
+     *                      of samples in the preceding segments.
+     * @param[in] x         The samples of all segments.  This is an array
+     *                      whose dimension is the sum of the segments'
+     *                      number of samples.
+     * @throws std::invalid_argument if there are no segments, a segment's
+     *         offset or sampling rate is invalid, the segments are not
+     *         sorted, there are too many samples, or x is NULL.
+     * @note The start time and sampling rate are set from the first
+     *       segment.
+     */
+    void setData(const std::vector<Segment> &segments, const double x[]);
     /*!
      * @brief Gets a pointer to the double precision time series.
      * @result A pointer to the time series data.
@@ -239,8 +442,60 @@ public:
      * @sa \c getPrecision()
      */
     const int *getDataPointer32i() const;
+    /*!
+     * @brief Gets a read-only view of the integer time series data.  This
+     *        lets consumers work on the counts without copying them.
+     * @result A view of the samples.  This is invalidated when the trace
+     *         is modified or destroyed.
+     * @throws std::runtime_error if the underlying precision is not an
+     *         integer or the time series data was never set or read from
+     *         disk.
+     */
+    SampleView<int> getDataView32i() const;
+    /*!
+     * @brief Gets a read-only view of the float time series data.
+     * @result A view of the samples.  This is invalidated when the trace
+     *         is modified or destroyed.
+     * @throws std::runtime_error if the underlying precision is not a float
+     *         or the time series data was never set or read from disk.
+     */
+    SampleView<float> getDataView32f() const;
+    /*!
+     * @brief Gets a read-only view of the double time series data.
+     * @result A view of the samples.  This is invalidated when the trace
+     *         is modified or destroyed.
+     * @throws std::runtime_error if the underlying precision is not a
+     *         double or the time series data was never set or read from
+     *         disk.
+     */
+    SampleView<double> getDataView64f() const;
     /*! @} */
 private:
+    friend class TraceGroup;
+    /*!
+     * @brief Unpacks the time series of a trace ID that was read by
+     *        libmseed with the MSF_RECORDLIST flag.
+     * @param[in] traceID  The libmseed trace ID to unpack.
+     * @throws std::runtime_error if the data cannot be unpacked.
+     * @note The SNCL is not modified.
+     */
+    void unpack(MS3TraceID *traceID);
+    /*!
+     * @brief Packs the time series into miniSEED records.
+     * @param[in] recordLength   The record length in bytes.
+     * @param[in] formatVersion  The miniSEED format version of the records.
+     * @param[in] encoding       The sample encoding.
+     * @param[in] nThreads       The number of threads packing segments.
+     * @result The packed records in the order they should be written.
+     * @throws std::invalid_argument if the arguments or trace are invalid.
+     * @throws std::runtime_error if the records cannot be packed.
+     * @sa \c write()
+     */
+    std::vector<char> pack(int recordLength,
+                           FormatVersion formatVersion,
+                           Encoding encoding,
+                           int nThreads) const;
+
     class TraceImpl;
     std::unique_ptr<TraceImpl> pImpl;
 };
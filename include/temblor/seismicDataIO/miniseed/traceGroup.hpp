@@ -1,5 +1,7 @@
 #ifndef TEMBLOR_SEISMICDATAIO_MINISEED_TRACEGROUP_HPP
 #define TEMBLOR_SEISMICDATAIO_MINISEED_TRACEGROUP_HPP 1
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
 #include "temblor/seismicDataIO/miniseed/enums.hpp"
@@ -13,6 +15,30 @@ namespace Temblor::SeismicDataIO::MiniSEED
 {
 class SNCL;
 class Trace;
+/*!
+ * @brief Counters describing the use of a trace group's decoded trace cache.
+ */
+struct CacheStatistics
+{
+    uint64_t hits = 0;      /*!< The number of traces served from the
+                                 cache or from another thread's decode of
+                                 the same trace. */
+    uint64_t misses = 0;    /*!< The number of traces that were decoded. */
+    uint64_t evictions = 0; /*!< The number of traces evicted from the cache
+                                 to respect the cache size. */
+    size_t bytes = 0;       /*!< The bytes of samples currently cached. */
+    int nTraces = 0;        /*!< The number of traces currently cached. */
+};
+/*!
+ * @brief A collection of the traces in a miniSEED file.  Reading a file only
+ *        indexes its records.  A trace is decoded the first time it is
+ *        requested and is then held in a least recently used cache whose
+ *        size is bounded in bytes.
+ * @note The getters may be called from several threads.  Traces are
+ *       decoded outside of the cache's lock so different traces decode
+ *       concurrently, while concurrent requests for the same trace share a
+ *       single decode.
+ */
 class TraceGroup
 {
 public:
@@ -71,12 +97,84 @@ public:
     /*! @} */ 
 
     /*!
-     * @brief Reads the miniSEED file.
+     * @brief Sets the number of threads used to decode miniSEED records.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     * @note This is not reset by \c clear().
+     * @sa \c Trace::setNumberOfThreads()
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads used to decode miniSEED records.
+     * @result The number of decoding threads.
+     */
+    int getNumberOfThreads() const noexcept;
+
+    /*! @name Cache
+     * @{
+     */
+    /*!
+     * @brief Sets the maximum number of bytes of decoded samples to cache.
+     *        Least recently used traces are evicted to respect this budget.
+     * @param[in] nBytes  The cache size in bytes.  By default this is 1 GiB.
+     *                    If 0 then decoded traces are not cached.
+     * @note This is not reset by \c clear().
+     */
+    void setCacheSize(size_t nBytes) noexcept;
+    /*!
+     * @brief Gets the maximum number of bytes of decoded samples to cache.
+     * @result The cache size in bytes.
+     */
+    size_t getCacheSize() const noexcept;
+    /*!
+     * @brief Gets the cache counters.  These are useful for sizing the cache.
+     * @result The cache hits, misses, evictions, and current contents.
+     */
+    CacheStatistics getCacheStatistics() const noexcept;
+    /*!
+     * @brief Resets the hit, miss, and eviction counters.
+     */
+    void resetCacheStatistics() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Reads the miniSEED file.  Only the record headers are read;
+     *        the samples of a trace are decoded by \c getTrace().
      * @param[in] fileName  The name of the miniSEED file.
      * @throws std::invalid_argument if the miniSEED file does not exist or
      *         the file is malformed.
+     * @note The file is memory mapped until \c clear() or the next read.
      */
     void read(const std::string &fileName);
+    /*!
+     * @brief Writes the traces to a miniSEED file.  Batches of
+     *        \c getNumberOfThreads() traces are packed in parallel and
+     *        written in order.
+     * @param[in] fileName       The name of the miniSEED file to write.  The
+     *                           records are written to fileName.tmp which
+     *                           replaces an existing file only after every
+     *                           trace was written.
+     * @param[in] recordLength   The record length in bytes.
+     * @param[in] formatVersion  The miniSEED format version of the records.
+     * @param[in] encoding       The sample encoding.
+     * @throws std::invalid_argument if there are no traces or a trace
+     *         cannot be packed with the given arguments.
+     * @throws std::runtime_error if the records cannot be packed or the file
+     *         cannot be written.
+     * @sa \c Trace::write()
+     */
+    void write(const std::string &fileName,
+               int recordLength = 4096,
+               FormatVersion formatVersion = FormatVersion::MINISEED2,
+               Encoding encoding = Encoding::AUTOMATIC) const;
+    /*!
+     * @brief Adds a trace to the group.  A trace in the group with the
+     *        same SNCL is replaced.  Added traces are held outside of the
+     *        cache and are never evicted.
+     * @param[in] trace  The trace to add.
+     * @throws std::invalid_argument if the trace's SNCL is not set.
+     */
+    void setTrace(const Trace &trace);
     /*!
      * @brief Gets the SNCLs that exist in the archive.
      * @result The SNCLs that exist in the archive.  The result can be 
@@ -86,14 +184,30 @@ public:
     std::vector<SNCL> getSNCLs() const noexcept;
     /*!
      * @brief Extracts a trace with given SNCL from the miniSEED archive.
+     *        The trace is decoded if it is not in the cache.
      * @param[in] sncl  The SNCL to extract from the archive.
      * @result The trace corresponding to the given SNCL.
      * @throws std::invalid_argument if the SNCL does not exist in the archive.
-     * @sa \c haveSNCL()
+     * @throws std::runtime_error if the trace cannot be decoded.
+     * @sa \c haveSNCL(), \c getCacheStatistics()
      */
     Trace getTrace(const SNCL &sncl) const;
+    /*!
+     * @brief Gets a read-only handle to the trace with the given SNCL.
+     *        Unlike \c getTrace() the samples are not copied so consumers
+     *        holding handles to the same trace share one set of samples.
+     *        The trace is decoded if it is not in the cache.
+     * @param[in] sncl  The SNCL to extract from the archive.
+     * @result A handle to the trace corresponding to the given SNCL.  The
+     *         handle remains valid after the trace is evicted from the
+     *         cache or this class is cleared.
+     * @throws std::invalid_argument if the SNCL does not exist in the archive.
+     * @throws std::runtime_error if the trace cannot be decoded.
+     */
+    std::shared_ptr<const Trace> getSharedTrace(const SNCL &sncl) const;
     /*!
      * @brief Checks if a trace with the given SNCL exists in the archive.
+     *        This is answered from the record index without decoding.
      * @result True indicates that the SNCL exists in the archive.
      */
     bool haveSNCL(const SNCL &sncl) const noexcept;
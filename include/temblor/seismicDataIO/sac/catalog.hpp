@@ -0,0 +1,184 @@
+#ifndef TEMBLOR_SEISMICDATAIO_SAC_CATALOG_HPP
+#define TEMBLOR_SEISMICDATAIO_SAC_CATALOG_HPP 1
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "temblor/seismicDataIO/sac/enums.hpp"
+
+namespace Temblor::SeismicDataIO::SAC
+{
+/*!
+ * @brief A columnar table describing the SAC files in a directory tree.
+ *        Only the 632 byte header of each file is read so that archives
+ *        of millions of small files can be cataloged quickly.  Each row
+ *        describes one file and the columns can be filtered and sorted.
+ * @note Undefined floating point header variables, and times that depend
+ *       on them, are NaN in the catalog.
+ */
+class Catalog
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    Catalog();
+    /*!
+     * @brief Copy constructor.
+     * @param[in] catalog  The catalog from which to initialize this class.
+     */
+    Catalog(const Catalog &catalog);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] catalog  The catalog from which to initialize this
+     *                         class.  On exit, catalog's behavior is
+     *                         undefined.
+     */
+    Catalog(Catalog &&catalog) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] catalog  The catalog to copy.
+     * @result A deep copy of the catalog.
+     */
+    Catalog& operator=(const Catalog &catalog);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] catalog  The catalog whose memory will be moved to
+     *                         this.  On exit, catalog's behavior is
+     *                         undefined.
+     * @result The memory from catalog moved to this.
+     */
+    Catalog& operator=(Catalog &&catalog) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~Catalog();
+    /*!
+     * @brief Removes all rows.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Sets the number of threads used to read the headers.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads used to read the headers.
+     * @result The number of threads.
+     */
+    int getNumberOfThreads() const noexcept;
+
+    /*!
+     * @brief Catalogs every SAC file in a directory tree.  This replaces
+     *        the current rows.  The rows are sorted by file name.
+     * @param[in] directory  The root of the directory tree.
+     * @throws std::invalid_argument if the directory does not exist.
+     * @throws std::runtime_error if the filesystem library is unavailable.
+     * @note Files that are not valid SAC files are skipped.
+     */
+    void scan(const std::string &directory);
+    /*!
+     * @result The number of files that were skipped by the last scan
+     *         because they are not valid SAC files.
+     */
+    int getNumberOfFilesSkipped() const noexcept;
+    /*!
+     * @result The number of rows in the catalog.
+     */
+    int getNumberOfRows() const noexcept;
+
+    /*! @name Columns
+     * @{
+     */
+    /*!
+     * @result The path of each file.
+     */
+    const std::vector<std::string>& getFileNames() const noexcept;
+    /*!
+     * @result The network of each file, i.e., KNETWK.  This is empty if
+     *         undefined.
+     */
+    const std::vector<std::string>& getNetworks() const noexcept;
+    /*!
+     * @result The station of each file, i.e., KSTNM.  This is empty if
+     *         undefined.
+     */
+    const std::vector<std::string>& getStations() const noexcept;
+    /*!
+     * @result The channel of each file, i.e., KCMPNM.  This is empty if
+     *         undefined.
+     */
+    const std::vector<std::string>& getChannels() const noexcept;
+    /*!
+     * @result The location code of each file, i.e., KHOLE.  This is empty
+     *         if undefined.
+     */
+    const std::vector<std::string>& getLocationCodes() const noexcept;
+    /*!
+     * @result The time of each file's first sample in UTC seconds since
+     *         the epoch.
+     */
+    const std::vector<double>& getStartTimes() const noexcept;
+    /*!
+     * @result The number of samples in each file.
+     */
+    const std::vector<int>& getNumberOfSamples() const noexcept;
+    /*!
+     * @result The sampling period of each file in seconds.
+     */
+    const std::vector<double>& getSamplingPeriods() const noexcept;
+    /*!
+     * @result The event latitude of each file in degrees.
+     */
+    const std::vector<double>& getEventLatitudes() const noexcept;
+    /*!
+     * @result The event longitude of each file in degrees.
+     */
+    const std::vector<double>& getEventLongitudes() const noexcept;
+    /*!
+     * @brief Gets a user defined pick of each file.
+     * @param[in] pick  The pick, i.e., 0 for T0 through 9 for T9.
+     * @result The time of the pick in UTC seconds since the epoch.
+     * @throws std::invalid_argument if pick is not in the range [0,9].
+     */
+    const std::vector<double>& getPicks(int pick) const;
+    /*! @} */
+
+    /*!
+     * @brief Keeps the rows for which the predicate is true.  The order of
+     *        the remaining rows is preserved.
+     * @param[in] keep  Given this catalog and a row index, this returns
+     *                  true if the row should be kept.
+     */
+    void filter(const std::function<bool (const Catalog &, int)> &keep);
+    /*!
+     * @brief Sorts the rows.  The sort is stable so successive sorts can
+     *        order the rows by several columns.  NaNs are sorted last.
+     * @param[in] column     The column by which to sort.
+     * @param[in] ascending  If true then the rows are sorted in ascending
+     *                       order.  Otherwise, they are sorted in
+     *                       descending order.
+     */
+    void sort(CatalogColumn column, bool ascending = true);
+private:
+    class CatalogImpl;
+    std::unique_ptr<CatalogImpl> pImpl;
+};
+}
+#endif
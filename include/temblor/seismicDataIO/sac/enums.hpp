@@ -8,7 +8,9 @@ namespace Temblor::SeismicDataIO::SAC
  * @brief Identifies a SAC floating point header variable.
  * @note SAC files internally store 32-bit float numbers.
  *       However, this interface will deal exclusively in doubles.
- *       Consequently, there will be truncation errors on write.
+ *       Consequently, there will be truncation errors on write unless
+ *       NVHDR is 7, in which case DELTA, B, E, O, A, T0-T9, F, EVLO, EVLA,
+ *       STLO, and STLA are also written as doubles in a footer.
  */
 enum class Double
 {
@@ -196,5 +198,31 @@ enum class Character
     KINST   /*!< Generic name of recording instrument. */
 };
 
+/*!
+ * @brief Defines the precision with which a waveform's samples are held
+ *        in memory.
+ * @note SAC files store 32-bit floats so FLOAT32 requires no conversion.
+ */
+enum class Precision
+{
+    FLOAT32, /*!< 32-bit floating precision. */
+    FLOAT64  /*!< 64-bit floating precision.  This is the default. */
+};
+
+/*!
+ * @brief Identifies a column by which a SAC catalog can be sorted.
+ */
+enum class CatalogColumn
+{
+    FILE_NAME,         /*!< The file name. */
+    SNCL,              /*!< The network, station, channel, and location
+                            code. */
+    START_TIME,        /*!< The time of the first sample. */
+    NUMBER_OF_SAMPLES, /*!< The number of samples. */
+    SAMPLING_PERIOD,   /*!< The sampling period. */
+    EVENT_LATITUDE,    /*!< The event latitude. */
+    EVENT_LONGITUDE    /*!< The event longitude. */
+};
+
 }
 #endif
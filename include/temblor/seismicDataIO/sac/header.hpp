@@ -76,7 +76,8 @@ public:
     /*! @} */
 
     /*!
-     * @brief Reads the header from a file.
+     * @brief Reads the header from a file.  The double precision footer of
+     *        a version 7 file is also read.
      * @param[in] fileName  The name of the SAC file.
      * @throws std::invalid_argument if the file does not exists or the header
      *         is malformed.
@@ -104,6 +105,35 @@ public:
      */
     void getBinaryHeader(char header[632], 
                          bool lswap = false) const noexcept;
+    /*!
+     * @brief Sets the double precision header variables from the footer of
+     *        a version 7 (NVHDR = 7) SAC file.  The footer follows the
+     *        data and holds DELTA, B, E, O, A, T0-T9, F, EVLO, EVLA, STLO,
+     *        STLA, SB, and SDELTA as 22 doubles.
+     * @param[in] footer  The footer.  This is an array of dimension [176].
+     * @param[in] lswap   If true then the byte order will be swapped.
+     *                    The default is false.
+     * @throws std::invalid_argument if the sampling period is not positive.
+     */
+    void setFromBinaryFooter(const char footer[176], bool lswap = false);
+    /*!
+     * @brief Creates the footer of a version 7 SAC file.
+     * @param[out] footer  The packed footer.  This is an array of dimension
+     *                     [176] and follows the data in the SAC file.
+     * @param[in] lswap    If true then the byte order will be swapped.
+     *                     The default is false.
+     */
+    void getBinaryFooter(char footer[176],
+                         bool lswap = false) const noexcept;
+    /*!
+     * @brief Determines the byte order of a binary header from its header
+     *        version and number of points.
+     * @param[in] header  The first 632 bytes of a SAC file.
+     * @result True indicates that the header's byte order is the opposite
+     *         of the machine's.
+     * @throws std::invalid_argument if the byte order cannot be determined.
+     */
+    static bool isByteSwapped(const char header[632]);
     /*! @name Floating Point Header Variables
      * @{
      */
@@ -192,6 +192,22 @@ public:
      */
     Temblor::Utilities::Time getStartTime() const override;
 
+    /*!
+     * @brief Sets the precision with which the samples are held in memory.
+     *        Any existing samples are converted.
+     * @param[in] precision  The sample precision.  By default this is
+     *                       Precision::FLOAT64.
+     * @note Holding the samples as Precision::FLOAT32 halves the memory
+     *       and lets files in the machine's byte order be read without
+     *       converting the samples.
+     */
+    void setPrecision(Precision precision);
+    /*!
+     * @brief Gets the precision with which the samples are held in memory.
+     * @result The sample precision.
+     */
+    Precision getPrecision() const noexcept;
+
     /*!
      * @brief Sets the data.
      * @param[in] npts  The number of samples in the waveform.  This must be
@@ -199,14 +215,26 @@ public:
      * @param[in] data  The waveform data.  This is an array of dimension
      *                  [npts].
      * @throws std::invalid_argument if npts is not positive or data is NULL.
+     * @note The samples are converted to the precision given by
+     *       \c getPrecision().
      */
     void setData(int npts, const double data[]);
+    /*! @copydoc setData(int, const double[]) */
+    void setData(int npts, const float data[]);
     /*!
      * @brief Returns a pointer to the data.
      * @result A pointer to the data.  This can be NULL.  The length of
      *         the pointer is given by \c getNumberOfSamples().
+     * @note This is NULL when the samples are held as Precision::FLOAT32.
      */
     const double *getDataPointer() const noexcept;
+    /*!
+     * @brief Returns a pointer to the data without copying the samples.
+     * @result A pointer to the data.  This can be NULL.  The length of
+     *         the pointer is given by \c getNumberOfSamples().
+     * @note This is NULL when the samples are held as Precision::FLOAT64.
+     */
+    const float *getDataPointer32f() const noexcept;
 
     void getData(int npts, double *data[]) const override;
     void getData(int npts, float *data[]) const override;
@@ -217,20 +245,58 @@ public:
     std::vector<double> getData() const noexcept;
 
     /*!
-     * @brief Loads a SAC data file.
+     * @brief Loads a SAC data file.  The file is memory mapped and its
+     *        samples are converted directly to the precision given by
+     *        \c getPrecision().
      * @param[in] fileName  The name of file to read.
      * @throws std::invalid_argument if fileName does not exist
      *         or the SAC file is unreadable.
      */
     void read(const std::string &fileName);
     /*!
-     * @brief Writes the SAC file.
+     * @brief Loads the samples of a SAC data file in the time window
+     *        [t0, t1].  Only the header and the samples in the window are
+     *        read from the file.  The byte order is determined from the
+     *        header.  B, E, and NPTS are adjusted to describe the window.
+     * @param[in] fileName  The name of file to read.
+     * @param[in] t0        The start time of the window.
+     * @param[in] t1        The end time of the window.
+     * @throws std::invalid_argument if fileName does not exist, the SAC
+     *         file is unreadable, t1 is less than t0, or there are no
+     *         samples in the window.
+     * @throws std::runtime_error if the header's start time is not set.
+     */
+    void read(const std::string &fileName,
+              const Temblor::Utilities::Time &t0,
+              const Temblor::Utilities::Time &t1);
+    /*!
+     * @brief Writes the SAC file.  The samples are converted and written a
+     *        block at a time so the file is never staged in memory.
      * @param[out] fileName  The SAC file to write.
+     * @param[in] lswap      If true then the file is written in the
+     *                       opposite of the machine's byte order.
      * @throws std::invalid_argument if the path to fileName is invalid.
-     * @throws std::runtime_error if the SAC class is not valid or.
+     * @throws std::runtime_error if the SAC class is not valid or the
+     *         file cannot be written.
+     * @note The double precision footer is written when NVHDR is 7.
      * @sa \c isValid()
      */
     void write(const std::string &fileName, const bool lswap = false) const;
+    /*!
+     * @brief Writes many SAC files in parallel.
+     * @param[in] waveforms  The waveforms to write.
+     * @param[in] fileNames  The file name of each waveform.
+     * @param[in] lswap      If true then the files are written in the
+     *                       opposite of the machine's byte order.
+     * @param[in] nThreads   The number of threads.
+     * @throws std::invalid_argument if the number of waveforms and file
+     *         names differ or nThreads is not positive.
+     * @throws std::runtime_error if any file cannot be written.  The other
+     *         files are still written.
+     */
+    static void writeMany(const std::vector<Waveform> &waveforms,
+                          const std::vector<std::string> &fileNames,
+                          bool lswap = false, int nThreads = 1);
 private:
     class WaveformImpl;
     std::unique_ptr<WaveformImpl> pImpl;
@@ -1,5 +1,6 @@
 #ifndef TEMBLOR_SEISMICDATAIO_SEGY_BINARYFILEHEADER_HPP
 #define TEMBLOR_SEISMICDATAIO_SEGY_BINARYFILEHEADER_HPP
+#include <cstdint>
 #include <memory>
 
 namespace Temblor::SeismicDataIO::SEGY
@@ -179,6 +180,9 @@ public:
     /*! 
      * @brief Sets the binary file header from data read from disk.
      * @param[in] header  The header variable information to set on the class.
+     *                    The byte order is determined from the integer
+     *                    constant in bytes 3297-3300.  If that is not set
+     *                    then the header is assumed to be big-endian.
      * @throws std::invalid_argument if the header is invalid.
      */
     void setBinaryHeader(const char header[400]);
@@ -188,6 +192,87 @@ public:
      * @throws std::runtime_error if the file header is malformed.
      */
     void getBinaryHeader(char header[400]) const;
+    /*!
+     * @brief Determines the byte order of the file.
+     * @result True indicates that the header and traces are little-endian.
+     *         False indicates the SEG-Y standard big-endian byte order.
+     */
+    bool isLittleEndian() const noexcept;
+
+    /*! @name Revision
+     * @{
+     */
+    /*!
+     * @brief Gets the major SEG-Y format revision number.
+     * @result The major revision.  0 indicates the traditional format.
+     */
+    uint8_t getMajorRevision() const noexcept;
+    /*!
+     * @brief Gets the minor SEG-Y format revision number.
+     * @result The minor revision.
+     */
+    uint8_t getMinorRevision() const noexcept;
+    /*! @} */
+
+    /*! @name File Layout
+     * @{
+     */
+    /*!
+     * @brief Sets the fixed length trace flag.
+     * @param[in] fixedLength  True indicates that every trace has the
+     *                         number of samples and sample interval in this
+     *                         header.
+     * @note This flag is defined for revision 1 and later files.  The
+     *       traces of revision 0 files always have a fixed length.
+     */
+    void setFixedLengthTraces(bool fixedLength) noexcept;
+    /*!
+     * @brief Determines if every trace has the number of samples and sample
+     *        interval in this header.
+     * @result True indicates that the traces have a fixed length.  This is
+     *         always true for revision 0 files.
+     */
+    bool haveFixedLengthTraces() const noexcept;
+    /*!
+     * @brief Gets the number of 3200-byte extended textual file headers
+     *        that follow this header.
+     * @result The number of extended textual file headers.  -1 indicates
+     *         a variable number terminated by an ((SEG: EndText)) stanza.
+     */
+    int getNumberOfExtendedTextualHeaders() const noexcept;
+    /*!
+     * @brief Gets the number of additional 240-byte trace headers that
+     *        may follow each standard trace header.
+     * @result The maximum number of additional trace headers.
+     */
+    int getMaximumNumberOfAdditionalTraceHeaders() const noexcept;
+    /*!
+     * @brief Sets the number of traces in the file.
+     * @param[in] nTraces  The number of traces in the file.  0 indicates
+     *                     that this is unknown.
+     * @note This field is defined for revision 2 and later files.
+     */
+    void setNumberOfTracesInFile(uint64_t nTraces) noexcept;
+    /*!
+     * @brief Gets the number of traces in the file.
+     * @result The number of traces in the file.  0 indicates that this
+     *         is unknown and must be determined from the file size.
+     */
+    uint64_t getNumberOfTracesInFile() const noexcept;
+    /*!
+     * @brief Gets the byte offset of the first trace.
+     * @result The byte offset of the first trace relative to the start of
+     *         the file.  0 indicates that this is unknown and the first
+     *         trace follows the extended textual file headers.
+     */
+    uint64_t getFirstTraceOffset() const noexcept;
+    /*!
+     * @brief Gets the number of 3200-byte data trailer stanzas.
+     * @result The number of data trailer stanzas.  -1 indicates a variable
+     *         number.
+     */
+    int getNumberOfDataTrailerStanzas() const noexcept;
+    /*! @} */
 
     /*! @name Job Identification Number
      * @{
@@ -0,0 +1,247 @@
+#ifndef TEMBLOR_SEISMICDATAIO_SEGY_GATHERINDEX_HPP
+#define TEMBLOR_SEISMICDATAIO_SEGY_GATHERINDEX_HPP 1
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Temblor::SeismicDataIO::SEGY
+{
+class TraceHeader;
+enum class TraceHeaderField;
+enum class TraceSortingCode: std::int16_t;
+/*!
+ * @brief Describes the location of a trace in an indexed SEG-Y file.
+ */
+struct IndexedTrace
+{
+    int64_t offset = 0;     /*!< The byte offset of the trace header in
+                                 the SEG-Y file. */
+    int32_t trace = 0;      /*!< The index of the trace in the SEG-Y
+                                 file. */
+    int32_t nSamples = 0;   /*!< The number of samples in the trace. */
+    std::vector<int> keys;  /*!< The value of each field in
+                                 \c GatherIndex::getKeys(). */
+};
+/*!
+ * @brief Indexes the trace headers of a SEG-Y file so that traces can be
+ *        regrouped into gathers, e.g., common receiver, source, CDP, or
+ *        offset gathers, without reading the file.
+ * @note The chosen trace header keys are extracted into an index file with
+ *       one fixed width row per trace that holds a column per key and the
+ *       trace's location.  The rows are sorted out-of-core by an external
+ *       merge sort whose memory is bounded by \c setMaximumMemory() so that
+ *       indexes of very large surveys can be sorted.  A gather is found by
+ *       a binary search of the sorted index and its traces are read with a
+ *       batch of preads.
+ */
+class GatherIndex
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    GatherIndex();
+    /*!
+     * @brief Copy constructor.
+     * @param[in] index  The gather index from which to initialize this
+     *                   class.
+     */
+    GatherIndex(const GatherIndex &index);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] index  The gather index from which to initialize this
+     *                       class.  On exit, index's behavior is undefined.
+     */
+    GatherIndex(GatherIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] index  The gather index to copy.
+     * @result A copy of the gather index.  Both refer to the same index
+     *         file.
+     */
+    GatherIndex& operator=(const GatherIndex &index);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] index  The gather index whose memory will be moved to
+     *                       this.  On exit, index's behavior is undefined.
+     * @result The memory from index moved to this.
+     */
+    GatherIndex& operator=(GatherIndex &&index) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~GatherIndex();
+    /*!
+     * @brief Releases the index.  The index file is not removed.
+     * @note The maximum memory is not reset.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Sets the maximum memory used to build and sort the index.
+     * @param[in] nBytes  The maximum number of bytes.  By default this is
+     *                    256 MB.
+     * @throws std::invalid_argument if nBytes is less than 4096.
+     */
+    void setMaximumMemory(size_t nBytes);
+    /*!
+     * @brief Gets the maximum memory used to build and sort the index.
+     * @result The maximum number of bytes.
+     */
+    size_t getMaximumMemory() const noexcept;
+
+    /*! @name Indexing
+     * @{
+     */
+    /*!
+     * @brief Extracts trace header keys from a SEG-Y file into an index
+     *        file.  The rows of the index are in file order.
+     * @param[in] segyFileName   The name of the SEG-Y file to index.
+     * @param[in] keys           The trace header fields to extract.  Each
+     *                           field may appear once.
+     * @param[in] indexFileName  The name of the index file to write.
+     * @throws std::invalid_argument if keys is empty or has duplicates or
+     *         the SEG-Y file cannot be read.
+     * @throws std::runtime_error if the index file cannot be written.
+     */
+    void build(const std::string &segyFileName,
+               const std::vector<TraceHeaderField> &keys,
+               const std::string &indexFileName);
+    /*!
+     * @brief Opens an index that was written by \c build().
+     * @param[in] indexFileName  The name of the index file.
+     * @throws std::invalid_argument if the file does not exist or is not a
+     *         valid index file.
+     */
+    void load(const std::string &indexFileName);
+    /*!
+     * @brief Gets the name of the indexed SEG-Y file.
+     * @result The name of the SEG-Y file.  This is empty if nothing has
+     *         been indexed.
+     */
+    std::string getSEGYFileName() const noexcept;
+    /*!
+     * @brief Gets the trace header fields in the index.
+     * @result The indexed trace header fields.
+     */
+    std::vector<TraceHeaderField> getKeys() const noexcept;
+    /*!
+     * @brief Gets the number of indexed traces.
+     * @result The number of traces in the index.
+     */
+    int getNumberOfTraces() const noexcept;
+    /*! @} */
+
+    /*! @name Sorting
+     * @{
+     */
+    /*!
+     * @brief Gets the trace sorting code of the indexed SEG-Y file's binary
+     *        file header, i.e., the order in which the traces were written.
+     * @result The native sorting code of the SEG-Y file.
+     */
+    TraceSortingCode getNativeSortingCode() const noexcept;
+    /*!
+     * @brief Gets the trace header fields that order the traces of a
+     *        sorting code.  For ensemble sorting codes, e.g., CDP or common
+     *        receiver, this is the ensemble number followed by the trace
+     *        number in the ensemble.
+     * @param[in] code  The trace sorting code.
+     * @result The sort keys.  This is empty if the order is unknown.
+     */
+    static std::vector<TraceHeaderField> getSortKeys(TraceSortingCode code);
+    /*!
+     * @brief Gets the keys by which the index is currently sorted.
+     * @result The sort keys.  This is empty if the rows are in file order.
+     */
+    std::vector<TraceHeaderField> getSortKeys() const noexcept;
+    /*!
+     * @brief Sorts the index by the given keys.  Ties are kept in file
+     *        order.
+     * @param[in] keys  The sort keys in order of precedence.  Each must be
+     *                  in \c getKeys().
+     * @result True if the rows were sorted.  False indicates that the
+     *         index was already in this order, e.g., the keys match the
+     *         native sorting code and the rows were verified to be in
+     *         order, so the sort was skipped.
+     * @throws std::invalid_argument if keys is empty or contains a field
+     *         that is not indexed.
+     * @throws std::runtime_error if the index is not loaded or a
+     *         temporary file cannot be written.
+     * @note The sorted runs are written next to the index file.  At most
+     *       \c getMaximumMemory() bytes of rows are held in memory.
+     */
+    bool sort(const std::vector<TraceHeaderField> &keys);
+    /*!
+     * @brief Sorts the index by the keys of a trace sorting code.
+     * @param[in] code  The trace sorting code.
+     * @result True if the rows were sorted.
+     * @throws std::invalid_argument if the code has no sort keys or the
+     *         sort keys are not indexed.
+     * @sa \c getSortKeys(TraceSortingCode)
+     */
+    bool sort(TraceSortingCode code);
+    /*! @} */
+
+    /*! @name Gathers
+     * @{
+     */
+    /*!
+     * @brief Finds the traces of a gather.
+     * @param[in] values  The values of the leading sort keys that define
+     *                    the gather, e.g., the receiver number.  There
+     *                    can be at most as many values as sort keys.
+     * @result The traces in the gather in sorted order.  This is empty if
+     *         no traces match.
+     * @throws std::invalid_argument if the index is not sorted, values is
+     *         empty, or values has more values than sort keys.
+     */
+    std::vector<IndexedTrace> getGather(const std::vector<int> &values) const;
+    /*!
+     * @brief Reads the traces of a gather from the SEG-Y file.
+     * @param[in] values    The values of the leading sort keys that define
+     *                      the gather.
+     * @param[out] headers  The trace header of each trace in the gather.
+     * @param[out] traces   The samples of each trace in the gather in the
+     *                      machine's byte order.
+     * @throws std::invalid_argument if headers or traces is NULL or the
+     *         gather cannot be found as in \c getGather().
+     * @throws std::runtime_error if the SEG-Y file cannot be read or its
+     *         data format is not supported.
+     * @note Traces that are adjacent in the SEG-Y file are read with a
+     *       single pread.
+     * @sa \c getGather()
+     */
+    void readGather(const std::vector<int> &values,
+                    std::vector<TraceHeader> *headers,
+                    std::vector<std::vector<double>> *traces) const;
+    /*!
+     * @brief Reads the traces of a gather in single precision.  The
+     *        arguments and exceptions are as for the double precision
+     *        version.
+     */
+    void readGather(const std::vector<int> &values,
+                    std::vector<TraceHeader> *headers,
+                    std::vector<std::vector<float>> *traces) const;
+    /*! @} */
+private:
+    class GatherIndexImpl;
+    std::unique_ptr<GatherIndexImpl> pImpl;
+};
+}
+#endif
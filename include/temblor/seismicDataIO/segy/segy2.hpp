@@ -1,5 +1,6 @@
 #ifndef TEMBLOR_SEISMICDATAIO_SEGY_SEGY2_HPP
 #define TEMBLOR_SEISMICDATAIO_SEGY_SEGY2_HPP
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -7,8 +8,15 @@
 namespace Temblor::SeismicDataIO::SEGY
 {
 class BinaryFileHeader;
+class TraceHeader;
 /*!
  * @brief A class for reading/writing SEGY-Revision 2 files.
+ * @note The file is memory mapped by \c read() and traces are decoded on
+ *       request.  When the traces have a fixed length a trace is located
+ *       in constant time from its index.  Otherwise, the trace offsets are
+ *       tabulated by a single scan of the trace headers.  The const
+ *       accessors do not modify the class so traces can be decoded
+ *       concurrently.
  */
 class Segy2
 {
@@ -43,11 +51,74 @@ public:
      * @param[in] fileName   The name of the SEGY-2 file to read.
      * @throws std::invalid_argument if the fileName does not exist or refers
      *         to an invalid SEGY-2 file.
+     * @note Revision 0 and 1 files can also be read.
      */
     void read(const std::string &fileName);
 
     /*! @} */
 
+    /*! @name Binary File Header
+     * @{
+     */
+    /*!
+     * @brief Gets the 400-byte binary file header.
+     * @result The binary file header.
+     */
+    BinaryFileHeader getBinaryFileHeader() const;
+    /*! @} */
+
+    /*! @name Traces
+     * @{
+     */
+    /*!
+     * @brief Gets the number of traces in the file.
+     * @result The number of traces.
+     */
+    int getNumberOfTraces() const noexcept;
+    /*!
+     * @brief Gets the 240-byte trace header of a trace.
+     * @param[in] trace  The trace index.  This must be in the range
+     *                   [0, \c getNumberOfTraces() - 1].
+     * @result The trace header.
+     * @throws std::invalid_argument if the trace index is out of range.
+     */
+    TraceHeader getTraceHeader(int trace) const;
+    /*!
+     * @brief Gets the byte offset of a trace in the file.
+     * @param[in] trace  The trace index.  This must be in the range
+     *                   [0, \c getNumberOfTraces() - 1].
+     * @result The offset of the trace's 240-byte header from the start of
+     *         the file.  The samples immediately follow the header.
+     * @throws std::invalid_argument if the trace index is out of range.
+     */
+    uint64_t getTraceOffset(int trace) const;
+    /*!
+     * @brief Gets the number of samples in a trace.
+     * @param[in] trace  The trace index.  This must be in the range
+     *                   [0, \c getNumberOfTraces() - 1].
+     * @result The number of samples in the trace.
+     * @throws std::invalid_argument if the trace index is out of range.
+     */
+    int getNumberOfSamples(int trace) const;
+    /*!
+     * @brief Gets the samples of a trace.
+     * @param[in] trace  The trace index.  This must be in the range
+     *                   [0, \c getNumberOfTraces() - 1].
+     * @param[in] npts   The space allocated to data.  This must be at least
+     *                   \c getNumberOfSamples(trace).
+     * @param[out] data  The samples of the trace in the machine's byte
+     *                   order.  This is an array of dimension [npts] though
+     *                   only the first \c getNumberOfSamples(trace) samples
+     *                   are set.
+     * @throws std::invalid_argument if the trace index is out of range,
+     *         npts is too small, or data is NULL.
+     * @throws std::runtime_error if the data format is not supported.
+     */
+    void getTrace(int trace, int npts, double *data[]) const;
+    /*! @copydoc getTrace(int, int, double *[]) const */
+    void getTrace(int trace, int npts, float *data[]) const;
+    /*! @} */
+
     /*! @name Textual Header
      * @{
      */
@@ -0,0 +1,180 @@
+#ifndef TEMBLOR_SEISMICDATAIO_SEGY_SEGY2WRITER_HPP
+#define TEMBLOR_SEISMICDATAIO_SEGY_SEGY2WRITER_HPP 1
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace Temblor::SeismicDataIO::SEGY
+{
+class BinaryFileHeader;
+class TraceHeader;
+/*!
+ * @brief Streams traces to a big-endian SEG-Y file.
+ * @note The textual and binary file headers are written by \c open() and
+ *       traces are then appended.  Traces are packed, i.e., their headers
+ *       and samples are converted to the file's data format, into a large
+ *       aligned buffer.  A batch of traces is packed in parallel while a
+ *       single thread writes the previously filled buffer so that the
+ *       traces are written in order and packing overlaps with I/O.  The
+ *       file is never staged in memory.
+ * @note Only the batch \c write() is parallel.  A single trace is packed
+ *       on the calling thread, and when it fills a buffer the previous
+ *       buffer is written on the calling thread before \c write() returns.
+ *       For throughput, append traces in batches of a buffer or more.
+ */
+class Segy2Writer
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Default constructor.
+     */
+    Segy2Writer();
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] writer  The writer from which to initialize this
+     *                        class.  On exit, writer's behavior is
+     *                        undefined.
+     */
+    Segy2Writer(Segy2Writer &&writer) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] writer  The writer whose memory will be moved to this.
+     *                        On exit, writer's behavior is undefined.
+     * @result The memory from writer moved to this.
+     */
+    Segy2Writer& operator=(Segy2Writer &&writer) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.  An open file is closed.
+     * @note Errors are only printed.  Use \c close() to detect them.
+     */
+    ~Segy2Writer();
+    /*! @} */
+
+    /*!
+     * @brief Sets the number of threads that pack traces.
+     * @param[in] nThreads  The number of threads.  By default this is 1.
+     * @throws std::invalid_argument if nThreads is not positive.
+     */
+    void setNumberOfThreads(int nThreads);
+    /*!
+     * @brief Gets the number of threads that pack traces.
+     * @result The number of packing threads.
+     */
+    int getNumberOfThreads() const noexcept;
+    /*!
+     * @brief Sets the size of each of the two write buffers.
+     * @param[in] nBytes  The buffer size in bytes.  By default this is
+     *                    16 MB.
+     * @throws std::invalid_argument if nBytes is less than 64 kB.
+     * @note This takes effect when the next file is opened.  A buffer is
+     *       enlarged if a single trace does not fit.
+     */
+    void setBufferSize(size_t nBytes);
+    /*!
+     * @brief Gets the size of each of the two write buffers.
+     * @result The buffer size in bytes.
+     */
+    size_t getBufferSize() const noexcept;
+
+    /*! @name Writing
+     * @{
+     */
+    /*!
+     * @brief Creates a SEG-Y file and writes its file headers.
+     * @param[in] fileName       The name of the file to write.
+     * @param[in] binaryHeader   The binary file header.  This defines the
+     *                           data format and, for fixed length traces,
+     *                           the number of samples in each trace.
+     * @param[in] textualHeader  The 3200 character textual header in
+     *                           ASCII.  It is padded with blanks or
+     *                           truncated to 3200 characters and written in
+     *                           EBCDIC.
+     * @throws std::invalid_argument if the data format is not supported,
+     *         the header has extended textual headers, additional trace
+     *         headers, or trailers, or fixed length traces do not have
+     *         a number of samples.
+     * @throws std::runtime_error if the file cannot be created.
+     * @note If a file is open then it is closed first.  For revision 2
+     *       and later files the number of traces in the binary header is
+     *       set when the file is closed.
+     */
+    void open(const std::string &fileName,
+              const BinaryFileHeader &binaryHeader,
+              const std::string &textualHeader = std::string());
+    /*!
+     * @brief Determines if a file is open.
+     * @result True indicates that traces can be written.
+     */
+    bool isOpen() const noexcept;
+    /*!
+     * @brief Appends a trace.
+     * @param[in] header  The trace header.  The number of samples is set
+     *                    from npts and the sample interval is set from the
+     *                    binary file header if it is zero.
+     * @param[in] npts    The number of samples.
+     * @param[in] x       The samples.  This is an array of dimension
+     *                    [npts].
+     * @throws std::invalid_argument if npts is not in the range
+     *         [0,65535], x is NULL, or the traces have a fixed length and
+     *         npts differs from the binary file header.
+     * @throws std::runtime_error if the file is not open or cannot be
+     *         written.
+     * @note The trace is packed on the calling thread.  If the current
+     *       buffer is full then the previous buffer is written before
+     *       packing so this call does not overlap packing with I/O.
+     */
+    void write(const TraceHeader &header, int npts, const double x[]);
+    /*! @copydoc write(const TraceHeader &, int, const double[]) */
+    void write(const TraceHeader &header, int npts, const float x[]);
+    /*!
+     * @brief Appends a batch of traces.  The traces are packed on
+     *        \c getNumberOfThreads() threads.
+     * @param[in] headers  The trace header of each trace.
+     * @param[in] traces   The samples of each trace.  This must be the
+     *                     same size as headers.
+     * @throws std::invalid_argument if headers and traces differ in size
+     *         or a trace has an invalid number of samples.
+     * @throws std::runtime_error if the file is not open or cannot be
+     *         written.
+     * @note The batch is checked before packing so no trace is appended
+     *       if a trace is invalid.
+     */
+    void write(const std::vector<TraceHeader> &headers,
+               const std::vector<std::vector<double>> &traces);
+    /*!
+     * @brief Appends a batch of single precision traces.  The arguments
+     *        and exceptions are as for the double precision version.
+     */
+    void write(const std::vector<TraceHeader> &headers,
+               const std::vector<std::vector<float>> &traces);
+    /*!
+     * @brief Gets the number of traces written to the open file.
+     * @result The number of traces appended since \c open().
+     */
+    uint64_t getNumberOfTracesWritten() const noexcept;
+    /*!
+     * @brief Writes the buffered traces and closes the file.
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void close();
+    /*! @} */
+private:
+    class Segy2WriterImpl;
+    std::unique_ptr<Segy2WriterImpl> pImpl;
+};
+}
+#endif
@@ -0,0 +1,176 @@
+#ifndef TEMBLOR_SEISMICDATAIO_SEGY_TRACEHEADER_HPP
+#define TEMBLOR_SEISMICDATAIO_SEGY_TRACEHEADER_HPP
+#include <cstdint>
+#include <memory>
+
+namespace Temblor::Utilities
+{
+class Time;
+}
+
+namespace Temblor::SeismicDataIO::SEGY
+{
+/*!
+ * @brief Defines the commonly used fields in the 240-byte standard trace
+ *        header.  The byte offset and width of each field follow SEG-Y
+ *        revision 2.
+ */
+enum class TraceHeaderField
+{
+    TRACE_SEQUENCE_NUMBER_IN_LINE = 0,  /*!< Bytes 1-4. */
+    TRACE_SEQUENCE_NUMBER_IN_FILE = 1,  /*!< Bytes 5-8. */
+    FIELD_RECORD_NUMBER = 2,            /*!< Bytes 9-12. */
+    TRACE_NUMBER_IN_FIELD_RECORD = 3,   /*!< Bytes 13-16. */
+    ENERGY_SOURCE_POINT_NUMBER = 4,     /*!< Bytes 17-20. */
+    ENSEMBLE_NUMBER = 5,                /*!< Bytes 21-24, e.g., the CDP. */
+    TRACE_NUMBER_IN_ENSEMBLE = 6,       /*!< Bytes 25-28. */
+    TRACE_IDENTIFICATION_CODE = 7,      /*!< Bytes 29-30. */
+    SOURCE_RECEIVER_OFFSET = 8,         /*!< Bytes 37-40. */
+    RECEIVER_GROUP_ELEVATION = 9,       /*!< Bytes 41-44. */
+    SURFACE_ELEVATION_AT_SOURCE = 10,   /*!< Bytes 45-48. */
+    SOURCE_DEPTH = 11,                  /*!< Bytes 49-52. */
+    ELEVATION_SCALAR = 12,              /*!< Bytes 69-70. */
+    COORDINATE_SCALAR = 13,             /*!< Bytes 71-72. */
+    SOURCE_X = 14,                      /*!< Bytes 73-76. */
+    SOURCE_Y = 15,                      /*!< Bytes 77-80. */
+    GROUP_X = 16,                       /*!< Bytes 81-84. */
+    GROUP_Y = 17,                       /*!< Bytes 85-88. */
+    COORDINATE_UNITS = 18,              /*!< Bytes 89-90. */
+    DELAY_RECORDING_TIME = 19,          /*!< Bytes 109-110 in ms. */
+    NUMBER_OF_SAMPLES = 20,             /*!< Bytes 115-116 (unsigned). */
+    SAMPLE_INTERVAL = 21,               /*!< Bytes 117-118 in
+                                             microseconds (unsigned). */
+    YEAR = 22,                          /*!< Bytes 157-158. */
+    DAY_OF_YEAR = 23,                   /*!< Bytes 159-160. */
+    HOUR = 24,                          /*!< Bytes 161-162. */
+    MINUTE = 25,                        /*!< Bytes 163-164. */
+    SECOND = 26,                        /*!< Bytes 165-166. */
+    TIME_BASIS_CODE = 27,               /*!< Bytes 167-168. */
+    CDP_X = 28,                         /*!< Bytes 181-184. */
+    CDP_Y = 29,                         /*!< Bytes 185-188. */
+    INLINE_NUMBER = 30,                 /*!< Bytes 189-192. */
+    CROSSLINE_NUMBER = 31,              /*!< Bytes 193-196. */
+    SHOTPOINT_NUMBER = 32,              /*!< Bytes 197-200. */
+    SHOTPOINT_SCALAR = 33               /*!< Bytes 201-202. */
+};
+
+/*!
+ * @class TraceHeader "traceHeader.hpp" "temblor/seismicDataIO/segy/traceHeader.hpp"
+ * @brief Defines the 240-byte standard trace header that precedes each
+ *        trace in a SEG-Y file.
+ * @note The header is kept as its 240 bytes so that fields which are not
+ *       enumerated in TraceHeaderField survive a read and write.
+ */
+class TraceHeader
+{
+public:
+    /*! @name Constructors
+     * @{
+     */
+    /*!
+     * @brief Constructor.  All fields are zero.
+     */
+    TraceHeader();
+    /*!
+     * @brief Copy constructor.
+     * @param[in] header  The trace header from which to initialize this
+     *                    class.
+     */
+    TraceHeader(const TraceHeader &header);
+    /*!
+     * @brief Move constructor.
+     * @param[in,out] header  The trace header whose memory will be moved to
+     *                        this class.  On exit header's behavior is
+     *                        undefined.
+     */
+    TraceHeader(TraceHeader &&header) noexcept;
+    /*! @} */
+
+    /*! @name Operators
+     * @{
+     */
+    /*!
+     * @brief Copy assignment operator.
+     * @param[in] header  The trace header to copy.
+     * @result A deep copy of header.
+     */
+    TraceHeader& operator=(const TraceHeader &header);
+    /*!
+     * @brief Move assignment operator.
+     * @param[in,out] header  The trace header whose memory will be moved to
+     *                        this.  On exit header's behavior is undefined.
+     * @result The memory from header moved to this.
+     */
+    TraceHeader& operator=(TraceHeader &&header) noexcept;
+    /*! @} */
+
+    /*! @name Destructors
+     * @{
+     */
+    /*!
+     * @brief Destructor.
+     */
+    ~TraceHeader();
+    /*!
+     * @brief Sets all fields to zero.
+     */
+    void clear() noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Sets the trace header from data read from disk.
+     * @param[in] header        The 240-byte trace header.
+     * @param[in] littleEndian  If true then the header was written in
+     *                          little-endian byte order.  By default SEG-Y
+     *                          is big-endian.
+     */
+    void setBinaryHeader(const char header[240],
+                         bool littleEndian = false) noexcept;
+    /*!
+     * @brief Packs the trace header to write to disk.
+     * @param[out] header       The 240-byte trace header.
+     * @param[in] littleEndian  If true then the header is packed in
+     *                          little-endian byte order.
+     */
+    void getBinaryHeader(char header[240],
+                         bool littleEndian = false) const noexcept;
+
+    /*! @name Header Fields
+     * @{
+     */
+    /*!
+     * @brief Sets a trace header field.
+     * @param[in] field  The field to set.
+     * @param[in] value  The value of the field.
+     * @throws std::invalid_argument if the value does not fit in the
+     *         field, e.g., a 2-byte field.
+     */
+    void setHeader(TraceHeaderField field, int value);
+    /*!
+     * @brief Gets a trace header field.
+     * @param[in] field  The field to get.
+     * @result The value of the field.
+     */
+    int getHeader(TraceHeaderField field) const noexcept;
+    /*! @} */
+
+    /*!
+     * @brief Gets the sampling period.
+     * @result The sampling period in seconds.
+     * @throws std::runtime_error if the sample interval is not set.
+     */
+    double getSamplingPeriod() const;
+    /*!
+     * @brief Gets the time of the first sample from the year, day of year,
+     *        hour, minute, and second fields and the delay recording time.
+     * @result The time of the first sample.
+     * @throws std::runtime_error if the year or day of year is not set.
+     */
+    Temblor::Utilities::Time getStartTime() const;
+private:
+    class TraceHeaderImpl;
+    std::unique_ptr<TraceHeaderImpl> pImpl;
+};
+
+}
+#endif
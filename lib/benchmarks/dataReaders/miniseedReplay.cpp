@@ -0,0 +1,219 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/packetIngest.hpp"
+
+/*
+ * Replays a miniSEED file through a pipe into a PacketIngest.  Each record
+ * is sent when its last sample would have been acquired, scaled by the
+ * speedup, while a reader thread continually takes snapshots of every
+ * SNCL.  The sustained ingest rate and the latency from writing a record
+ * to the pipe to its samples being available in a ring buffer are
+ * reported.
+ *
+ * Usage: benchmarkMiniSEEDReplay fileName [speedup] [repeats]
+ *
+ * A speedup of 0 sends the records as fast as possible.  The records are
+ * sent repeats times.
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+/// Gets the time in nanoseconds on the steady clock
+int64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+           (Clock::now().time_since_epoch()).count();
+}
+
+/// Gets the p'th percentile of sorted values
+double percentile(const std::vector<int64_t> &x, const double p)
+{
+    if (x.empty()){return 0;}
+    auto i = static_cast<size_t> (p/100*static_cast<double> (x.size() - 1));
+    return static_cast<double> (x[i]);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr,
+                "Usage: %s fileName [speedup] [repeats]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::string fileName = argv[1];
+    double speedup = 1;
+    if (argc > 2){speedup = std::max(0.0, std::atof(argv[2]));}
+    int nRepeats = 1;
+    if (argc > 3){nRepeats = std::max(1, std::atoi(argv[3]));}
+    // Order the records by the time their last sample is acquired
+    MiniSEED::RecordIndex index;
+    try
+    {
+        index.load(fileName);
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s", e.what());
+        return EXIT_FAILURE;
+    }
+    auto records = index.getRecords();
+    if (records.empty())
+    {
+        fprintf(stderr, "No records in %s\n", fileName.c_str());
+        return EXIT_FAILURE;
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const MiniSEED::IndexedRecord &lhs,
+                        const MiniSEED::IndexedRecord &rhs)
+                     {
+                         return lhs.endTime < rhs.endTime;
+                     });
+    // The stream carries fixed length records
+    auto recordLength = records.front().length;
+    auto nRecordsInFile = records.size();
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [=](const MiniSEED::IndexedRecord &record)
+                                 {
+                                     return record.length != recordLength;
+                                 }), records.end());
+    if (records.size() != nRecordsInFile)
+    {
+        fprintf(stderr, "Skipping %ld records that are not %d bytes\n",
+                static_cast<long> (nRecordsInFile - records.size()),
+                recordLength);
+    }
+    auto firstEndTime = records.front().endTime;
+    auto duration = records.back().endTime - firstEndTime;
+    std::ifstream file(fileName, std::ios::binary);
+    std::vector<char> buffer((std::istreambuf_iterator<char> (file)),
+                             std::istreambuf_iterator<char> ());
+    const char *data = buffer.data();
+    // Latencies are measured on the ingest thread.  The records arrive in
+    // the order they are sent so the k'th callback is the k'th record.
+    auto nRecords = records.size()*static_cast<size_t> (nRepeats);
+    std::vector<std::atomic<int64_t>> sendTimes(nRecords);
+    std::vector<int64_t> latencies(nRecords, 0);
+    size_t nReceived = 0;
+    MiniSEED::PacketIngest ingest;
+    ingest.setRecordCallback([&](const MiniSEED::SNCL &,
+                                 const MiniSEED::Segment &)
+                             {
+                                 if (nReceived >= nRecords){return;}
+                                 auto sent = sendTimes[nReceived].load(
+                                     std::memory_order_acquire);
+                                 latencies[nReceived] = now() - sent;
+                                 nReceived = nReceived + 1;
+                             });
+    int fd[2];
+    if (pipe(fd) != 0)
+    {
+        fprintf(stderr, "Failed to create pipe\n");
+        return EXIT_FAILURE;
+    }
+    ingest.start(fd[0], recordLength);
+    // Readers take snapshots while the records are ingested
+    std::atomic<bool> ldone{false};
+    std::atomic<int64_t> nSnapshots{0};
+    std::thread reader([&]()
+    {
+        while (!ldone.load())
+        {
+            for (const auto &sncl : ingest.getSNCLs())
+            {
+                try
+                {
+                    auto trace = ingest.getSnapshot(sncl);
+                    nSnapshots.fetch_add(1);
+                }
+                catch (const std::exception &e)
+                {
+                    fprintf(stderr, "%s", e.what());
+                }
+            }
+            std::this_thread::yield();
+        }
+    });
+    // Send the records
+    auto startTime = now();
+    size_t k = 0;
+    bool lfail = false;
+    for (int repeat=0; repeat<nRepeats && !lfail; ++repeat)
+    {
+        for (const auto &record : records)
+        {
+            if (speedup > 0)
+            {
+                auto dataTime = static_cast<double> (repeat*(duration + 1)
+                                + record.endTime - firstEndTime);
+                auto sendTime = startTime
+                              + static_cast<int64_t> (dataTime/speedup);
+                std::this_thread::sleep_for(
+                    std::chrono::nanoseconds(sendTime - now()));
+            }
+            sendTimes[k].store(now(), std::memory_order_release);
+            k = k + 1;
+            if (write(fd[1], data + record.offset, recordLength)
+                != recordLength)
+            {
+                fprintf(stderr, "Failed to write record\n");
+                lfail = true;
+                break;
+            }
+        }
+    }
+    close(fd[1]);
+    while (ingest.isRunning())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto endTime = now();
+    ldone = true;
+    reader.join();
+    ingest.stop();
+    close(fd[0]);
+    if (lfail){return EXIT_FAILURE;}
+    // Summarize
+    auto statistics = ingest.getStatistics();
+    latencies.resize(nReceived);
+    std::sort(latencies.begin(), latencies.end());
+    double elapsed = static_cast<double> (endTime - startTime)*1.e-9;
+    double meanLatency = 0;
+    for (const auto &latency : latencies)
+    {
+        meanLatency = meanLatency + static_cast<double> (latency);
+    }
+    if (!latencies.empty()){meanLatency = meanLatency/latencies.size();}
+    printf("File:               %s\n", fileName.c_str());
+    printf("Speedup:            %.1lf\n", speedup);
+    printf("Records:            %lu (%lu rejected)\n",
+           static_cast<unsigned long> (statistics.records),
+           static_cast<unsigned long> (statistics.rejected));
+    printf("Elapsed (s):        %.4lf\n", elapsed);
+    printf("Records per second: %.1lf\n", statistics.records/elapsed);
+    printf("Samples per second: %.1lf\n", statistics.samples/elapsed);
+    printf("Snapshots:          %ld\n", static_cast<long> (nSnapshots.load()));
+    printf("Latency (us):       mean %.2lf p50 %.2lf p99 %.2lf max %.2lf\n",
+           meanLatency*1.e-3, percentile(latencies, 50)*1.e-3,
+           percentile(latencies, 99)*1.e-3, percentile(latencies, 100)*1.e-3);
+    return EXIT_SUCCESS;
+}
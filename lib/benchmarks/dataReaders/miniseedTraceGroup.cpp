@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <libmseed.h>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/traceGroup.hpp"
+
+/*
+ * Compares indexing the file once with TraceGroup::read and decoding
+ * every trace with TraceGroup::getTrace to the legacy strategy of
+ * re-reading the file once per SNCL with Trace::read.  A synthetic,
+ * multiplexed file of 100 sps Steim2 data is generated for an increasing
+ * number of channels.
+ *
+ * Usage: benchmarkMiniSEEDTraceGroup [minutes of data per channel]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+void recordHandler(char *record, int reclen, void *handlerData)
+{
+    auto fl = static_cast<FILE *> (handlerData);
+    fwrite(record, sizeof(char), static_cast<size_t> (reclen), fl);
+}
+
+/// Writes nChannels of multiplexed data in one minute blocks
+void createSyntheticFile(const std::string &fileName,
+                         const int nChannels, const int nMinutes)
+{
+    constexpr double samplingRate = 100;
+    constexpr int nSamplesPerBlock = 6000;
+    constexpr nstime_t startTime = 1577836800LL*NSTMODULUS; // 2020-01-01
+    FILE *fl = fopen(fileName.c_str(), "wb");
+    std::vector<int> data(nSamplesPerBlock);
+    std::vector<MS3Record *> records(nChannels, nullptr);
+    for (int ic=0; ic<nChannels; ++ic)
+    {
+        records[ic] = msr3_init(nullptr);
+        auto station = "S" + std::to_string(ic);
+        char network[] = "XX";
+        char channel[] = "HHZ";
+        char location[] = "00";
+        ms_nslc2sid(records[ic]->sid, LM_SIDLEN, 0, network,
+                    station.data(), location, channel);
+        records[ic]->formatversion = 3;
+        records[ic]->reclen = 4096;
+        records[ic]->encoding = DE_STEIM2;
+        records[ic]->samprate = samplingRate;
+        records[ic]->sampletype = 'i';
+    }
+    for (int im=0; im<nMinutes; ++im)
+    {
+        for (int ic=0; ic<nChannels; ++ic)
+        {
+            for (int i=0; i<nSamplesPerBlock; ++i)
+            {
+                auto t = static_cast<double> (im*nSamplesPerBlock + i);
+                data[i] = static_cast<int>
+                          (1000*std::sin(0.01*t*(ic + 1)) + (i%7));
+            }
+            auto msr = records[ic];
+            msr->starttime = startTime
+                           + static_cast<nstime_t> (im)*60*NSTMODULUS;
+            msr->datasamples = data.data();
+            msr->numsamples = nSamplesPerBlock;
+            msr->samplecnt = nSamplesPerBlock;
+            int64_t packedSamples = 0;
+            msr3_pack(msr, recordHandler, fl, &packedSamples,
+                      MSF_FLUSHDATA, 0);
+            msr->datasamples = nullptr;
+        }
+    }
+    for (auto &msr : records){msr3_free(&msr);}
+    fclose(fl);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int nMinutes = 60;
+    if (argc > 1){nMinutes = std::max(1, std::atoi(argv[1]));}
+    std::string fileName = "benchmarkTraceGroup.mseed";
+#if TEMBLOR_USE_FILESYSTEM == 1
+    fileName = std::string((fs::temp_directory_path()/fileName).c_str());
+#endif
+    printf("%10s %14s %16s %16s %10s\n",
+           "nChannels", "fileSize (MB)", "singlePass (s)", "perSNCL (s)",
+           "speedup");
+    for (auto nChannels : {1, 10, 25, 50, 100})
+    {
+        createSyntheticFile(fileName, nChannels, nMinutes);
+        FILE *fl = fopen(fileName.c_str(), "rb");
+        fseek(fl, 0, SEEK_END);
+        auto fileSize = static_cast<double> (ftell(fl));
+        fclose(fl);
+        // New strategy
+        auto t0 = std::chrono::high_resolution_clock::now();
+        MiniSEED::TraceGroup traceGroup;
+        traceGroup.read(fileName);
+        for (const auto &sncl : traceGroup.getSNCLs())
+        {
+            traceGroup.getTrace(sncl);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> singlePass = t1 - t0;
+        // Legacy strategy
+        auto sncls = traceGroup.getSNCLs();
+        t0 = std::chrono::high_resolution_clock::now();
+        for (const auto &sncl : sncls)
+        {
+            MiniSEED::Trace trace;
+            trace.read(fileName, sncl);
+        }
+        t1 = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> perSNCL = t1 - t0;
+        printf("%10d %14.2lf %16.4lf %16.4lf %10.2lf\n",
+               nChannels, fileSize/1024./1024.,
+               singlePass.count(), perSNCL.count(),
+               perSNCL.count()/std::max(1.e-12, singlePass.count()));
+    }
+    std::remove(fileName.c_str());
+    return EXIT_SUCCESS;
+}
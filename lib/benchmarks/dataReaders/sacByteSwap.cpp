@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/alignedBuffer.hpp"
+#include "temblor/private/byteSwap.hpp"
+#include "temblor/private/sampleConversion.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/sac/enums.hpp"
+#include "temblor/seismicDataIO/sac/waveform.hpp"
+
+/*
+ * Compares reading and writing SAC files in the machine's byte order to
+ * reading and writing byte swapped (big-endian) SAC files.  The kernels
+ * are first timed on memory resident samples and compared to the scalar
+ * loop they replace.  Then a synthetic waveform is written and read in
+ * both byte orders and at both in-memory precisions.  The best of three
+ * repetitions is reported.
+ *
+ * Usage: benchmarkSACByteSwap [number of samples]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+using Clock = std::chrono::high_resolution_clock;
+constexpr int N_REPEATS = 3;
+
+/// Times the best of N_REPEATS calls of f
+template<typename F>
+double bestOf(F &&f)
+{
+    double best = 0;
+    for (int k=0; k<N_REPEATS; ++k)
+    {
+        auto t0 = Clock::now();
+        f();
+        std::chrono::duration<double> elapsed = Clock::now() - t0;
+        if (k == 0 || elapsed.count() < best){best = elapsed.count();}
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int nSamples = 100000000;
+    if (argc > 1){nSamples = std::max(1, std::atoi(argv[1]));}
+    auto nBytes = 4*static_cast<double> (nSamples);
+    auto gigabytes = nBytes/1024./1024./1024.;
+    // Kernels on memory resident samples
+    Temblor::Private::AlignedBuffer packed, floats, doubles;
+    packed.allocate(4*static_cast<size_t> (nSamples));
+    floats.allocate(sizeof(float)*static_cast<size_t> (nSamples));
+    doubles.allocate(sizeof(double)*static_cast<size_t> (nSamples));
+    auto x = doubles.data<double> ();
+    for (int i=0; i<nSamples; ++i){x[i] = 1000*std::sin(0.001*i);}
+    auto y = floats.data<float> ();
+    auto c = packed.data<char> ();
+    Temblor::Private::convertSamples<double, float>(nSamples, x, y);
+    printf("%-32s %12s %12s\n", "Kernel (memory resident)", "time (s)",
+           "GB/s");
+    auto report = [&](const char *name, const double seconds)
+    {
+        printf("%-32s %12.4lf %12.2lf\n", name, seconds,
+               gigabytes/std::max(1.e-12, seconds));
+    };
+    report("native float -> double", bestOf([&]()
+    {
+        Temblor::Private::convertSamples(nSamples, y, x);
+    }));
+    report("swapped float -> double scalar", bestOf([&]()
+    {
+        Temblor::Private::unpackSwapped32<double>(nSamples, c, x);
+    }));
+    report("swapped float -> double", bestOf([&]()
+    {
+        Temblor::Private::unpackSwapped32(nSamples, c, x);
+    }));
+    report("swapped float -> float", bestOf([&]()
+    {
+        Temblor::Private::unpackSwapped32(nSamples, c, y);
+    }));
+    report("double -> swapped float scalar", bestOf([&]()
+    {
+        Temblor::Private::packSwapped32<double>(nSamples, x, c);
+    }));
+    report("double -> swapped float", bestOf([&]()
+    {
+        Temblor::Private::packSwapped32(nSamples, x, c);
+    }));
+    packed.clear();
+    floats.clear();
+    // Files
+    SAC::Waveform waveform;
+    waveform.setHeader(SAC::Double::DELTA, 0.01);
+    waveform.setStartTime(Temblor::Utilities::Time(1577836800));
+    waveform.setData(nSamples, x);
+    doubles.clear();
+    std::string nativeFile = "benchmarkNative.sac";
+    std::string swappedFile = "benchmarkSwapped.sac";
+#if TEMBLOR_USE_FILESYSTEM == 1
+    nativeFile = std::string((fs::temp_directory_path()/nativeFile).c_str());
+    swappedFile
+        = std::string((fs::temp_directory_path()/swappedFile).c_str());
+#endif
+    printf("\n%-10s %-10s %12s %12s %12s\n", "precision", "byteOrder",
+           "write (s)", "read (s)", "read GB/s");
+    for (const auto precision : {SAC::Precision::FLOAT64,
+                                 SAC::Precision::FLOAT32})
+    {
+        waveform.setPrecision(precision);
+        auto precisionName = precision == SAC::Precision::FLOAT64 ?
+                             "float64" : "float32";
+        for (const auto lswap : {false, true})
+        {
+            const auto &fileName = lswap ? swappedFile : nativeFile;
+            auto writeTime = bestOf([&]()
+            {
+                waveform.write(fileName, lswap);
+            });
+            SAC::Waveform waveformRead;
+            waveformRead.setPrecision(precision);
+            auto readTime = bestOf([&]()
+            {
+                waveformRead.read(fileName);
+            });
+            printf("%-10s %-10s %12.4lf %12.4lf %12.2lf\n",
+                   precisionName, lswap ? "swapped" : "native",
+                   writeTime, readTime,
+                   gigabytes/std::max(1.e-12, readTime));
+        }
+    }
+    std::remove(nativeFile.c_str());
+    std::remove(swappedFile.c_str());
+    return EXIT_SUCCESS;
+}
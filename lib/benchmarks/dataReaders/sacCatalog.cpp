@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/sac/enums.hpp"
+#include "temblor/seismicDataIO/sac/waveform.hpp"
+#include "temblor/seismicDataIO/sac/catalog.hpp"
+
+/*
+ * Catalogs a synthetic archive of small SAC files.  The files are written
+ * to a scratch directory with 1000 files per subdirectory.  The archive is
+ * then scanned with increasing numbers of threads and the scan rate is
+ * reported.  The first scan also warms the page cache.
+ *
+ * Usage: benchmarkSACCatalog [number of files]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+using Clock = std::chrono::high_resolution_clock;
+constexpr int N_FILES_PER_DIRECTORY = 1000;
+}
+
+int main(int argc, char *argv[])
+{
+#if TEMBLOR_USE_FILESYSTEM == 1
+    int nFiles = 1000000;
+    if (argc > 1){nFiles = std::max(1, std::atoi(argv[1]));}
+    auto directory = fs::temp_directory_path()/"benchmarkSACCatalog";
+    fs::remove_all(directory);
+    // Make the archive
+    std::vector<double> x(100);
+    for (int i=0; i<static_cast<int> (x.size()); ++i){x[i] = i;}
+    SAC::Waveform waveform;
+    waveform.setHeader(SAC::Double::DELTA, 0.01);
+    waveform.setHeader(SAC::Character::KNETWK, "UU");
+    waveform.setHeader(SAC::Character::KCMPNM, "HHZ");
+    waveform.setHeader(SAC::Character::KHOLE, "01");
+    waveform.setData(static_cast<int> (x.size()), x.data());
+    auto t0 = Clock::now();
+    for (int ifile=0; ifile<nFiles; ++ifile)
+    {
+        auto subDirectory = directory
+            / std::to_string(ifile/N_FILES_PER_DIRECTORY);
+        if (ifile%N_FILES_PER_DIRECTORY == 0)
+        {
+            fs::create_directories(subDirectory);
+        }
+        waveform.setHeader(SAC::Character::KSTNM,
+                           "S" + std::to_string(ifile%5000));
+        waveform.setStartTime(Temblor::Utilities::Time(1577836800 + ifile));
+        auto fileName = subDirectory/(std::to_string(ifile) + ".sac");
+        waveform.write(fileName.string());
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - t0;
+    printf("Wrote %d files in %.2lf s\n\n", nFiles, elapsed.count());
+    // Scan it
+    printf("%-10s %12s %12s\n", "threads", "scan (s)", "files/s");
+    int maxThreads
+        = std::max(1, static_cast<int> (std::thread::hardware_concurrency()));
+    std::vector<int> nThreads{1};
+    while (nThreads.back()*2 <= maxThreads)
+    {
+        nThreads.push_back(nThreads.back()*2);
+    }
+    if (nThreads.back() != maxThreads){nThreads.push_back(maxThreads);}
+    SAC::Catalog catalog;
+    catalog.scan(directory.string());
+    for (const auto &n : nThreads)
+    {
+        catalog.setNumberOfThreads(n);
+        t0 = Clock::now();
+        catalog.scan(directory.string());
+        elapsed = Clock::now() - t0;
+        printf("%-10d %12.4lf %12.0lf\n", n, elapsed.count(),
+               catalog.getNumberOfRows()/std::max(1.e-12, elapsed.count()));
+        if (catalog.getNumberOfRows() != nFiles)
+        {
+            fprintf(stderr, "%s: Cataloged %d of %d files\n", __func__,
+                    catalog.getNumberOfRows(), nFiles);
+        }
+    }
+    // Filter and sort
+    t0 = Clock::now();
+    catalog.filter([](const SAC::Catalog &c, const int row)
+    {
+        return c.getStations()[row] < "S2500";
+    });
+    catalog.sort(SAC::CatalogColumn::SNCL);
+    catalog.sort(SAC::CatalogColumn::START_TIME);
+    elapsed = Clock::now() - t0;
+    printf("\nFiltered to %d rows and sorted in %.4lf s\n",
+           catalog.getNumberOfRows(), elapsed.count());
+    fs::remove_all(directory);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr, "%s: Filesystem library required\n", argv[0]);
+    return EXIT_FAILURE;
+#endif
+}
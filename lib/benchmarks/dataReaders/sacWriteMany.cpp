@@ -0,0 +1,86 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/sac/enums.hpp"
+#include "temblor/seismicDataIO/sac/waveform.hpp"
+
+/*
+ * Exports a synthetic event gather as one SAC file per trace.  The gather
+ * is written with increasing numbers of threads in both byte orders and
+ * the export rate is reported.
+ *
+ * Usage: benchmarkSACWriteMany [number of traces] [number of samples]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+using Clock = std::chrono::high_resolution_clock;
+}
+
+int main(int argc, char *argv[])
+{
+#if TEMBLOR_USE_FILESYSTEM == 1
+    int nTraces = 50000;
+    int nSamples = 6000;
+    if (argc > 1){nTraces = std::max(1, std::atoi(argv[1]));}
+    if (argc > 2){nSamples = std::max(1, std::atoi(argv[2]));}
+    auto directory = fs::temp_directory_path()/"benchmarkSACWriteMany";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    // Make the gather
+    std::vector<double> x(nSamples);
+    for (int i=0; i<nSamples; ++i){x[i] = 1000*std::sin(0.01*i);}
+    std::vector<SAC::Waveform> waveforms(nTraces);
+    std::vector<std::string> fileNames(nTraces);
+    for (int i=0; i<nTraces; ++i)
+    {
+        auto station = "S" + std::to_string(i);
+        waveforms[i].setHeader(SAC::Double::DELTA, 0.01);
+        waveforms[i].setHeader(SAC::Character::KNETWK, "UU");
+        waveforms[i].setHeader(SAC::Character::KSTNM, station);
+        waveforms[i].setHeader(SAC::Character::KCMPNM, "HHZ");
+        waveforms[i].setStartTime(Temblor::Utilities::Time(1577836800));
+        waveforms[i].setData(nSamples, x.data());
+        fileNames[i] = (directory/(station + ".sac")).string();
+    }
+    auto gigabytes = (632 + 4*static_cast<double> (nSamples))*nTraces
+                    /1024./1024./1024.;
+    printf("%-10s %-10s %12s %12s %12s\n", "threads", "byteOrder",
+           "write (s)", "traces/s", "GB/s");
+    int maxThreads
+        = std::max(1, static_cast<int> (std::thread::hardware_concurrency()));
+    std::vector<int> nThreads{1};
+    while (nThreads.back()*2 <= maxThreads)
+    {
+        nThreads.push_back(nThreads.back()*2);
+    }
+    if (nThreads.back() != maxThreads){nThreads.push_back(maxThreads);}
+    for (const auto lswap : {false, true})
+    {
+        for (const auto &n : nThreads)
+        {
+            auto t0 = Clock::now();
+            SAC::Waveform::writeMany(waveforms, fileNames, lswap, n);
+            std::chrono::duration<double> elapsed = Clock::now() - t0;
+            auto seconds = std::max(1.e-12, elapsed.count());
+            printf("%-10d %-10s %12.4lf %12.0lf %12.2lf\n", n,
+                   lswap ? "swapped" : "native", elapsed.count(),
+                   nTraces/seconds, gigabytes/seconds);
+        }
+    }
+    fs::remove_all(directory);
+    return EXIT_SUCCESS;
+#else
+    fprintf(stderr, "%s: Filesystem library required\n", argv[0]);
+    return EXIT_FAILURE;
+#endif
+}
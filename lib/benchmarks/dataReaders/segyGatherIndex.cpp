@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/seismicDataIO/segy/gatherIndex.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+
+/*
+ * Measures the cost of regrouping a shot ordered SEG-Y file into receiver
+ * gathers.  A synthetic nodal survey is written, its trace headers are
+ * indexed, the index is sorted by receiver and offset with a small memory
+ * budget so that the external merge sort spills to disk, and every
+ * receiver gather is read.
+ *
+ * Usage: benchmarkSEGYGatherIndex [number of shots] [memory in MB]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+using Clock = std::chrono::high_resolution_clock;
+constexpr int N_RECEIVERS = 1000;
+constexpr int N_SAMPLES_PER_TRACE = 500;
+
+/// Times a function call
+template<typename F>
+double timeIt(F &&f)
+{
+    auto t0 = Clock::now();
+    f();
+    std::chrono::duration<double> elapsed = Clock::now() - t0;
+    return elapsed.count();
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int nShots = 200;
+    size_t memory = 4;
+    if (argc > 1){nShots = std::max(1, std::atoi(argv[1]));}
+    if (argc > 2){memory = std::max(1, std::atoi(argv[2]));}
+    std::string segyFileName = "benchmarkGatherIndex.sgy";
+    std::string indexFileName = "benchmarkGatherIndex.idx";
+#if TEMBLOR_USE_FILESYSTEM == 1
+    auto temporaryDirectory = fs::temp_directory_path();
+    segyFileName = std::string((temporaryDirectory/segyFileName).c_str());
+    indexFileName = std::string((temporaryDirectory/indexFileName).c_str());
+#endif
+    // Write the shot gathers
+    SEGY::BinaryFileHeader binaryHeader(2, 0);
+    binaryHeader.setSampleInterval(4000);
+    binaryHeader.setNumberOfSamplesPerTrace(N_SAMPLES_PER_TRACE);
+    binaryHeader.setDataFormat(SEGY::DataFormat::IEEE_FLOAT);
+    binaryHeader.setTraceSortingCode(SEGY::TraceSortingCode::AS_REOCORDED);
+    std::vector<char> headers(3600, ' ');
+    binaryHeader.getBinaryHeader(headers.data() + 3200);
+    std::vector<char> samples(4*N_SAMPLES_PER_TRACE, 0);
+    std::ofstream segyFile(segyFileName, std::ios::binary);
+    segyFile.write(headers.data(), headers.size());
+    SEGY::TraceHeader traceHeader;
+    traceHeader.setHeader(SEGY::TraceHeaderField::NUMBER_OF_SAMPLES,
+                          N_SAMPLES_PER_TRACE);
+    char cheader[240];
+    for (int shot=0; shot<nShots; ++shot)
+    {
+        traceHeader.setHeader(SEGY::TraceHeaderField::FIELD_RECORD_NUMBER,
+                              shot + 1);
+        for (int receiver=0; receiver<N_RECEIVERS; ++receiver)
+        {
+            traceHeader.setHeader(
+                SEGY::TraceHeaderField::TRACE_NUMBER_IN_FIELD_RECORD,
+                receiver + 1);
+            traceHeader.setHeader(SEGY::TraceHeaderField::GROUP_X,
+                                  25*receiver);
+            traceHeader.setHeader(
+                SEGY::TraceHeaderField::SOURCE_RECEIVER_OFFSET,
+                std::abs(25*receiver - 125*shot));
+            traceHeader.getBinaryHeader(cheader);
+            segyFile.write(cheader, 240);
+            segyFile.write(samples.data(), samples.size());
+        }
+    }
+    segyFile.close();
+    auto nTraces = nShots*N_RECEIVERS;
+    printf("Traces: %d, memory: %zu MB\n", nTraces, memory);
+    printf("%-32s %12s %12s\n", "Operation", "time (s)", "traces/s");
+    auto report = [&](const char *name, const double seconds)
+    {
+        printf("%-32s %12.4lf %12.0lf\n", name, seconds,
+               nTraces/std::max(1.e-12, seconds));
+    };
+    SEGY::GatherIndex index;
+    index.setMaximumMemory(memory*1024*1024);
+    report("build index", timeIt([&]()
+    {
+        index.build(segyFileName,
+                    {SEGY::TraceHeaderField::FIELD_RECORD_NUMBER,
+                     SEGY::TraceHeaderField::GROUP_X,
+                     SEGY::TraceHeaderField::SOURCE_RECEIVER_OFFSET},
+                    indexFileName);
+    }));
+    report("verify native shot order", timeIt([&]()
+    {
+        index.sort({SEGY::TraceHeaderField::FIELD_RECORD_NUMBER});
+    }));
+    report("sort by receiver and offset", timeIt([&]()
+    {
+        index.sort({SEGY::TraceHeaderField::GROUP_X,
+                    SEGY::TraceHeaderField::SOURCE_RECEIVER_OFFSET});
+    }));
+    std::vector<SEGY::TraceHeader> gatherHeaders;
+    std::vector<std::vector<float>> traces;
+    report("read receiver gathers", timeIt([&]()
+    {
+        for (int receiver=0; receiver<N_RECEIVERS; ++receiver)
+        {
+            index.readGather({25*receiver}, &gatherHeaders, &traces);
+        }
+    }));
+    std::remove(segyFileName.c_str());
+    std::remove(indexFileName.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/alignedBuffer.hpp"
+#include "temblor/private/ibmFloat.hpp"
+#include "temblor/seismicDataIO/segy/segy2.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+
+/*
+ * Measures the throughput of converting big-endian IBM floats, i.e., SEG-Y
+ * data format 1, to and from IEEE floats.  The vector kernels are first
+ * timed on memory resident samples and compared to the scalar loop.  Then
+ * a synthetic SEG-Y file is written and every trace is decoded.  The best
+ * of three repetitions is reported.
+ *
+ * Usage: benchmarkSEGYIBMFloat [number of samples]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+using Clock = std::chrono::high_resolution_clock;
+constexpr int N_REPEATS = 3;
+constexpr int N_SAMPLES_PER_TRACE = 4000;
+
+/// Times the best of N_REPEATS calls of f
+template<typename F>
+double bestOf(F &&f)
+{
+    double best = 0;
+    for (int k=0; k<N_REPEATS; ++k)
+    {
+        auto t0 = Clock::now();
+        f();
+        std::chrono::duration<double> elapsed = Clock::now() - t0;
+        if (k == 0 || elapsed.count() < best){best = elapsed.count();}
+    }
+    return best;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int nSamples = 100000000;
+    if (argc > 1){nSamples = std::max(1, std::atoi(argv[1]));}
+    auto nTraces = std::max(1, nSamples/N_SAMPLES_PER_TRACE);
+    nSamples = nTraces*N_SAMPLES_PER_TRACE;
+    auto gigabytes = 4*static_cast<double> (nSamples)/1024./1024./1024.;
+    constexpr bool lswap = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+    // Kernels on memory resident samples
+    Temblor::Private::AlignedBuffer packed, floats, doubles;
+    packed.allocate(4*static_cast<size_t> (nSamples));
+    floats.allocate(sizeof(float)*static_cast<size_t> (nSamples));
+    doubles.allocate(sizeof(double)*static_cast<size_t> (nSamples));
+    auto x = doubles.data<double> ();
+    for (int i=0; i<nSamples; ++i){x[i] = 1000*std::sin(0.001*i);}
+    auto y = floats.data<float> ();
+    auto c = packed.data<char> ();
+    Temblor::Private::packIBM32<double>(nSamples, x, c, lswap);
+    printf("%-32s %12s %12s\n", "Kernel (memory resident)", "time (s)",
+           "GB/s");
+    auto report = [&](const char *name, const double seconds)
+    {
+        printf("%-32s %12.4lf %12.2lf\n", name, seconds,
+               gigabytes/std::max(1.e-12, seconds));
+    };
+    report("IBM -> float scalar", bestOf([&]()
+    {
+        Temblor::Private::unpackIBM32<float>(nSamples, c, y, lswap);
+    }));
+    report("IBM -> float", bestOf([&]()
+    {
+        Temblor::Private::unpackIBM32(nSamples, c, y, lswap);
+    }));
+    report("IBM -> double scalar", bestOf([&]()
+    {
+        Temblor::Private::unpackIBM32<double>(nSamples, c, x, lswap);
+    }));
+    report("IBM -> double", bestOf([&]()
+    {
+        Temblor::Private::unpackIBM32(nSamples, c, x, lswap);
+    }));
+    report("float -> IBM scalar", bestOf([&]()
+    {
+        Temblor::Private::packIBM32<float>(nSamples, y, c, lswap);
+    }));
+    report("float -> IBM", bestOf([&]()
+    {
+        Temblor::Private::packIBM32(nSamples, y, c, lswap);
+    }));
+    report("double -> IBM scalar", bestOf([&]()
+    {
+        Temblor::Private::packIBM32<double>(nSamples, x, c, lswap);
+    }));
+    report("double -> IBM", bestOf([&]()
+    {
+        Temblor::Private::packIBM32(nSamples, x, c, lswap);
+    }));
+    // Make a SEG-Y file of fixed length IBM traces
+    std::string fileName = "benchmarkIBMFloat.sgy";
+#if TEMBLOR_USE_FILESYSTEM == 1
+    fileName = std::string((fs::temp_directory_path()/fileName).c_str());
+#endif
+    SEGY::BinaryFileHeader binaryHeader(0, 0);
+    binaryHeader.setSampleInterval(2000);
+    binaryHeader.setNumberOfSamplesPerTrace(N_SAMPLES_PER_TRACE);
+    binaryHeader.setDataFormat(SEGY::DataFormat::IBM_FLOAT);
+    std::vector<char> headers(3600, 0x40); // EBCDIC blanks
+    binaryHeader.getBinaryHeader(headers.data() + 3200);
+    std::vector<char> traceHeader(240, 0);
+    std::ofstream segyFile(fileName, std::ios::binary);
+    segyFile.write(headers.data(), headers.size());
+    for (int i=0; i<nTraces; ++i)
+    {
+        segyFile.write(traceHeader.data(), traceHeader.size());
+        segyFile.write(c + 4*static_cast<size_t> (i)*N_SAMPLES_PER_TRACE,
+                       4*N_SAMPLES_PER_TRACE);
+    }
+    segyFile.close();
+    packed.clear();
+    // Decode every trace
+    SEGY::Segy2 segy2;
+    segy2.read(fileName);
+    printf("\n%-32s %12s %12s\n", "SEG-Y file", "time (s)", "GB/s");
+    report("map and index", bestOf([&]()
+    {
+        segy2.read(fileName);
+    }));
+    report("decode traces to float", bestOf([&]()
+    {
+        for (int i=0; i<segy2.getNumberOfTraces(); ++i)
+        {
+            auto yi = y + static_cast<size_t> (i)*N_SAMPLES_PER_TRACE;
+            segy2.getTrace(i, N_SAMPLES_PER_TRACE, &yi);
+        }
+    }));
+    report("decode traces to double", bestOf([&]()
+    {
+        for (int i=0; i<segy2.getNumberOfTraces(); ++i)
+        {
+            auto xi = x + static_cast<size_t> (i)*N_SAMPLES_PER_TRACE;
+            segy2.getTrace(i, N_SAMPLES_PER_TRACE, &xi);
+        }
+    }));
+    std::remove(fileName.c_str());
+    return EXIT_SUCCESS;
+}
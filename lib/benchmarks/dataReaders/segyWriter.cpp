@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <thread>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/seismicDataIO/segy/segy2Writer.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+
+/*
+ * Exports a synthetic record section as a single SEG-Y file.  The traces
+ * are handed to the writer in batches and packed with increasing numbers
+ * of threads in each data format.  The export rate is reported.
+ *
+ * Usage: benchmarkSEGYWriter [number of traces] [number of samples]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+using Clock = std::chrono::high_resolution_clock;
+constexpr int BATCH_SIZE = 4096;
+}
+
+int main(int argc, char *argv[])
+{
+    int nTraces = 200000;
+    int nSamples = 1500;
+    if (argc > 1){nTraces = std::max(1, std::atoi(argv[1]));}
+    if (argc > 2){nSamples = std::min(65535, std::max(1, std::atoi(argv[2])));}
+    std::string fileName = "benchmarkSEGYWriter.sgy";
+#if TEMBLOR_USE_FILESYSTEM == 1
+    fileName = std::string((fs::temp_directory_path()/fileName).c_str());
+#endif
+    // Make a batch of traces that is written repeatedly
+    auto nBatch = std::min(nTraces, BATCH_SIZE);
+    std::vector<SEGY::TraceHeader> headers(nBatch);
+    std::vector<std::vector<float>> traces(nBatch);
+    for (int i=0; i<nBatch; ++i)
+    {
+        headers[i].setHeader(SEGY::TraceHeaderField::GROUP_X, 25*i);
+        traces[i].resize(nSamples);
+        for (int j=0; j<nSamples; ++j)
+        {
+            traces[i][j] = static_cast<float> (1000*std::sin(0.01*(i + j)));
+        }
+    }
+    // The last batch may be partial
+    auto nTail = nTraces%nBatch;
+    std::vector<SEGY::TraceHeader> tailHeaders(headers.begin(),
+                                               headers.begin() + nTail);
+    std::vector<std::vector<float>> tailTraces(traces.begin(),
+                                               traces.begin() + nTail);
+    int maxThreads
+        = std::max(1, static_cast<int> (std::thread::hardware_concurrency()));
+    std::vector<int> nThreads{1};
+    while (nThreads.back()*2 <= maxThreads)
+    {
+        nThreads.push_back(nThreads.back()*2);
+    }
+    if (nThreads.back() != maxThreads){nThreads.push_back(maxThreads);}
+    printf("%-10s %-12s %12s %12s %12s\n", "threads", "format",
+           "write (s)", "traces/s", "GB/s");
+    for (const auto format : {SEGY::DataFormat::IBM_FLOAT,
+                              SEGY::DataFormat::IEEE_FLOAT,
+                              SEGY::DataFormat::IEEE_DOUBLE})
+    {
+        SEGY::BinaryFileHeader binaryHeader(2, 0);
+        binaryHeader.setSampleInterval(2000);
+        binaryHeader.setNumberOfSamplesPerTrace(nSamples);
+        binaryHeader.setDataFormat(format);
+        binaryHeader.setFixedLengthTraces(true);
+        auto bytesPerSample = (format == SEGY::DataFormat::IEEE_DOUBLE) ? 8 : 4;
+        auto gigabytes = (240 + bytesPerSample*static_cast<double> (nSamples))
+                        *nTraces/1024./1024./1024.;
+        for (const auto &n : nThreads)
+        {
+            auto t0 = Clock::now();
+            SEGY::Segy2Writer writer;
+            writer.setNumberOfThreads(n);
+            writer.open(fileName, binaryHeader);
+            for (int i=0; i<nTraces/nBatch; ++i)
+            {
+                writer.write(headers, traces);
+            }
+            if (nTail > 0){writer.write(tailHeaders, tailTraces);}
+            writer.close();
+            std::chrono::duration<double> elapsed = Clock::now() - t0;
+            auto seconds = std::max(1.e-12, elapsed.count());
+            printf("%-10d %-12s %12.4lf %12.0lf %12.2lf\n", n,
+                   format == SEGY::DataFormat::IBM_FLOAT ? "IBM float" :
+                   format == SEGY::DataFormat::IEEE_FLOAT ? "IEEE float" :
+                   "IEEE double",
+                   elapsed.count(), nTraces/seconds, gigabytes/seconds);
+        }
+    }
+    std::remove(fileName.c_str());
+    return EXIT_SUCCESS;
+}
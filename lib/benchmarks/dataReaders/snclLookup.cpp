@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/traceGroup.hpp"
+
+/*
+ * Compares looking up SNCLs with a linear search to the hashed lookup used
+ * by TraceGroup.  Every SNCL of a network-wide day file is looked up once,
+ * which is the access pattern of deduplicating SNCLs while reading.
+ *
+ * Usage: benchmarkSNCLLookup [number of SNCLs]
+ */
+
+using namespace Temblor::SeismicDataIO;
+
+namespace
+{
+
+/// Makes nSNCLs distinct SNCLs spread over networks and stations
+std::vector<MiniSEED::SNCL> makeSNCLs(const int nSNCLs)
+{
+    std::vector<MiniSEED::SNCL> sncls;
+    sncls.reserve(nSNCLs);
+    const std::vector<std::string> channels = {"HHZ", "HHN", "HHE"};
+    for (int i=0; i<nSNCLs; ++i)
+    {
+        MiniSEED::SNCL sncl;
+        sncl.setNetwork("N" + std::to_string(i/3000));
+        sncl.setStation("S" + std::to_string((i/3)%1000));
+        sncl.setChannel(channels[i%3]);
+        sncl.setLocationCode("00");
+        sncls.push_back(sncl);
+    }
+    return sncls;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int nSNCLs = 10000;
+    if (argc > 1){nSNCLs = std::max(1, std::atoi(argv[1]));}
+    auto sncls = makeSNCLs(nSNCLs);
+    auto queries = sncls;
+    std::reverse(queries.begin(), queries.end());
+    // Linear search
+    auto t0 = std::chrono::high_resolution_clock::now();
+    size_t nFound = 0;
+    for (const auto &query : queries)
+    {
+        auto idx = std::find(sncls.begin(), sncls.end(), query);
+        if (idx != sncls.end()){nFound = nFound + 1;}
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> linear = t1 - t0;
+    // Hashed search
+    std::unordered_map<MiniSEED::SNCL, int> snclIndex;
+    t0 = std::chrono::high_resolution_clock::now();
+    snclIndex.reserve(sncls.size());
+    for (int i=0; i<static_cast<int> (sncls.size()); ++i)
+    {
+        snclIndex.emplace(sncls[i], i);
+    }
+    for (const auto &query : queries)
+    {
+        if (snclIndex.find(query) != snclIndex.end()){nFound = nFound + 1;}
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> hashed = t1 - t0;
+    // Trace group
+    MiniSEED::TraceGroup traceGroup;
+    MiniSEED::Trace trace;
+    trace.setSamplingRate(100);
+    std::vector<int> x(1, 0);
+    trace.setData(x.size(), x.data());
+    for (const auto &sncl : sncls)
+    {
+        trace.setSNCL(sncl);
+        traceGroup.setTrace(trace);
+    }
+    t0 = std::chrono::high_resolution_clock::now();
+    for (const auto &query : queries)
+    {
+        if (traceGroup.haveSNCL(query)){nFound = nFound + 1;}
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> group = t1 - t0;
+    if (nFound != 3*sncls.size())
+    {
+        fprintf(stderr, "Failed to find all SNCLs\n");
+        return EXIT_FAILURE;
+    }
+    auto nQueries = static_cast<double> (queries.size());
+    printf("%10s %16s %16s %16s\n",
+           "nSNCLs", "linear (us)", "hashed (us)", "haveSNCL (us)");
+    printf("%10d %16.4lf %16.4lf %16.4lf\n", nSNCLs,
+           linear.count()/nQueries*1.e6,
+           hashed.count()/nQueries*1.e6,
+           group.count()/nQueries*1.e6);
+    return EXIT_SUCCESS;
+}
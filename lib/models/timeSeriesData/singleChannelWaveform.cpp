@@ -3,6 +3,7 @@
 #include <string>
 #include <algorithm>
 #include <vector>
+#include "temblor/private/alignedBuffer.hpp"
 #include "temblor/models/timeSeriesData/waveformIdentifier.hpp"
 #include "temblor/models/timeSeriesData/singleChannelWaveform.hpp"
 #include "temblor/utilities/time.hpp"
@@ -33,7 +34,7 @@ public:
     /// The channel start time
     Time mStartTime;
     /// Container with the waveform data
-    std::vector<double> mData;
+    Temblor::Private::AlignedBuffer mData;
     /// The sampling period
     double mSamplingRate = 0;
     /// Number of samples in waveform
@@ -191,7 +192,11 @@ void SingleChannelWaveform::readSAC(const std::string &fileName)
         throw std::runtime_error("Sampling period in header is invalid\n"); 
     }
     setSamplingRate(1./dt);
-    pImpl->mData = sac.getData();
+    auto npts = sac.getNumberOfSamples();
+    pImpl->mData.allocate(sizeof(double)*static_cast<size_t> (npts));
+    auto data = pImpl->mData.data<double> ();
+    sac.getData(npts, &data);
+    pImpl->mNumberOfSamples = npts;
 }
 
 /*
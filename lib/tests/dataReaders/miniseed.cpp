@@ -2,13 +2,29 @@
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <unistd.h>
+#include <libmseed.h>
+#include "temblor/private/filesystem.hpp"
 #include "temblor/utilities/time.hpp"
-#include "temblor/dataReaders/miniseed/sncl.hpp"
-#include "temblor/dataReaders/miniseed/trace.hpp"
-#include "temblor/dataReaders/miniseed/enums.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/traceGroup.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/archiveIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/recordMerger.hpp"
+#include "temblor/seismicDataIO/miniseed/ringBuffer.hpp"
+#include "temblor/seismicDataIO/miniseed/packetIngest.hpp"
+#include "temblor/seismicDataIO/miniseed/steim.hpp"
+#include "temblor/seismicDataIO/miniseed/enums.hpp"
 #include <gtest/gtest.h>
 
 namespace
@@ -16,8 +32,9 @@ namespace
 
 std::vector<int>
 loadIntegerData(const std::string &textFileName, const int npts);
+std::vector<uint8_t> encodeSteim(int version, const std::vector<int> &x);
 
-using namespace Temblor::DataReaders;
+using namespace Temblor::SeismicDataIO;
 
 TEST(LibraryDataReadersMiniSEED, SNCL)
 {
@@ -63,6 +80,19 @@ TEST(LibraryDataReadersMiniSEED, SNCL)
     ASSERT_STREQ(sncl.getStation().c_str(), "1234567891");
     ASSERT_STREQ(sncl.getChannel().c_str(), "1234567891");
     ASSERT_STREQ(sncl.getLocationCode().c_str(), "1234567891");
+    // Hashing
+    std::hash<MiniSEED::SNCL> hasher;
+    MiniSEED::SNCL snclCopy2(snclCopy);
+    EXPECT_EQ(hasher(snclCopy), hasher(snclCopy2));
+    EXPECT_NE(hasher(snclCopy), hasher(sncl));
+    snclCopy2.setStation("DU");
+    snclCopy2.setChannel("GHHZ");
+    EXPECT_NE(hasher(snclCopy), hasher(snclCopy2));
+    std::unordered_map<MiniSEED::SNCL, int> snclMap;
+    snclMap.emplace(sncl, 1);
+    snclMap.emplace(snclCopy, 2);
+    EXPECT_EQ(snclMap.at(snclCopy), 2);
+    EXPECT_EQ(snclMap.count(snclCopy2), 0);
 }
 
 TEST(LibraryDataReadersMiniSEED, Trace)
@@ -149,6 +179,1129 @@ TEST(LibraryDataReadersMiniSEED, Trace)
     EXPECT_LE(ddmax, 1.e-14);
     EXPECT_LE(fdmax, 1.e-7); 
     EXPECT_EQ(idmax, 0);
+    // Views share the trace's samples
+    auto view = trace.getDataView32i();
+    EXPECT_EQ(view.data(), data);
+    EXPECT_EQ(view.size(), static_cast<size_t> (npts));
+    EXPECT_TRUE(std::equal(view.begin(), view.end(),
+                           referenceSignal.begin()));
+    EXPECT_EQ(reinterpret_cast<uintptr_t> (view.data())%64, 0);
+    EXPECT_THROW(trace.getDataView64f(), std::runtime_error);
+    EXPECT_THROW(view.subview(npts - 10, 11), std::out_of_range);
+    // Convert an unaligned range into a caller's buffer
+    constexpr int offset = 13;
+    constexpr int nSamples = 1003;
+    std::vector<double> range64f(nSamples);
+    std::vector<float> range32f(nSamples);
+    trace.getData(offset, nSamples, range64f.data());
+    trace.getData(offset, nSamples, range32f.data());
+    auto subview = view.subview(offset, nSamples);
+    for (int i=0; i<nSamples; ++i)
+    {
+        EXPECT_EQ(range64f[i], static_cast<double> (subview[i]));
+        EXPECT_EQ(range32f[i], static_cast<float> (subview[i]));
+    }
+    EXPECT_THROW(trace.getData(npts - 1, 2, range64f.data()),
+                 std::invalid_argument);
+    EXPECT_THROW(trace.getData(0, 1, static_cast<double *> (nullptr)),
+                 std::invalid_argument);
+    // Copies own their samples
+    auto traceCopy = trace;
+    EXPECT_NE(traceCopy.getDataPointer32i(), data);
+    EXPECT_EQ(traceCopy.getData32i(), data32i);
+    std::vector<float> floatSignal(data32f);
+    traceCopy.setData(floatSignal.size(), floatSignal.data());
+    EXPECT_EQ(traceCopy.getPrecision(), MiniSEED::Precision::FLOAT32);
+    EXPECT_EQ(traceCopy.getData64f(), data64f);
+    // A continuous trace is a single segment
+    EXPECT_EQ(trace.getNumberOfSegments(), 1);
+    EXPECT_TRUE(trace.getGaps().empty());
+    EXPECT_TRUE(trace.getOverlaps().empty());
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceSegments)
+{
+    // This is WY.YWB.EHZ.01.mseed with the 11'th record (463 samples) removed
+    MiniSEED::SNCL sncl;
+    MiniSEED::Trace trace;
+    std::string fileName = "data/WY.YWB.EHZ.01.gap.mseed";
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    auto referenceSignal = loadIntegerData("data/WY.YWB.EHZ.01.txt", 14609);
+    referenceSignal.erase(referenceSignal.begin() + 4548,
+                          referenceSignal.begin() + 4548 + 463);
+    EXPECT_NO_THROW(trace.read(fileName, sncl));
+    EXPECT_EQ(trace.getNumberOfSamples(), 14609 - 463);
+    // Check the segment table
+    ASSERT_EQ(trace.getNumberOfSegments(), 2);
+    auto segments = trace.getSegments();
+    const int64_t t0 = 1452742593340000000; // 2016-01-14T03:36:33.34
+    const int64_t t1 = 1452742643450000000; // 2016-01-14T03:37:23.45
+    EXPECT_EQ(segments[0].startTime, t0);
+    EXPECT_EQ(segments[0].offset, 0);
+    EXPECT_EQ(segments[0].nSamples, 4548);
+    EXPECT_NEAR(segments[0].samplingRate, 100, 1.e-10);
+    EXPECT_EQ(segments[1].startTime, t1);
+    EXPECT_EQ(segments[1].offset, 4548);
+    EXPECT_EQ(segments[1].nSamples, 14609 - 463 - 4548);
+    EXPECT_NEAR(segments[1].samplingRate, 100, 1.e-10);
+    EXPECT_THROW(trace.getSegment(2), std::invalid_argument);
+    // Check the gaps
+    auto gaps = trace.getGaps();
+    ASSERT_EQ(gaps.size(), 1);
+    EXPECT_EQ(gaps[0].startTime, t0 + 4547*10000000LL);
+    EXPECT_EQ(gaps[0].endTime, t1);
+    EXPECT_EQ(gaps[0].segment, 1);
+    EXPECT_TRUE(trace.getOverlaps().empty());
+    // The samples after the gap must be retained
+    const int *data = trace.getDataPointer32i();
+    int idmax = 0;
+    for (int i=0; i<trace.getNumberOfSamples(); ++i)
+    {
+        idmax = std::max(idmax, std::abs(data[i] - referenceSignal[i]));
+    }
+    EXPECT_EQ(idmax, 0);
+    // Extract a window that straddles the gap
+    Temblor::Utilities::Time wt0(t0*1.e-9 + 45);
+    Temblor::Utilities::Time wt1(t1*1.e-9 + 1);
+    auto windows = trace.getSegments(wt0, wt1);
+    ASSERT_EQ(windows.size(), 2);
+    EXPECT_EQ(windows[0].startTime, t0 + 4500*10000000LL);
+    EXPECT_EQ(windows[0].offset, 4500);
+    EXPECT_EQ(windows[0].nSamples, 48);
+    EXPECT_EQ(windows[1].startTime, t1);
+    EXPECT_EQ(windows[1].offset, 4548);
+    EXPECT_EQ(windows[1].nSamples, 101);
+    EXPECT_THROW(trace.getSegments(wt1, wt0), std::invalid_argument);
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceThreads)
+{
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    MiniSEED::Trace serialTrace;
+    MiniSEED::Trace parallelTrace;
+    MiniSEED::Trace referenceTrace;
+    EXPECT_EQ(referenceTrace.getDecoder(), MiniSEED::Decoder::NATIVE);
+    referenceTrace.setDecoder(MiniSEED::Decoder::LIBMSEED);
+    EXPECT_EQ(referenceTrace.getDecoder(), MiniSEED::Decoder::LIBMSEED);
+    EXPECT_EQ(parallelTrace.getNumberOfThreads(), 1);
+    EXPECT_THROW(parallelTrace.setNumberOfThreads(0), std::invalid_argument);
+    parallelTrace.setNumberOfThreads(4);
+    EXPECT_EQ(parallelTrace.getNumberOfThreads(), 4);
+    for (const auto &fileName : {"data/WY.YWB.EHZ.01.mseed",
+                                 "data/WY.YWB.EHZ.01.gap.mseed"})
+    {
+        // The native decoders must match libmseed on any number of threads
+        referenceTrace.read(fileName, sncl);
+        auto npts = static_cast<size_t> (referenceTrace.getNumberOfSamples());
+        for (auto trace : {&serialTrace, &parallelTrace})
+        {
+            trace->read(fileName, sncl);
+            ASSERT_EQ(trace->getNumberOfSamples(),
+                      referenceTrace.getNumberOfSamples());
+            EXPECT_EQ(trace->getNumberOfSegments(),
+                      referenceTrace.getNumberOfSegments());
+            EXPECT_EQ(std::memcmp(referenceTrace.getDataPointer32i(),
+                                  trace->getDataPointer32i(),
+                                  npts*sizeof(int)), 0);
+        }
+        EXPECT_EQ(parallelTrace.getNumberOfThreads(), 4);
+        // Windowed reads must also be bit-identical
+        Temblor::Utilities::Time t0(1452742593.34 + 20.005);
+        Temblor::Utilities::Time t1(1452742593.34 + 100.005);
+        referenceTrace.read(fileName, sncl, t0, t1);
+        npts = static_cast<size_t> (referenceTrace.getNumberOfSamples());
+        for (auto trace : {&serialTrace, &parallelTrace})
+        {
+            trace->read(fileName, sncl, t0, t1);
+            ASSERT_EQ(trace->getNumberOfSamples(),
+                      referenceTrace.getNumberOfSamples());
+            EXPECT_EQ(std::memcmp(referenceTrace.getDataPointer32i(),
+                                  trace->getDataPointer32i(),
+                                  npts*sizeof(int)), 0);
+        }
+    }
+    // Repeat for a trace group
+    MiniSEED::TraceGroup serialGroup;
+    MiniSEED::TraceGroup parallelGroup;
+    parallelGroup.setNumberOfThreads(3);
+    serialGroup.read("data/cola.mseed");
+    parallelGroup.read("data/cola.mseed");
+    ASSERT_EQ(serialGroup.getNumberOfTraces(),
+              parallelGroup.getNumberOfTraces());
+    for (const auto &groupSNCL : serialGroup.getSNCLs())
+    {
+        auto serial = serialGroup.getTrace(groupSNCL);
+        auto parallel = parallelGroup.getTrace(groupSNCL);
+        ASSERT_EQ(serial.getNumberOfSamples(), parallel.getNumberOfSamples());
+        auto npts = static_cast<size_t> (serial.getNumberOfSamples());
+        EXPECT_EQ(std::memcmp(serial.getDataPointer32i(),
+                              parallel.getDataPointer32i(),
+                              npts*sizeof(int)), 0);
+    }
+}
+
+TEST(LibraryDataReadersMiniSEED, RecordIndex)
+{
+    MiniSEED::RecordIndex index;
+    EXPECT_FALSE(index.isLoaded());
+    EXPECT_NO_THROW(index.load("data/cola.mseed"));
+    EXPECT_TRUE(index.isLoaded());
+    EXPECT_EQ(index.getNumberOfRecords(), 107);
+    auto sncls = index.getSNCLs();
+    EXPECT_EQ(sncls.size(), 3);
+    // Records are sorted by SNCL then time and all records are 512 bytes
+    auto records = index.getRecords();
+    ASSERT_EQ(records.size(), 107);
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].length, 512);
+        EXPECT_EQ(records[i].offset%512, 0);
+        EXPECT_LE(records[i].startTime, records[i].endTime);
+        if (i > 0)
+        {
+            EXPECT_LE(records[i-1].sncl, records[i].sncl);
+            if (records[i-1].sncl == records[i].sncl)
+            {
+                EXPECT_LT(records[i-1].startTime, records[i].startTime);
+            }
+        }
+    }
+    // Query a window
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    EXPECT_FALSE(index.haveSNCL(sncl));
+    index.load("data/WY.YWB.EHZ.01.mseed");
+    EXPECT_TRUE(index.haveSNCL(sncl));
+    EXPECT_EQ(index.getNumberOfRecords(), 32);
+    // 2016-01-14T03:36:55 to 2016-01-14T03:37:05
+    Temblor::Utilities::Time t0(1452742615.0);
+    Temblor::Utilities::Time t1(1452742625.0);
+    auto window = index.getRecords(sncl, t0, t1);
+    ASSERT_EQ(window.size(), 3);
+    EXPECT_EQ(window[0].offset, 4*512);
+    EXPECT_EQ(window[2].offset, 6*512);
+    EXPECT_THROW(index.getRecords(sncl, t1, t0), std::invalid_argument);
+}
+
+TEST(LibraryDataReadersMiniSEED, ArchiveIndex)
+{
+#ifdef TEMBLOR_USE_FILESYSTEM
+    // Build a small SDS archive
+    auto root = fs::temp_directory_path()/"temblorSDS";
+    fs::remove_all(root);
+    auto wyDirectory = root/"2016"/"WY"/"YWB"/"EHZ.D";
+    auto iuDirectory = root/"2010"/"IU"/"COLA"/"LHZ.D";
+    fs::create_directories(wyDirectory);
+    fs::create_directories(iuDirectory);
+    auto wyFile = wyDirectory/"WY.YWB.01.EHZ.D.2016.014";
+    auto iuFile = iuDirectory/"IU.COLA.00.LHZ.D.2010.058";
+    fs::copy_file("data/WY.YWB.EHZ.01.mseed", wyFile);
+    fs::copy_file("data/cola.mseed", iuFile);
+    fs::copy_file("data/cola.mseed", iuDirectory/"notADayFile.mseed");
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    MiniSEED::ArchiveIndex archive;
+    archive.setNumberOfThreads(2);
+    archive.scan(root.string());
+    EXPECT_EQ(archive.getNumberOfFiles(), 2);
+    EXPECT_EQ(archive.getNumberOfFilesScanned(), 2);
+    EXPECT_EQ(archive.getSNCLs().size(), 4);
+    EXPECT_TRUE(archive.haveSNCL(sncl));
+    // The archive must find the same records as the file's index
+    MiniSEED::RecordIndex index;
+    index.load("data/WY.YWB.EHZ.01.mseed");
+    Temblor::Utilities::Time t0(1452742593.34 + 20.005);
+    Temblor::Utilities::Time t1(1452742593.34 + 100.005);
+    auto expected = index.getRecords(sncl, t0, t1);
+    auto records = archive.getRecords(sncl, t0, t1);
+    ASSERT_EQ(records.size(), expected.size());
+    ASSERT_FALSE(records.empty());
+    auto fileNames = archive.getFileNames();
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].offset, expected[i].offset);
+        EXPECT_EQ(records[i].length, expected[i].length);
+        EXPECT_EQ(records[i].startTime, expected[i].startTime);
+        EXPECT_EQ(records[i].endTime, expected[i].endTime);
+        EXPECT_NEAR(records[i].samplingRate, 100, 1.e-10);
+        EXPECT_TRUE(fs::equivalent(fileNames.at(records[i].file), wyFile));
+    }
+    EXPECT_THROW(archive.getRecords(sncl, t1, t0), std::invalid_argument);
+    // Save and load the index
+    auto indexFile = (root/"archive.index").string();
+    archive.save(indexFile);
+    MiniSEED::ArchiveIndex archiveLoaded;
+    archiveLoaded.load(indexFile);
+    EXPECT_EQ(archiveLoaded.getRootDirectory(), archive.getRootDirectory());
+    EXPECT_EQ(archiveLoaded.getFileNames(), fileNames);
+    auto recordsLoaded = archiveLoaded.getRecords(sncl, t0, t1);
+    ASSERT_EQ(recordsLoaded.size(), records.size());
+    for (size_t i=0; i<records.size(); ++i)
+    {
+        EXPECT_EQ(recordsLoaded[i].offset, records[i].offset);
+        EXPECT_EQ(recordsLoaded[i].file, records[i].file);
+    }
+    EXPECT_THROW(archiveLoaded.load("data/cola.mseed"),
+                 std::invalid_argument);
+    // Unchanged files are not re-indexed
+    archiveLoaded.load(indexFile);
+    archiveLoaded.scan(root.string());
+    EXPECT_EQ(archiveLoaded.getNumberOfFilesScanned(), 0);
+    EXPECT_EQ(archiveLoaded.getNumberOfFiles(), 2);
+    // A modified file is re-indexed
+    fs::copy_file("data/WY.YWB.EHZ.01.gap.mseed", wyFile,
+                  fs::copy_options::overwrite_existing);
+    archiveLoaded.scan(root.string());
+    EXPECT_EQ(archiveLoaded.getNumberOfFilesScanned(), 1);
+    index.load("data/WY.YWB.EHZ.01.gap.mseed");
+    Temblor::Utilities::Time tStart(0);
+    Temblor::Utilities::Time tEnd(2000000000);
+    EXPECT_EQ(archiveLoaded.getRecords(sncl, tStart, tEnd).size(),
+              index.getRecords(sncl, tStart, tEnd).size());
+    // A removed file is dropped
+    fs::remove(iuFile);
+    archiveLoaded.scan(root.string());
+    EXPECT_EQ(archiveLoaded.getNumberOfFilesScanned(), 0);
+    EXPECT_EQ(archiveLoaded.getNumberOfFiles(), 1);
+    EXPECT_EQ(archiveLoaded.getSNCLs().size(), 1);
+    fs::remove_all(root);
+#endif
+}
+
+TEST(LibraryDataReadersMiniSEED, RecordMerger)
+{
+#ifdef TEMBLOR_USE_FILESYSTEM
+    auto root = fs::temp_directory_path()/"temblorMerge";
+    fs::remove_all(root);
+    fs::create_directories(root/"copies");
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    MiniSEED::Trace reference;
+    reference.read("data/WY.YWB.EHZ.01.mseed", sncl);
+    auto x = reference.getData32i();
+    // An exact copy and a copy whose records straddle the originals
+    fs::copy_file("data/WY.YWB.EHZ.01.mseed", root/"original.mseed");
+    fs::copy_file("data/WY.YWB.EHZ.01.mseed", root/"copies"/"copy.mseed");
+    reference.write((root/"copies"/"overlap.mseed").string(), 1024);
+    auto outputFile = (root/"merged.mseed").string();
+    MiniSEED::RecordMerger merger;
+    merger.setNumberOfThreads(2);
+    EXPECT_EQ(merger.getNumberOfThreads(), 2);
+    auto statistics = merger.merge(root.string(), outputFile);
+    EXPECT_EQ(statistics.files, 3);
+    EXPECT_EQ(statistics.duplicates, 32);
+    EXPECT_GT(statistics.overlapped + statistics.trimmed, 0);
+    EXPECT_EQ(statistics.samples, x.size());
+    EXPECT_EQ(statistics.segments, 1);
+    MiniSEED::Trace merged;
+    merged.read(outputFile, sncl);
+    EXPECT_EQ(merged.getNumberOfSegments(), 1);
+    EXPECT_NEAR(merged.getStartTime().getEpochalTime(),
+                reference.getStartTime().getEpochalTime(), 1.e-6);
+    EXPECT_EQ(merged.getData32i(), x);
+    // The merged file is skipped when merging the directory again
+    statistics = merger.merge(root.string(), outputFile, 512);
+    EXPECT_EQ(statistics.files, 3);
+    EXPECT_EQ(statistics.samples, x.size());
+    // Gaps start new segments
+    MiniSEED::Trace gapped;
+    gapped.read("data/WY.YWB.EHZ.01.gap.mseed", sncl);
+    statistics = merger.merge("data/WY.YWB.EHZ.01.gap.mseed", outputFile,
+                              512, MiniSEED::FormatVersion::MINISEED3);
+    EXPECT_EQ(statistics.files, 1);
+    EXPECT_EQ(statistics.duplicates, 0);
+    EXPECT_EQ(statistics.segments, gapped.getNumberOfSegments());
+    merged.read(outputFile, sncl);
+    EXPECT_EQ(merged.getNumberOfSegments(), gapped.getNumberOfSegments());
+    EXPECT_EQ(merged.getData32i(), gapped.getData32i());
+    EXPECT_THROW(merger.merge(outputFile, outputFile), std::invalid_argument);
+    EXPECT_THROW(merger.merge(root.string(), outputFile, 1000),
+                 std::invalid_argument);
+    EXPECT_THROW(merger.setNumberOfThreads(0), std::invalid_argument);
+    fs::remove_all(root);
+#endif
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceWindow)
+{
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    auto referenceSignal = loadIntegerData("data/WY.YWB.EHZ.01.txt", 14609);
+    // The first sample is at 2016-01-14T03:36:33.34
+    const double startTime = 1452742593.34;
+    Temblor::Utilities::Time t0(startTime + 20);
+    Temblor::Utilities::Time t1(startTime + 80);
+    MiniSEED::Trace trace;
+    EXPECT_NO_THROW(trace.read("data/WY.YWB.EHZ.01.mseed", sncl, t0, t1));
+    EXPECT_EQ(trace.getNumberOfSamples(), 6001);
+    EXPECT_EQ(trace.getNumberOfSegments(), 1);
+    EXPECT_NEAR(trace.getSamplingRate(), 100, 1.e-10);
+    EXPECT_NEAR(trace.getStartTime().getEpochalTime(),
+                startTime + 20, 1.e-6);
+    const int *data = trace.getDataPointer32i();
+    int idmax = 0;
+    for (int i=0; i<trace.getNumberOfSamples(); ++i)
+    {
+        idmax = std::max(idmax, std::abs(data[i] - referenceSignal[2000 + i]));
+    }
+    EXPECT_EQ(idmax, 0);
+    // Reading the whole file through the index matches the full read
+    MiniSEED::RecordIndex index;
+    index.load("data/WY.YWB.EHZ.01.mseed");
+    Temblor::Utilities::Time tStart(startTime - 1);
+    Temblor::Utilities::Time tEnd(startTime + 1000);
+    trace.read(index, sncl, tStart, tEnd);
+    EXPECT_EQ(trace.getNumberOfSamples(), 14609);
+    data = trace.getDataPointer32i();
+    idmax = 0;
+    for (int i=0; i<trace.getNumberOfSamples(); ++i)
+    {
+        idmax = std::max(idmax, std::abs(data[i] - referenceSignal[i]));
+    }
+    EXPECT_EQ(idmax, 0);
+    // A window straddling a gap retains both segments
+    trace.read("data/WY.YWB.EHZ.01.gap.mseed", sncl, t0, t1);
+    EXPECT_EQ(trace.getNumberOfSegments(), 2);
+    EXPECT_EQ(trace.getGaps().size(), 1);
+    EXPECT_EQ(trace.getNumberOfSamples(), 6001 - 463);
+    // No data in the window
+    Temblor::Utilities::Time tEarly(startTime - 100);
+    Temblor::Utilities::Time tLate(startTime - 50);
+    EXPECT_THROW(trace.read(index, sncl, tEarly, tLate),
+                 std::invalid_argument);
+}
+
+TEST(LibraryDataReadersMiniSEED, RingBuffer)
+{
+    EXPECT_THROW(MiniSEED::RingBuffer(0, 8), std::invalid_argument);
+    MiniSEED::RingBuffer ringBuffer(100, 8);
+    EXPECT_EQ(ringBuffer.getSampleCapacity(), 128);
+    EXPECT_EQ(ringBuffer.getSegmentCapacity(), 8);
+    MiniSEED::Trace trace;
+    EXPECT_FALSE(ringBuffer.getSnapshot(&trace));
+    // Two contiguous appends are one segment
+    const double samplingRate = 10;
+    const int64_t second = 1000000000;
+    std::vector<double> x(150);
+    for (int i=0; i<static_cast<int> (x.size()); ++i){x[i] = i;}
+    ringBuffer.append(0, samplingRate, 50, x.data());
+    ringBuffer.append(5*second, samplingRate, 50, x.data() + 50);
+    ASSERT_TRUE(ringBuffer.getSnapshot(&trace));
+    EXPECT_EQ(trace.getNumberOfSegments(), 1);
+    EXPECT_EQ(trace.getData64f(), std::vector<double>(x.begin(),
+                                                      x.begin() + 100));
+    // A gap starts a new segment and the oldest samples are overwritten
+    ringBuffer.append(20*second, samplingRate, 50, x.data() + 100);
+    EXPECT_EQ(ringBuffer.getNumberOfSamplesAppended(), 150);
+    ASSERT_TRUE(ringBuffer.getSnapshot(&trace));
+    ASSERT_EQ(trace.getNumberOfSegments(), 2);
+    EXPECT_EQ(trace.getNumberOfSamples(), 128);
+    EXPECT_EQ(trace.getSegment(0).startTime, 2200000000);
+    EXPECT_EQ(trace.getSegment(1).startTime, 20*second);
+    EXPECT_EQ(trace.getSegment(1).offset, 78);
+    EXPECT_EQ(trace.getData64f(), std::vector<double>(x.begin() + 22,
+                                                      x.end()));
+    EXPECT_EQ(trace.getGaps().size(), 1);
+    // Readers racing the producer only see consistent samples.  The value
+    // of each sample is its index so it must match its time.
+    MiniSEED::RingBuffer sharedBuffer(1000, 64);
+    constexpr int nAppends = 20000;
+    constexpr int nSamplesPerAppend = 37;
+    std::atomic<bool> ldone{false};
+    std::atomic<int> nInconsistent{0};
+    std::atomic<int> nSnapshots{0};
+    std::vector<std::thread> readers;
+    for (int ir=0; ir<3; ++ir)
+    {
+        readers.push_back(std::thread([&]()
+        {
+            MiniSEED::Trace snapshot;
+            while (!ldone.load())
+            {
+                if (!sharedBuffer.getSnapshot(&snapshot)){continue;}
+                nSnapshots.fetch_add(1);
+                auto samples = snapshot.getData64f();
+                for (const auto &segment : snapshot.getSegments())
+                {
+                    auto first = std::round(segment.startTime*1.e-9
+                                           *samplingRate);
+                    for (int64_t i=0; i<segment.nSamples; ++i)
+                    {
+                        if (samples[segment.offset + i] != first + i)
+                        {
+                            nInconsistent.fetch_add(1);
+                            break;
+                        }
+                    }
+                }
+            }
+        }));
+    }
+    std::vector<double> y(nSamplesPerAppend);
+    int64_t i0 = 0;
+    for (int ia=0; ia<nAppends; ++ia)
+    {
+        // Every tenth append follows a gap
+        if (ia%10 == 9){i0 = i0 + 5;}
+        for (int i=0; i<nSamplesPerAppend; ++i){y[i] = i0 + i;}
+        sharedBuffer.append(i0*second/10, samplingRate,
+                            nSamplesPerAppend, y.data());
+        i0 = i0 + nSamplesPerAppend;
+    }
+    // On a loaded machine the producer can finish before any reader runs
+    while (nSnapshots.load() == 0){std::this_thread::yield();}
+    ldone = true;
+    for (auto &reader : readers){reader.join();}
+    EXPECT_EQ(nInconsistent.load(), 0);
+    EXPECT_GT(nSnapshots.load(), 0);
+    ASSERT_TRUE(sharedBuffer.getSnapshot(&trace));
+    EXPECT_EQ(trace.getNumberOfSamples(), 1024);
+    EXPECT_EQ(trace.getData64f().back(), i0 - 1);
+}
+
+TEST(LibraryDataReadersMiniSEED, PacketIngest)
+{
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    std::string fileName = "data/WY.YWB.EHZ.01.mseed";
+    MiniSEED::Trace reference;
+    reference.read(fileName, sncl);
+    MiniSEED::RecordIndex index;
+    index.load(fileName);
+    std::ifstream file(fileName, std::ios::binary);
+    std::vector<char> records((std::istreambuf_iterator<char> (file)),
+                              std::istreambuf_iterator<char> ());
+    constexpr int recordLength = 512;
+    ASSERT_EQ(records.size()%recordLength, 0);
+    // Stream the file through a pipe
+    MiniSEED::PacketIngest ingest;
+    EXPECT_THROW(ingest.setBufferDuration(0), std::invalid_argument);
+    int nCallbacks = 0;
+    int64_t nCallbackSamples = 0;
+    ingest.setRecordCallback([&](const MiniSEED::SNCL &recordSNCL,
+                                 const MiniSEED::Segment &segment)
+                             {
+                                 EXPECT_EQ(recordSNCL, sncl);
+                                 EXPECT_EQ(segment.offset, nCallbackSamples);
+                                 nCallbacks = nCallbacks + 1;
+                                 nCallbackSamples = nCallbackSamples
+                                                  + segment.nSamples;
+                             });
+    int fd[2];
+    ASSERT_EQ(pipe(fd), 0);
+    ingest.start(fd[0], recordLength);
+    EXPECT_TRUE(ingest.isRunning());
+    EXPECT_THROW(ingest.start(fd[0], recordLength), std::runtime_error);
+    // Write a partial record then the rest
+    ASSERT_EQ(write(fd[1], records.data(), 100), 100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto nRemaining = static_cast<ssize_t> (records.size()) - 100;
+    ASSERT_EQ(write(fd[1], records.data() + 100, nRemaining), nRemaining);
+    close(fd[1]);
+    for (int i=0; i<1000 && ingest.isRunning(); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_FALSE(ingest.isRunning());
+    ingest.stop();
+    close(fd[0]);
+    auto statistics = ingest.getStatistics();
+    EXPECT_EQ(statistics.records,
+              static_cast<uint64_t> (index.getNumberOfRecords()));
+    EXPECT_EQ(statistics.samples, 14609);
+    EXPECT_EQ(statistics.rejected, 0);
+    EXPECT_EQ(nCallbacks, index.getNumberOfRecords());
+    ASSERT_TRUE(ingest.haveSNCL(sncl));
+    EXPECT_EQ(ingest.getSNCLs().size(), 1);
+    auto snapshot = ingest.getSnapshot(sncl);
+    EXPECT_EQ(snapshot.getSNCL(), sncl);
+    EXPECT_EQ(snapshot.getNumberOfSegments(), 1);
+    EXPECT_EQ(snapshot.getSegment(0).startTime,
+              reference.getSegment(0).startTime);
+    EXPECT_EQ(snapshot.getData64f(), reference.getData64f());
+    // A short buffer keeps only the latest samples
+    ingest.clear();
+    EXPECT_FALSE(ingest.haveSNCL(sncl));
+    ingest.setBufferDuration(10);
+    ingest.setRecordCallback(nullptr);
+    for (size_t offset=0; offset<records.size(); offset=offset+recordLength)
+    {
+        EXPECT_TRUE(ingest.addRecord(recordLength, records.data() + offset));
+    }
+    std::vector<char> garbage(recordLength, 'x');
+    EXPECT_FALSE(ingest.addRecord(recordLength, garbage.data()));
+    EXPECT_EQ(ingest.getStatistics().rejected, 1);
+    snapshot = ingest.getSnapshot(sncl);
+    EXPECT_EQ(snapshot.getNumberOfSamples(), 2048);
+    EXPECT_NEAR(snapshot.getEndTime().getEpochalTime(),
+                reference.getEndTime().getEpochalTime(), 1.e-6);
+    auto referenceData = reference.getData64f();
+    EXPECT_EQ(snapshot.getData64f(),
+              std::vector<double>(referenceData.end() - 2048,
+                                  referenceData.end()));
+    MiniSEED::SNCL unknown;
+    unknown.setNetwork("XX");
+    EXPECT_THROW(ingest.getSnapshot(unknown), std::invalid_argument);
+}
+
+TEST(LibraryDataReadersMiniSEED, Steim)
+{
+    std::vector<MiniSEED::InstructionSet> instructionSets
+        = {MiniSEED::InstructionSet::AUTOMATIC,
+           MiniSEED::InstructionSet::SCALAR};
+    for (const auto &instructionSet : {MiniSEED::InstructionSet::SSE41,
+                                       MiniSEED::InstructionSet::AVX2})
+    {
+        if (MiniSEED::isSupported(instructionSet))
+        {
+            instructionSets.push_back(instructionSet);
+        }
+    }
+    // Compare to libmseed on the Steim2 fixtures
+    for (const auto &fileName : {"data/WY.YWB.EHZ.01.mseed",
+                                 "data/cola.mseed"})
+    {
+        std::ifstream file(fileName, std::ios::binary);
+        std::vector<char> buffer((std::istreambuf_iterator<char> (file)),
+                                 std::istreambuf_iterator<char> ());
+        MiniSEED::RecordIndex index;
+        index.load(fileName);
+        for (const auto &record : index.getRecords())
+        {
+            MS3Record *msr = nullptr;
+            ASSERT_EQ(msr3_parse(buffer.data() + record.offset,
+                                 record.length, &msr, 0, 0), MS_NOERROR);
+            ASSERT_EQ(msr->encoding, DE_STEIM2);
+            auto payload = buffer.data() + record.offset
+                         + (msr->reclen - msr->datalength);
+            auto nSamples = msr->samplecnt;
+            ASSERT_EQ(msr3_unpack_data(msr, 0), nSamples);
+            auto reference = static_cast<const int32_t *> (msr->datasamples);
+            std::vector<int32_t> y(nSamples);
+            for (const auto &instructionSet : instructionSets)
+            {
+                std::fill(y.begin(), y.end(), 0);
+                EXPECT_EQ(MiniSEED::decodeSteim2(msr->datalength, payload,
+                                                 nSamples, y.data(),
+                                                 instructionSet), nSamples);
+                EXPECT_TRUE(std::equal(y.begin(), y.end(), reference));
+            }
+            msr3_free(&msr);
+        }
+    }
+    // Exercise every packing with synthetic Steim1 and Steim2 frames
+    std::mt19937 generator(4042);
+    std::uniform_int_distribution<int> bits(1, 29);
+    std::vector<int> x(5000);
+    int sample = 0;
+    for (auto &xi : x)
+    {
+        auto range = (1 << bits(generator)) - 1;
+        std::uniform_int_distribution<int> difference(-range/2, range/2);
+        auto dx = difference(generator);
+        // Keep the walk bounded so every difference packs into 30 bits
+        if (std::abs(sample + dx) > (1 << 29)){dx = -dx;}
+        sample = sample + dx;
+        xi = sample;
+    }
+    for (const auto &version : {1, 2})
+    {
+        auto frames = encodeSteim(version, x);
+        auto nSamples = static_cast<int64_t> (x.size());
+        std::vector<int32_t> y(x.size());
+        for (const auto &instructionSet : instructionSets)
+        {
+            std::fill(y.begin(), y.end(), 0);
+            int64_t nDecoded = 0;
+            if (version == 1)
+            {
+                nDecoded = MiniSEED::decodeSteim1(frames.size(), frames.data(),
+                                                  nSamples, y.data(),
+                                                  instructionSet);
+            }
+            else
+            {
+                nDecoded = MiniSEED::decodeSteim2(frames.size(), frames.data(),
+                                                  nSamples, y.data(),
+                                                  instructionSet);
+            }
+            EXPECT_EQ(nDecoded, nSamples);
+            EXPECT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+        }
+        // Fewer samples than are in the frames
+        auto decode = [&](const std::vector<uint8_t> &input, int64_t n)
+        {
+            if (version == 1)
+            {
+                return MiniSEED::decodeSteim1(input.size(), input.data(),
+                                              n, y.data());
+            }
+            return MiniSEED::decodeSteim2(input.size(), input.data(),
+                                          n, y.data());
+        };
+        auto nPrefix = nSamples/3;
+        std::fill(y.begin(), y.end(), 0);
+        EXPECT_EQ(decode(frames, nPrefix), nPrefix);
+        EXPECT_TRUE(std::equal(y.begin(), y.begin() + nPrefix, x.begin()));
+        EXPECT_TRUE(std::all_of(y.begin() + nPrefix, y.end(),
+                                [](const int32_t yi){return yi == 0;}));
+        EXPECT_EQ(MiniSEED::getReverseIntegrationConstant(frames.size(),
+                                                          frames.data()),
+                  x.back());
+        // A corrupt difference is decoded but the last sample no longer
+        // matches the reverse integration constant
+        auto corrupt = frames;
+        corrupt[64 + 4*5 + 3] = corrupt[64 + 4*5 + 3] ^ 0x01;
+        EXPECT_EQ(decode(corrupt, nSamples), nSamples);
+        EXPECT_NE(y.back(), MiniSEED::getReverseIntegrationConstant(
+                                corrupt.size(), corrupt.data()));
+        // Garbage in an unused trailing frame, including words with an
+        // invalid Steim2 layout, is ignored like libmseed does
+        auto garbage = frames;
+        garbage.insert(garbage.end(), 64, 0xFF);
+        std::fill(y.begin(), y.end(), 0);
+        EXPECT_EQ(decode(garbage, nSamples), nSamples);
+        EXPECT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+        std::vector<int32_t> reference(x.size());
+        char sampleType;
+        int8_t swapFlag = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) ? 1 : 0;
+        EXPECT_EQ(ms_decode_data(garbage.data(), garbage.size(),
+                                 version == 1 ? DE_STEIM1 : DE_STEIM2,
+                                 nSamples, reference.data(),
+                                 reference.size()*sizeof(int32_t),
+                                 &sampleType, swapFlag, "", 0), nSamples);
+        EXPECT_EQ(y, reference);
+    }
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceWrite)
+{
+#ifdef TEMBLOR_USE_FILESYSTEM
+    fs::path scratchFilePath = fs::temp_directory_path();
+    std::string scratchFile = std::string(scratchFilePath.c_str())
+                            + "/temp.mseed";
+#else
+    std::string scratchFile = "temp.mseed";
+#endif
+    MiniSEED::SNCL sncl;
+    sncl.setNetwork("WY");
+    sncl.setStation("YWB");
+    sncl.setChannel("EHZ");
+    sncl.setLocationCode("01");
+    MiniSEED::Trace trace;
+    trace.setNumberOfThreads(2);
+    trace.read("data/WY.YWB.EHZ.01.gap.mseed", sncl);
+    auto x = trace.getData32i();
+    auto segments = trace.getSegments();
+    // Steim2 round trips for both format versions
+    for (const auto &formatVersion : {MiniSEED::FormatVersion::MINISEED2,
+                                      MiniSEED::FormatVersion::MINISEED3})
+    {
+        for (const auto &recordLength : {512, 4096})
+        {
+            trace.write(scratchFile, recordLength, formatVersion);
+            MiniSEED::Trace traceRead;
+            traceRead.read(scratchFile, sncl);
+            EXPECT_EQ(traceRead.getPrecision(), MiniSEED::Precision::INT32);
+            EXPECT_NEAR(traceRead.getSamplingRate(),
+                        trace.getSamplingRate(), 1.e-10);
+            ASSERT_EQ(traceRead.getNumberOfSegments(),
+                      static_cast<int> (segments.size()));
+            for (int is=0; is<traceRead.getNumberOfSegments(); ++is)
+            {
+                auto segment = traceRead.getSegment(is);
+                EXPECT_EQ(segment.offset, segments[is].offset);
+                EXPECT_EQ(segment.nSamples, segments[is].nSamples);
+                EXPECT_NEAR(static_cast<double> (segment.startTime),
+                            static_cast<double> (segments[is].startTime),
+                            1000);
+            }
+            EXPECT_EQ(traceRead.getData32i(), x);
+        }
+    }
+    // Float encodings
+    trace.write(scratchFile, 4096, MiniSEED::FormatVersion::MINISEED3,
+                MiniSEED::Encoding::FLOAT32);
+    MiniSEED::Trace traceRead;
+    traceRead.read(scratchFile, sncl);
+    EXPECT_EQ(traceRead.getPrecision(), MiniSEED::Precision::FLOAT32);
+    EXPECT_EQ(traceRead.getData32f(), trace.getData32f());
+    // This trace is floating precision so the default is not Steim2
+    traceRead.write(scratchFile, 1024, MiniSEED::FormatVersion::MINISEED2,
+                    MiniSEED::Encoding::FLOAT64);
+    traceRead.read(scratchFile, sncl);
+    EXPECT_EQ(traceRead.getPrecision(), MiniSEED::Precision::FLOAT64);
+    EXPECT_EQ(traceRead.getData64f(), trace.getData64f());
+    EXPECT_THROW(traceRead.write(scratchFile, 4096,
+                                 MiniSEED::FormatVersion::MINISEED2,
+                                 MiniSEED::Encoding::STEIM2),
+                 std::invalid_argument);
+    EXPECT_THROW(trace.write(scratchFile, 1000,
+                             MiniSEED::FormatVersion::MINISEED2),
+                 std::invalid_argument);
+    EXPECT_THROW(trace.write(scratchFile, 64,
+                             MiniSEED::FormatVersion::MINISEED3),
+                 std::invalid_argument);
+    // A trace group
+    MiniSEED::TraceGroup group;
+    group.setNumberOfThreads(2);
+    group.read("data/cola.mseed");
+    group.write(scratchFile);
+    MiniSEED::TraceGroup groupRead;
+    groupRead.read(scratchFile);
+    ASSERT_EQ(groupRead.getNumberOfTraces(), group.getNumberOfTraces());
+    for (const auto &groupSNCL : group.getSNCLs())
+    {
+        ASSERT_TRUE(groupRead.haveSNCL(groupSNCL));
+        EXPECT_EQ(groupRead.getTrace(groupSNCL).getData32i(),
+                  group.getTrace(groupSNCL).getData32i());
+    }
+    // Add a trace to the group
+    trace.setData(x.size() - 1000, x.data() + 1000);
+    group.setTrace(trace);
+    EXPECT_EQ(group.getNumberOfTraces(), groupRead.getNumberOfTraces() + 1);
+    group.setTrace(trace);
+    EXPECT_EQ(group.getNumberOfTraces(), groupRead.getNumberOfTraces() + 1);
+    group.write(scratchFile, 512);
+    groupRead.read(scratchFile);
+    ASSERT_TRUE(groupRead.haveSNCL(sncl));
+    EXPECT_EQ(groupRead.getTrace(sncl).getData32i(), trace.getData32i());
+    // A failed write leaves the existing file alone
+    std::ifstream before(scratchFile, std::ios::binary);
+    std::vector<char> original((std::istreambuf_iterator<char> (before)),
+                               std::istreambuf_iterator<char> ());
+    before.close();
+    MiniSEED::SNCL floatSNCL(sncl);
+    floatSNCL.setChannel("EHN");
+    std::vector<double> floatData(1000, 1.5);
+    MiniSEED::Trace floatTrace;
+    floatTrace.setSNCL(floatSNCL);
+    floatTrace.setSamplingRate(100);
+    floatTrace.setData(floatData.size(), floatData.data());
+    group.setTrace(floatTrace);
+    EXPECT_THROW(group.write(scratchFile, 512,
+                             MiniSEED::FormatVersion::MINISEED2,
+                             MiniSEED::Encoding::STEIM2),
+                 std::invalid_argument);
+    std::ifstream after(scratchFile, std::ios::binary);
+    std::vector<char> unchanged((std::istreambuf_iterator<char> (after)),
+                                std::istreambuf_iterator<char> ());
+    after.close();
+    EXPECT_EQ(unchanged, original);
+    EXPECT_FALSE(std::ifstream(scratchFile + ".tmp").good());
+    // A long segment is packed as one stream rather than in pieces
+    std::vector<int> longData(300000);
+    for (size_t i=0; i<longData.size(); ++i)
+    {
+        longData[i] = static_cast<int> (1000*std::sin(0.001*i));
+    }
+    MiniSEED::Trace longTrace;
+    longTrace.setSNCL(sncl);
+    longTrace.setSamplingRate(100);
+    longTrace.setData(longData.size(), longData.data());
+    longTrace.setNumberOfThreads(2);
+    longTrace.write(scratchFile, 512);
+    MS3Record *msr = msr3_init(nullptr);
+    char network[] = "WY";
+    char station[] = "YWB";
+    char location[] = "01";
+    char channel[] = "EHZ";
+    ms_nslc2sid(msr->sid, LM_SIDLEN, 0, network, station, location, channel);
+    msr->formatversion = 2;
+    msr->pubversion = 1;
+    msr->reclen = 512;
+    msr->encoding = DE_STEIM2;
+    msr->starttime = 0;
+    msr->samprate = 100;
+    msr->datasamples = longData.data();
+    msr->numsamples = static_cast<int64_t> (longData.size());
+    msr->sampletype = 'i';
+    std::vector<char> reference;
+    int64_t nPacked = 0;
+    auto appendRecord = [](char *record, int length, void *data)
+    {
+        auto buffer = static_cast<std::vector<char> *> (data);
+        buffer->insert(buffer->end(), record, record + length);
+    };
+    EXPECT_GT(msr3_pack(msr, appendRecord, &reference, &nPacked,
+                        MSF_FLUSHDATA | MSF_PACKVER2, 0), 0);
+    EXPECT_EQ(nPacked, static_cast<int64_t> (longData.size()));
+    msr->datasamples = nullptr;
+    msr3_free(&msr);
+    std::ifstream longFile(scratchFile, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<size_t> (longFile.tellg()), reference.size());
+    longFile.close();
+    MiniSEED::Trace longRead;
+    longRead.read(scratchFile, sncl);
+    EXPECT_EQ(longRead.getNumberOfSegments(), 1);
+    EXPECT_EQ(longRead.getData32i(), longData);
+    // A group read rejects a miniSEED3 record with a bad CRC
+    longTrace.write(scratchFile, 512, MiniSEED::FormatVersion::MINISEED3);
+    MiniSEED::TraceGroup crcGroup;
+    crcGroup.read(scratchFile);
+    EXPECT_EQ(crcGroup.getTrace(sncl).getData32i(), longData);
+    std::fstream corrupt(scratchFile, std::ios::binary | std::ios::in
+                                    | std::ios::out);
+    corrupt.seekp(2*512 + 500);
+    corrupt.put('\xA5');
+    corrupt.close();
+    crcGroup.read(scratchFile);
+    EXPECT_THROW(crcGroup.getTrace(sncl), std::runtime_error);
+    std::remove(scratchFile.c_str());
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceGroup)
+{
+    MiniSEED::TraceGroup traceGroup;
+    std::string fileName = "data/cola.mseed";
+    EXPECT_NO_THROW(traceGroup.read(fileName));
+    EXPECT_EQ(traceGroup.getNumberOfTraces(), 3);
+    auto sncls = traceGroup.getSNCLs();
+    EXPECT_EQ(sncls.size(), 3);
+    for (const auto &channel : {"LH1", "LH2", "LHZ"})
+    {
+        MiniSEED::SNCL sncl;
+        sncl.setNetwork("IU");
+        sncl.setStation("COLA");
+        sncl.setChannel(channel);
+        sncl.setLocationCode("00");
+        EXPECT_TRUE(traceGroup.haveSNCL(sncl));
+        auto trace = traceGroup.getTrace(sncl);
+        EXPECT_EQ(trace.getNumberOfSamples(), 4200);
+        EXPECT_NEAR(trace.getSamplingRate(), 1, 1.e-10);
+        EXPECT_EQ(trace.getPrecision(), MiniSEED::Precision::INT32);
+        // The single pass read must match the dedicated trace reader
+        MiniSEED::Trace traceCheck;
+        traceCheck.read(fileName, sncl);
+        ASSERT_EQ(traceCheck.getNumberOfSamples(),
+                  trace.getNumberOfSamples());
+        std::string textFileName = "data/IU.COLA." + std::string(channel)
+                                 + ".00.txt";
+        auto referenceSignal = loadIntegerData(textFileName, 4200);
+        ASSERT_EQ(referenceSignal.size(), 4200);
+        const int *data = trace.getDataPointer32i();
+        const int *dataCheck = traceCheck.getDataPointer32i();
+        int idmax = 0;
+        for (int i=0; i<trace.getNumberOfSamples(); ++i)
+        {
+            idmax = std::max(idmax, std::abs(data[i] - dataCheck[i]));
+            idmax = std::max(idmax, std::abs(data[i] - referenceSignal[i]));
+        }
+        EXPECT_EQ(idmax, 0);
+    }
+}
+
+TEST(LibraryDataReadersMiniSEED, TraceGroupCache)
+{
+    MiniSEED::TraceGroup traceGroup;
+    EXPECT_EQ(traceGroup.getCacheSize(), size_t {1} << 30);
+    traceGroup.read("data/cola.mseed");
+    std::vector<MiniSEED::SNCL> sncls;
+    for (const auto &channel : {"LH1", "LH2", "LHZ"})
+    {
+        MiniSEED::SNCL sncl;
+        sncl.setNetwork("IU");
+        sncl.setStation("COLA");
+        sncl.setChannel(channel);
+        sncl.setLocationCode("00");
+        EXPECT_TRUE(traceGroup.haveSNCL(sncl));
+        sncls.push_back(sncl);
+    }
+    // Indexing does not decode anything
+    auto statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.misses, 0);
+    EXPECT_EQ(statistics.nTraces, 0);
+    // Each trace has 4200 integer samples
+    constexpr size_t traceSize = 4200*sizeof(int);
+    auto lh1 = traceGroup.getTrace(sncls[0]);
+    auto lh1Again = traceGroup.getTrace(sncls[0]);
+    EXPECT_EQ(lh1.getData32i(), lh1Again.getData32i());
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.hits, 1);
+    EXPECT_EQ(statistics.misses, 1);
+    EXPECT_EQ(statistics.bytes, traceSize);
+    EXPECT_EQ(statistics.nTraces, 1);
+    // Room for two traces so LH1 is evicted when LHZ is decoded
+    traceGroup.setCacheSize(2*traceSize);
+    traceGroup.getTrace(sncls[1]);
+    traceGroup.getTrace(sncls[2]);
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.misses, 3);
+    EXPECT_EQ(statistics.evictions, 1);
+    EXPECT_EQ(statistics.nTraces, 2);
+    EXPECT_EQ(statistics.bytes, 2*traceSize);
+    // LH2 is now more recently used than LHZ so LHZ is evicted for LH1
+    traceGroup.getTrace(sncls[1]);
+    traceGroup.getTrace(sncls[0]);
+    traceGroup.getTrace(sncls[1]);
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.hits, 3);
+    EXPECT_EQ(statistics.misses, 4);
+    EXPECT_EQ(statistics.evictions, 2);
+    // Disable the cache
+    traceGroup.setCacheSize(0);
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.evictions, 4);
+    EXPECT_EQ(statistics.nTraces, 0);
+    EXPECT_EQ(statistics.bytes, 0);
+    EXPECT_EQ(traceGroup.getTrace(sncls[0]).getData32i(), lh1.getData32i());
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.misses, 5);
+    EXPECT_EQ(statistics.nTraces, 0);
+    // Shared handles reference one decoded trace
+    traceGroup.setCacheSize(size_t {1} << 30);
+    auto handle = traceGroup.getSharedTrace(sncls[2]);
+    auto handleAgain = traceGroup.getSharedTrace(sncls[2]);
+    EXPECT_EQ(handle.get(), handleAgain.get());
+    EXPECT_EQ(handle->getData32i(), traceGroup.getTrace(sncls[2]).getData32i());
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.misses, 6);
+    EXPECT_EQ(statistics.hits, 5);
+    // Concurrent requests share one decode
+    traceGroup.setCacheSize(0);
+    traceGroup.setCacheSize(size_t {1} << 30);
+    traceGroup.resetCacheStatistics();
+    std::vector<std::shared_ptr<const MiniSEED::Trace>> handles(4);
+    std::vector<std::thread> threads;
+    for (size_t i=0; i<handles.size(); ++i)
+    {
+        threads.emplace_back([&, i]()
+        {
+            handles[i] = traceGroup.getSharedTrace(sncls[i%2]);
+            EXPECT_EQ(traceGroup.getCacheSize(), size_t {1} << 30);
+        });
+    }
+    // The cache size can be changed while it is read
+    threads.emplace_back([&]()
+    {
+        traceGroup.setCacheSize(size_t {1} << 30);
+    });
+    for (auto &thread : threads){thread.join();}
+    EXPECT_EQ(handles[0].get(), handles[2].get());
+    EXPECT_EQ(handles[1].get(), handles[3].get());
+    EXPECT_EQ(handles[0]->getData32i(), lh1.getData32i());
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.misses, 2);
+    EXPECT_EQ(statistics.hits, 2);
+    EXPECT_EQ(statistics.nTraces, 2);
+    // Handles outlive eviction
+    traceGroup.clear();
+    EXPECT_EQ(handle->getNumberOfSamples(), 4200);
+    EXPECT_THROW(traceGroup.getSharedTrace(sncls[2]), std::invalid_argument);
+    traceGroup.resetCacheStatistics();
+    statistics = traceGroup.getCacheStatistics();
+    EXPECT_EQ(statistics.hits, 0);
+    EXPECT_EQ(statistics.misses, 0);
+    EXPECT_EQ(statistics.evictions, 0);
+}
+
+/// Packs the first differences of x into Steim frames
+std::vector<uint8_t> encodeSteim(const int version, const std::vector<int> &x)
+{
+    // (code, dnib, count, bits) from the most to least differences per word
+    struct Layout{uint32_t code; uint32_t dnib; int count; int bits;};
+    std::vector<Layout> layouts;
+    if (version == 1)
+    {
+        layouts = {{1, 0, 4, 8}, {2, 0, 2, 16}, {3, 0, 1, 32}};
+    }
+    else
+    {
+        layouts = {{3, 2, 7, 4}, {3, 1, 6, 5}, {3, 0, 5, 6}, {1, 0, 4, 8},
+                   {2, 3, 3, 10}, {2, 2, 2, 15}, {2, 1, 1, 30}};
+    }
+    std::vector<int64_t> diffs(x.size());
+    for (size_t i=0; i<x.size(); ++i)
+    {
+        diffs[i] = (i == 0) ? x[0] : static_cast<int64_t> (x[i]) - x[i-1];
+    }
+    std::vector<uint32_t> words;
+    size_t id = 0;
+    int word = 0;
+    while (id < diffs.size())
+    {
+        if (word%16 == 0)
+        {
+            words.push_back(0); // Control word
+            if (word == 0)
+            {
+                words.push_back(static_cast<uint32_t> (x.front()));
+                words.push_back(static_cast<uint32_t> (x.back()));
+                word = 2;
+            }
+            word = word + 1;
+            continue;
+        }
+        bool lpacked = false;
+        for (const auto &layout : layouts)
+        {
+            auto count = std::min(static_cast<size_t> (layout.count),
+                                  diffs.size() - id);
+            int64_t limit = int64_t {1} << (layout.bits - 1);
+            bool lfits = true;
+            for (size_t i=0; i<count; ++i)
+            {
+                if (diffs[id+i] < -limit || diffs[id+i] >= limit)
+                {
+                    lfits = false;
+                }
+            }
+            if (!lfits){continue;}
+            uint32_t packed = (layout.bits == 32) ? 0 : layout.dnib << 30;
+            for (int i=0; i<layout.count; ++i)
+            {
+                uint64_t mask = (uint64_t {1} << layout.bits) - 1;
+                uint64_t value = (static_cast<size_t> (i) < count) ?
+                                 static_cast<uint64_t> (diffs[id+i]) & mask : 0;
+                packed = packed | static_cast<uint32_t>
+                         (value << ((layout.count - 1 - i)*layout.bits));
+            }
+            auto frame = words.size()/16;
+            words[16*frame] = words[16*frame]
+                            | (layout.code << (30 - 2*(word%16)));
+            words.push_back(packed);
+            id = id + count;
+            lpacked = true;
+            break;
+        }
+        if (!lpacked)
+        {
+            throw std::invalid_argument("Difference does not fit in a word\n");
+        }
+        word = word + 1;
+    }
+    words.resize(16*((words.size() + 15)/16), 0);
+    std::vector<uint8_t> frames(4*words.size());
+    for (size_t i=0; i<words.size(); ++i)
+    {
+        frames[4*i]   = static_cast<uint8_t> (words[i] >> 24);
+        frames[4*i+1] = static_cast<uint8_t> (words[i] >> 16);
+        frames[4*i+2] = static_cast<uint8_t> (words[i] >> 8);
+        frames[4*i+3] = static_cast<uint8_t> (words[i]);
+    }
+    return frames;
 }
 
 std::vector<int>
@@ -2,11 +2,14 @@
 #include <cstdlib>
 #include <climits>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 #include "temblor/private/filesystem.hpp"
+#include "temblor/private/bufferPool.hpp"
 #include "temblor/utilities/time.hpp"
 #include "temblor/seismicDataIO/sac/waveform.hpp"
 #include "temblor/seismicDataIO/sac/header.hpp"
+#include "temblor/seismicDataIO/sac/catalog.hpp"
 #include "temblor/seismicDataIO/sac/enums.hpp"
 #include <gtest/gtest.h>
 
@@ -319,6 +322,49 @@ TEST(LibraryDataReadersSAC, header)
                                        "kinst");
 }
 
+TEST(LibraryDataReadersSAC, headerBinary)
+{
+    SAC::Header header;
+    header.read("data/debug.sac");
+    header.setHeader(SAC::Double::USER9, 1.5);
+    header.setHeader(SAC::Integer::UNUSED9, -7);
+    header.setHeader(SAC::Logical::LCALDA, true);
+    header.setHeader(SAC::Character::KEVNM, "sixteen chars ok");
+    header.setHeader(SAC::Character::KINST, "kinst");
+    // Both byte orders round trip
+    for (const auto lswap : {false, true})
+    {
+        char binaryHeader[632];
+        header.getBinaryHeader(binaryHeader, lswap);
+        SAC::Header headerCheck(binaryHeader, lswap);
+        EXPECT_EQ(headerCheck.getHeader(SAC::Integer::NPTS), 100);
+        EXPECT_NEAR(headerCheck.getHeader(SAC::Double::DELTA),
+                    0.005, 1.e-7);
+        EXPECT_NEAR(headerCheck.getHeader(SAC::Double::USER9), 1.5, 1.e-7);
+        EXPECT_EQ(headerCheck.getHeader(SAC::Integer::UNUSED9), -7);
+        EXPECT_EQ(headerCheck.getHeader(SAC::Logical::LCALDA), 1);
+        EXPECT_STREQ(headerCheck.getHeader(SAC::Character::KEVNM).c_str(),
+                     "sixteen chars ok");
+        EXPECT_STREQ(headerCheck.getHeader(SAC::Character::KINST).c_str(),
+                     "kinst");
+        EXPECT_STREQ(headerCheck.getHeader(SAC::Character::KNETWK).c_str(),
+                     "FK");
+        char binaryHeaderCheck[632];
+        headerCheck.getBinaryHeader(binaryHeaderCheck, lswap);
+        EXPECT_EQ(std::memcmp(binaryHeader, binaryHeaderCheck, 632), 0);
+    }
+    // Out of range time variables are rejected
+    EXPECT_THROW(header.setHeader(SAC::Integer::NZJDAY, 367),
+                 std::invalid_argument);
+    EXPECT_THROW(header.setHeader(SAC::Integer::NZMSEC, -1),
+                 std::invalid_argument);
+    EXPECT_THROW(header.setHeader(SAC::Integer::NPTS, -1),
+                 std::invalid_argument);
+    EXPECT_THROW(header.setHeader(SAC::Double::DELTA, 0),
+                 std::invalid_argument);
+    EXPECT_EQ(header.getHeader(SAC::Integer::NPTS), 100);
+}
+
 TEST(LibraryDataReadersSAC, headerRead)
 {
     const std::string sacFile = "data/debug.sac";
@@ -412,4 +458,419 @@ TEST(LibraryDataReadersSAC, waveform)
     EXPECT_EQ(startTime.getMicroSecond(), 850000);
 }
 
+TEST(LibraryDataReadersSAC, waveformFloat32)
+{
+    const std::string sacFile = "data/debug.sac";
+    SAC::Waveform waveform;
+    EXPECT_EQ(waveform.getPrecision(), SAC::Precision::FLOAT64);
+    waveform.setPrecision(SAC::Precision::FLOAT32);
+    waveform.read(sacFile);
+    EXPECT_EQ(waveform.getPrecision(), SAC::Precision::FLOAT32);
+    ASSERT_EQ(waveform.getNumberOfSamples(), 100);
+    EXPECT_TRUE(waveform.getDataPointer() == nullptr);
+    const float *fPtr = waveform.getDataPointer32f();
+    ASSERT_TRUE(fPtr != nullptr);
+    std::vector<float> reference(waveform.getNumberOfSamples());
+    for (int i=0; i<waveform.getNumberOfSamples(); ++i)
+    {
+        reference[i] = static_cast<float> (i + 1);
+        EXPECT_EQ(fPtr[i], reference[i]);
+    }
+    auto dVec = waveform.getData();
+    ASSERT_EQ(dVec.size(), reference.size());
+    for (size_t i=0; i<dVec.size(); ++i)
+    {
+        EXPECT_EQ(dVec[i], static_cast<double> (reference[i]));
+    }
+    // Both byte orders read back exactly
+#ifdef TEMBLOR_USE_FILESYSTEM
+    fs::path scratchFilePath = fs::temp_directory_path();
+    std::string scratchFile = std::string(scratchFilePath.c_str())
+                            + "/temp32.sac";
+#else
+    std::string scratchFile = "temp32.sac";
+#endif
+    for (const auto lswap : {false, true})
+    {
+        waveform.write(scratchFile, lswap);
+        for (const auto precision : {SAC::Precision::FLOAT32,
+                                     SAC::Precision::FLOAT64})
+        {
+            SAC::Waveform waveformRead;
+            waveformRead.setPrecision(precision);
+            waveformRead.read(scratchFile);
+            EXPECT_EQ(waveformRead.getPrecision(), precision);
+            ASSERT_EQ(waveformRead.getNumberOfSamples(), 100);
+            EXPECT_NEAR(waveformRead.getSamplingPeriod(), 0.005, 1.e-7);
+            std::vector<float> fVec(100);
+            float *fVecPtr = fVec.data();
+            waveformRead.getData(100, &fVecPtr);
+            EXPECT_EQ(fVec, reference);
+        }
+    }
+    std::remove(scratchFile.c_str());
+    // Changing the precision converts the samples
+    SAC::Waveform copy(waveform);
+    copy.setPrecision(SAC::Precision::FLOAT64);
+    ASSERT_TRUE(copy.getDataPointer() != nullptr);
+    EXPECT_TRUE(copy.getDataPointer32f() == nullptr);
+    EXPECT_EQ(copy.getData(), dVec);
+    EXPECT_EQ(waveform.getDataPointer32f()[99], 100.0f);
+    // Float samples can be set directly
+    waveform.setData(static_cast<int> (reference.size()) - 1,
+                     reference.data() + 1);
+    EXPECT_EQ(waveform.getNumberOfSamples(), 99);
+    EXPECT_EQ(waveform.getDataPointer32f()[0], 2.0f);
+    EXPECT_THROW(waveform.setData(0, reference.data()),
+                 std::invalid_argument);
+}
+
+
+TEST(LibraryDataReadersSAC, waveformWindow)
+{
+    const std::string sacFile = "data/debug.sac";
+    SAC::Waveform waveform;
+    waveform.read(sacFile);
+    auto startTime = waveform.getStartTime().getEpochalTime();
+    auto dt = waveform.getSamplingPeriod();
+#ifdef TEMBLOR_USE_FILESYSTEM
+    fs::path scratchFilePath = fs::temp_directory_path();
+    std::string scratchFile = std::string(scratchFilePath.c_str())
+                            + "/tempWindow.sac";
+#else
+    std::string scratchFile = "tempWindow.sac";
+#endif
+    for (const auto lswap : {false, true})
+    {
+        waveform.write(scratchFile, lswap);
+        for (const auto precision : {SAC::Precision::FLOAT64,
+                                     SAC::Precision::FLOAT32})
+        {
+            // Samples 10 through 20 inclusive
+            SAC::Waveform window;
+            window.setPrecision(precision);
+            window.read(scratchFile,
+                        Temblor::Utilities::Time(startTime + 10*dt),
+                        Temblor::Utilities::Time(startTime + 20*dt));
+            ASSERT_EQ(window.getNumberOfSamples(), 11);
+            EXPECT_NEAR(window.getStartTime().getEpochalTime(),
+                        startTime + 10*dt, 1.e-4);
+            EXPECT_NEAR(window.getHeader(SAC::Double::E)
+                      - window.getHeader(SAC::Double::B), 10*dt, 1.e-5);
+            EXPECT_STREQ(window.getHeader(SAC::Character::KSTNM).c_str(),
+                         "NEW");
+            auto data = window.getData();
+            for (int i=0; i<window.getNumberOfSamples(); ++i)
+            {
+                EXPECT_NEAR(data[i], i + 11, 1.e-7);
+            }
+            // Windows are clipped to the trace
+            window.read(scratchFile,
+                        Temblor::Utilities::Time(startTime - 10),
+                        Temblor::Utilities::Time(startTime + 2.5*dt));
+            ASSERT_EQ(window.getNumberOfSamples(), 3);
+            EXPECT_NEAR(window.getData()[2], 3, 1.e-7);
+            window.read(scratchFile,
+                        Temblor::Utilities::Time(startTime + 98.5*dt),
+                        Temblor::Utilities::Time(startTime + 1000));
+            ASSERT_EQ(window.getNumberOfSamples(), 1);
+            EXPECT_NEAR(window.getData()[0], 100, 1.e-7);
+        }
+    }
+    SAC::Waveform window;
+    EXPECT_THROW(window.read(scratchFile,
+                             Temblor::Utilities::Time(startTime + 1),
+                             Temblor::Utilities::Time(startTime + 2)),
+                 std::invalid_argument);
+    EXPECT_THROW(window.read(scratchFile,
+                             Temblor::Utilities::Time(startTime + 0.1),
+                             Temblor::Utilities::Time(startTime)),
+                 std::invalid_argument);
+    std::remove(scratchFile.c_str());
+}
+
+TEST(LibraryDataReadersSAC, waveformVersion7)
+{
+    const std::string sacFile = "data/debug.sac";
+    SAC::Waveform waveform;
+    waveform.read(sacFile);
+    // Three days into a continuous record a float cannot resolve a sample
+    const double b = 3*86400 + 0.123456789;
+    const double t5 = b + 42.000123;
+    const double dt = 0.005000001;
+    waveform.setHeader(SAC::Integer::NVHDR, 7);
+    waveform.setHeader(SAC::Double::DELTA, dt);
+    waveform.setHeader(SAC::Double::B, b);
+    waveform.setHeader(SAC::Double::E, b + 99*dt);
+    waveform.setHeader(SAC::Double::T5, t5);
+    waveform.setHeader(SAC::Double::EVLA, 40.123456789);
+#ifdef TEMBLOR_USE_FILESYSTEM
+    fs::path scratchFilePath = fs::temp_directory_path();
+    std::string scratchFile = std::string(scratchFilePath.c_str())
+                            + "/temp7.sac";
+#else
+    std::string scratchFile = "temp7.sac";
+#endif
+    for (const auto lswap : {false, true})
+    {
+        waveform.write(scratchFile, lswap);
+#ifdef TEMBLOR_USE_FILESYSTEM
+        EXPECT_EQ(fs::file_size(scratchFile), 632 + 4*100 + 176);
+#endif
+        SAC::Waveform waveformRead;
+        waveformRead.read(scratchFile);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Integer::NVHDR), 7);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Double::DELTA), dt);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Double::B), b);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Double::E), b + 99*dt);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Double::T5), t5);
+        EXPECT_EQ(waveformRead.getHeader(SAC::Double::EVLA), 40.123456789);
+        // Variables that are not in the footer are still floats
+        EXPECT_NEAR(waveformRead.getHeader(SAC::Double::EVLO), 30, 1.e-5);
+        EXPECT_EQ(waveformRead.getData(), waveform.getData());
+        // The header alone
+        SAC::Header header;
+        header.read(scratchFile);
+        EXPECT_EQ(header.getHeader(SAC::Double::B), b);
+        EXPECT_EQ(header.getHeader(SAC::Double::T5), t5);
+        // A window is sample accurate
+        auto startTime = waveformRead.getStartTime().getEpochalTime();
+        SAC::Waveform window;
+        window.read(scratchFile,
+                    Temblor::Utilities::Time(startTime + 50*dt),
+                    Temblor::Utilities::Time(startTime + 59*dt));
+        ASSERT_EQ(window.getNumberOfSamples(), 10);
+        EXPECT_NEAR(window.getHeader(SAC::Double::B), b + 50*dt, 1.e-9);
+        EXPECT_NEAR(window.getData()[0], 51, 1.e-7);
+    }
+    // Version 6 files truncate to float
+    waveform.setHeader(SAC::Integer::NVHDR, 6);
+    waveform.write(scratchFile);
+    SAC::Waveform waveformRead;
+    waveformRead.read(scratchFile);
+    EXPECT_EQ(waveformRead.getHeader(SAC::Double::B),
+              static_cast<double> (static_cast<float> (b)));
+    std::remove(scratchFile.c_str());
+}
+
+#ifdef TEMBLOR_USE_FILESYSTEM
+TEST(LibraryDataReadersSAC, waveformWriteMany)
+{
+    // Longer than a write block and not a multiple of it
+    const int npts = 40003;
+    std::vector<double> x(npts);
+    for (int i=0; i<npts; ++i)
+    {
+        x[i] = static_cast<float> (std::sin(0.01*i) + i);
+    }
+    SAC::Waveform waveform;
+    waveform.setHeader(SAC::Double::DELTA, 0.01);
+    waveform.setStartTime(Temblor::Utilities::Time(1577836800));
+    waveform.setData(npts, x.data());
+    auto directory = fs::temp_directory_path()/"temblorWriteMany";
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    auto fileName = (directory/"long.sac").string();
+    for (const auto nvhdr : {6, 7})
+    {
+        waveform.setHeader(SAC::Integer::NVHDR, nvhdr);
+        for (const auto precision : {SAC::Precision::FLOAT64,
+                                     SAC::Precision::FLOAT32})
+        {
+            waveform.setPrecision(precision);
+            for (const auto lswap : {false, true})
+            {
+                waveform.write(fileName, lswap);
+                EXPECT_EQ(fs::file_size(fileName),
+                          632 + 4*npts + (nvhdr == 7 ? 176 : 0));
+                SAC::Waveform waveformRead;
+                waveformRead.setPrecision(precision);
+                waveformRead.read(fileName);
+                EXPECT_EQ(waveformRead.getHeader(SAC::Integer::NVHDR), nvhdr);
+                EXPECT_EQ(waveformRead.getData(), waveform.getData());
+            }
+        }
+    }
+    // Many waveforms
+    std::vector<SAC::Waveform> waveforms;
+    std::vector<std::string> fileNames;
+    for (int i=0; i<20; ++i)
+    {
+        SAC::Waveform w;
+        w.setHeader(SAC::Double::DELTA, 0.01);
+        w.setHeader(SAC::Character::KSTNM, "S" + std::to_string(i));
+        w.setData(100 + i, x.data() + i);
+        waveforms.push_back(std::move(w));
+        fileNames.push_back((directory/(std::to_string(i) + ".sac")).string());
+    }
+    SAC::Waveform::writeMany(waveforms, fileNames, true, 3);
+    for (int i=0; i<20; ++i)
+    {
+        SAC::Waveform waveformRead;
+        waveformRead.read(fileNames[i]);
+        EXPECT_EQ(waveformRead.getNumberOfSamples(), 100 + i);
+        EXPECT_STREQ(waveformRead.getHeader(SAC::Character::KSTNM).c_str(),
+                     ("S" + std::to_string(i)).c_str());
+        EXPECT_EQ(waveformRead.getData(), waveforms[i].getData());
+    }
+    fileNames.pop_back();
+    EXPECT_THROW(SAC::Waveform::writeMany(waveforms, fileNames),
+                 std::invalid_argument);
+    fileNames.push_back((directory/"missing"/"x.sac").string());
+    EXPECT_THROW(SAC::Waveform::writeMany(waveforms, fileNames, false, 2),
+                 std::runtime_error);
+    fs::remove_all(directory);
+}
+#endif
+
+TEST(LibraryDataReadersSAC, bufferPool)
+{
+    const std::string sacFile = "data/debug.sac";
+    auto &pool = Temblor::Private::BufferPool::instance();
+    EXPECT_EQ(pool.getCapacity(1), 64);
+    EXPECT_EQ(pool.getCapacity(64), 64);
+    EXPECT_EQ(pool.getCapacity(65), 128);
+    EXPECT_EQ(pool.getCapacity(800), 896);
+    // Quarter octave classes waste little on large traces and the largest
+    // buffers are not rounded up at all
+    for (size_t nBytes=257; nBytes<pool.MAXIMUM_POOLED_BYTES; nBytes=3*nBytes)
+    {
+        auto capacity = pool.getCapacity(nBytes);
+        EXPECT_GE(capacity, nBytes);
+        EXPECT_LT(capacity, nBytes + nBytes/4 + pool.ALIGNMENT);
+        EXPECT_EQ(pool.getCapacity(capacity), capacity);
+    }
+    EXPECT_EQ(pool.getCapacity(pool.MAXIMUM_POOLED_BYTES),
+              pool.MAXIMUM_POOLED_BYTES);
+    EXPECT_EQ(pool.getCapacity(513*1024*1024 + 1), 513*1024*1024 + 64);
+    // Load, copy, and discard waveforms.  After the first cycle the
+    // samples should come from the pool.
+    {
+        SAC::Waveform waveform;
+        waveform.read(sacFile);
+        SAC::Waveform copy(waveform);
+    }
+    auto before = pool.getStatistics();
+    for (int k=0; k<100; ++k)
+    {
+        SAC::Waveform w;
+        w.read(sacFile);
+        SAC::Waveform copy(w);
+        EXPECT_EQ(copy.getNumberOfSamples(), 100);
+    }
+    auto after = pool.getStatistics();
+    EXPECT_EQ(after.nAcquired - before.nAcquired, 200);
+    EXPECT_EQ(after.nReused - before.nReused, 200);
+    EXPECT_EQ(after.bytesLive, before.bytesLive);
+    EXPECT_GE(after.peakBytesLive,
+              after.bytesLive + 2*pool.getCapacity(100*sizeof(double)));
+    EXPECT_GT(after.getReuseRate(), 0);
+    // Trimming returns the cached buffers to the system
+    pool.trim();
+    EXPECT_LT(pool.getStatistics().bytesCached, after.bytesCached);
+    EXPECT_EQ(pool.getStatistics().bytesLive, after.bytesLive);
+}
+
+#ifdef TEMBLOR_USE_FILESYSTEM
+TEST(LibraryDataReadersSAC, catalog)
+{
+    const std::string sacFile = "data/debug.sac";
+    auto directory = fs::temp_directory_path()/"temblorCatalog";
+    fs::remove_all(directory);
+    fs::create_directories(directory/"a");
+    fs::create_directories(directory/"b"/"c");
+    SAC::Waveform waveform;
+    waveform.read(sacFile);
+    auto startTime = waveform.getStartTime().getEpochalTime();
+    auto oneFile = (directory/"a"/"one.sac").string();
+    auto twoFile = (directory/"b"/"c"/"two.sac").string();
+    auto threeFile = (directory/"b"/"three.sac").string();
+    waveform.write(oneFile);
+    // A byte swapped file with picks and an event
+    SAC::Waveform two(waveform);
+    two.setHeader(SAC::Character::KSTNM, "ABC");
+    two.setHeader(SAC::Double::T0, two.getHeader(SAC::Double::B) + 1.5);
+    two.setHeader(SAC::Double::T9, two.getHeader(SAC::Double::B) + 2.5);
+    two.setHeader(SAC::Double::EVLA, 40);
+    two.setHeader(SAC::Double::EVLO, -111);
+    two.write(twoFile, true);
+    // An earlier file
+    SAC::Waveform three(waveform);
+    three.setHeader(SAC::Character::KSTNM, "ZZZ");
+    three.setStartTime(Temblor::Utilities::Time(startTime - 10));
+    three.setHeader(SAC::Double::EVLA, -12345);
+    three.write(threeFile);
+    // Something that is not a SAC file
+    auto notes = fopen((directory/"b"/"notes.txt").string().c_str(), "w");
+    ASSERT_TRUE(notes != nullptr);
+    fprintf(notes, "not a sac file\n");
+    fclose(notes);
+
+    SAC::Catalog catalog;
+    EXPECT_THROW(catalog.setNumberOfThreads(0), std::invalid_argument);
+    EXPECT_THROW(catalog.scan((directory/"missing").string()),
+                 std::invalid_argument);
+    catalog.setNumberOfThreads(2);
+    EXPECT_EQ(catalog.getNumberOfThreads(), 2);
+    catalog.scan(directory.string());
+    ASSERT_EQ(catalog.getNumberOfRows(), 3);
+    EXPECT_EQ(catalog.getNumberOfFilesSkipped(), 1);
+    std::vector<std::string> fileNames{oneFile, twoFile, threeFile};
+    EXPECT_EQ(catalog.getFileNames(), fileNames);
+    std::vector<std::string> stations{"NEW", "ABC", "ZZZ"};
+    EXPECT_EQ(catalog.getStations(), stations);
+    for (int row=0; row<catalog.getNumberOfRows(); ++row)
+    {
+        EXPECT_EQ(catalog.getNetworks()[row], "FK");
+        EXPECT_EQ(catalog.getChannels()[row], "HHZ");
+        EXPECT_EQ(catalog.getLocationCodes()[row], "10");
+        EXPECT_EQ(catalog.getNumberOfSamples()[row], 100);
+        EXPECT_NEAR(catalog.getSamplingPeriods()[row], 0.005, 1.e-7);
+    }
+    EXPECT_NEAR(catalog.getStartTimes()[0], startTime, 1.e-3);
+    EXPECT_NEAR(catalog.getStartTimes()[1], startTime, 1.e-3);
+    EXPECT_NEAR(catalog.getStartTimes()[2], startTime - 10, 1.e-3);
+    EXPECT_NEAR(catalog.getEventLatitudes()[0], 20, 1.e-5);
+    EXPECT_TRUE(std::isnan(catalog.getEventLatitudes()[2]));
+    EXPECT_NEAR(catalog.getEventLatitudes()[1], 40, 1.e-5);
+    EXPECT_NEAR(catalog.getEventLongitudes()[1], -111, 1.e-5);
+    EXPECT_TRUE(std::isnan(catalog.getPicks(0)[0]));
+    EXPECT_NEAR(catalog.getPicks(0)[1], startTime + 1.5, 1.e-3);
+    EXPECT_NEAR(catalog.getPicks(9)[1], startTime + 2.5, 1.e-3);
+    EXPECT_TRUE(std::isnan(catalog.getPicks(5)[1]));
+    EXPECT_THROW(catalog.getPicks(10), std::invalid_argument);
+    // Sorting
+    catalog.sort(SAC::CatalogColumn::START_TIME);
+    EXPECT_EQ(catalog.getFileNames()[0], threeFile);
+    EXPECT_EQ(catalog.getFileNames()[1], oneFile);
+    catalog.sort(SAC::CatalogColumn::SNCL, false);
+    stations = {"ZZZ", "NEW", "ABC"};
+    EXPECT_EQ(catalog.getStations(), stations);
+    catalog.sort(SAC::CatalogColumn::EVENT_LATITUDE);
+    fileNames = {oneFile, twoFile, threeFile};
+    EXPECT_EQ(catalog.getFileNames(), fileNames);
+    catalog.sort(SAC::CatalogColumn::EVENT_LATITUDE, false);
+    fileNames = {twoFile, oneFile, threeFile};
+    EXPECT_EQ(catalog.getFileNames(), fileNames);
+    EXPECT_NEAR(catalog.getPicks(0)[0], startTime + 1.5, 1.e-3);
+    catalog.sort(SAC::CatalogColumn::FILE_NAME);
+    fileNames = {oneFile, twoFile, threeFile};
+    EXPECT_EQ(catalog.getFileNames(), fileNames);
+    // Filtering
+    SAC::Catalog copy(catalog);
+    copy.filter([](const SAC::Catalog &c, const int row)
+    {
+        return c.getStations()[row] != "ZZZ";
+    });
+    ASSERT_EQ(copy.getNumberOfRows(), 2);
+    EXPECT_EQ(copy.getFileNames()[1], twoFile);
+    EXPECT_EQ(copy.getStations()[1], "ABC");
+    EXPECT_EQ(catalog.getNumberOfRows(), 3);
+    copy.clear();
+    EXPECT_EQ(copy.getNumberOfRows(), 0);
+    EXPECT_EQ(copy.getNumberOfThreads(), 2);
+    fs::remove_all(directory);
+}
+#endif
+
 }
@@ -1,19 +1,578 @@
 #include <cstdio>
 #include <cstdlib>
 #include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <limits>
+#include <fstream>
 #include "temblor/private/filesystem.hpp"
-#include "temblor/dataReaders/segy/segy2.hpp"
+#include "temblor/private/ibmFloat.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/segy/segy2.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+#include "temblor/seismicDataIO/segy/gatherIndex.hpp"
+#include "temblor/seismicDataIO/segy/segy2Writer.hpp"
 #include <gtest/gtest.h>
 
 namespace
 {
 
-using namespace Temblor::DataReaders;
+using namespace Temblor::SeismicDataIO;
+
+std::string makeScratchFileName(const std::string &name)
+{
+#ifdef TEMBLOR_USE_FILESYSTEM
+    fs::path scratchFilePath = fs::temp_directory_path();
+    return std::string(scratchFilePath.c_str()) + "/" + name;
+#else
+    return name;
+#endif
+}
+
+TEST(LibraryDataReadersSEGY, ibmFloat)
+{
+    namespace Private = Temblor::Private;
+    // Known values
+    EXPECT_EQ(Private::ibmToDouble(0x41100000), 1.0);
+    EXPECT_EQ(Private::ibmToDouble(0xc276a000), -118.625);
+    EXPECT_EQ(Private::doubleToIBM(1.0), 0x41100000u);
+    EXPECT_EQ(Private::doubleToIBM(-118.625), 0xc276a000u);
+    EXPECT_EQ(Private::doubleToIBM(0.0), 0u);
+    EXPECT_EQ(Private::doubleToIBM(1.e100), 0x7fffffffu);
+    EXPECT_EQ(Private::doubleToIBM(-std::numeric_limits<double>::infinity()),
+              0xffffffffu);
+    EXPECT_EQ(Private::doubleToIBM(1.e-100), 0u);
+    // The vector kernels must match the scalar reference bit for bit.
+    // An odd length exercises the remainder.
+    constexpr int n = 100003;
+    std::mt19937 generator(86754);
+    std::vector<uint32_t> ibm(n);
+    for (auto &u4 : ibm){u4 = generator();}
+    ibm[0] = 0x00000000;
+    ibm[1] = 0x80000000;
+    ibm[2] = 0x7fffffff;
+    ibm[3] = 0x00000001;
+    std::vector<float> x32(n);
+    for (auto &x : x32)
+    {
+        auto u4 = static_cast<uint32_t> (generator());
+        std::memcpy(&x, &u4, sizeof(float));
+    }
+    x32[0] = std::numeric_limits<float>::quiet_NaN();
+    x32[1] = std::numeric_limits<float>::denorm_min();
+    for (const auto lswap : {false, true})
+    {
+        auto c = reinterpret_cast<const char *> (ibm.data());
+        std::vector<double> y(n), yRef(n);
+        std::vector<float> y32(n), y32Ref(n);
+        Private::unpackIBM32(n, c, y.data(), lswap);
+        Private::unpackIBM32<double>(n, c, yRef.data(), lswap);
+        Private::unpackIBM32(n, c, y32.data(), lswap);
+        Private::unpackIBM32<float>(n, c, y32Ref.data(), lswap);
+        EXPECT_EQ(std::memcmp(y.data(), yRef.data(), sizeof(double)*n), 0);
+        EXPECT_EQ(std::memcmp(y32.data(), y32Ref.data(), sizeof(float)*n), 0);
+        std::vector<uint32_t> packed(n), packedRef(n);
+        auto p = reinterpret_cast<char *> (packed.data());
+        auto pRef = reinterpret_cast<char *> (packedRef.data());
+        Private::packIBM32(n, y.data(), p, lswap);
+        Private::packIBM32<double>(n, y.data(), pRef, lswap);
+        EXPECT_EQ(packed, packedRef);
+        Private::packIBM32(n, x32.data(), p, lswap);
+        Private::packIBM32<float>(n, x32.data(), pRef, lswap);
+        EXPECT_EQ(packed, packedRef);
+        // Normalized IBM floats survive a round trip through double
+        Private::packIBM32(n, y.data(), p, lswap);
+        for (int i=0; i<n; ++i)
+        {
+            auto u4 = lswap ? __builtin_bswap32(ibm[i]) : ibm[i];
+            auto v4 = lswap ? __builtin_bswap32(packed[i]) : packed[i];
+            if ((u4 & 0x00f00000) != 0){EXPECT_EQ(u4, v4);}
+        }
+    }
+}
 
 TEST(LibraryDataReadersSEGY, segy2)
 {
     SEGY::Segy2 segy2;
     segy2.read("data/small.sgy");
+    EXPECT_EQ(segy2.getTextualHeader().substr(0, 3), "C 1");
+    auto binaryHeader = segy2.getBinaryFileHeader();
+    EXPECT_EQ(binaryHeader.getNumberOfTracesPerEnsemble(), 25u);
+    EXPECT_EQ(binaryHeader.getSampleInterval(), 4000);
+    EXPECT_EQ(binaryHeader.getNumberOfSamplesPerTrace(), 50u);
+    EXPECT_EQ(binaryHeader.getDataFormat(), SEGY::DataFormat::IBM_FLOAT);
+    EXPECT_TRUE(binaryHeader.haveFixedLengthTraces());
+    EXPECT_FALSE(binaryHeader.isLittleEndian());
+    ASSERT_EQ(segy2.getNumberOfTraces(), 25);
+    std::vector<double> x(50);
+    std::vector<float> x32(50);
+    auto xPtr = x.data();
+    auto x32Ptr = x32.data();
+    // Visit the traces out of order
+    for (int i=0; i<25; ++i)
+    {
+        auto trace = (7*i)%25;
+        EXPECT_EQ(segy2.getNumberOfSamples(trace), 50);
+        // The traces are a 5 x 5 grid of inlines and crosslines
+        auto inLine = 1 + trace/5;
+        auto crossLine = 20 + trace%5;
+        auto traceHeader = segy2.getTraceHeader(trace);
+        EXPECT_EQ(traceHeader.getHeader(SEGY::TraceHeaderField::INLINE_NUMBER),
+                  inLine);
+        EXPECT_EQ(traceHeader.getHeader(
+                      SEGY::TraceHeaderField::CROSSLINE_NUMBER), crossLine);
+        segy2.getTrace(trace, 50, &xPtr);
+        segy2.getTrace(trace, 50, &x32Ptr);
+        for (int j=0; j<50; ++j)
+        {
+            EXPECT_NEAR(x[j], inLine + 0.01*crossLine + 1.e-5*j, 1.e-5);
+            EXPECT_EQ(static_cast<float> (x[j]), x32[j]);
+        }
+    }
+    // The first sample is 0x4133 3333 in IBM format
+    segy2.getTrace(0, 50, &xPtr);
+    EXPECT_NEAR(x[0], 1.1999998092651367, 1.e-14);
+    EXPECT_THROW(segy2.getTraceHeader(25), std::invalid_argument);
+    EXPECT_THROW(segy2.getTrace(-1, 50, &xPtr), std::invalid_argument);
+    EXPECT_THROW(segy2.getTrace(0, 49, &xPtr), std::invalid_argument);
+}
+
+TEST(LibraryDataReadersSEGY, traceHeader)
+{
+    SEGY::TraceHeader header;
+    header.setHeader(SEGY::TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_LINE,
+                     -123456);
+    header.setHeader(SEGY::TraceHeaderField::SOURCE_X, 4567890);
+    header.setHeader(SEGY::TraceHeaderField::COORDINATE_SCALAR, -100);
+    header.setHeader(SEGY::TraceHeaderField::NUMBER_OF_SAMPLES, 60000);
+    header.setHeader(SEGY::TraceHeaderField::SAMPLE_INTERVAL, 2000);
+    header.setHeader(SEGY::TraceHeaderField::YEAR, 2019);
+    header.setHeader(SEGY::TraceHeaderField::DAY_OF_YEAR, 32);
+    header.setHeader(SEGY::TraceHeaderField::HOUR, 3);
+    header.setHeader(SEGY::TraceHeaderField::MINUTE, 4);
+    header.setHeader(SEGY::TraceHeaderField::SECOND, 5);
+    header.setHeader(SEGY::TraceHeaderField::DELAY_RECORDING_TIME, 250);
+    EXPECT_THROW(header.setHeader(SEGY::TraceHeaderField::HOUR, 40000),
+                 std::invalid_argument);
+    EXPECT_THROW(header.setHeader(SEGY::TraceHeaderField::SAMPLE_INTERVAL,
+                                  -1), std::invalid_argument);
+    // Round trip through both byte orders
+    for (const auto littleEndian : {false, true})
+    {
+        char cheader[240];
+        header.getBinaryHeader(cheader, littleEndian);
+        if (!littleEndian)
+        {
+            // SOURCE_X is big-endian at bytes 73-76
+            EXPECT_EQ(static_cast<unsigned char> (cheader[72]), 0x00);
+            EXPECT_EQ(static_cast<unsigned char> (cheader[73]), 0x45);
+            EXPECT_EQ(static_cast<unsigned char> (cheader[74]), 0xb3);
+            EXPECT_EQ(static_cast<unsigned char> (cheader[75]), 0x52);
+        }
+        SEGY::TraceHeader headerRead;
+        headerRead.setBinaryHeader(cheader, littleEndian);
+        EXPECT_EQ(headerRead.getHeader(
+                SEGY::TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_LINE),
+                -123456);
+        EXPECT_EQ(headerRead.getHeader(SEGY::TraceHeaderField::SOURCE_X),
+                  4567890);
+        EXPECT_EQ(headerRead.getHeader(
+                      SEGY::TraceHeaderField::COORDINATE_SCALAR), -100);
+        EXPECT_EQ(headerRead.getHeader(
+                      SEGY::TraceHeaderField::NUMBER_OF_SAMPLES), 60000);
+        EXPECT_NEAR(headerRead.getSamplingPeriod(), 0.002, 1.e-14);
+        Temblor::Utilities::Time startTime;
+        startTime.setYear(2019);
+        startTime.setJulianDay(32);
+        startTime.setHour(3);
+        startTime.setMinute(4);
+        startTime.setSecond(5);
+        EXPECT_NEAR(headerRead.getStartTime().getEpochalTime(),
+                    startTime.getEpochalTime() + 0.25, 1.e-6);
+    }
+}
+
+TEST(LibraryDataReadersSEGY, segy2VariableLength)
+{
+    // Revision 2 big-endian file with traces of different lengths
+    SEGY::BinaryFileHeader binaryHeader(2, 0);
+    binaryHeader.setSampleInterval(1000);
+    binaryHeader.setNumberOfSamplesPerTrace(5);
+    binaryHeader.setDataFormat(SEGY::DataFormat::IEEE_FLOAT);
+    EXPECT_FALSE(binaryHeader.haveFixedLengthTraces());
+    std::vector<char> file(3600, ' ');
+    binaryHeader.getBinaryHeader(file.data() + 3200);
+    const std::vector<int> nSamples{5, 0, 3, 12, 1};
+    for (int i=0; i<static_cast<int> (nSamples.size()); ++i)
+    {
+        SEGY::TraceHeader traceHeader;
+        traceHeader.setHeader(
+            SEGY::TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_FILE, i + 1);
+        traceHeader.setHeader(SEGY::TraceHeaderField::NUMBER_OF_SAMPLES,
+                              nSamples[i]);
+        char cheader[240];
+        traceHeader.getBinaryHeader(cheader);
+        file.insert(file.end(), cheader, cheader + 240);
+        for (int j=0; j<nSamples[i]; ++j)
+        {
+            float sample = 100*i + j;
+            uint32_t u4;
+            std::memcpy(&u4, &sample, sizeof(float));
+            for (int k=3; k>=0; --k)
+            {
+                file.push_back(static_cast<char> ((u4 >> (8*k)) & 0xff));
+            }
+        }
+    }
+    auto scratchFile = makeScratchFileName("tempVariable.sgy");
+    std::ofstream(scratchFile, std::ios::binary).write(file.data(),
+                                                       file.size());
+    SEGY::Segy2 segy2;
+    segy2.read(scratchFile);
+    ASSERT_EQ(segy2.getNumberOfTraces(), static_cast<int> (nSamples.size()));
+    std::vector<double> x(12);
+    auto xPtr = x.data();
+    for (int i=static_cast<int> (nSamples.size()) - 1; i>=0; --i)
+    {
+        EXPECT_EQ(segy2.getNumberOfSamples(i), nSamples[i]);
+        auto traceHeader = segy2.getTraceHeader(i);
+        EXPECT_EQ(traceHeader.getHeader(
+                  SEGY::TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_FILE),
+                  i + 1);
+        segy2.getTrace(i, 12, &xPtr);
+        for (int j=0; j<nSamples[i]; ++j)
+        {
+            EXPECT_EQ(x[j], 100*i + j);
+        }
+    }
+    // Truncate the last trace
+    std::ofstream(scratchFile, std::ios::binary).write(file.data(),
+                                                       file.size() - 1);
+    EXPECT_THROW(segy2.read(scratchFile), std::invalid_argument);
+    std::remove(scratchFile.c_str());
+}
+
+TEST(LibraryDataReadersSEGY, segy2LittleEndian)
+{
+    // Revision 2 little-endian file with fixed length IEEE doubles and an
+    // extended textual header
+    constexpr int nTraces = 4;
+    constexpr int nSamples = 7;
+    std::vector<char> file(3600 + 3200, ' ');
+    auto binaryHeader = file.data() + 3200;
+    std::memset(binaryHeader, 0, 400);
+    int16_t i2 = nSamples;
+    std::memcpy(binaryHeader + 20, &i2, sizeof(int16_t));
+    i2 = 6;
+    std::memcpy(binaryHeader + 24, &i2, sizeof(int16_t));
+    uint32_t constant = 0x01020304;
+    std::memcpy(binaryHeader + 96, &constant, sizeof(uint32_t));
+    binaryHeader[300] = 2;
+    i2 = 1;
+    std::memcpy(binaryHeader + 302, &i2, sizeof(int16_t)); // Fixed length
+    std::memcpy(binaryHeader + 304, &i2, sizeof(int16_t)); // 1 extended
+    for (int i=0; i<nTraces; ++i)
+    {
+        SEGY::TraceHeader traceHeader;
+        traceHeader.setHeader(SEGY::TraceHeaderField::CDP_X, -i);
+        char cheader[240];
+        traceHeader.getBinaryHeader(cheader, true);
+        file.insert(file.end(), cheader, cheader + 240);
+        for (int j=0; j<nSamples; ++j)
+        {
+            double sample = -0.5*i + j;
+            char c8[8];
+            std::memcpy(c8, &sample, sizeof(double));
+            file.insert(file.end(), c8, c8 + 8);
+        }
+    }
+    auto scratchFile = makeScratchFileName("tempLittleEndian.sgy");
+    std::ofstream(scratchFile, std::ios::binary).write(file.data(),
+                                                       file.size());
+    SEGY::Segy2 segy2;
+    segy2.read(scratchFile);
+    EXPECT_TRUE(segy2.getBinaryFileHeader().isLittleEndian());
+    EXPECT_EQ(segy2.getBinaryFileHeader().getMajorRevision(), 2);
+    ASSERT_EQ(segy2.getNumberOfTraces(), nTraces);
+    std::vector<float> x(nSamples);
+    auto xPtr = x.data();
+    for (int i=0; i<nTraces; ++i)
+    {
+        EXPECT_EQ(segy2.getTraceHeader(i).getHeader(
+                      SEGY::TraceHeaderField::CDP_X), -i);
+        segy2.getTrace(i, nSamples, &xPtr);
+        for (int j=0; j<nSamples; ++j)
+        {
+            EXPECT_EQ(x[j], static_cast<float> (-0.5*i + j));
+        }
+    }
+    // A partial trace is inconsistent with fixed length traces
+    file.push_back(0);
+    std::ofstream(scratchFile, std::ios::binary).write(file.data(),
+                                                       file.size());
+    EXPECT_THROW(segy2.read(scratchFile), std::invalid_argument);
+    std::remove(scratchFile.c_str());
+}
+
+TEST(LibraryDataReadersSEGY, gatherIndex)
+{
+    using SEGY::TraceHeaderField;
+    // Shot ordered survey of variable length IBM traces
+    constexpr int nShots = 30;
+    constexpr int nReceivers = 20;
+    constexpr bool lswap = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+    SEGY::BinaryFileHeader binaryHeader(2, 0);
+    binaryHeader.setSampleInterval(1000);
+    binaryHeader.setNumberOfSamplesPerTrace(4);
+    binaryHeader.setDataFormat(SEGY::DataFormat::IBM_FLOAT);
+    binaryHeader.setTraceSortingCode(SEGY::TraceSortingCode::AS_REOCORDED);
+    std::vector<char> file(3600, ' ');
+    binaryHeader.getBinaryHeader(file.data() + 3200);
+    auto getOffset = [](const int shot, const int receiver)
+    {
+        return std::abs(100*receiver - 70*shot);
+    };
+    for (int shot=0; shot<nShots; ++shot)
+    {
+        for (int receiver=0; receiver<nReceivers; ++receiver)
+        {
+            auto trace = shot*nReceivers + receiver;
+            auto nSamples = 4 + trace%3;
+            SEGY::TraceHeader traceHeader;
+            traceHeader.setHeader(TraceHeaderField::FIELD_RECORD_NUMBER,
+                                  shot + 1);
+            traceHeader.setHeader(
+                TraceHeaderField::TRACE_NUMBER_IN_FIELD_RECORD, receiver + 1);
+            traceHeader.setHeader(TraceHeaderField::GROUP_X, 100*receiver);
+            traceHeader.setHeader(TraceHeaderField::SOURCE_RECEIVER_OFFSET,
+                                  getOffset(shot, receiver));
+            traceHeader.setHeader(TraceHeaderField::NUMBER_OF_SAMPLES,
+                                  nSamples);
+            char cheader[240];
+            traceHeader.getBinaryHeader(cheader);
+            file.insert(file.end(), cheader, cheader + 240);
+            std::vector<double> samples(nSamples);
+            for (int j=0; j<nSamples; ++j){samples[j] = trace + 0.25*j;}
+            std::vector<char> packed(4*nSamples);
+            Temblor::Private::packIBM32<double>(nSamples, samples.data(),
+                                                packed.data(), lswap);
+            file.insert(file.end(), packed.begin(), packed.end());
+        }
+    }
+    auto segyFile = makeScratchFileName("tempGather.sgy");
+    auto indexFile = makeScratchFileName("tempGather.idx");
+    std::ofstream(segyFile, std::ios::binary).write(file.data(),
+                                                    file.size());
+    const std::vector<TraceHeaderField> keys{
+        TraceHeaderField::FIELD_RECORD_NUMBER,
+        TraceHeaderField::TRACE_NUMBER_IN_FIELD_RECORD,
+        TraceHeaderField::GROUP_X,
+        TraceHeaderField::SOURCE_RECEIVER_OFFSET};
+    SEGY::GatherIndex index;
+    EXPECT_THROW(index.setMaximumMemory(100), std::invalid_argument);
+    // Force several runs and merge passes
+    index.setMaximumMemory(4096);
+    EXPECT_THROW(index.build(segyFile, {TraceHeaderField::GROUP_X,
+                                        TraceHeaderField::GROUP_X},
+                             indexFile), std::invalid_argument);
+    index.build(segyFile, keys, indexFile);
+    EXPECT_EQ(index.getNumberOfTraces(), nShots*nReceivers);
+    EXPECT_EQ(index.getKeys(), keys);
+    EXPECT_TRUE(index.getSortKeys().empty());
+    EXPECT_EQ(index.getNativeSortingCode(),
+              SEGY::TraceSortingCode::AS_REOCORDED);
+    EXPECT_THROW(index.getGather({1}), std::invalid_argument);
+    EXPECT_THROW(index.sort({TraceHeaderField::CDP_X}),
+                 std::invalid_argument);
+    // The native order is verified and the sort is skipped
+    EXPECT_FALSE(index.sort({TraceHeaderField::FIELD_RECORD_NUMBER}));
+    auto shotGather = index.getGather({4});
+    ASSERT_EQ(static_cast<int> (shotGather.size()), nReceivers);
+    for (int receiver=0; receiver<nReceivers; ++receiver)
+    {
+        EXPECT_EQ(shotGather[receiver].trace, 3*nReceivers + receiver);
+        EXPECT_EQ(shotGather[receiver].keys[2], 100*receiver);
+    }
+    // Regroup by receiver then offset
+    const std::vector<TraceHeaderField> receiverKeys{
+        TraceHeaderField::GROUP_X, TraceHeaderField::SOURCE_RECEIVER_OFFSET};
+    EXPECT_TRUE(index.sort(receiverKeys));
+    EXPECT_EQ(index.getSortKeys(), receiverKeys);
+    EXPECT_FALSE(index.sort(receiverKeys));
+#ifdef TEMBLOR_USE_FILESYSTEM
+    EXPECT_FALSE(fs::exists(indexFile + ".run0"));
+#endif
+    SEGY::GatherIndex loadedIndex;
+    loadedIndex.load(indexFile);
+    EXPECT_EQ(loadedIndex.getSortKeys(), receiverKeys);
+    EXPECT_EQ(loadedIndex.getNumberOfTraces(), nShots*nReceivers);
+    for (int receiver=0; receiver<nReceivers; ++receiver)
+    {
+        auto gather = loadedIndex.getGather({100*receiver});
+        ASSERT_EQ(static_cast<int> (gather.size()), nShots);
+        std::vector<SEGY::TraceHeader> headers;
+        std::vector<std::vector<float>> traces;
+        loadedIndex.readGather({100*receiver}, &headers, &traces);
+        ASSERT_EQ(headers.size(), gather.size());
+        for (int i=0; i<nShots; ++i)
+        {
+            EXPECT_EQ(gather[i].keys[2], 100*receiver);
+            if (i > 0)
+            {
+                EXPECT_LE(gather[i-1].keys[3], gather[i].keys[3]);
+            }
+            auto shot = gather[i].trace/nReceivers;
+            EXPECT_EQ(gather[i].trace%nReceivers, receiver);
+            EXPECT_EQ(headers[i].getHeader(TraceHeaderField::GROUP_X),
+                      100*receiver);
+            EXPECT_EQ(headers[i].getHeader(
+                          TraceHeaderField::SOURCE_RECEIVER_OFFSET),
+                      getOffset(shot, receiver));
+            auto nSamples = 4 + gather[i].trace%3;
+            ASSERT_EQ(static_cast<int> (traces[i].size()), nSamples);
+            for (int j=0; j<nSamples; ++j)
+            {
+                EXPECT_EQ(traces[i][j],
+                          static_cast<float> (gather[i].trace + 0.25*j));
+            }
+        }
+    }
+    auto gather = loadedIndex.getGather({300, getOffset(5, 3)});
+    ASSERT_EQ(gather.size(), 1u);
+    EXPECT_EQ(gather[0].trace, 5*nReceivers + 3);
+    EXPECT_TRUE(loadedIndex.getGather({50}).empty());
+    EXPECT_THROW(loadedIndex.getGather({0, 0, 0}), std::invalid_argument);
+    // All rows fit in one run so the sorted run is written directly
+    loadedIndex.setMaximumMemory(1024*1024);
+    EXPECT_TRUE(loadedIndex.sort({TraceHeaderField::FIELD_RECORD_NUMBER}));
+    EXPECT_FALSE(loadedIndex.sort({TraceHeaderField::FIELD_RECORD_NUMBER}));
+#ifdef TEMBLOR_USE_FILESYSTEM
+    EXPECT_FALSE(fs::exists(indexFile + ".run0"));
+#endif
+    SEGY::GatherIndex reloadedIndex;
+    reloadedIndex.load(indexFile);
+    EXPECT_EQ(reloadedIndex.getNumberOfTraces(), nShots*nReceivers);
+    shotGather = reloadedIndex.getGather({4});
+    ASSERT_EQ(static_cast<int> (shotGather.size()), nReceivers);
+    for (int receiver=0; receiver<nReceivers; ++receiver)
+    {
+        EXPECT_EQ(shotGather[receiver].trace, 3*nReceivers + receiver);
+    }
+    std::remove(segyFile.c_str());
+    std::remove(indexFile.c_str());
+}
+
+TEST(LibraryDataReadersSEGY, segy2Writer)
+{
+    using SEGY::TraceHeaderField;
+    auto scratchFile = makeScratchFileName("tempWriter.sgy");
+    // Revision 2 file of variable length IBM traces
+    SEGY::BinaryFileHeader binaryHeader(2, 0);
+    binaryHeader.setSampleInterval(2000);
+    binaryHeader.setNumberOfSamplesPerTrace(50);
+    binaryHeader.setDataFormat(SEGY::DataFormat::IBM_FLOAT);
+    SEGY::Segy2Writer writer;
+    EXPECT_THROW(writer.setBufferSize(1024), std::invalid_argument);
+    EXPECT_THROW(writer.setNumberOfThreads(0), std::invalid_argument);
+    writer.setBufferSize(64*1024);
+    writer.setNumberOfThreads(2);
+    SEGY::TraceHeader header;
+    std::vector<double> x(10);
+    EXPECT_THROW(writer.write(header, 10, x.data()), std::runtime_error);
+    std::string textualHeader = "C 1 CLIENT TEMBLOR";
+    writer.open(scratchFile, binaryHeader, textualHeader);
+    EXPECT_TRUE(writer.isOpen());
+    // Lengths of the traces.  One trace exceeds the buffer.
+    std::vector<int> nSamples;
+    auto getSample = [](const int trace, const int j)
+    {
+        return trace + 0.25*(j%100);
+    };
+    for (int i=0; i<3; ++i)
+    {
+        nSamples.push_back(10 + i);
+        header.setHeader(TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_FILE,
+                         i + 1);
+        x.resize(nSamples.back());
+        for (int j=0; j<nSamples.back(); ++j){x[j] = getSample(i, j);}
+        writer.write(header, nSamples.back(), x.data());
+    }
+    std::vector<SEGY::TraceHeader> headers(500);
+    std::vector<std::vector<float>> traces(headers.size());
+    for (int k=0; k<static_cast<int> (headers.size()); ++k)
+    {
+        auto i = static_cast<int> (nSamples.size());
+        nSamples.push_back(k == 250 ? 20000 : 50 + k%40);
+        headers[k].setHeader(TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_FILE,
+                             i + 1);
+        if (k%2 == 1)
+        {
+            headers[k].setHeader(TraceHeaderField::SAMPLE_INTERVAL, 1000);
+        }
+        traces[k].resize(nSamples.back());
+        for (int j=0; j<nSamples.back(); ++j)
+        {
+            traces[k][j] = static_cast<float> (getSample(i, j));
+        }
+    }
+    EXPECT_THROW(writer.write(headers, std::vector<std::vector<float>> (1)),
+                 std::invalid_argument);
+    writer.write(headers, traces);
+    EXPECT_EQ(writer.getNumberOfTracesWritten(), nSamples.size());
+    writer.close();
+    EXPECT_FALSE(writer.isOpen());
+    // Read it back
+    SEGY::Segy2 segy2;
+    segy2.read(scratchFile);
+    EXPECT_EQ(segy2.getTextualHeader().substr(0, textualHeader.size()),
+              textualHeader);
+    EXPECT_EQ(segy2.getBinaryFileHeader().getNumberOfTracesInFile(),
+              nSamples.size());
+    ASSERT_EQ(segy2.getNumberOfTraces(), static_cast<int> (nSamples.size()));
+    std::vector<double> y(20000);
+    auto yPtr = y.data();
+    for (int i=0; i<segy2.getNumberOfTraces(); ++i)
+    {
+        auto traceHeader = segy2.getTraceHeader(i);
+        EXPECT_EQ(traceHeader.getHeader(
+                      TraceHeaderField::TRACE_SEQUENCE_NUMBER_IN_FILE), i + 1);
+        auto sampleInterval = (i >= 3 && (i - 3)%2 == 1) ? 1000 : 2000;
+        EXPECT_EQ(traceHeader.getHeader(TraceHeaderField::SAMPLE_INTERVAL),
+                  sampleInterval);
+        ASSERT_EQ(segy2.getNumberOfSamples(i), nSamples[i]);
+        segy2.getTrace(i, static_cast<int> (y.size()), &yPtr);
+        for (int j=0; j<nSamples[i]; ++j)
+        {
+            EXPECT_EQ(y[j], getSample(i, j));
+        }
+    }
+    // Fixed length IEEE traces
+    binaryHeader.setDataFormat(SEGY::DataFormat::IEEE_FLOAT);
+    binaryHeader.setFixedLengthTraces(true);
+    binaryHeader.setNumberOfSamplesPerTrace(10);
+    writer.open(scratchFile, binaryHeader);
+    std::vector<float> x4(10);
+    EXPECT_THROW(writer.write(header, 9, x4.data()), std::invalid_argument);
+    for (int i=0; i<4; ++i)
+    {
+        for (int j=0; j<10; ++j){x4[j] = -1.5f*i + j;}
+        writer.write(header, 10, x4.data());
+    }
+    writer.close();
+    segy2.read(scratchFile);
+    EXPECT_EQ(segy2.getTextualHeader(), std::string(3200, ' '));
+    ASSERT_EQ(segy2.getNumberOfTraces(), 4);
+    auto x4Ptr = x4.data();
+    for (int i=0; i<4; ++i)
+    {
+        segy2.getTrace(i, 10, &x4Ptr);
+        for (int j=0; j<10; ++j){EXPECT_EQ(x4[j], -1.5f*i + j);}
+    }
+    std::remove(scratchFile.c_str());
 }
 
 }
@@ -0,0 +1,503 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <sys/stat.h>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/indexFile.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/miniseed/archiveIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+namespace
+{
+
+/// Identifies an index file
+constexpr char MAGIC[8] = {'T', 'M', 'B', 'L', 'S', 'D', 'S', 'X'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+/// An indexed day file
+struct ArchiveFile
+{
+    std::string name;      // Path relative to the root directory
+    int64_t modified = 0;  // Modification time in nanoseconds
+    int64_t size = 0;      // Size in bytes
+    std::vector<SNCL> sncls;
+    std::vector<IndexedRecord> records;
+};
+
+/// Checks if a file name looks like NET.STA.LOC.CHAN.TYPE.YEAR.DAY
+bool isSDSFileName(const std::string &name)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true)
+    {
+        auto dot = name.find('.', start);
+        fields.push_back(name.substr(start, dot - start));
+        if (dot == std::string::npos){break;}
+        start = dot + 1;
+    }
+    if (fields.size() != 7){return false;}
+    if (fields[5].size() != 4 || fields[6].size() != 3){return false;}
+    for (const auto &field : {fields[5], fields[6]})
+    {
+        for (const auto &c : field)
+        {
+            if (!std::isdigit(static_cast<unsigned char> (c))){return false;}
+        }
+    }
+    return true;
+}
+
+/// Gets the modification time (ns) and size of a file
+bool getFileStatus(const std::string &fileName,
+                   int64_t *modified, int64_t *size)
+{
+    struct stat fileStatus;
+    if (stat(fileName.c_str(), &fileStatus) != 0){return false;}
+#if defined(__APPLE__)
+    const auto &mtime = fileStatus.st_mtimespec;
+#else
+    const auto &mtime = fileStatus.st_mtim;
+#endif
+    *modified = static_cast<int64_t> (mtime.tv_sec)*1000000000
+              + static_cast<int64_t> (mtime.tv_nsec);
+    *size = static_cast<int64_t> (fileStatus.st_size);
+    return true;
+}
+
+}
+
+class ArchiveIndex::ArchiveIndexImpl
+{
+public:
+    /// Builds the SNCL lookup tables from the files
+    void buildLookup()
+    {
+        mSNCLs.clear();
+        mSNCLIndex.clear();
+        mRecords.clear();
+        mMaximumDuration.clear();
+        for (int ifile=0; ifile<static_cast<int> (mFiles.size()); ++ifile)
+        {
+            const auto &file = mFiles[ifile];
+            std::vector<int> fileToArchive(file.sncls.size());
+            for (size_t i=0; i<file.sncls.size(); ++i)
+            {
+                auto idx = mSNCLIndex.emplace(file.sncls[i],
+                                              static_cast<int> (mSNCLs.size()));
+                if (idx.second)
+                {
+                    mSNCLs.push_back(file.sncls[i]);
+                    mRecords.emplace_back();
+                    mMaximumDuration.push_back(0);
+                }
+                fileToArchive[i] = idx.first->second;
+            }
+            for (const auto &record : file.records)
+            {
+                auto isncl = fileToArchive[record.sncl];
+                ArchiveRecord archiveRecord;
+                archiveRecord.startTime = record.startTime;
+                archiveRecord.endTime = record.endTime;
+                archiveRecord.offset = record.offset;
+                archiveRecord.length = record.length;
+                archiveRecord.file = ifile;
+                archiveRecord.samplingRate = record.samplingRate;
+                mRecords[isncl].push_back(archiveRecord);
+                mMaximumDuration[isncl]
+                    = std::max(mMaximumDuration[isncl],
+                               record.endTime - record.startTime);
+            }
+        }
+        for (auto &records : mRecords)
+        {
+            std::sort(records.begin(), records.end(),
+                      [](const ArchiveRecord &lhs, const ArchiveRecord &rhs)
+                      {
+                          if (lhs.startTime != rhs.startTime)
+                          {
+                              return lhs.startTime < rhs.startTime;
+                          }
+                          if (lhs.file != rhs.file)
+                          {
+                              return lhs.file < rhs.file;
+                          }
+                          return lhs.offset < rhs.offset;
+                      });
+        }
+    }
+    /// Finds the index of the SNCL
+    int findSNCL(const SNCL &sncl) const noexcept
+    {
+        auto idx = mSNCLIndex.find(sncl);
+        if (idx == mSNCLIndex.end()){return -1;}
+        return idx->second;
+    }
+    std::string mRootDirectory;
+    /// The indexed files sorted by name
+    std::vector<ArchiveFile> mFiles;
+    std::vector<SNCL> mSNCLs;
+    std::unordered_map<SNCL, int> mSNCLIndex;
+    /// The records of each SNCL sorted by start time, file, and offset
+    std::vector<std::vector<ArchiveRecord>> mRecords;
+    /// The longest record duration (ns) for each SNCL
+    std::vector<int64_t> mMaximumDuration;
+    int mNumberOfFilesScanned = 0;
+    int mNumberOfThreads = 1;
+};
+
+/// Constructor
+ArchiveIndex::ArchiveIndex() :
+    pImpl(std::make_unique<ArchiveIndexImpl> ())
+{
+}
+
+/// Copy constructor
+ArchiveIndex::ArchiveIndex(const ArchiveIndex &index)
+{
+    *this = index;
+}
+
+/// Move constructor
+ArchiveIndex::ArchiveIndex(ArchiveIndex &&index) noexcept
+{
+    *this = std::move(index);
+}
+
+/// Copy assignment
+ArchiveIndex& ArchiveIndex::operator=(const ArchiveIndex &index)
+{
+    if (&index == this){return *this;}
+    pImpl = std::make_unique<ArchiveIndexImpl> (*index.pImpl);
+    return *this;
+}
+
+/// Move assignment
+ArchiveIndex& ArchiveIndex::operator=(ArchiveIndex &&index) noexcept
+{
+    if (&index == this){return *this;}
+    pImpl = std::move(index.pImpl);
+    return *this;
+}
+
+/// Destructor
+ArchiveIndex::~ArchiveIndex() = default;
+
+/// Clear the class
+void ArchiveIndex::clear() noexcept
+{
+    pImpl->mRootDirectory.clear();
+    pImpl->mFiles.clear();
+    pImpl->mSNCLs.clear();
+    pImpl->mSNCLIndex.clear();
+    pImpl->mRecords.clear();
+    pImpl->mMaximumDuration.clear();
+    pImpl->mNumberOfFilesScanned = 0;
+}
+
+/// Threads
+void ArchiveIndex::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int ArchiveIndex::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Scan the archive
+void ArchiveIndex::scan(const std::string &rootDirectory)
+{
+#if TEMBLOR_USE_FILESYSTEM == 1
+    if (!fs::is_directory(rootDirectory))
+    {
+        throw std::invalid_argument("Archive directory = " + rootDirectory
+                                  + " does not exist\n");
+    }
+    // A different archive cannot reuse the current index
+    std::string root = fs::path(rootDirectory).string();
+    while (root.size() > 1 && root.back() == '/'){root.pop_back();}
+    if (root != pImpl->mRootDirectory){clear();}
+    pImpl->mNumberOfFilesScanned = 0;
+    // Find the day files
+    std::vector<ArchiveFile> files;
+    for (const auto &entry :
+         fs::recursive_directory_iterator(
+             root, fs::directory_options::skip_permission_denied))
+    {
+        if (!fs::is_regular_file(entry.status())){continue;}
+        auto fileName = entry.path().filename().string();
+        if (!isSDSFileName(fileName)){continue;}
+        ArchiveFile file;
+        file.name = entry.path().string().substr(root.size() + 1);
+        if (!getFileStatus(entry.path().string(),
+                           &file.modified, &file.size))
+        {
+            continue;
+        }
+        files.push_back(std::move(file));
+    }
+    std::sort(files.begin(), files.end(),
+              [](const ArchiveFile &lhs, const ArchiveFile &rhs)
+              {
+                  return lhs.name < rhs.name;
+              });
+    // Reuse the entries of files that have not changed.  Both lists are
+    // sorted by name.
+    std::vector<int> toScan;
+    size_t iold = 0;
+    for (int ifile=0; ifile<static_cast<int> (files.size()); ++ifile)
+    {
+        auto &file = files[ifile];
+        while (iold < pImpl->mFiles.size() &&
+               pImpl->mFiles[iold].name < file.name)
+        {
+            iold = iold + 1;
+        }
+        if (iold < pImpl->mFiles.size() &&
+            pImpl->mFiles[iold].name == file.name &&
+            pImpl->mFiles[iold].modified == file.modified &&
+            pImpl->mFiles[iold].size == file.size)
+        {
+            file.sncls = std::move(pImpl->mFiles[iold].sncls);
+            file.records = std::move(pImpl->mFiles[iold].records);
+            continue;
+        }
+        toScan.push_back(ifile);
+    }
+    // Index the new and modified files
+    auto nScan = static_cast<int> (toScan.size());
+    std::vector<char> lfailed(nScan, 0);
+    #pragma omp parallel for num_threads(pImpl->mNumberOfThreads) \
+            schedule(dynamic, 1)
+    for (int i=0; i<nScan; ++i)
+    {
+        auto &file = files[toScan[i]];
+        try
+        {
+            RecordIndex index;
+            index.load(root + "/" + file.name);
+            file.sncls = index.getSNCLs();
+            file.records = index.getRecords();
+        }
+        catch (...)
+        {
+            lfailed[i] = 1;
+        }
+    }
+    // Skip the files that could not be indexed
+    for (int i=nScan-1; i>=0; --i)
+    {
+        if (!lfailed[i]){continue;}
+        fprintf(stderr, "%s: Could not index %s\n",
+                __func__, files[toScan[i]].name.c_str());
+        files.erase(files.begin() + toScan[i]);
+    }
+    pImpl->mRootDirectory = root;
+    pImpl->mFiles = std::move(files);
+    pImpl->mNumberOfFilesScanned = nScan;
+    pImpl->buildLookup();
+#else
+    throw std::runtime_error("Filesystem library required to scan "
+                           + rootDirectory + "\n");
+#endif
+}
+
+int ArchiveIndex::getNumberOfFilesScanned() const noexcept
+{
+    return pImpl->mNumberOfFilesScanned;
+}
+
+/// Save the index
+void ArchiveIndex::save(const std::string &fileName) const
+{
+    Temblor::Private::IndexWriter writer;
+    writer.putPreamble(MAGIC, FORMAT_VERSION);
+    writer.putString(pImpl->mRootDirectory);
+    writer.put(static_cast<uint64_t> (pImpl->mFiles.size()));
+    for (const auto &file : pImpl->mFiles)
+    {
+        writer.putString(file.name);
+        writer.put(file.modified);
+        writer.put(file.size);
+        writer.put(static_cast<uint32_t> (file.sncls.size()));
+        for (const auto &sncl : file.sncls)
+        {
+            writer.putString(sncl.getNetwork());
+            writer.putString(sncl.getStation());
+            writer.putString(sncl.getChannel());
+            writer.putString(sncl.getLocationCode());
+        }
+        writer.put(static_cast<uint64_t> (file.records.size()));
+        for (const auto &record : file.records)
+        {
+            writer.put(record.startTime);
+            writer.put(record.endTime);
+            writer.put(record.offset);
+            writer.put(record.length);
+            writer.put(record.sncl);
+            writer.put(record.samplingRate);
+        }
+    }
+    std::ofstream outfile(fileName,
+                          std::ofstream::binary | std::ofstream::trunc);
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not open " + fileName + "\n");
+    }
+    outfile.write(writer.mBuffer.data(),
+                  static_cast<std::streamsize> (writer.mBuffer.size()));
+    outfile.close();
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not write " + fileName + "\n");
+    }
+}
+
+/// Load the index
+void ArchiveIndex::load(const std::string &fileName)
+{
+    clear();
+    std::ifstream infile(fileName, std::ifstream::binary);
+    if (!infile)
+    {
+        throw std::invalid_argument("Index file = " + fileName
+                                  + " does not exist\n");
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char> (infile)),
+                             std::istreambuf_iterator<char> ());
+    infile.close();
+    Temblor::Private::IndexReader reader(buffer);
+    ArchiveIndexImpl impl;
+    impl.mNumberOfThreads = pImpl->mNumberOfThreads;
+    reader.checkPreamble(MAGIC, FORMAT_VERSION, fileName);
+    impl.mRootDirectory = reader.getString();
+    auto nFiles = reader.get<uint64_t> ();
+    impl.mFiles.reserve(std::min<uint64_t> (nFiles, reader.getRemaining()));
+    for (uint64_t ifile=0; ifile<nFiles; ++ifile)
+    {
+        ArchiveFile file;
+        file.name = reader.getString();
+        file.modified = reader.get<int64_t> ();
+        file.size = reader.get<int64_t> ();
+        auto nSNCLs = reader.get<uint32_t> ();
+        for (uint32_t i=0; i<nSNCLs; ++i)
+        {
+            SNCL sncl;
+            sncl.setNetwork(reader.getString());
+            sncl.setStation(reader.getString());
+            sncl.setChannel(reader.getString());
+            sncl.setLocationCode(reader.getString());
+            file.sncls.push_back(sncl);
+        }
+        auto nRecords = reader.get<uint64_t> ();
+        file.records.reserve(std::min<uint64_t> (nRecords,
+                                                 reader.getRemaining()));
+        for (uint64_t i=0; i<nRecords; ++i)
+        {
+            IndexedRecord record;
+            record.startTime = reader.get<int64_t> ();
+            record.endTime = reader.get<int64_t> ();
+            record.offset = reader.get<int64_t> ();
+            record.length = reader.get<int32_t> ();
+            record.sncl = reader.get<int32_t> ();
+            record.samplingRate = reader.get<double> ();
+            if (record.sncl < 0 || record.sncl >= static_cast<int> (nSNCLs))
+            {
+                throw std::invalid_argument("Index file is corrupt\n");
+            }
+            file.records.push_back(record);
+        }
+        impl.mFiles.push_back(std::move(file));
+    }
+    impl.buildLookup();
+    *pImpl = std::move(impl);
+}
+
+/// Root directory
+std::string ArchiveIndex::getRootDirectory() const noexcept
+{
+    return pImpl->mRootDirectory;
+}
+
+/// Files
+int ArchiveIndex::getNumberOfFiles() const noexcept
+{
+    return static_cast<int> (pImpl->mFiles.size());
+}
+
+std::vector<std::string> ArchiveIndex::getFileNames() const
+{
+    std::vector<std::string> fileNames;
+    fileNames.reserve(pImpl->mFiles.size());
+    for (const auto &file : pImpl->mFiles)
+    {
+        fileNames.push_back(pImpl->mRootDirectory + "/" + file.name);
+    }
+    return fileNames;
+}
+
+/// SNCLs
+std::vector<SNCL> ArchiveIndex::getSNCLs() const noexcept
+{
+    return pImpl->mSNCLs;
+}
+
+bool ArchiveIndex::haveSNCL(const SNCL &sncl) const noexcept
+{
+    return (pImpl->findSNCL(sncl) >= 0);
+}
+
+/// Records
+std::vector<ArchiveRecord>
+ArchiveIndex::getRecords(const SNCL &sncl,
+                         const Temblor::Utilities::Time &t0,
+                         const Temblor::Utilities::Time &t1) const
+{
+    auto startTime
+        = static_cast<int64_t> (std::round(t0.getEpochalTime()*1.e9));
+    auto endTime
+        = static_cast<int64_t> (std::round(t1.getEpochalTime()*1.e9));
+    if (endTime < startTime)
+    {
+        throw std::invalid_argument("t1 cannot precede t0\n");
+    }
+    std::vector<ArchiveRecord> result;
+    auto isncl = pImpl->findSNCL(sncl);
+    if (isncl < 0){return result;}
+    // Records that intersect the window begin no earlier than the window
+    // start less the longest record and no later than the window end
+    const auto &records = pImpl->mRecords[isncl];
+    auto earliest = startTime - pImpl->mMaximumDuration[isncl];
+    auto first = std::lower_bound(records.begin(), records.end(), earliest,
+                                  [](const ArchiveRecord &lhs,
+                                     const int64_t rhs)
+                                  {
+                                      return lhs.startTime < rhs;
+                                  });
+    for (auto record = first; record != records.end(); ++record)
+    {
+        if (record->startTime > endTime){break;}
+        if (record->endTime < startTime){continue;}
+        result.push_back(*record);
+    }
+    return result;
+}
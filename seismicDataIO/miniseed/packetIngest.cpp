@@ -0,0 +1,362 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <libmseed.h>
+#include "temblor/private/sampleConversion.hpp"
+#include "temblor/private/sourceIdentifier.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/ringBuffer.hpp"
+#include "temblor/seismicDataIO/miniseed/packetIngest.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+namespace
+{
+
+/// The number of records requested from the file descriptor per read
+constexpr int RECORDS_PER_READ = 64;
+
+/// The producer's view of a channel
+struct Channel
+{
+    SNCL sncl;
+    std::shared_ptr<RingBuffer> buffer;
+};
+
+}
+
+class PacketIngest::PacketIngestImpl
+{
+public:
+    /// Finds or creates the channel of a SID.  Only the producer calls this.
+    Channel *getChannel(const char *sid, const double samplingRate)
+    {
+        auto idx = mChannels.find(sid);
+        if (idx != mChannels.end()){return &idx->second;}
+        Channel channel;
+        channel.sncl = Temblor::Private::sid2sncl(sid);
+        // Leave room for a record's worth of samples past the duration
+        auto nSamples = std::ceil(mBufferDuration*samplingRate) + 1024;
+        nSamples = std::min(nSamples, static_cast<double> (1 << 30));
+        auto sampleCapacity = static_cast<int> (nSamples);
+        auto segmentCapacity = std::max(64, sampleCapacity/16);
+        channel.buffer = std::make_shared<RingBuffer> (sampleCapacity,
+                                                       segmentCapacity);
+        // Publish the channel to the readers.  This is the only time the
+        // producer takes the lock.
+        {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto snclIndex = mSNCLIndex.find(channel.sncl);
+        if (snclIndex != mSNCLIndex.end())
+        {
+            // Different SIDs can map to the same SNCL
+            channel.buffer = mBuffers[snclIndex->second];
+        }
+        else
+        {
+            mSNCLIndex.emplace(channel.sncl,
+                               static_cast<int> (mSNCLs.size()));
+            mSNCLs.push_back(channel.sncl);
+            mBuffers.push_back(channel.buffer);
+        }
+        }
+        return &mChannels.emplace(sid, channel).first->second;
+    }
+    /// Reads records from the file descriptor until end of file or stop
+    void run(const int fileDescriptor, const int recordLength)
+    {
+        std::vector<char> buffer(
+            static_cast<size_t> (recordLength)*RECORDS_PER_READ);
+        size_t nBuffered = 0;
+        while (!mStop.load())
+        {
+            struct pollfd request;
+            request.fd = fileDescriptor;
+            request.events = POLLIN;
+            request.revents = 0;
+            // Wake periodically to check for a stop request
+            auto nReady = poll(&request, 1, 100);
+            if (nReady < 0)
+            {
+                if (errno == EINTR){continue;}
+                fprintf(stderr, "%s: poll failed with %s\n",
+                        __func__, strerror(errno));
+                break;
+            }
+            if (nReady == 0){continue;}
+            auto nRead = read(fileDescriptor, buffer.data() + nBuffered,
+                              buffer.size() - nBuffered);
+            if (nRead < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN){continue;}
+                fprintf(stderr, "%s: read failed with %s\n",
+                        __func__, strerror(errno));
+                break;
+            }
+            if (nRead == 0){break;} // End of file
+            nBuffered = nBuffered + static_cast<size_t> (nRead);
+            // Ingest the complete records and keep the partial one
+            size_t offset = 0;
+            while (offset + recordLength <= nBuffered)
+            {
+                addRecord(recordLength, buffer.data() + offset);
+                offset = offset + recordLength;
+            }
+            if (offset > 0)
+            {
+                std::memmove(buffer.data(), buffer.data() + offset,
+                             nBuffered - offset);
+                nBuffered = nBuffered - offset;
+            }
+        }
+        if (nBuffered > 0)
+        {
+            fprintf(stderr, "%s: Discarding %ld bytes of a partial record\n",
+                    __func__, static_cast<long> (nBuffered));
+        }
+        mRunning = false;
+    }
+    /// Decodes a record and appends it to its channel's buffer
+    bool addRecord(const int length, const char record[])
+    {
+        auto retcode = msr3_parse(record, static_cast<uint64_t> (length),
+                                  &mRecord, 0, 0);
+        if (retcode != MS_NOERROR || mRecord->samplecnt < 1 ||
+            msr3_sampratehz(mRecord) <= 0)
+        {
+            mRejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto nSamples = msr3_unpack_data(mRecord, 0);
+        if (nSamples != mRecord->samplecnt)
+        {
+            fprintf(stderr, "%s: Failed to unpack record for %s\n",
+                    __func__, mRecord->sid);
+            mRejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        mSamples.resize(nSamples);
+        if (mRecord->sampletype == 'i')
+        {
+            Temblor::Private::convertSamples(
+                nSamples, static_cast<const int32_t *> (mRecord->datasamples),
+                mSamples.data());
+        }
+        else if (mRecord->sampletype == 'f')
+        {
+            Temblor::Private::convertSamples(
+                nSamples, static_cast<const float *> (mRecord->datasamples),
+                mSamples.data());
+        }
+        else if (mRecord->sampletype == 'd')
+        {
+            Temblor::Private::convertSamples(
+                nSamples, static_cast<const double *> (mRecord->datasamples),
+                mSamples.data());
+        }
+        else
+        {
+            mRejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        auto samplingRate = msr3_sampratehz(mRecord);
+        Segment segment;
+        try
+        {
+            auto channel = getChannel(mRecord->sid, samplingRate);
+            segment.startTime = mRecord->starttime;
+            segment.offset = channel->buffer->getNumberOfSamplesAppended();
+            segment.nSamples = nSamples;
+            segment.samplingRate = samplingRate;
+            channel->buffer->append(segment.startTime, samplingRate,
+                                    static_cast<int> (nSamples),
+                                    mSamples.data());
+            mRecords.fetch_add(1, std::memory_order_relaxed);
+            mSampleCount.fetch_add(static_cast<uint64_t> (nSamples),
+                                   std::memory_order_relaxed);
+            if (mCallback){mCallback(channel->sncl, segment);}
+        }
+        catch (const std::exception &e)
+        {
+            fprintf(stderr, "%s: %s", __func__, e.what());
+            mRejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+    /// The producer's channels keyed by SID
+    std::unordered_map<std::string, Channel> mChannels;
+    /// The channels shared with readers.  These are guarded by the mutex.
+    mutable std::mutex mMutex;
+    std::unordered_map<SNCL, int> mSNCLIndex;
+    std::vector<SNCL> mSNCLs;
+    std::vector<std::shared_ptr<RingBuffer>> mBuffers;
+    /// The producer's parsed record and converted samples
+    MS3Record *mRecord = nullptr;
+    std::vector<double> mSamples;
+    RecordCallback mCallback;
+    std::thread mThread;
+    std::atomic<bool> mRunning{false};
+    std::atomic<bool> mStop{false};
+    std::atomic<uint64_t> mRecords{0};
+    std::atomic<uint64_t> mSampleCount{0};
+    std::atomic<uint64_t> mRejected{0};
+    double mBufferDuration = 600;
+};
+
+/// Constructor
+PacketIngest::PacketIngest() :
+    pImpl(std::make_unique<PacketIngestImpl> ())
+{
+}
+
+/// Destructor
+PacketIngest::~PacketIngest()
+{
+    stop();
+    msr3_free(&pImpl->mRecord);
+}
+
+/// Clear the class
+void PacketIngest::clear() noexcept
+{
+    stop();
+    pImpl->mChannels.clear();
+    {
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mSNCLIndex.clear();
+    pImpl->mSNCLs.clear();
+    pImpl->mBuffers.clear();
+    }
+    pImpl->mRecords = 0;
+    pImpl->mSampleCount = 0;
+    pImpl->mRejected = 0;
+}
+
+/// Parameters
+void PacketIngest::setBufferDuration(const double seconds)
+{
+    if (seconds <= 0)
+    {
+        throw std::invalid_argument("Buffer duration = "
+                                  + std::to_string(seconds)
+                                  + " must be positive\n");
+    }
+    if (isRunning()){throw std::runtime_error("Ingest is running\n");}
+    pImpl->mBufferDuration = seconds;
+}
+
+double PacketIngest::getBufferDuration() const noexcept
+{
+    return pImpl->mBufferDuration;
+}
+
+void PacketIngest::setRecordCallback(const RecordCallback &callback)
+{
+    if (isRunning()){throw std::runtime_error("Ingest is running\n");}
+    pImpl->mCallback = callback;
+}
+
+/// Ingest
+bool PacketIngest::addRecord(const int length, const char record[])
+{
+    if (length < 1)
+    {
+        throw std::invalid_argument("Record length = "
+                                  + std::to_string(length)
+                                  + " must be positive\n");
+    }
+    if (record == nullptr){throw std::invalid_argument("record is NULL\n");}
+    return pImpl->addRecord(length, record);
+}
+
+void PacketIngest::start(const int fileDescriptor, const int recordLength)
+{
+    if (fileDescriptor < 0 || fcntl(fileDescriptor, F_GETFD) == -1)
+    {
+        throw std::invalid_argument("File descriptor = "
+                                  + std::to_string(fileDescriptor)
+                                  + " is invalid\n");
+    }
+    if (recordLength < 128 || recordLength > 1048576)
+    {
+        throw std::invalid_argument("Record length = "
+                                  + std::to_string(recordLength)
+                                  + " must be in range [128,1048576]\n");
+    }
+    if (isRunning()){throw std::runtime_error("Ingest is running\n");}
+    // Reap a thread that reached end of file
+    if (pImpl->mThread.joinable()){pImpl->mThread.join();}
+    pImpl->mStop = false;
+    pImpl->mRunning = true;
+    pImpl->mThread = std::thread(&PacketIngestImpl::run, pImpl.get(),
+                                 fileDescriptor, recordLength);
+}
+
+void PacketIngest::stop() noexcept
+{
+    pImpl->mStop = true;
+    if (pImpl->mThread.joinable()){pImpl->mThread.join();}
+    pImpl->mRunning = false;
+}
+
+bool PacketIngest::isRunning() const noexcept
+{
+    return pImpl->mRunning.load();
+}
+
+IngestStatistics PacketIngest::getStatistics() const noexcept
+{
+    IngestStatistics statistics;
+    statistics.records = pImpl->mRecords.load(std::memory_order_relaxed);
+    statistics.samples = pImpl->mSampleCount.load(std::memory_order_relaxed);
+    statistics.rejected = pImpl->mRejected.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+/// Snapshots
+std::vector<SNCL> PacketIngest::getSNCLs() const
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mSNCLs;
+}
+
+bool PacketIngest::haveSNCL(const SNCL &sncl) const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return (pImpl->mSNCLIndex.find(sncl) != pImpl->mSNCLIndex.end());
+}
+
+Trace PacketIngest::getSnapshot(const SNCL &sncl) const
+{
+    std::shared_ptr<RingBuffer> buffer;
+    {
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto idx = pImpl->mSNCLIndex.find(sncl);
+    if (idx != pImpl->mSNCLIndex.end()){buffer = pImpl->mBuffers[idx->second];}
+    }
+    if (!buffer)
+    {
+        throw std::invalid_argument("SNCL has not been ingested\n");
+    }
+    Trace trace;
+    if (!buffer->getSnapshot(&trace))
+    {
+        throw std::runtime_error("Could not take a consistent snapshot\n");
+    }
+    trace.setSNCL(sncl);
+    return trace;
+}
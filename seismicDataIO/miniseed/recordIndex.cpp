@@ -0,0 +1,299 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <libmseed.h>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/mappedFile.hpp"
+#include "temblor/private/sourceIdentifier.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+namespace
+{
+
+/// Orders records by SNCL index
+struct RecordSNCLComparator
+{
+    bool operator()(const IndexedRecord &lhs, const int rhs) const noexcept
+    {
+        return lhs.sncl < rhs;
+    }
+    bool operator()(const int lhs, const IndexedRecord &rhs) const noexcept
+    {
+        return lhs < rhs.sncl;
+    }
+};
+
+}
+
+class RecordIndex::RecordIndexImpl
+{
+public:
+    /// Finds the index of the SNCL
+    int findSNCL(const SNCL &sncl) const noexcept
+    {
+        auto idx = mSNCLIndex.find(sncl);
+        if (idx == mSNCLIndex.end()){return -1;}
+        return idx->second;
+    }
+    /// The memory mapped file.  This is shared by copies of the index.
+    std::shared_ptr<const Temblor::Private::MappedFile> mFile;
+    std::string mFileName;
+    std::vector<SNCL> mSNCLs;
+    /// Maps a SNCL to its index in mSNCLs
+    std::unordered_map<SNCL, int> mSNCLIndex;
+    /// The longest record duration (ns) for each SNCL.  This bounds the
+    /// search for records that begin before a time window.
+    std::vector<int64_t> mMaximumDuration;
+    /// The records sorted by SNCL, start time, and byte offset
+    std::vector<IndexedRecord> mRecords;
+};
+
+/// Constructor
+RecordIndex::RecordIndex() :
+    pImpl(std::make_unique<RecordIndexImpl> ())
+{
+}
+
+/// Copy constructor
+RecordIndex::RecordIndex(const RecordIndex &index)
+{
+    *this = index;
+}
+
+/// Move constructor
+RecordIndex::RecordIndex(RecordIndex &&index) noexcept
+{
+    *this = std::move(index);
+}
+
+/// Copy assignment
+RecordIndex& RecordIndex::operator=(const RecordIndex &index)
+{
+    if (&index == this){return *this;}
+    pImpl = std::make_unique<RecordIndexImpl> (*index.pImpl);
+    return *this;
+}
+
+/// Move assignment
+RecordIndex& RecordIndex::operator=(RecordIndex &&index) noexcept
+{
+    if (&index == this){return *this;}
+    pImpl = std::move(index.pImpl);
+    return *this;
+}
+
+/// Destructor
+RecordIndex::~RecordIndex() = default;
+
+/// Clear the class
+void RecordIndex::clear() noexcept
+{
+    pImpl->mFile = nullptr;
+    pImpl->mFileName.clear();
+    pImpl->mSNCLs.clear();
+    pImpl->mSNCLIndex.clear();
+    pImpl->mMaximumDuration.clear();
+    pImpl->mRecords.clear();
+}
+
+/// Index the file
+void RecordIndex::load(const std::string &fileName)
+{
+    clear();
+#if TEMBLOR_USE_FILESYSTEM == 1
+    if (!fs::exists(fileName))
+    {
+        std::string errmsg = "miniSEED file = " + fileName
+                           + " does not exist\n";
+        throw std::invalid_argument(errmsg);
+    }
+#endif
+    auto file = std::make_shared<const Temblor::Private::MappedFile>
+                (fileName);
+    file->adviseSequential();
+    // Scan the record headers
+    std::vector<std::string> sids;
+    std::unordered_map<std::string, int> sidIndex;
+    int lastSID = -1;
+    std::vector<IndexedRecord> records;
+    const char *data = file->data();
+    auto fileSize = static_cast<int64_t> (file->size());
+    int64_t offset = 0;
+    MS3Record *msr = nullptr;
+    constexpr uint32_t flags = 0; // Do not unpack the data samples
+    constexpr int8_t verbose = 0;
+    while (offset < fileSize)
+    {
+        auto retcode = msr3_parse(data + offset,
+                                  static_cast<uint64_t> (fileSize - offset),
+                                  &msr, flags, verbose);
+        if (retcode != MS_NOERROR || msr->reclen < 1)
+        {
+            msr3_free(&msr);
+            throw std::invalid_argument("Could not parse record at byte "
+                                      + std::to_string(offset) + " of "
+                                      + fileName + "\n");
+        }
+        // Only data records are indexed
+        if (msr->samplecnt > 0 && msr->samprate > 0)
+        {
+            // Consecutive records usually share a SID
+            if (lastSID < 0 || strcmp(sids[lastSID].c_str(), msr->sid) != 0)
+            {
+                auto idx = sidIndex.emplace(msr->sid,
+                                            static_cast<int> (sids.size()));
+                if (idx.second){sids.push_back(msr->sid);}
+                lastSID = idx.first->second;
+            }
+            int isid = lastSID;
+            IndexedRecord record;
+            record.startTime = msr->starttime;
+            record.endTime = msr3_endtime(msr);
+            record.offset = offset;
+            record.length = msr->reclen;
+            record.sncl = isid;
+            record.samplingRate = msr3_sampratehz(msr);
+            records.push_back(record);
+        }
+        offset = offset + msr->reclen;
+    }
+    msr3_free(&msr);
+    // Convert the SIDs to SNCLs.  SIDs mapping to the same SNCL are merged.
+    std::vector<int> sidToSNCL(sids.size());
+    std::vector<SNCL> sncls;
+    std::unordered_map<SNCL, int> snclIndex;
+    for (size_t i=0; i<sids.size(); ++i)
+    {
+        auto sncl = Temblor::Private::sid2sncl(sids[i].c_str());
+        auto idx = snclIndex.emplace(sncl, static_cast<int> (sncls.size()));
+        sidToSNCL[i] = idx.first->second;
+        if (idx.second){sncls.push_back(sncl);}
+    }
+    std::vector<int64_t> maximumDuration(sncls.size(), 0);
+    for (auto &record : records)
+    {
+        record.sncl = sidToSNCL[record.sncl];
+        maximumDuration[record.sncl]
+            = std::max(maximumDuration[record.sncl],
+                       record.endTime - record.startTime);
+    }
+    // Sort the table
+    std::sort(records.begin(), records.end(),
+              [](const IndexedRecord &lhs, const IndexedRecord &rhs)
+              {
+                  if (lhs.sncl != rhs.sncl){return lhs.sncl < rhs.sncl;}
+                  if (lhs.startTime != rhs.startTime)
+                  {
+                      return lhs.startTime < rhs.startTime;
+                  }
+                  return lhs.offset < rhs.offset;
+              });
+    file->adviseRandom();
+    pImpl->mFile = file;
+    pImpl->mFileName = fileName;
+    pImpl->mSNCLs = std::move(sncls);
+    pImpl->mSNCLIndex = std::move(snclIndex);
+    pImpl->mMaximumDuration = std::move(maximumDuration);
+    pImpl->mRecords = std::move(records);
+}
+
+bool RecordIndex::isLoaded() const noexcept
+{
+    return (pImpl->mFile != nullptr);
+}
+
+std::string RecordIndex::getFileName() const
+{
+    if (!isLoaded()){throw std::runtime_error("File not indexed\n");}
+    return pImpl->mFileName;
+}
+
+const char *RecordIndex::getData() const noexcept
+{
+    if (!isLoaded()){return nullptr;}
+    return pImpl->mFile->data();
+}
+
+/// SNCLs
+std::vector<SNCL> RecordIndex::getSNCLs() const noexcept
+{
+    return pImpl->mSNCLs;
+}
+
+bool RecordIndex::haveSNCL(const SNCL &sncl) const noexcept
+{
+    return (pImpl->findSNCL(sncl) >= 0);
+}
+
+/// Records
+int RecordIndex::getNumberOfRecords() const noexcept
+{
+    return static_cast<int> (pImpl->mRecords.size());
+}
+
+std::vector<IndexedRecord> RecordIndex::getRecords() const noexcept
+{
+    return pImpl->mRecords;
+}
+
+std::vector<IndexedRecord> RecordIndex::getRecords(const SNCL &sncl) const
+{
+    std::vector<IndexedRecord> result;
+    auto isncl = pImpl->findSNCL(sncl);
+    if (isncl < 0){return result;}
+    auto range = std::equal_range(pImpl->mRecords.begin(),
+                                  pImpl->mRecords.end(), isncl,
+                                  RecordSNCLComparator());
+    result.assign(range.first, range.second);
+    return result;
+}
+
+std::vector<IndexedRecord>
+RecordIndex::getRecords(const SNCL &sncl,
+                        const Temblor::Utilities::Time &t0,
+                        const Temblor::Utilities::Time &t1) const
+{
+    auto startTime
+        = static_cast<int64_t> (std::round(t0.getEpochalTime()*1.e9));
+    auto endTime
+        = static_cast<int64_t> (std::round(t1.getEpochalTime()*1.e9));
+    if (endTime < startTime)
+    {
+        throw std::invalid_argument("t1 cannot precede t0\n");
+    }
+    std::vector<IndexedRecord> result;
+    auto isncl = pImpl->findSNCL(sncl);
+    if (isncl < 0){return result;}
+    // Records that intersect the window begin no earlier than the window
+    // start less the longest record and no later than the window end
+    IndexedRecord key;
+    key.sncl = isncl;
+    key.startTime = startTime - pImpl->mMaximumDuration[isncl];
+    auto first = std::lower_bound(pImpl->mRecords.begin(),
+                                  pImpl->mRecords.end(), key,
+                                  [](const IndexedRecord &lhs,
+                                     const IndexedRecord &rhs)
+                                  {
+                                      if (lhs.sncl != rhs.sncl)
+                                      {
+                                          return lhs.sncl < rhs.sncl;
+                                      }
+                                      return lhs.startTime < rhs.startTime;
+                                  });
+    for (auto record = first; record != pImpl->mRecords.end(); ++record)
+    {
+        if (record->sncl != isncl || record->startTime > endTime){break;}
+        if (record->endTime < startTime){continue;}
+        result.push_back(*record);
+    }
+    return result;
+}
@@ -0,0 +1,568 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <libmseed.h>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/mappedFile.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/recordMerger.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+namespace
+{
+
+/// Complete records are packed once this many samples are pending
+constexpr int64_t PACK_THRESHOLD = 65536;
+
+/// Converts a duration in seconds to nanoseconds
+int64_t toNanoseconds(const double seconds) noexcept
+{
+    return static_cast<int64_t> (std::round(seconds*1.e9));
+}
+
+/// A record to merge
+struct Entry
+{
+    int64_t startTime = 0;
+    int64_t offset = 0;
+    int32_t length = 0;
+    int file = 0;
+    int sncl = 0;
+};
+
+/// Identifies exact duplicates among records with the same start time
+struct Signature
+{
+    bool operator==(const Signature &rhs) const noexcept
+    {
+        return samplecnt == rhs.samplecnt &&
+               samprate == rhs.samprate &&
+               encoding == rhs.encoding &&
+               datalength == rhs.datalength &&
+               crc == rhs.crc;
+    }
+    int64_t samplecnt = 0;
+    double samprate = 0;
+    int8_t encoding = 0;
+    uint32_t datalength = 0;
+    uint32_t crc = 0;
+};
+
+/// Record handler for msr3_pack that writes the record to a file
+void writeRecord(char *record, int recordLength, void *handlerData)
+{
+    auto outfile = static_cast<std::ofstream *> (handlerData);
+    outfile->write(record, recordLength);
+}
+
+/// Accumulates the samples of a contiguous segment and writes complete
+/// records as they fill.  Only the samples of the last, partially filled,
+/// record are held between packs.
+class SegmentPacker
+{
+public:
+    SegmentPacker(std::ofstream *outfile, const int recordLength,
+                  const FormatVersion formatVersion) :
+        mOutfile(outfile),
+        mRecordLength(recordLength),
+        mFormatVersion(formatVersion)
+    {
+        mRecord = msr3_init(nullptr);
+        if (!mRecord)
+        {
+            throw std::runtime_error("Failed to initialize record\n");
+        }
+    }
+    ~SegmentPacker()
+    {
+        mRecord->datasamples = nullptr;
+        msr3_free(&mRecord);
+    }
+    SegmentPacker(const SegmentPacker &) = delete;
+    SegmentPacker& operator=(const SegmentPacker &) = delete;
+    bool isOpen() const noexcept
+    {
+        return mOpen;
+    }
+    /// Begins a segment
+    void open(const char *sid, const int64_t startTime,
+              const double samplingRate, const char sampleType,
+              const uint8_t sampleSize)
+    {
+        mSID = sid;
+        mStartTime = startTime;
+        mSamplingRate = samplingRate;
+        mSampleType = sampleType;
+        mSampleSize = sampleSize;
+        mNumberOfSamples = 0;
+        mNumberOfPending = 0;
+        mPending.clear();
+        mOpen = true;
+    }
+    /// Checks if a record can continue the segment
+    bool isCompatible(const char *sid, const double samplingRate,
+                      const char sampleType) const noexcept
+    {
+        return mOpen && mSampleType == sampleType &&
+               std::abs(samplingRate - mSamplingRate)
+                   < 1.e-6*mSamplingRate &&
+               mSID == sid;
+    }
+    /// The expected time of the next sample
+    int64_t getNextSampleTime() const noexcept
+    {
+        return mStartTime
+             + toNanoseconds(static_cast<double> (mNumberOfSamples)
+                            /mSamplingRate);
+    }
+    double getSamplingRate() const noexcept
+    {
+        return mSamplingRate;
+    }
+    /// Appends samples to the segment
+    void append(const char *samples, const int64_t nSamples)
+    {
+        mPending.insert(mPending.end(), samples,
+                        samples + nSamples*mSampleSize);
+        mNumberOfPending = mNumberOfPending + nSamples;
+        mNumberOfSamples = mNumberOfSamples + nSamples;
+        if (mNumberOfPending >= PACK_THRESHOLD){pack(false);}
+    }
+    /// Writes the remaining samples and ends the segment
+    void close()
+    {
+        if (!mOpen){return;}
+        pack(true);
+        if (mNumberOfSamples > 0){mSegments = mSegments + 1;}
+        mOpen = false;
+    }
+    uint64_t getNumberOfSamplesWritten() const noexcept
+    {
+        return mSamplesWritten;
+    }
+    int getNumberOfSegments() const noexcept
+    {
+        return mSegments;
+    }
+private:
+    /// Packs the pending samples.  Unless flushing, the samples that do
+    /// not fill a record are kept.
+    void pack(const bool lflush)
+    {
+        if (mNumberOfPending < 1){return;}
+        uint32_t flags = lflush ? MSF_FLUSHDATA : 0;
+        mRecord->formatversion = 3;
+        if (mFormatVersion == FormatVersion::MINISEED2)
+        {
+            flags = flags | MSF_PACKVER2;
+            mRecord->formatversion = 2;
+        }
+        memset(mRecord->sid, 0, sizeof(mRecord->sid));
+        strncpy(mRecord->sid, mSID.c_str(), LM_SIDLEN - 1);
+        mRecord->pubversion = 1;
+        mRecord->reclen = mRecordLength;
+        mRecord->encoding = DE_STEIM2;
+        if (mSampleType == 'f'){mRecord->encoding = DE_FLOAT32;}
+        if (mSampleType == 'd'){mRecord->encoding = DE_FLOAT64;}
+        auto firstSample = mNumberOfSamples - mNumberOfPending;
+        mRecord->starttime = mStartTime
+                           + toNanoseconds(static_cast<double> (firstSample)
+                                          /mSamplingRate);
+        mRecord->samprate = mSamplingRate;
+        mRecord->datasamples = mPending.data();
+        mRecord->numsamples = mNumberOfPending;
+        mRecord->sampletype = mSampleType;
+        int64_t nPacked = 0;
+        auto nRecords = msr3_pack(mRecord, writeRecord, mOutfile,
+                                  &nPacked, flags, 0);
+        mRecord->datasamples = nullptr;
+        if (nRecords < 0 || nPacked < 0 || nPacked > mNumberOfPending ||
+            (lflush && nPacked != mNumberOfPending))
+        {
+            fprintf(stderr, "%s: Failed to pack %s\n",
+                    __func__, mSID.c_str());
+            throw std::runtime_error("Algorithmic failure calling miniSEED\n");
+        }
+        if (!*mOutfile)
+        {
+            throw std::runtime_error("Could not write records\n");
+        }
+        mPending.erase(mPending.begin(),
+                       mPending.begin() + nPacked*mSampleSize);
+        mNumberOfPending = mNumberOfPending - nPacked;
+        mSamplesWritten = mSamplesWritten + static_cast<uint64_t> (nPacked);
+    }
+    std::ofstream *mOutfile = nullptr;
+    MS3Record *mRecord = nullptr;
+    std::string mSID;
+    std::vector<char> mPending;
+    int64_t mStartTime = 0;
+    int64_t mNumberOfSamples = 0;
+    int64_t mNumberOfPending = 0;
+    uint64_t mSamplesWritten = 0;
+    double mSamplingRate = 0;
+    int mRecordLength = 4096;
+    int mSegments = 0;
+    FormatVersion mFormatVersion = FormatVersion::MINISEED2;
+    char mSampleType = 'i';
+    uint8_t mSampleSize = 4;
+    bool mOpen = false;
+};
+
+}
+
+class RecordMerger::RecordMergerImpl
+{
+public:
+    int mNumberOfThreads = 1;
+};
+
+/// Constructor
+RecordMerger::RecordMerger() :
+    pImpl(std::make_unique<RecordMergerImpl> ())
+{
+}
+
+/// Copy constructor
+RecordMerger::RecordMerger(const RecordMerger &merger)
+{
+    *this = merger;
+}
+
+/// Move constructor
+RecordMerger::RecordMerger(RecordMerger &&merger) noexcept
+{
+    *this = std::move(merger);
+}
+
+/// Copy assignment
+RecordMerger& RecordMerger::operator=(const RecordMerger &merger)
+{
+    if (&merger == this){return *this;}
+    pImpl = std::make_unique<RecordMergerImpl> (*merger.pImpl);
+    return *this;
+}
+
+/// Move assignment
+RecordMerger& RecordMerger::operator=(RecordMerger &&merger) noexcept
+{
+    if (&merger == this){return *this;}
+    pImpl = std::move(merger.pImpl);
+    return *this;
+}
+
+/// Destructor
+RecordMerger::~RecordMerger() = default;
+
+/// Threads
+void RecordMerger::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int RecordMerger::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Merge
+MergeStatistics RecordMerger::merge(const std::string &input,
+                                    const std::string &outputFile,
+                                    const int recordLength,
+                                    const FormatVersion formatVersion) const
+{
+    bool lpowerOf2 = (recordLength > 0 &&
+                      (recordLength & (recordLength - 1)) == 0);
+    if (recordLength < 128 || recordLength > 1048576 ||
+        (formatVersion == FormatVersion::MINISEED2 && !lpowerOf2))
+    {
+        throw std::invalid_argument("Record length = "
+                                  + std::to_string(recordLength)
+                                  + " is invalid\n");
+    }
+    // Find the input files.  The output is never an input.
+    std::vector<std::string> fileNames;
+#if TEMBLOR_USE_FILESYSTEM == 1
+    if (!fs::exists(input))
+    {
+        throw std::invalid_argument("Input = " + input
+                                  + " does not exist\n");
+    }
+    bool loutputExists = fs::exists(outputFile);
+    if (fs::is_directory(input))
+    {
+        for (const auto &entry :
+             fs::recursive_directory_iterator(
+                 input, fs::directory_options::skip_permission_denied))
+        {
+            if (!fs::is_regular_file(entry.status())){continue;}
+            if (loutputExists && fs::equivalent(entry.path(), outputFile))
+            {
+                continue;
+            }
+            fileNames.push_back(entry.path().string());
+        }
+        std::sort(fileNames.begin(), fileNames.end());
+    }
+    else
+    {
+        if (loutputExists && fs::equivalent(input, outputFile))
+        {
+            throw std::invalid_argument("Output cannot overwrite input\n");
+        }
+        fileNames.push_back(input);
+    }
+#else
+    if (input == outputFile)
+    {
+        throw std::invalid_argument("Output cannot overwrite input\n");
+    }
+    fileNames.push_back(input);
+#endif
+    // Index the record headers
+    auto nFiles = static_cast<int> (fileNames.size());
+    std::vector<RecordIndex> indices(nFiles);
+    std::vector<char> lfailed(nFiles, 0);
+    #pragma omp parallel for num_threads(pImpl->mNumberOfThreads) \
+            schedule(dynamic, 1)
+    for (int ifile=0; ifile<nFiles; ++ifile)
+    {
+        try
+        {
+            indices[ifile].load(fileNames[ifile]);
+        }
+        catch (...)
+        {
+            lfailed[ifile] = 1;
+        }
+    }
+    if (nFiles == 1 && lfailed[0])
+    {
+        throw std::invalid_argument("Could not index " + fileNames[0]
+                                  + "\n");
+    }
+    // Sort the records by SNCL then start time
+    std::vector<SNCL> sncls;
+    std::unordered_map<SNCL, int> snclIndex;
+    std::vector<Entry> entries;
+    MergeStatistics statistics;
+    for (int ifile=0; ifile<nFiles; ++ifile)
+    {
+        if (lfailed[ifile])
+        {
+            fprintf(stderr, "%s: Could not index %s\n",
+                    __func__, fileNames[ifile].c_str());
+            continue;
+        }
+        statistics.files = statistics.files + 1;
+        auto fileSNCLs = indices[ifile].getSNCLs();
+        std::vector<int> map(fileSNCLs.size());
+        for (size_t i=0; i<fileSNCLs.size(); ++i)
+        {
+            auto idx = snclIndex.emplace(fileSNCLs[i],
+                                         static_cast<int> (sncls.size()));
+            if (idx.second){sncls.push_back(fileSNCLs[i]);}
+            map[i] = idx.first->second;
+        }
+        for (const auto &record : indices[ifile].getRecords())
+        {
+            Entry entry;
+            entry.startTime = record.startTime;
+            entry.offset = record.offset;
+            entry.length = record.length;
+            entry.file = ifile;
+            entry.sncl = map[record.sncl];
+            entries.push_back(entry);
+        }
+        indices[ifile].clear();
+    }
+    std::vector<int> snclOrder(sncls.size());
+    {
+    std::vector<int> perm(sncls.size());
+    for (size_t i=0; i<perm.size(); ++i){perm[i] = static_cast<int> (i);}
+    auto key = [&](const int i)
+    {
+        return std::make_tuple(sncls[i].getNetwork(), sncls[i].getStation(),
+                               sncls[i].getLocationCode(),
+                               sncls[i].getChannel());
+    };
+    std::sort(perm.begin(), perm.end(),
+              [&](const int lhs, const int rhs)
+              {
+                  return key(lhs) < key(rhs);
+              });
+    for (size_t i=0; i<perm.size(); ++i)
+    {
+        snclOrder[perm[i]] = static_cast<int> (i);
+    }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [&](const Entry &lhs, const Entry &rhs)
+              {
+                  if (lhs.sncl != rhs.sncl)
+                  {
+                      return snclOrder[lhs.sncl] < snclOrder[rhs.sncl];
+                  }
+                  if (lhs.startTime != rhs.startTime)
+                  {
+                      return lhs.startTime < rhs.startTime;
+                  }
+                  if (lhs.file != rhs.file){return lhs.file < rhs.file;}
+                  return lhs.offset < rhs.offset;
+              });
+    // Stream the records into the output
+    std::ofstream outfile(outputFile,
+                          std::ofstream::binary | std::ofstream::trunc);
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not open " + outputFile + "\n");
+    }
+    // A file is mapped when its first record is merged and released after
+    // its last record is merged
+    std::vector<std::unique_ptr<Temblor::Private::MappedFile>> files(nFiles);
+    std::vector<size_t> lastEntry(nFiles, 0);
+    for (size_t ie=0; ie<entries.size(); ++ie)
+    {
+        lastEntry[entries[ie].file] = ie;
+    }
+    SegmentPacker packer(&outfile, recordLength, formatVersion);
+    std::vector<Signature> signatures;
+    MS3Record *msr = nullptr;
+    int previousSNCL = -1;
+    int64_t previousStartTime = 0;
+    try
+    {
+    for (size_t ie=0; ie<entries.size(); ++ie)
+    {
+        if (ie > 0 && lastEntry[entries[ie - 1].file] == ie - 1)
+        {
+            files[entries[ie - 1].file] = nullptr;
+        }
+        const auto &entry = entries[ie];
+        auto &file = files[entry.file];
+        if (!file)
+        {
+            file = std::make_unique<Temblor::Private::MappedFile>
+                   (fileNames[entry.file]);
+            file->adviseSequential();
+        }
+        auto retcode = msr3_parse(file->data() + entry.offset,
+                                  static_cast<uint64_t> (entry.length),
+                                  &msr, 0, 0);
+        if (retcode != MS_NOERROR ||
+            msr->datalength < 1 || msr->datalength > msr->reclen)
+        {
+            throw std::runtime_error("Could not parse record at byte "
+                                   + std::to_string(entry.offset) + " of "
+                                   + fileNames[entry.file] + "\n");
+        }
+        statistics.records = statistics.records + 1;
+        // Drop exact duplicates of records with the same start time
+        if (entry.sncl != previousSNCL ||
+            entry.startTime != previousStartTime)
+        {
+            signatures.clear();
+        }
+        previousSNCL = entry.sncl;
+        previousStartTime = entry.startTime;
+        auto payload = msr->record + (msr->reclen - msr->datalength);
+        Signature signature;
+        signature.samplecnt = msr->samplecnt;
+        signature.samprate = msr->samprate;
+        signature.encoding = msr->encoding;
+        signature.datalength = msr->datalength;
+        signature.crc = ms_crc32c(reinterpret_cast<const uint8_t *> (payload),
+                                  static_cast<int> (msr->datalength), 0);
+        if (std::find(signatures.begin(), signatures.end(), signature)
+            != signatures.end())
+        {
+            statistics.duplicates = statistics.duplicates + 1;
+            continue;
+        }
+        signatures.push_back(signature);
+        // Decode the samples
+        auto nSamples = msr3_unpack_data(msr, 0);
+        if (nSamples != msr->samplecnt)
+        {
+            throw std::runtime_error("Could not decode record at byte "
+                                   + std::to_string(entry.offset) + " of "
+                                   + fileNames[entry.file] + "\n");
+        }
+        uint8_t sampleSize = 0;
+        char sampleType = 0;
+        ms_encoding_sizetype(msr->encoding, &sampleSize, &sampleType);
+        if (sampleType != 'i' && sampleType != 'f' && sampleType != 'd')
+        {
+            fprintf(stderr, "%s: Skipping record of %s with sample type %c\n",
+                    __func__, msr->sid, sampleType);
+            continue;
+        }
+        auto samplingRate = msr3_sampratehz(msr);
+        // Continue the segment, trim an overlap, or start a new segment
+        int64_t nSkip = 0;
+        if (packer.isCompatible(msr->sid, samplingRate, sampleType))
+        {
+            auto halfSample = toNanoseconds(0.5/samplingRate);
+            auto dt = msr->starttime - packer.getNextSampleTime();
+            if (dt > halfSample)
+            {
+                packer.close();
+            }
+            else if (dt < -halfSample)
+            {
+                nSkip = static_cast<int64_t>
+                        (std::round(-dt*1.e-9*samplingRate));
+                if (nSkip >= nSamples)
+                {
+                    statistics.overlapped = statistics.overlapped + 1;
+                    continue;
+                }
+                statistics.trimmed = statistics.trimmed + 1;
+                statistics.samplesTrimmed = statistics.samplesTrimmed
+                                          + static_cast<uint64_t> (nSkip);
+            }
+        }
+        else
+        {
+            packer.close();
+        }
+        if (!packer.isOpen())
+        {
+            packer.open(msr->sid, msr->starttime, samplingRate,
+                        sampleType, sampleSize);
+        }
+        auto samples = static_cast<const char *> (msr->datasamples);
+        packer.append(samples + nSkip*sampleSize, nSamples - nSkip);
+    }
+    packer.close();
+    }
+    catch (...)
+    {
+        msr3_free(&msr);
+        throw;
+    }
+    msr3_free(&msr);
+    outfile.close();
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not write " + outputFile + "\n");
+    }
+    statistics.samples = packer.getNumberOfSamplesWritten();
+    statistics.segments = packer.getNumberOfSegments();
+    return statistics;
+}
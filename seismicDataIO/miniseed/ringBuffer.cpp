@@ -0,0 +1,284 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/ringBuffer.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+/*
+ * The producer and readers synchronize like a sequence lock.  Before
+ * writing, the producer claims the samples and segment it is about to
+ * overwrite.  After writing, it publishes the new heads.  A reader copies
+ * the published samples and then re-reads the claims.  Anything the
+ * producer may have overwritten during the copy is older than the claim
+ * less the capacity, and it is discarded.  Because samples are atomics
+ * accessed with relaxed ordering, this race is well defined and costs
+ * nothing on x86.
+ */
+
+namespace
+{
+
+/// The number of times a reader retries when it is lapped by the producer
+constexpr int MAXIMUM_SNAPSHOT_ATTEMPTS = 8;
+
+/// Rounds n up to a power of 2
+int64_t roundUpToPowerOf2(const int64_t n) noexcept
+{
+    int64_t result = 1;
+    while (result < n){result = 2*result;}
+    return result;
+}
+
+/// Converts a duration in seconds to nanoseconds
+int64_t toNanoseconds(const double seconds) noexcept
+{
+    return static_cast<int64_t> (std::round(seconds*1.e9));
+}
+
+/// The published description of an appended run of samples
+struct SegmentSlot
+{
+    std::atomic<int64_t> startTime{0};
+    std::atomic<int64_t> firstSample{0};
+    std::atomic<int64_t> nSamples{0};
+    std::atomic<double> samplingRate{0};
+};
+
+/// A reader's copy of a segment slot
+struct Piece
+{
+    int64_t startTime = 0;
+    int64_t firstSample = 0;
+    int64_t nSamples = 0;
+    double samplingRate = 0;
+};
+
+}
+
+class RingBuffer::RingBufferImpl
+{
+public:
+    RingBufferImpl(const int64_t sampleCapacity,
+                   const int64_t segmentCapacity) :
+        mSamples(std::make_unique<std::atomic<double>[]> (sampleCapacity)),
+        mSegments(std::make_unique<SegmentSlot[]> (segmentCapacity)),
+        mSampleCapacity(sampleCapacity),
+        mSegmentCapacity(segmentCapacity)
+    {
+    }
+    std::unique_ptr<std::atomic<double>[]> mSamples;
+    std::unique_ptr<SegmentSlot[]> mSegments;
+    const int64_t mSampleCapacity;
+    const int64_t mSegmentCapacity;
+    /// The claims are written by the producer before it overwrites and
+    /// the heads after it has written.  They are kept on separate cache
+    /// lines from the buffers' descriptions to avoid false sharing.
+    alignas(64) std::atomic<int64_t> mSampleClaim{0};
+    std::atomic<int64_t> mSegmentClaim{0};
+    alignas(64) std::atomic<int64_t> mSampleHead{0};
+    std::atomic<int64_t> mSegmentHead{0};
+};
+
+/// Constructor
+RingBuffer::RingBuffer(const int sampleCapacity, const int segmentCapacity)
+{
+    constexpr int maximumCapacity = 1 << 30;
+    if (sampleCapacity < 1 || sampleCapacity > maximumCapacity)
+    {
+        throw std::invalid_argument("Sample capacity = "
+                                  + std::to_string(sampleCapacity)
+                                  + " must be in range [1,"
+                                  + std::to_string(maximumCapacity) + "]\n");
+    }
+    if (segmentCapacity < 1 || segmentCapacity > maximumCapacity)
+    {
+        throw std::invalid_argument("Segment capacity = "
+                                  + std::to_string(segmentCapacity)
+                                  + " must be in range [1,"
+                                  + std::to_string(maximumCapacity) + "]\n");
+    }
+    pImpl = std::make_unique<RingBufferImpl>
+            (roundUpToPowerOf2(sampleCapacity),
+             roundUpToPowerOf2(segmentCapacity));
+}
+
+/// Destructor
+RingBuffer::~RingBuffer() = default;
+
+/// Capacities
+int RingBuffer::getSampleCapacity() const noexcept
+{
+    return static_cast<int> (pImpl->mSampleCapacity);
+}
+
+int RingBuffer::getSegmentCapacity() const noexcept
+{
+    return static_cast<int> (pImpl->mSegmentCapacity);
+}
+
+int64_t RingBuffer::getNumberOfSamplesAppended() const noexcept
+{
+    return pImpl->mSampleHead.load(std::memory_order_acquire);
+}
+
+/// Producer
+void RingBuffer::append(const int64_t startTimeIn, const double samplingRate,
+                        const int nSamplesIn, const double xIn[])
+{
+    if (samplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate must be positive\n");
+    }
+    if (nSamplesIn < 0)
+    {
+        throw std::invalid_argument("Number of samples cannot be negative\n");
+    }
+    if (nSamplesIn == 0){return;}
+    if (xIn == nullptr){throw std::invalid_argument("x is NULL\n");}
+    // Only the latest samples fit
+    auto startTime = startTimeIn;
+    auto nSamples = static_cast<int64_t> (nSamplesIn);
+    const double *x = xIn;
+    if (nSamples > pImpl->mSampleCapacity)
+    {
+        auto nSkip = nSamples - pImpl->mSampleCapacity;
+        startTime = startTime + toNanoseconds(nSkip/samplingRate);
+        x = x + nSkip;
+        nSamples = pImpl->mSampleCapacity;
+    }
+    auto sampleHead = pImpl->mSampleHead.load(std::memory_order_relaxed);
+    auto segmentHead = pImpl->mSegmentHead.load(std::memory_order_relaxed);
+    // Claim what is about to be overwritten
+    pImpl->mSampleClaim.store(sampleHead + nSamples,
+                              std::memory_order_relaxed);
+    pImpl->mSegmentClaim.store(segmentHead + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // Write
+    auto sampleMask = pImpl->mSampleCapacity - 1;
+    for (int64_t i=0; i<nSamples; ++i)
+    {
+        pImpl->mSamples[(sampleHead + i) & sampleMask].store(
+            x[i], std::memory_order_relaxed);
+    }
+    auto &slot = pImpl->mSegments[segmentHead & (pImpl->mSegmentCapacity-1)];
+    slot.startTime.store(startTime, std::memory_order_relaxed);
+    slot.firstSample.store(sampleHead, std::memory_order_relaxed);
+    slot.nSamples.store(nSamples, std::memory_order_relaxed);
+    slot.samplingRate.store(samplingRate, std::memory_order_relaxed);
+    // Publish
+    pImpl->mSampleHead.store(sampleHead + nSamples,
+                             std::memory_order_release);
+    pImpl->mSegmentHead.store(segmentHead + 1, std::memory_order_release);
+}
+
+/// Consumers
+bool RingBuffer::getSnapshot(Trace *trace) const
+{
+    if (trace == nullptr){throw std::invalid_argument("trace is NULL\n");}
+    auto sampleMask = pImpl->mSampleCapacity - 1;
+    auto segmentMask = pImpl->mSegmentCapacity - 1;
+    std::vector<Piece> pieces;
+    std::vector<double> window;
+    for (int attempt=0; attempt<MAXIMUM_SNAPSHOT_ATTEMPTS; ++attempt)
+    {
+        // The segment head is published last so every sample of the
+        // published segments is visible
+        auto segmentHead = pImpl->mSegmentHead.load(std::memory_order_acquire);
+        if (segmentHead == 0){return false;}
+        auto firstSegment = std::max(int64_t {0},
+                                     segmentHead - pImpl->mSegmentCapacity);
+        pieces.resize(segmentHead - firstSegment);
+        for (auto is=firstSegment; is<segmentHead; ++is)
+        {
+            const auto &slot = pImpl->mSegments[is & segmentMask];
+            auto &piece = pieces[is - firstSegment];
+            piece.startTime = slot.startTime.load(std::memory_order_relaxed);
+            piece.firstSample
+                = slot.firstSample.load(std::memory_order_relaxed);
+            piece.nSamples = slot.nSamples.load(std::memory_order_relaxed);
+            piece.samplingRate
+                = slot.samplingRate.load(std::memory_order_relaxed);
+        }
+        auto sampleEnd = pieces.back().firstSample + pieces.back().nSamples;
+        auto sampleStart = std::max(sampleEnd - pImpl->mSampleCapacity,
+                                    pieces.front().firstSample);
+        sampleStart = std::max(int64_t {0}, sampleStart);
+        window.resize(std::max(int64_t {0}, sampleEnd - sampleStart));
+        for (auto i=sampleStart; i<sampleEnd; ++i)
+        {
+            window[i - sampleStart]
+                = pImpl->mSamples[i & sampleMask].load(
+                      std::memory_order_relaxed);
+        }
+        // Discard whatever the producer may have overwritten while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto sampleClaim = pImpl->mSampleClaim.load(std::memory_order_relaxed);
+        auto segmentClaim
+            = pImpl->mSegmentClaim.load(std::memory_order_relaxed);
+        auto validSample = std::max(sampleStart,
+                                    sampleClaim - pImpl->mSampleCapacity);
+        auto validSegment = segmentClaim - pImpl->mSegmentCapacity;
+        std::vector<Piece> kept;
+        kept.reserve(pieces.size());
+        for (int i=0; i<static_cast<int> (pieces.size()); ++i)
+        {
+            if (firstSegment + i < validSegment){continue;}
+            auto piece = pieces[i];
+            auto pieceEnd = piece.firstSample + piece.nSamples;
+            if (pieceEnd <= validSample){continue;}
+            if (piece.firstSample < validSample)
+            {
+                auto nSkip = validSample - piece.firstSample;
+                piece.startTime = piece.startTime
+                                + toNanoseconds(nSkip/piece.samplingRate);
+                piece.firstSample = validSample;
+                piece.nSamples = pieceEnd - validSample;
+            }
+            kept.push_back(piece);
+        }
+        if (kept.empty()){continue;}
+        // Order the pieces in time and merge the contiguous ones
+        std::stable_sort(kept.begin(), kept.end(),
+                         [](const Piece &lhs, const Piece &rhs)
+                         {
+                             return lhs.startTime < rhs.startTime;
+                         });
+        std::vector<Segment> segments;
+        std::vector<double> samples;
+        for (const auto &piece : kept)
+        {
+            auto first = window.data() + (piece.firstSample - sampleStart);
+            samples.insert(samples.end(), first, first + piece.nSamples);
+            if (!segments.empty())
+            {
+                auto &previous = segments.back();
+                auto halfSample = toNanoseconds(0.5/previous.samplingRate);
+                auto dt = piece.startTime - previous.getNextSampleTime();
+                if (std::abs(piece.samplingRate - previous.samplingRate) <
+                    1.e-6*previous.samplingRate && std::abs(dt) <= halfSample)
+                {
+                    previous.nSamples = previous.nSamples + piece.nSamples;
+                    continue;
+                }
+            }
+            Segment segment;
+            segment.startTime = piece.startTime;
+            segment.offset = static_cast<int64_t> (samples.size())
+                           - piece.nSamples;
+            segment.nSamples = piece.nSamples;
+            segment.samplingRate = piece.samplingRate;
+            segments.push_back(segment);
+        }
+        trace->setData(segments, samples.data());
+        return true;
+    }
+    return false;
+}
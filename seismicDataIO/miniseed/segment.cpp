@@ -0,0 +1,18 @@
+#include <cmath>
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+int64_t Segment::getEndTime() const noexcept
+{
+    if (nSamples < 1 || samplingRate <= 0){return startTime;}
+    auto duration = static_cast<double> (nSamples - 1)/samplingRate;
+    return startTime + static_cast<int64_t> (std::round(duration*1.e9));
+}
+
+int64_t Segment::getNextSampleTime() const noexcept
+{
+    if (samplingRate <= 0){return startTime;}
+    auto duration = static_cast<double> (nSamples)/samplingRate;
+    return startTime + static_cast<int64_t> (std::round(duration*1.e9));
+}
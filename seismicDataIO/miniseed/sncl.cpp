@@ -1,11 +1,12 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <cstdint>
 #include <string>
 #include <algorithm>
-#include "temblor/dataReaders/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
 
-using namespace Temblor::DataReaders::MiniSEED;
+using namespace Temblor::SeismicDataIO::MiniSEED;
 
 #define NETWORK_LENGTH 10 
 #define STATION_LENGTH 10
@@ -42,6 +43,23 @@ public:
     char mLocation[LOCATION_LENGTH+1] = {"\0\0\0\0\0\0\0\0\0\0"};
 };
 
+namespace
+{
+/// Accumulates the FNV-1a hash of a field.  Only the characters preceding
+/// the null terminator are hashed so that the hash is consistent with
+/// operator==.  A separator distinguishes, e.g., "AB"+"C" from "A"+"BC".
+void hashField(const char *field, const size_t maxlen, uint64_t *hash)
+{
+    constexpr uint64_t prime = 1099511628211ULL;
+    auto len = strnlen(field, maxlen);
+    for (size_t i=0; i<len; ++i)
+    {
+        *hash = (*hash ^ static_cast<unsigned char> (field[i]))*prime;
+    }
+    *hash = (*hash ^ 0xff)*prime;
+}
+}
+
 /// Constructors
 SNCL::SNCL() :
     pImpl(std::make_unique<SNCLImpl> ())
@@ -73,16 +91,21 @@ SNCL& SNCL::operator=(SNCL &&sncl) noexcept
     return *this;
 }
 
-bool SNCL::operator==(const SNCL &sncl) noexcept
+bool SNCL::operator==(const SNCL &sncl) const noexcept
 {
-    if (getNetwork() != sncl.getNetwork()){return false;}
-    if (getStation() != sncl.getStation()){return false;}
-    if (getChannel() != sncl.getChannel()){return false;}
-    if (getLocationCode() != sncl.getLocationCode()){return false;}
+    // Compare the fixed size arrays rather than building strings
+    if (std::strncmp(pImpl->mNetwork, sncl.pImpl->mNetwork,
+                     NETWORK_LENGTH) != 0){return false;}
+    if (std::strncmp(pImpl->mStation, sncl.pImpl->mStation,
+                     STATION_LENGTH) != 0){return false;}
+    if (std::strncmp(pImpl->mChannel, sncl.pImpl->mChannel,
+                     CHANNEL_LENGTH) != 0){return false;}
+    if (std::strncmp(pImpl->mLocation, sncl.pImpl->mLocation,
+                     LOCATION_LENGTH) != 0){return false;}
     return true;
 }
 
-bool SNCL::operator!=(const SNCL &sncl) noexcept
+bool SNCL::operator!=(const SNCL &sncl) const noexcept
 {
     return !(*this == sncl);
 }
@@ -184,3 +207,13 @@ bool SNCL::isEmpty() const noexcept
     if (lenos == 0){return true;}
     return false;
 }
+
+size_t SNCL::getHash() const noexcept
+{
+    uint64_t hash = 14695981039346656037ULL;
+    hashField(pImpl->mNetwork,  NETWORK_LENGTH,  &hash);
+    hashField(pImpl->mStation,  STATION_LENGTH,  &hash);
+    hashField(pImpl->mChannel,  CHANNEL_LENGTH,  &hash);
+    hashField(pImpl->mLocation, LOCATION_LENGTH, &hash);
+    return static_cast<size_t> (hash);
+}
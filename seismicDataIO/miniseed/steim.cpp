@@ -0,0 +1,393 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "temblor/private/cpuFeatures.hpp"
+#include "temblor/seismicDataIO/miniseed/steim.hpp"
+#ifdef TEMBLOR_USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+using namespace Temblor::SeismicDataIO::MiniSEED;
+
+/*
+ * A Steim frame is 16 big-endian 32-bit words.  The first word holds 2-bit
+ * codes that describe how the differences are packed in the other 15 words.
+ * In the first frame words 1 and 2 hold the forward and reverse integration
+ * constants.  Each word is expanded into up to 7 differences that are then
+ * integrated with a prefix sum.  The first difference of a record is
+ * replaced by the forward integration constant.
+ */
+
+namespace
+{
+
+constexpr int FRAME_SIZE = 64;
+constexpr int WORDS_PER_FRAME = 16;
+/// The most differences in a frame is 15 words of 7 differences.  The
+/// buffer is padded so that 8 lanes can always be stored.
+constexpr int DIFFERENCE_BUFFER_SIZE = 128;
+
+/// The ways in which differences are packed in a word
+enum Layout
+{
+    BYTE4x8 = 0, // Steim1 and Steim2
+    HALF2x16,    // Steim1
+    FULL1x32,    // Steim1
+    BITS1x30,    // Steim2
+    BITS2x15,    // Steim2
+    BITS3x10,    // Steim2
+    BITS5x6,     // Steim2
+    BITS6x5,     // Steim2
+    BITS7x4,     // Steim2
+    INVALID
+};
+constexpr std::array<int, 9> LAYOUT_COUNT{4, 2, 1, 1, 2, 3, 5, 6, 7};
+constexpr std::array<int, 9> LAYOUT_BITS{8, 16, 32, 30, 15, 10, 6, 5, 4};
+
+/// Difference i of a word is moved to the top of the lane with a left shift
+/// then sign extended with an arithmetic right shift of 32 - bits.  Unused
+/// lanes are shifted out.
+struct ShiftTable
+{
+    constexpr ShiftTable() :
+        left{},
+        multiplier{}
+    {
+        for (int layout=0; layout<9; ++layout)
+        {
+            for (int i=0; i<8; ++i)
+            {
+                auto count = LAYOUT_COUNT[layout];
+                auto bits = LAYOUT_BITS[layout];
+                left[layout][i] = 32;
+                multiplier[layout][i] = 0;
+                if (i < count)
+                {
+                    left[layout][i] = 32 - (count - i)*bits;
+                    multiplier[layout][i] = 1 << left[layout][i];
+                }
+            }
+        }
+    }
+    alignas(32) int32_t left[9][8];
+    alignas(32) int32_t multiplier[9][8];
+};
+constexpr ShiftTable SHIFT_TABLE;
+
+inline uint32_t loadBigEndian(const uint8_t *x) noexcept
+{
+    uint32_t word;
+    std::memcpy(&word, x, sizeof(uint32_t));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+/// Determines how the differences are packed in a word
+template<int version>
+inline int getLayout(const uint32_t code, const uint32_t word) noexcept
+{
+    if (code == 1){return BYTE4x8;}
+    if constexpr (version == 1)
+    {
+        if (code == 2){return HALF2x16;}
+        return FULL1x32;
+    }
+    else
+    {
+        auto dnib = word >> 30;
+        if (code == 2)
+        {
+            if (dnib == 1){return BITS1x30;}
+            if (dnib == 2){return BITS2x15;}
+            if (dnib == 3){return BITS3x10;}
+            return INVALID;
+        }
+        if (dnib == 0){return BITS5x6;}
+        if (dnib == 1){return BITS6x5;}
+        if (dnib == 2){return BITS7x4;}
+        return INVALID;
+    }
+}
+
+/// Portable kernels
+struct ScalarKernel
+{
+    template<int version>
+    static int expandFrame(const uint8_t *frame, const int firstWord,
+                           const int64_t maxDiffs, int32_t diffs[])
+    {
+        auto controls = loadBigEndian(frame);
+        int nDiffs = 0;
+        for (int w=firstWord; w<WORDS_PER_FRAME && nDiffs<maxDiffs; ++w)
+        {
+            auto code = (controls >> (30 - 2*w)) & 0x3;
+            if (code == 0){continue;}
+            auto word = loadBigEndian(frame + 4*w);
+            auto layout = getLayout<version>(code, word);
+            if (layout == INVALID){return -1;}
+            auto count = LAYOUT_COUNT[layout];
+            auto rightShift = 32 - LAYOUT_BITS[layout];
+            for (int i=0; i<count; ++i)
+            {
+                auto shifted = word << SHIFT_TABLE.left[layout][i];
+                diffs[nDiffs + i]
+                    = static_cast<int32_t> (shifted) >> rightShift;
+            }
+            nDiffs = nDiffs + count;
+        }
+        return nDiffs;
+    }
+    static int32_t integrate(const int n, int32_t x[], const int32_t carry)
+    {
+        // Unsigned arithmetic wraps like the SIMD kernels
+        auto sum = static_cast<uint32_t> (carry);
+        for (int i=0; i<n; ++i)
+        {
+            sum = sum + static_cast<uint32_t> (x[i]);
+            x[i] = static_cast<int32_t> (sum);
+        }
+        return static_cast<int32_t> (sum);
+    }
+};
+
+#ifdef TEMBLOR_USE_X86_SIMD
+/// SSE4.1 kernels.  Variable left shifts are done by multiplying with
+/// powers of 2.
+struct SSE41Kernel
+{
+    template<int version>
+    __attribute__((target("sse4.1")))
+    static int expandFrame(const uint8_t *frame, const int firstWord,
+                           const int64_t maxDiffs, int32_t diffs[])
+    {
+        auto controls = loadBigEndian(frame);
+        int nDiffs = 0;
+        for (int w=firstWord; w<WORDS_PER_FRAME && nDiffs<maxDiffs; ++w)
+        {
+            auto code = (controls >> (30 - 2*w)) & 0x3;
+            if (code == 0){continue;}
+            auto word = loadBigEndian(frame + 4*w);
+            auto layout = getLayout<version>(code, word);
+            if (layout == INVALID){return -1;}
+            auto rightShift = _mm_cvtsi32_si128(32 - LAYOUT_BITS[layout]);
+            auto v = _mm_set1_epi32(static_cast<int32_t> (word));
+            auto m = reinterpret_cast<const __m128i *>
+                     (SHIFT_TABLE.multiplier[layout]);
+            auto lo = _mm_sra_epi32(_mm_mullo_epi32(v, _mm_load_si128(m)),
+                                    rightShift);
+            _mm_storeu_si128(reinterpret_cast<__m128i *> (diffs + nDiffs),
+                             lo);
+            if (LAYOUT_COUNT[layout] > 4)
+            {
+                auto hi = _mm_sra_epi32(_mm_mullo_epi32(v,
+                                            _mm_load_si128(m + 1)),
+                                        rightShift);
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i *> (diffs + nDiffs + 4), hi);
+            }
+            nDiffs = nDiffs + LAYOUT_COUNT[layout];
+        }
+        return nDiffs;
+    }
+    __attribute__((target("sse4.1")))
+    static int32_t integrate(const int n, int32_t x[], const int32_t carry)
+    {
+        auto sum = _mm_set1_epi32(carry);
+        for (int i=0; i<n; i=i+4)
+        {
+            auto xPtr = reinterpret_cast<__m128i *> (x + i);
+            auto v = _mm_loadu_si128(xPtr);
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, sum);
+            _mm_storeu_si128(xPtr, v);
+            sum = _mm_shuffle_epi32(v, 0xFF);
+        }
+        // The padded lanes past n hold garbage so return the n'th sum
+        return x[n - 1];
+    }
+};
+
+/// AVX2 kernels
+struct AVX2Kernel
+{
+    template<int version>
+    __attribute__((target("avx2")))
+    static int expandFrame(const uint8_t *frame, const int firstWord,
+                           const int64_t maxDiffs, int32_t diffs[])
+    {
+        auto controls = loadBigEndian(frame);
+        int nDiffs = 0;
+        for (int w=firstWord; w<WORDS_PER_FRAME && nDiffs<maxDiffs; ++w)
+        {
+            auto code = (controls >> (30 - 2*w)) & 0x3;
+            if (code == 0){continue;}
+            auto word = loadBigEndian(frame + 4*w);
+            auto layout = getLayout<version>(code, word);
+            if (layout == INVALID){return -1;}
+            auto rightShift = _mm_cvtsi32_si128(32 - LAYOUT_BITS[layout]);
+            auto leftShift = _mm256_load_si256(
+                reinterpret_cast<const __m256i *> (SHIFT_TABLE.left[layout]));
+            auto v = _mm256_set1_epi32(static_cast<int32_t> (word));
+            v = _mm256_sra_epi32(_mm256_sllv_epi32(v, leftShift), rightShift);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *> (diffs + nDiffs),
+                                v);
+            nDiffs = nDiffs + LAYOUT_COUNT[layout];
+        }
+        return nDiffs;
+    }
+    __attribute__((target("avx2")))
+    static int32_t integrate(const int n, int32_t x[], const int32_t carry)
+    {
+        auto sum = _mm256_set1_epi32(carry);
+        const auto last = _mm256_set1_epi32(7);
+        for (int i=0; i<n; i=i+8)
+        {
+            auto xPtr = reinterpret_cast<__m256i *> (x + i);
+            auto v = _mm256_loadu_si256(xPtr);
+            // Prefix sums in each 128 bit lane
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+            v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+            // Add the total of the lower lane to the upper lane
+            auto lowerTotal = _mm256_shuffle_epi32(v, 0xFF);
+            lowerTotal = _mm256_permute2x128_si256(lowerTotal, lowerTotal,
+                                                   0x08);
+            v = _mm256_add_epi32(v, lowerTotal);
+            v = _mm256_add_epi32(v, sum);
+            _mm256_storeu_si256(xPtr, v);
+            sum = _mm256_permutevar8x32_epi32(v, last);
+        }
+        return x[n - 1];
+    }
+};
+#endif
+
+/// Expands and integrates the frames one at a time.  Like libmseed this
+/// stops at the requested samples since unused trailing words may hold
+/// garbage.
+template<int version, class Kernel>
+int64_t decodeFrames(const size_t nBytes, const uint8_t *frames,
+                     const int64_t nSamples, int32_t y[])
+{
+    alignas(32) std::array<int32_t, DIFFERENCE_BUFFER_SIZE> diffs{};
+    auto nFrames = static_cast<int64_t> (nBytes/FRAME_SIZE);
+    auto forwardConstant = static_cast<int32_t> (loadBigEndian(frames + 4));
+    int32_t carry = 0;
+    int64_t nDecoded = 0;
+    bool lfirst = true;
+    for (int64_t frame=0; frame<nFrames && nDecoded<nSamples; ++frame)
+    {
+        int firstWord = (frame == 0) ? 3 : 1;
+        auto nDiffs = Kernel::template expandFrame<version>
+                      (frames + frame*FRAME_SIZE, firstWord,
+                       nSamples - nDecoded, diffs.data());
+        if (nDiffs < 0){return -1;}
+        if (nDiffs == 0){continue;}
+        // The first sample is the forward integration constant
+        if (lfirst)
+        {
+            diffs[0] = forwardConstant;
+            carry = 0;
+            lfirst = false;
+        }
+        carry = Kernel::integrate(nDiffs, diffs.data(), carry);
+        auto nCopy = std::min(static_cast<int64_t> (nDiffs),
+                              nSamples - nDecoded);
+        std::copy(diffs.data(), diffs.data() + nCopy, y + nDecoded);
+        nDecoded = nDecoded + nCopy;
+    }
+    return nDecoded;
+}
+
+template<int version>
+int64_t decodeSteim(const size_t nBytes, const void *frames,
+                    const int64_t nSamples, int32_t y[],
+                    InstructionSet instructionSet)
+{
+    if (nSamples < 1){return 0;}
+    if (frames == nullptr){throw std::invalid_argument("frames is NULL\n");}
+    if (y == nullptr){throw std::invalid_argument("y is NULL\n");}
+    if (!isSupported(instructionSet))
+    {
+        throw std::invalid_argument("Instruction set not supported\n");
+    }
+    if (instructionSet == InstructionSet::AUTOMATIC)
+    {
+        instructionSet = InstructionSet::SCALAR;
+        if (isSupported(InstructionSet::SSE41))
+        {
+            instructionSet = InstructionSet::SSE41;
+        }
+        if (isSupported(InstructionSet::AVX2))
+        {
+            instructionSet = InstructionSet::AVX2;
+        }
+    }
+    auto framePtr = static_cast<const uint8_t *> (frames);
+#ifdef TEMBLOR_USE_X86_SIMD
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return decodeFrames<version, AVX2Kernel> (nBytes, framePtr,
+                                                  nSamples, y);
+    }
+    if (instructionSet == InstructionSet::SSE41)
+    {
+        return decodeFrames<version, SSE41Kernel> (nBytes, framePtr,
+                                                   nSamples, y);
+    }
+#endif
+    return decodeFrames<version, ScalarKernel> (nBytes, framePtr,
+                                                nSamples, y);
+}
+
+}
+
+bool Temblor::SeismicDataIO::MiniSEED::isSupported(
+    const InstructionSet instructionSet) noexcept
+{
+    if (instructionSet == InstructionSet::SSE41)
+    {
+        return Temblor::Private::haveSSE41();
+    }
+    if (instructionSet == InstructionSet::AVX2)
+    {
+        return Temblor::Private::haveAVX2();
+    }
+    return true;
+}
+
+int32_t Temblor::SeismicDataIO::MiniSEED::getReverseIntegrationConstant(
+    const size_t nBytes, const void *frames)
+{
+    if (nBytes < FRAME_SIZE)
+    {
+        throw std::invalid_argument("nBytes = " + std::to_string(nBytes)
+                                  + " must be at least "
+                                  + std::to_string(FRAME_SIZE) + "\n");
+    }
+    if (frames == nullptr){throw std::invalid_argument("frames is NULL\n");}
+    auto framePtr = static_cast<const uint8_t *> (frames);
+    return static_cast<int32_t> (loadBigEndian(framePtr + 8));
+}
+
+int64_t Temblor::SeismicDataIO::MiniSEED::decodeSteim1(
+    const size_t nBytes, const void *frames,
+    const int64_t nSamples, int32_t y[],
+    const InstructionSet instructionSet)
+{
+    return decodeSteim<1> (nBytes, frames, nSamples, y, instructionSet);
+}
+
+int64_t Temblor::SeismicDataIO::MiniSEED::decodeSteim2(
+    const size_t nBytes, const void *frames,
+    const int64_t nSamples, int32_t y[],
+    const InstructionSet instructionSet)
+{
+    return decodeSteim<2> (nBytes, frames, nSamples, y, instructionSet);
+}
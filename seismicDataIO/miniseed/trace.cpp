@@ -2,35 +2,190 @@
 #include <cstdlib>
 #include <climits>
 #include <cstring>
+#include <cmath>
 #include <array>
+#include <fstream>
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <string>
 #include <libmseed.h>
+#include "temblor/private/alignedBuffer.hpp"
 #include "temblor/private/filesystem.hpp"
-#include "temblor/dataReaders/miniseed/sncl.hpp"
-#include "temblor/dataReaders/miniseed/trace.hpp"
+#include "temblor/private/mappedFile.hpp"
+#include "temblor/private/sampleConversion.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/segment.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/steim.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
 #include "temblor/utilities/time.hpp"
 
 using namespace Temblor;
-using namespace Temblor::DataReaders::MiniSEED;
+using namespace Temblor::SeismicDataIO::MiniSEED;
 
 namespace
 {
 
-template<typename T>
-void copySeismogram(const int n, const T x[], T y[])
+/// The size of a sample in bytes
+size_t getSampleSize(const Precision precision) noexcept
 {
-    std::memcpy(y, x, static_cast<size_t> (n)*sizeof(T));
+    if (precision == Precision::INT32){return sizeof(int32_t);}
+    if (precision == Precision::FLOAT32){return sizeof(float);}
+    if (precision == Precision::FLOAT64){return sizeof(double);}
+    return 0;
 }
 
-template<typename T, typename S>
-void convertSeismogram(const int n, const T x[], S y[])
+/// Converts an epochal time in seconds to nanoseconds
+int64_t toNanoseconds(const double epoch)
 {
-    #pragma omp simd
-    for (int i=0; i<n; ++i)
+    return static_cast<int64_t> (std::round(epoch*1.e9));
+}
+
+/// Packs a SNCL into a miniSEED source identifier (SID)
+std::string sncl2sid(const SNCL &sncl)
+{
+    std::string network  = sncl.getNetwork();
+    std::string station  = sncl.getStation();
+    std::string channel  = sncl.getChannel();
+    std::string location = sncl.getLocationCode();
+    char *networkQuery = NULL;
+    if (network.length() > 0){networkQuery = network.data();}
+    char *stationQuery = NULL;
+    if (station.length() > 0){stationQuery = station.data();}
+    char *channelQuery = NULL;
+    if (channel.length() > 0){channelQuery = channel.data();}
+    char *locationQuery = NULL;
+    if (location.length() > 0){locationQuery = location.data();}
+    std::array<char, LM_SIDLEN+1> sid;
+    memset(sid.data(), 0, (LM_SIDLEN+1)*sizeof(char));
+    auto retcode = ms_nslc2sid(sid.data(), LM_SIDLEN, 0,
+                               networkQuery, stationQuery,
+                               locationQuery, channelQuery);
+    if (retcode < 0)
+    {
+        throw std::runtime_error("Failed to create target SNCL\n");
+    }
+    return std::string(sid.data());
+}
+
+/// Record handler for msr3_pack that appends the record to a buffer
+void appendRecord(char *record, int recordLength, void *handlerData)
+{
+    auto buffer = static_cast<std::vector<char> *> (handlerData);
+    buffer->insert(buffer->end(), record, record + recordLength);
+}
+
+/// Decodes a record's payload into y which has space for the record's
+/// samples.  Big-endian Steim payloads are decoded with the native
+/// decoders unless libmseed is requested.  Everything else is handed to
+/// libmseed.
+int64_t decodePayload(const MS3Record *msr, const char *payload,
+                      const uint8_t sampleSize, const Decoder decoder,
+                      char *y)
+{
+    if (decoder == Decoder::NATIVE &&
+        (msr->encoding == DE_STEIM1 || msr->encoding == DE_STEIM2))
+    {
+        // Steim is big-endian in miniSEED3.  In miniSEED2 the payload
+        // swap flag is relative to the host.
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        bool lbigEndian = (msr->swapflag & MSSWAP_PAYLOAD);
+#else
+        bool lbigEndian = !(msr->swapflag & MSSWAP_PAYLOAD);
+#endif
+        if (msr->formatversion == 3 || lbigEndian)
+        {
+            auto x = reinterpret_cast<int32_t *> (y);
+            int64_t nDecoded;
+            if (msr->encoding == DE_STEIM1)
+            {
+                nDecoded = decodeSteim1(msr->datalength, payload,
+                                        msr->samplecnt, x);
+            }
+            else
+            {
+                nDecoded = decodeSteim2(msr->datalength, payload,
+                                        msr->samplecnt, x);
+            }
+            // Like libmseed a failed integrity check is only a warning
+            if (nDecoded > 0 && nDecoded == msr->samplecnt &&
+                x[nDecoded - 1] != getReverseIntegrationConstant(
+                                       msr->datalength, payload))
+            {
+                fprintf(stderr, "%s: %s last sample differs from the "
+                        "reverse integration constant\n",
+                        __func__, msr->sid);
+            }
+            return nDecoded;
+        }
+    }
+    char sampleType;
+    int8_t swapFlag = (msr->swapflag & MSSWAP_PAYLOAD) ? 1 : 0;
+    return ms_decode_data(payload, msr->datalength,
+                          msr->encoding, msr->samplecnt,
+                          y, msr->samplecnt*sampleSize,
+                          &sampleType, swapFlag, msr->sid, 0);
+}
+
+/// Decodes the records of the segments into y.  The records are
+/// independent so each is decoded straight into its precomputed offset of
+/// y, hence, the result does not depend on the number of threads.
+bool decodeRecordList(const std::vector<MS3TraceSeg *> &segments,
+                      const std::vector<Segment> &table,
+                      const uint8_t sampleSize, const Decoder decoder,
+                      char *y, const int nThreads)
+{
+    std::vector<const MS3RecordPtr *> records;
+    std::vector<const char *> payloads;
+    std::vector<int64_t> offsets;
+    std::map<std::string, std::unique_ptr<Temblor::Private::MappedFile>> files;
+    for (size_t is=0; is<segments.size(); ++is)
     {
-        y[i] = static_cast<S> (x[i]);
+        auto offset = table[is].offset;
+        for (auto recordPtr = segments[is]->recordlist->first;
+             recordPtr != NULL;
+             recordPtr = recordPtr->next)
+        {
+            // Locate the record's payload
+            const char *record = recordPtr->bufferptr;
+            if (!record)
+            {
+                if (!recordPtr->filename){return false;}
+                auto &file = files[recordPtr->filename];
+                if (!file)
+                {
+                    file = std::make_unique<Temblor::Private::MappedFile>
+                           (recordPtr->filename);
+                }
+                auto end = recordPtr->fileoffset + recordPtr->dataoffset
+                         + recordPtr->msr->datalength;
+                if (recordPtr->fileoffset < 0 ||
+                    static_cast<size_t> (end) > file->size())
+                {
+                    return false;
+                }
+                record = file->data() + recordPtr->fileoffset;
+            }
+            records.push_back(recordPtr);
+            payloads.push_back(record + recordPtr->dataoffset);
+            offsets.push_back(offset);
+            offset = offset + recordPtr->msr->samplecnt;
+        }
+        if (offset != table[is].offset + table[is].nSamples){return false;}
+    }
+    auto nRecords = static_cast<int> (records.size());
+    int nFailed = 0;
+    #pragma omp parallel for num_threads(nThreads) schedule(dynamic, 16) \
+            reduction(+:nFailed)
+    for (int ir=0; ir<nRecords; ++ir)
+    {
+        auto msr = records[ir]->msr;
+        auto nDecoded = decodePayload(msr, payloads[ir], sampleSize,
+                                      decoder, y + offsets[ir]*sampleSize);
+        if (nDecoded != msr->samplecnt){nFailed = nFailed + 1;}
     }
+    return (nFailed == 0);
 }
 
 }
@@ -40,19 +195,341 @@ class Trace::TraceImpl
 public:
     void clearTimeSeries() noexcept
     {
-        mData64f.clear();
-        mData32f.clear();
-        mData32i.clear();
+        mData.clear();
+        mSegments.clear();
         mPrecision = Precision::UNKNOWN;
         mNumberOfSamples = 0;
     }
+    /// Sizes the sample buffer to hold nSamples of the given precision
+    char *allocateSamples(const Precision precision, const int64_t nSamples)
+    {
+        mData.allocate(static_cast<size_t> (nSamples)
+                      *getSampleSize(precision));
+        mPrecision = precision;
+        return mData.data<char> ();
+    }
+    /// Sets the time series to a copy of x
+    template<typename T>
+    void setSamples(const Precision precision, const size_t nSamples,
+                    const T x[])
+    {
+        clearTimeSeries();
+        if (nSamples > INT_MAX)
+        {
+            throw std::invalid_argument("Number of samples = "
+                                      + std::to_string(nSamples)
+                                      + " cannot exceed "
+                                      + std::to_string(INT_MAX) + "\n");
+        }
+        if (nSamples > 0 && x == nullptr)
+        {
+            throw std::invalid_argument("x cannot be NULL\n");
+        }
+        auto y = reinterpret_cast<T *> (allocateSamples(precision,
+                                                        nSamples));
+        mNumberOfSamples = static_cast<int64_t> (nSamples);
+        Temblor::Private::convertSamples(mNumberOfSamples, x, y);
+        setSingleSegment();
+    }
+    /// Converts the samples [offset, offset + nSamples) into y
+    template<typename S>
+    void getSamples(const int64_t offset, const int64_t nSamples,
+                    S y[]) const
+    {
+        if (mPrecision == Precision::INT32)
+        {
+            Temblor::Private::convertSamples(
+                nSamples, mData.data<int32_t> () + offset, y);
+        }
+        else if (mPrecision == Precision::FLOAT32)
+        {
+            Temblor::Private::convertSamples(
+                nSamples, mData.data<float> () + offset, y);
+        }
+        else if (mPrecision == Precision::FLOAT64)
+        {
+            Temblor::Private::convertSamples(
+                nSamples, mData.data<double> () + offset, y);
+        }
+    }
+    /// Checks the arguments of a request for the samples
+    /// [offset, offset + nSamples)
+    void checkSampleRange(const int offset, const int nSamples,
+                          const void *x) const
+    {
+        if (mPrecision == Precision::UNKNOWN)
+        {
+            throw std::runtime_error("Data was never set\n");
+        }
+        if (offset < 0 || nSamples < 0 ||
+            offset > mNumberOfSamples - nSamples)
+        {
+            throw std::invalid_argument("Samples [" + std::to_string(offset)
+                                      + ", "
+                                      + std::to_string(offset + nSamples)
+                                      + ") exceed number of samples = "
+                                      + std::to_string(mNumberOfSamples)
+                                      + "\n");
+        }
+        if (nSamples > 0 && x == nullptr)
+        {
+            throw std::invalid_argument("x is NULL\n");
+        }
+    }
+    /// Describes a time series that was set as a single segment
+    void setSingleSegment()
+    {
+        mSegments.resize(1);
+        mSegments[0].startTime = toNanoseconds(mStartTime.getEpochalTime());
+        mSegments[0].offset = 0;
+        mSegments[0].nSamples = mNumberOfSamples;
+        mSegments[0].samplingRate = mSamplingRate;
+    }
+    /// Finds the gaps or overlaps between consecutive segments.  A segment
+    /// is compared to the latest ending of the segments preceding it and
+    /// differences of less than half a sample are ignored.
+    std::vector<Discontinuity> findDiscontinuities(const bool lgaps) const
+    {
+        std::vector<Discontinuity> result;
+        if (mSegments.empty()){return result;}
+        auto previous = mSegments[0];
+        for (int is=1; is<static_cast<int> (mSegments.size()); ++is)
+        {
+            const auto &segment = mSegments[is];
+            auto nextSampleTime = previous.getNextSampleTime();
+            int64_t tolerance = 0;
+            if (previous.samplingRate > 0)
+            {
+                tolerance = toNanoseconds(0.5/previous.samplingRate);
+            }
+            if (lgaps && segment.startTime > nextSampleTime + tolerance)
+            {
+                Discontinuity gap;
+                gap.startTime = previous.getEndTime();
+                gap.endTime = segment.startTime;
+                gap.segment = is;
+                result.push_back(gap);
+            }
+            else if (!lgaps && segment.startTime < nextSampleTime - tolerance)
+            {
+                Discontinuity overlap;
+                overlap.startTime = segment.startTime;
+                overlap.endTime = std::min(previous.getEndTime(),
+                                           segment.getEndTime());
+                overlap.segment = is;
+                result.push_back(overlap);
+            }
+            if (segment.getNextSampleTime() > nextSampleTime)
+            {
+                previous = segment;
+            }
+        }
+        return result;
+    }
+    /// Decodes the samples of the records in the time window
+    /// [startTime, endTime] (ns).  The records must belong to one SNCL and
+    /// be sorted by start time.  On failure the caller clears the trace.
+    void readRecords(const char *data,
+                     const std::vector<IndexedRecord> &records,
+                     const int64_t startTime, const int64_t endTime)
+    {
+        // Allow for the microsecond resolution of the time class
+        constexpr int64_t tolerance = 1000;
+        // Determine the samples of each record in the window from the headers
+        auto nRecords = static_cast<int> (records.size());
+        std::vector<int64_t> firstSample(nRecords, 0);
+        std::vector<int64_t> nKeep(nRecords, 0);
+        std::vector<int64_t> outputOffset(nRecords, 0);
+        MS3Record *msr = nullptr;
+        uint8_t sampleSize = 0;
+        char sampleType = 0;
+        bool lfail = false;
+        for (int ir=0; ir<nRecords; ++ir)
+        {
+            const auto &record = records[ir];
+            auto retcode = msr3_parse(data + record.offset,
+                                      static_cast<uint64_t> (record.length),
+                                      &msr, 0, 0);
+            if (retcode != MS_NOERROR)
+            {
+                fprintf(stderr, "%s: Could not parse record at byte %ld\n",
+                        __func__, static_cast<long> (record.offset));
+                lfail = true;
+                break;
+            }
+            uint8_t recordSampleSize;
+            char recordSampleType;
+            ms_encoding_sizetype(msr->encoding,
+                                 &recordSampleSize, &recordSampleType);
+            if (sampleType == 0)
+            {
+                sampleSize = recordSampleSize;
+                sampleType = recordSampleType;
+            }
+            if (recordSampleType != sampleType)
+            {
+                fprintf(stderr, "%s: Records have different sample types\n",
+                        __func__);
+                lfail = true;
+                break;
+            }
+            auto dt0 = static_cast<double> (startTime - msr->starttime
+                                          - tolerance);
+            auto dt1 = static_cast<double> (endTime - msr->starttime
+                                          + tolerance);
+            auto i0 = static_cast<int64_t>
+                      (std::ceil(dt0*1.e-9*msr->samprate));
+            auto i1 = static_cast<int64_t>
+                      (std::floor(dt1*1.e-9*msr->samprate));
+            i0 = std::max(int64_t {0}, i0);
+            i1 = std::min(msr->samplecnt - 1, i1);
+            if (i1 < i0){continue;}
+            auto nSamples = i1 - i0 + 1;
+            firstSample[ir] = i0;
+            nKeep[ir] = nSamples;
+            outputOffset[ir] = mNumberOfSamples;
+            // Extend the current segment or begin a new one
+            Segment segment;
+            segment.startTime = msr->starttime
+                              + toNanoseconds(i0/msr->samprate);
+            segment.offset = mNumberOfSamples;
+            segment.nSamples = nSamples;
+            segment.samplingRate = msr->samprate;
+            mNumberOfSamples = mNumberOfSamples + nSamples;
+            if (!mSegments.empty())
+            {
+                auto &previous = mSegments.back();
+                auto halfSample = toNanoseconds(0.5/previous.samplingRate);
+                auto dt = segment.startTime - previous.getNextSampleTime();
+                if (std::abs(segment.samplingRate - previous.samplingRate) <
+                    1.e-6*previous.samplingRate && std::abs(dt) <= halfSample)
+                {
+                    previous.nSamples = previous.nSamples + nSamples;
+                    continue;
+                }
+            }
+            mSegments.push_back(segment);
+        }
+        msr3_free(&msr);
+        if (!lfail && mNumberOfSamples > INT_MAX)
+        {
+            fprintf(stderr, "%s: Number of samples = %ld can't exceed %d\n",
+                    __func__, static_cast<long> (mNumberOfSamples),
+                    INT_MAX);
+            lfail = true;
+        }
+        // Allocate space to receive the unpacked data
+        char *dPtr = nullptr;
+        if (!lfail)
+        {
+            auto nSamples = mNumberOfSamples;
+            if (sampleType == 'i')
+            {
+                dPtr = allocateSamples(Precision::INT32, nSamples);
+            }
+            else if (sampleType == 'f')
+            {
+                dPtr = allocateSamples(Precision::FLOAT32, nSamples);
+            }
+            else if (sampleType == 'd')
+            {
+                dPtr = allocateSamples(Precision::FLOAT64, nSamples);
+            }
+            else
+            {
+                fprintf(stderr, "%s: Unsupported sample type = %1s\n",
+                        __func__, &sampleType);
+                lfail = true;
+            }
+        }
+        // Decode the records.  Every record is written to its own part of the
+        // output so the records can be decoded in any order.
+        if (!lfail)
+        {
+            int nFailed = 0;
+            #pragma omp parallel num_threads(mNumberOfThreads) \
+                    reduction(+:nFailed)
+            {
+            MS3Record *msrThread = nullptr;
+            std::vector<double> scratch;
+            #pragma omp for schedule(dynamic, 16)
+            for (int ir=0; ir<nRecords; ++ir)
+            {
+                if (nKeep[ir] < 1){continue;}
+                const auto &record = records[ir];
+                // Like ms3_readtracelist reject miniSEED3 records with a
+                // bad CRC
+                auto retcode = msr3_parse(data + record.offset,
+                                          static_cast<uint64_t> (record.length),
+                                          &msrThread, MSF_VALIDATECRC, 0);
+                if (retcode != MS_NOERROR)
+                {
+                    nFailed = nFailed + 1;
+                    continue;
+                }
+                // The payload is at the end of the record
+                if (msrThread->datalength < 1 ||
+                    msrThread->datalength > msrThread->reclen)
+                {
+                    nFailed = nFailed + 1;
+                    continue;
+                }
+                auto payload = msrThread->record
+                             + (msrThread->reclen - msrThread->datalength);
+                // Unpack whole records directly into the output
+                char *output = dPtr + outputOffset[ir]*sampleSize;
+                bool lcopy = (nKeep[ir] != msrThread->samplecnt);
+                if (lcopy)
+                {
+                    size_t dataSize = msrThread->samplecnt*sampleSize;
+                    scratch.resize(dataSize/sizeof(double) + 1);
+                    output = reinterpret_cast<char *> (scratch.data());
+                }
+                auto unpacked = decodePayload(msrThread, payload, sampleSize,
+                                              mDecoder, output);
+                if (unpacked != msrThread->samplecnt)
+                {
+                    nFailed = nFailed + 1;
+                    continue;
+                }
+                if (lcopy)
+                {
+                    std::memcpy(dPtr + outputOffset[ir]*sampleSize,
+                                output + firstSample[ir]*sampleSize,
+                                nKeep[ir]*sampleSize);
+                }
+            }
+            msr3_free(&msrThread);
+            } // End parallel
+            if (nFailed > 0)
+            {
+                fprintf(stderr, "%s: Failed to unpack %d records\n",
+                        __func__, nFailed);
+                lfail = true;
+            }
+        }
+        if (lfail)
+        {
+            throw std::runtime_error("Algorithmic failure calling miniSEED\n");
+        }
+        if (mSegments.empty())
+        {
+            throw std::invalid_argument("No data for SNCL in time window\n");
+        }
+        mSamplingRate = mSegments.front().samplingRate;
+        mStartTime.setEpochalTime(mSegments.front().startTime*1.e-9);
+    }
     class Utilities::Time mStartTime;
     class SNCL mSNCL;
-    std::vector<double> mData64f;
-    std::vector<float> mData32f;
-    std::vector<int> mData32i;
+    /// The segment table.  The segments are in order of increasing start
+    /// time and index into the sample buffer.
+    std::vector<Segment> mSegments;
+    /// The samples of all segments.  The precision tags the sample type.
+    Temblor::Private::AlignedBuffer mData;
     double mSamplingRate = 0;
     int64_t mNumberOfSamples = 0;
+    int mNumberOfThreads = 1;
+    Decoder mDecoder = Decoder::NATIVE;
     Precision mPrecision = Precision::UNKNOWN;
 };
 
@@ -94,11 +571,34 @@ void Trace::clear() noexcept
     pImpl->mStartTime.clear();
     pImpl->mSNCL.clear();
     pImpl->mSamplingRate = 0;
-    //pImpl->mData64f.clear();
-    //pImpl->mData32f.clear();
-    //pImpl->mData32i.clear();
-    //pImpl->mNumberOfSamples = 0;
-    //pImpl->mPrecision = Precision::UNKNOWN;
+}
+
+/// Threads
+void Trace::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int Trace::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Decoder
+void Trace::setDecoder(const Decoder decoder) noexcept
+{
+    pImpl->mDecoder = decoder;
+}
+
+Decoder Trace::getDecoder() const noexcept
+{
+    return pImpl->mDecoder;
 }
 
 /// FileIO
@@ -118,30 +618,17 @@ void Trace::read(const std::string &fileName, const SNCL &sncl)
         throw std::invalid_argument("SNCL cannot be empty\n");
     }
     pImpl->mSNCL = sncl;
-    // Create a SNCL selection
-    int retcode = 0;
-    std::string network  = sncl.getNetwork();
-    std::string station  = sncl.getStation();
-    std::string channel  = sncl.getChannel();
-    std::string location = sncl.getLocationCode();
-    char *networkQuery = NULL;
-    if (network.length() > 0){networkQuery = network.data();}
-    char *stationQuery = NULL;
-    if (station.length() > 0){stationQuery = station.data();}
-    char *channelQuery = NULL;
-    if (channel.length() > 0){channelQuery = channel.data();}
-    char *locationQuery = NULL;
-    if (location.length() > 0){locationQuery = location.data();}
     // Pack the SNCL into a miniSEED source identifier (SID)
-    std::array<char, LM_SIDLEN+1> sid;
-    memset(sid.data(), 0, (LM_SIDLEN+1)*sizeof(char));
-    retcode = ms_nslc2sid(sid.data(), LM_SIDLEN, 0,
-                          networkQuery, stationQuery,
-                          locationQuery, channelQuery);
-    if (retcode < 0)
+    int retcode = 0;
+    std::string sid;
+    try
+    {
+        sid = sncl2sid(sncl);
+    }
+    catch (...)
     {
         clear();
-        throw std::runtime_error("Failed to create target SNCL\n");
+        throw;
     }
     // Load the trace list
     MS3TraceList *traceList = NULL;
@@ -158,102 +645,444 @@ void Trace::read(const std::string &fileName, const SNCL &sncl)
         throw std::runtime_error("Failed to read trace list\n");
     }
     bool lfound = false;
-    bool lfail = false;
     for (auto traceID=traceList->traces;
          traceID != NULL;
          traceID=traceID->next)
     {
-        bool lmatch = false;
-        if (strcasecmp(traceID->sid, sid.data()) == 0)
+        if (strcasecmp(traceID->sid, sid.c_str()) != 0){continue;}
+        lfound = true;
+        try
         {
-            lmatch = true;
+            unpack(traceID);
         }
-        if (!lmatch){continue;}
-        lfound = true;
-        for (auto segment = traceID->first; 
-             segment != NULL;
-             segment = segment->next)
-        {
-            // Check the pointer isn't NULL and this is fthe first go
-            if (!segment->recordlist){continue;}
-            if (!segment->recordlist->first){continue;}
-            // Determine the sample size and type
-            uint8_t sampleSize;
-            char sampleType;
-            ms_encoding_sizetype(segment->recordlist->first->msr->encoding,
-                                 &sampleSize, &sampleType);
-            void *dPtr = NULL;
-            if (segment->samplecnt > INT_MAX)
-            {
-                fprintf(stderr, "%s: Number of samples = %ld can't exceed %d\n",
-                        __func__, static_cast<size_t> (segment->samplecnt),
-                        INT_MAX);
-                lfail = true;
-            }
-            pImpl->mNumberOfSamples = segment->samplecnt;
-            // Allocate space to receive unpacked data
-            if (sampleType == 'i')
-            {
-                pImpl->mPrecision = Precision::INT32;
-                pImpl->mData32i.resize(segment->samplecnt);
-                dPtr = pImpl->mData32i.data();
-            }
-            else if (sampleType == 'f')
-            {
-                pImpl->mPrecision = Precision::FLOAT32;
-                pImpl->mData32f.resize(segment->samplecnt);
-                dPtr = pImpl->mData32f.data(); 
-            }
-            else if (sampleType == 'd')
-            {
-                pImpl->mPrecision = Precision::FLOAT64;
-                pImpl->mData64f.resize(segment->samplecnt);
-                dPtr = pImpl->mData64f.data();
-            }
-            else
-            {
-                fprintf(stderr, "%s: Unsupported sample type = %1s\n", 
-                        __func__, &sampleType);
-                lfail = true;
-                goto EXIT;
-            }
-            // Does the sampling rate make sense?
-            pImpl->mSamplingRate = segment->samprate;
-            if (segment->samprate <= 0)
-            {
-                fprintf(stderr, "%s: Sampling rate = %lf must be positive",
-                        __func__, segment->samprate);
-                lfail = true;
-            }
-            // Set the start time (nstime is in nanoseconds)
-            double startTime = (segment->starttime)*1.e-9;
-            pImpl->mStartTime.setEpochalTime(startTime);
-            // Unpack the data
+        catch (...)
+        {
+            mstl3_free(&traceList, 0);
+            clear();
+            throw;
+        }
+        break; // I've got what I need - leave loop
+    } // Loop on traces
+    if (traceList){mstl3_free(&traceList, 0);}
+    if (!lfound)
+    {
+        clear();
+        throw std::invalid_argument("Could not find "
+                                  + sid + "\n");
+    }
+}
+
+/// Reads the records in a time window
+void Trace::read(const std::string &fileName, const SNCL &sncl,
+                 const Utilities::Time &t0, const Utilities::Time &t1)
+{
+    clear();
+    RecordIndex index;
+    index.load(fileName);
+    read(index, sncl, t0, t1);
+}
+
+void Trace::read(const RecordIndex &index, const SNCL &sncl,
+                 const Utilities::Time &t0, const Utilities::Time &t1)
+{
+    clear();
+    if (!index.isLoaded())
+    {
+        throw std::invalid_argument("Record index not loaded\n");
+    }
+    if (sncl.isEmpty())
+    {
+        throw std::invalid_argument("SNCL cannot be empty\n");
+    }
+    // Find the records that overlap the window
+    auto records = index.getRecords(sncl, t0, t1);
+    if (records.empty())
+    {
+        throw std::invalid_argument("No data for SNCL in time window\n");
+    }
+    pImpl->mSNCL = sncl;
+    auto startTime = toNanoseconds(t0.getEpochalTime());
+    auto endTime = toNanoseconds(t1.getEpochalTime());
+    try
+    {
+        pImpl->readRecords(index.getData(), records, startTime, endTime);
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+}
+
+/// Reads all the records of a SNCL
+void Trace::read(const RecordIndex &index, const SNCL &sncl)
+{
+    clear();
+    if (!index.isLoaded())
+    {
+        throw std::invalid_argument("Record index not loaded\n");
+    }
+    if (sncl.isEmpty())
+    {
+        throw std::invalid_argument("SNCL cannot be empty\n");
+    }
+    auto records = index.getRecords(sncl);
+    if (records.empty())
+    {
+        throw std::invalid_argument("No data for SNCL\n");
+    }
+    pImpl->mSNCL = sncl;
+    auto startTime = records.front().startTime;
+    auto endTime = records.front().endTime;
+    for (const auto &record : records)
+    {
+        endTime = std::max(endTime, record.endTime);
+    }
+    try
+    {
+        pImpl->readRecords(index.getData(), records, startTime, endTime);
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+}
+
+/// Unpacks the data from a trace ID read with MSF_RECORDLIST
+void Trace::unpack(MS3TraceID *traceID)
+{
+    pImpl->clearTimeSeries();
+    pImpl->mStartTime.clear();
+    pImpl->mSamplingRate = 0;
+    // Collect the segments with data in chronological order
+    std::vector<MS3TraceSeg *> segments;
+    for (auto segment = traceID->first;
+         segment != NULL;
+         segment = segment->next)
+    {
+        if (!segment->recordlist){continue;}
+        if (!segment->recordlist->first){continue;}
+        segments.push_back(segment);
+    }
+    if (segments.empty()){return;}
+    std::stable_sort(segments.begin(), segments.end(),
+                     [](const MS3TraceSeg *lhs, const MS3TraceSeg *rhs)
+                     {
+                         return lhs->starttime < rhs->starttime;
+                     });
+    // Build the segment table.  All segments must share a sample type.
+    bool lfail = false;
+    uint8_t sampleSize = 0;
+    char sampleType = 0;
+    int64_t nSamples = 0;
+    pImpl->mSegments.reserve(segments.size());
+    for (const auto &segment : segments)
+    {
+        uint8_t segmentSampleSize;
+        char segmentSampleType;
+        ms_encoding_sizetype(segment->recordlist->first->msr->encoding,
+                             &segmentSampleSize, &segmentSampleType);
+        if (sampleType == 0)
+        {
+            sampleSize = segmentSampleSize;
+            sampleType = segmentSampleType;
+        }
+        if (segmentSampleType != sampleType)
+        {
+            fprintf(stderr, "%s: Segments of %s have different sample types\n",
+                    __func__, traceID->sid);
+            lfail = true;
+            break;
+        }
+        // Does the sampling rate make sense?
+        if (segment->samprate <= 0)
+        {
+            fprintf(stderr, "%s: Sampling rate = %lf must be positive\n",
+                    __func__, segment->samprate);
+            lfail = true;
+            break;
+        }
+        Segment segmentInfo;
+        segmentInfo.startTime = segment->starttime;
+        segmentInfo.offset = nSamples;
+        segmentInfo.nSamples = segment->samplecnt;
+        segmentInfo.samplingRate = segment->samprate;
+        pImpl->mSegments.push_back(segmentInfo);
+        nSamples = nSamples + segment->samplecnt;
+    }
+    if (!lfail && nSamples > INT_MAX)
+    {
+        fprintf(stderr, "%s: Number of samples = %ld can't exceed %d\n",
+                __func__, static_cast<size_t> (nSamples), INT_MAX);
+        lfail = true;
+    }
+    // Allocate space to receive unpacked data
+    char *dPtr = NULL;
+    if (!lfail)
+    {
+        pImpl->mNumberOfSamples = nSamples;
+        if (sampleType == 'i')
+        {
+            dPtr = pImpl->allocateSamples(Precision::INT32, nSamples);
+        }
+        else if (sampleType == 'f')
+        {
+            dPtr = pImpl->allocateSamples(Precision::FLOAT32, nSamples);
+        }
+        else if (sampleType == 'd')
+        {
+            dPtr = pImpl->allocateSamples(Precision::FLOAT64, nSamples);
+        }
+        else
+        {
+            fprintf(stderr, "%s: Unsupported sample type = %1s\n",
+                    __func__, &sampleType);
+            lfail = true;
+        }
+    }
+    // Unpack each segment into its place in the sample buffer
+    if (!lfail && pImpl->mDecoder == Decoder::LIBMSEED)
+    {
+        for (size_t is=0; is<segments.size(); ++is)
+        {
+            auto segment = segments[is];
+            auto offset = pImpl->mSegments[is].offset*sampleSize;
             size_t outputSize = segment->samplecnt*sampleSize;
             auto unpacked = mstl3_unpack_recordlist(traceID, segment,
-                                                    dPtr, outputSize, 0);
+                                                    dPtr + offset,
+                                                    outputSize, 0);
             if (unpacked != segment->samplecnt)
             {
                 fprintf(stderr, "%s: Cannot unpack data for %s\n",
                         __func__, traceID->sid);
                 lfail = true;
-                goto EXIT;
+                break;
             }
-            goto EXIT; // I've got what I need - leave loop
-        } // Loop on segment
-    } // Loop on traces
-EXIT:;
-    if (traceList){mstl3_free(&traceList, 0);}
+        }
+    }
+    else if (!lfail)
+    {
+        try
+        {
+            lfail = !decodeRecordList(segments, pImpl->mSegments, sampleSize,
+                                      pImpl->mDecoder, dPtr,
+                                      pImpl->mNumberOfThreads);
+        }
+        catch (const std::exception &e)
+        {
+            fprintf(stderr, "%s: %s", __func__, e.what());
+            lfail = true;
+        }
+        if (lfail)
+        {
+            fprintf(stderr, "%s: Cannot unpack data for %s\n",
+                    __func__, traceID->sid);
+        }
+    }
     if (lfail)
     {
-        clear();
+        pImpl->clearTimeSeries();
         throw std::runtime_error("Algorithmic failure calling miniSEED\n");
     }
-    if (!lfound)
+    // Set the start time (nstime is in nanoseconds) and sampling rate
+    pImpl->mSamplingRate = pImpl->mSegments.front().samplingRate;
+    double startTime = (pImpl->mSegments.front().startTime)*1.e-9;
+    pImpl->mStartTime.setEpochalTime(startTime);
+}
+
+/// Packs the time series into records
+std::vector<char> Trace::pack(const int recordLength,
+                              const FormatVersion formatVersion,
+                              const Encoding encoding,
+                              const int nThreads) const
+{
+    // Check the inputs
+    bool lpowerOf2 = (recordLength > 0 &&
+                      (recordLength & (recordLength - 1)) == 0);
+    if (recordLength < 128 || recordLength > 1048576 ||
+        (formatVersion == FormatVersion::MINISEED2 && !lpowerOf2))
     {
-        clear();
-        throw std::invalid_argument("Could not find "
-                                  + std::string(sid.data()) + "\n");
+        throw std::invalid_argument("Record length = "
+                                  + std::to_string(recordLength)
+                                  + " is invalid\n");
+    }
+    if (pImpl->mPrecision == Precision::UNKNOWN)
+    {
+        throw std::invalid_argument("Data was never set\n");
+    }
+    if (pImpl->mSamplingRate <= 0)
+    {
+        throw std::invalid_argument("Sampling rate not set\n");
+    }
+    if (pImpl->mSNCL.isEmpty())
+    {
+        throw std::invalid_argument("SNCL not set\n");
+    }
+    auto sid = sncl2sid(pImpl->mSNCL);
+    // Resolve the encoding and get the samples in that type.  The trace's
+    // buffer is used directly when the types match.
+    auto precision = pImpl->mPrecision;
+    auto recordEncoding = encoding;
+    if (recordEncoding == Encoding::AUTOMATIC)
+    {
+        recordEncoding = Encoding::STEIM2;
+        if (precision == Precision::FLOAT32)
+        {
+            recordEncoding = Encoding::FLOAT32;
+        }
+        else if (precision == Precision::FLOAT64)
+        {
+            recordEncoding = Encoding::FLOAT64;
+        }
+    }
+    auto npts = getNumberOfSamples();
+    std::vector<float> work32f;
+    std::vector<double> work64f;
+    const char *samples = nullptr;
+    uint8_t sampleSize = 0;
+    char sampleType = 0;
+    int8_t recordFormat = DE_STEIM2;
+    if (recordEncoding == Encoding::STEIM2)
+    {
+        if (precision != Precision::INT32)
+        {
+            throw std::invalid_argument("Steim2 requires integer data\n");
+        }
+        samples = pImpl->mData.data<char> ();
+        sampleSize = sizeof(int32_t);
+        sampleType = 'i';
+        recordFormat = DE_STEIM2;
+    }
+    else if (recordEncoding == Encoding::FLOAT32)
+    {
+        if (precision == Precision::FLOAT32)
+        {
+            samples = pImpl->mData.data<char> ();
+        }
+        else
+        {
+            work32f.resize(npts);
+            pImpl->getSamples(0, npts, work32f.data());
+            samples = reinterpret_cast<const char *> (work32f.data());
+        }
+        sampleSize = sizeof(float);
+        sampleType = 'f';
+        recordFormat = DE_FLOAT32;
+    }
+    else
+    {
+        if (precision == Precision::FLOAT64)
+        {
+            samples = pImpl->mData.data<char> ();
+        }
+        else
+        {
+            work64f.resize(npts);
+            pImpl->getSamples(0, npts, work64f.data());
+            samples = reinterpret_cast<const char *> (work64f.data());
+        }
+        sampleSize = sizeof(double);
+        sampleType = 'd';
+        recordFormat = DE_FLOAT64;
+    }
+    // Each contiguous segment is packed as one stream so only its last
+    // record can be partially filled.  The segments are independent so
+    // the output does not depend on the number of threads.
+    std::vector<const Segment *> segments;
+    for (const auto &segment : pImpl->mSegments)
+    {
+        if (segment.nSamples < 1){continue;}
+        if (segment.offset < 0 || segment.offset + segment.nSamples > npts)
+        {
+            throw std::runtime_error("Segment table is inconsistent\n");
+        }
+        segments.push_back(&segment);
+    }
+    // Pack the segments
+    uint32_t flags = MSF_FLUSHDATA;
+    uint8_t version = 3;
+    if (formatVersion == FormatVersion::MINISEED2)
+    {
+        flags = flags | MSF_PACKVER2;
+        version = 2;
+    }
+    auto nSegments = static_cast<int> (segments.size());
+    std::vector<std::vector<char>> buffers(nSegments);
+    int nFailed = 0;
+    #pragma omp parallel for num_threads(std::max(1, nThreads)) \
+            schedule(dynamic, 1) reduction(+:nFailed)
+    for (int is=0; is<nSegments; ++is)
+    {
+        auto msr = msr3_init(nullptr);
+        if (!msr)
+        {
+            nFailed = nFailed + 1;
+            continue;
+        }
+        const auto segment = segments[is];
+        strncpy(msr->sid, sid.c_str(), LM_SIDLEN - 1);
+        msr->formatversion = version;
+        msr->pubversion = 1;
+        msr->reclen = recordLength;
+        msr->encoding = recordFormat;
+        msr->starttime = segment->startTime;
+        msr->samprate = segment->samplingRate;
+        // libmseed does not modify the samples when packing
+        msr->datasamples
+            = const_cast<char *> (samples + segment->offset*sampleSize);
+        msr->numsamples = segment->nSamples;
+        msr->sampletype = sampleType;
+        int64_t nPacked = 0;
+        auto nRecords = msr3_pack(msr, appendRecord, &buffers[is],
+                                  &nPacked, flags, 0);
+        if (nRecords < 0 || nPacked != segment->nSamples)
+        {
+            nFailed = nFailed + 1;
+        }
+        // The samples belong to the trace
+        msr->datasamples = nullptr;
+        msr3_free(&msr);
+    }
+    if (nFailed > 0)
+    {
+        fprintf(stderr, "%s: Failed to pack %d segments\n",
+                __func__, nFailed);
+        throw std::runtime_error("Algorithmic failure calling miniSEED\n");
+    }
+    // Concatenate the records
+    size_t nBytes = 0;
+    for (const auto &buffer : buffers){nBytes = nBytes + buffer.size();}
+    std::vector<char> records;
+    records.reserve(nBytes);
+    for (auto &buffer : buffers)
+    {
+        records.insert(records.end(), buffer.begin(), buffer.end());
+        std::vector<char>().swap(buffer);
+    }
+    return records;
+}
+
+/// Writes the trace
+void Trace::write(const std::string &fileName,
+                  const int recordLength,
+                  const FormatVersion formatVersion,
+                  const Encoding encoding) const
+{
+    auto records = pack(recordLength, formatVersion, encoding,
+                        pImpl->mNumberOfThreads);
+    std::ofstream outfile(fileName,
+                          std::ofstream::binary | std::ofstream::trunc);
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not open " + fileName + "\n");
+    }
+    outfile.write(records.data(),
+                  static_cast<std::streamsize> (records.size()));
+    outfile.close();
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not write " + fileName + "\n");
     }
 }
 
@@ -268,11 +1097,41 @@ Precision Trace::getPrecision() const
 }
 
 /// Start time
+void Trace::setStartTime(const Utilities::Time &startTime) noexcept
+{
+    pImpl->mStartTime = startTime;
+    // Shift the segments so that the first segment begins at the start time
+    if (!pImpl->mSegments.empty())
+    {
+        auto shift = toNanoseconds(startTime.getEpochalTime())
+                   - pImpl->mSegments.front().startTime;
+        for (auto &segment : pImpl->mSegments)
+        {
+            segment.startTime = segment.startTime + shift;
+        }
+    }
+}
+
 Utilities::Time Trace::getStartTime() const noexcept
 {
     return pImpl->mStartTime;
 }
 
+Utilities::Time Trace::getEndTime() const
+{
+    if (pImpl->mSamplingRate <= 0)
+    {
+        throw std::runtime_error("Sampling rate not set\n");
+    }
+    if (pImpl->mSegments.empty()){return pImpl->mStartTime;}
+    int64_t endTime = pImpl->mSegments.front().getEndTime();
+    for (const auto &segment : pImpl->mSegments)
+    {
+        endTime = std::max(endTime, segment.getEndTime());
+    }
+    return Utilities::Time(endTime*1.e-9);
+}
+
 /// Sampling rate
 void Trace::setSamplingRate(const double samplingRate)
 {
@@ -284,6 +1143,10 @@ void Trace::setSamplingRate(const double samplingRate)
                                   + " must be positive\n");
     }
     pImpl->mSamplingRate = samplingRate;
+    for (auto &segment : pImpl->mSegments)
+    {
+        segment.samplingRate = samplingRate;
+    }
 }
 
 double Trace::getSamplingRate() const
@@ -295,12 +1158,89 @@ double Trace::getSamplingRate() const
     return pImpl->mSamplingRate;
 }
 
+double Trace::getSamplingPeriod() const
+{
+    return 1.0/getSamplingRate();
+}
+
 /// Number of samples
 int Trace::getNumberOfSamples() const noexcept
 {
     return static_cast<int> (pImpl->mNumberOfSamples);
 }
 
+/// Segments
+int Trace::getNumberOfSegments() const noexcept
+{
+    return static_cast<int> (pImpl->mSegments.size());
+}
+
+Segment Trace::getSegment(const int segment) const
+{
+    if (segment < 0 || segment >= getNumberOfSegments())
+    {
+        throw std::invalid_argument("segment = " + std::to_string(segment)
+                                  + " must be in range [0,"
+                                  + std::to_string(getNumberOfSegments())
+                                  + ")\n");
+    }
+    return pImpl->mSegments[segment];
+}
+
+std::vector<Segment> Trace::getSegments() const noexcept
+{
+    return pImpl->mSegments;
+}
+
+std::vector<Segment> Trace::getSegments(const Utilities::Time &t0,
+                                        const Utilities::Time &t1) const
+{
+    auto startTime = toNanoseconds(t0.getEpochalTime());
+    auto endTime = toNanoseconds(t1.getEpochalTime());
+    if (endTime < startTime)
+    {
+        throw std::invalid_argument("t1 cannot precede t0\n");
+    }
+    // Allow for the microsecond resolution of the time class
+    constexpr int64_t tolerance = 1000;
+    std::vector<Segment> segments;
+    for (const auto &segment : pImpl->mSegments)
+    {
+        if (segment.nSamples < 1 || segment.samplingRate <= 0){continue;}
+        if (startTime > segment.getEndTime() + tolerance){continue;}
+        if (endTime < segment.startTime - tolerance){continue;}
+        auto dt0 = static_cast<double> (startTime - segment.startTime
+                                      - tolerance);
+        auto dt1 = static_cast<double> (endTime - segment.startTime
+                                      + tolerance);
+        auto i0 = static_cast<int64_t>
+                  (std::ceil(dt0*1.e-9*segment.samplingRate));
+        auto i1 = static_cast<int64_t>
+                  (std::floor(dt1*1.e-9*segment.samplingRate));
+        i0 = std::max(int64_t {0}, i0);
+        i1 = std::min(segment.nSamples - 1, i1);
+        if (i1 < i0){continue;}
+        Segment window;
+        window.startTime = segment.startTime
+                         + toNanoseconds(i0/segment.samplingRate);
+        window.offset = segment.offset + i0;
+        window.nSamples = i1 - i0 + 1;
+        window.samplingRate = segment.samplingRate;
+        segments.push_back(window);
+    }
+    return segments;
+}
+
+std::vector<Discontinuity> Trace::getGaps() const
+{
+    return pImpl->findDiscontinuities(true);
+}
+
+std::vector<Discontinuity> Trace::getOverlaps() const
+{
+    return pImpl->findDiscontinuities(false);
+}
+
 /// SNCL
 void Trace::setSNCL(const SNCL &sncl)
 {
@@ -320,68 +1260,50 @@ SNCL Trace::getSNCL() const
 /// Sets the trace data
 void Trace::setData(const size_t nSamples, const double x[])
 {
-    // Null out old data
-    pImpl->clearTimeSeries();
-    // Check the inputs
-    if (nSamples > INT_MAX)
-    {
-        throw std::runtime_error("Number of samples = "
-                               + std::to_string(nSamples)
-                               + " must be positive\n");
-    }
-    if (nSamples > 0 && x == nullptr)
-    {
-        throw std::invalid_argument("x cannot be NULL\n");
-    }
-    // Copy
-    pImpl->mNumberOfSamples = static_cast<int> (nSamples);
-    pImpl->mPrecision = Precision::FLOAT64; 
-    pImpl->mData64f.resize(nSamples);
-    copySeismogram(pImpl->mNumberOfSamples, x, pImpl->mData64f.data());
+    pImpl->setSamples(Precision::FLOAT64, nSamples, x);
 }
 
 void Trace::setData(const size_t nSamples, const float x[])
 {
-    // Null out old data
-    pImpl->clearTimeSeries();
-    // Check the inputs
-    if (nSamples > INT_MAX)
-    {
-        throw std::runtime_error("Number of samples = "
-                               + std::to_string(nSamples)
-                               + " must be positive\n");
-    }
-    if (nSamples > 0 && x == nullptr)
-    {
-        throw std::invalid_argument("x cannot be NULL\n");
-    }
-    // Copy
-    pImpl->mNumberOfSamples = static_cast<int> (nSamples);
-    pImpl->mPrecision = Precision::FLOAT32;
-    pImpl->mData32f.resize(nSamples);
-    copySeismogram(pImpl->mNumberOfSamples, x, pImpl->mData32f.data());
+    pImpl->setSamples(Precision::FLOAT32, nSamples, x);
 }
 
 void Trace::setData(const size_t nSamples, const int x[])
 {
-    // Null out old data
-    pImpl->clearTimeSeries();
-    // Check the inputs
-    if (nSamples > INT_MAX)
+    pImpl->setSamples(Precision::INT32, nSamples, x);
+}
+
+void Trace::setData(const std::vector<Segment> &segments, const double x[])
+{
+    if (segments.empty())
     {
-        throw std::runtime_error("Number of samples = "
-                               + std::to_string(nSamples)
-                               + " must be positive\n");
+        throw std::invalid_argument("No segments\n");
     }
-    if (nSamples > 0 && x == nullptr)
+    int64_t nSamples = 0;
+    for (size_t is=0; is<segments.size(); ++is)
     {
-        throw std::invalid_argument("x cannot be NULL\n");
+        if (segments[is].offset != nSamples)
+        {
+            throw std::invalid_argument("Offset of segment "
+                                      + std::to_string(is)
+                                      + " must be "
+                                      + std::to_string(nSamples) + "\n");
+        }
+        if (segments[is].samplingRate <= 0 || segments[is].nSamples < 0)
+        {
+            throw std::invalid_argument("Segment " + std::to_string(is)
+                                      + " is invalid\n");
+        }
+        if (is > 0 && segments[is].startTime < segments[is-1].startTime)
+        {
+            throw std::invalid_argument("Segments must be sorted\n");
+        }
+        nSamples = nSamples + segments[is].nSamples;
     }
-    // Copy
-    pImpl->mNumberOfSamples = static_cast<int> (nSamples);
-    pImpl->mPrecision = Precision::INT32;
-    pImpl->mData32i.resize(nSamples);
-    copySeismogram(pImpl->mNumberOfSamples, x, pImpl->mData32i.data());
+    pImpl->setSamples(Precision::FLOAT64, static_cast<size_t> (nSamples), x);
+    pImpl->mSegments = segments;
+    pImpl->mSamplingRate = segments.front().samplingRate;
+    pImpl->mStartTime.setEpochalTime(segments.front().startTime*1.e-9);
 }
 
 /// Data getters - vectors
@@ -418,98 +1340,79 @@ std::vector<int> Trace::getData32i() const
 // Data getters - arrays
 void Trace::getData(const int length, double *xIn[]) const
 {
-    if (pImpl->mPrecision == Precision::UNKNOWN)
-    {
-        throw std::runtime_error("Data was never set\n");
-    }
     auto npts = getNumberOfSamples();
     if (length < npts)
     {
         throw std::invalid_argument("length = "
-                                  + std::to_string(npts)
+                                  + std::to_string(length)
                                   + " must be at least = "
                                   + std::to_string(npts) + "\n");
     }
-    if (npts < 1){return;}
-    auto x = *xIn;
-    if (x == nullptr){ throw std::invalid_argument("x is NULL\n");}
-    // Copy the data
-    if (pImpl->mPrecision == Precision::FLOAT64)
-    {
-        copySeismogram(npts, pImpl->mData64f.data(), x);
-    }
-    else if (pImpl->mPrecision == Precision::FLOAT32)
-    {
-        convertSeismogram(npts, pImpl->mData32f.data(), x);
-    }
-    else //if (pImpl->mPrecision == Precision::INT32)
-    {
-        convertSeismogram(npts, pImpl->mData32i.data(), x);
-    }
+    getData(0, npts, *xIn);
 }
 
 void Trace::getData(const int length, float *xIn[]) const
 {
-    if (pImpl->mPrecision == Precision::UNKNOWN)
-    {
-        throw std::runtime_error("Data was never set\n");
-    }
     auto npts = getNumberOfSamples();
     if (length < npts)
     {
         throw std::invalid_argument("length = "
-                                  + std::to_string(npts)
+                                  + std::to_string(length)
                                   + " must be at least = "
                                   + std::to_string(npts) + "\n");
     }
-    if (npts < 1){return;}
-    auto x = *xIn;
-    if (x == nullptr){ throw std::invalid_argument("x is NULL\n");}
-    // Copy the data
-    if (pImpl->mPrecision == Precision::FLOAT32)
-    {
-        copySeismogram(npts, pImpl->mData32f.data(), x);
-    }
-    else if (pImpl->mPrecision == Precision::FLOAT64)
-    {
-        convertSeismogram(npts, pImpl->mData64f.data(), x);
-    }
-    else //if (pImpl->mPrecision == Precision::INT32)
-    {
-        convertSeismogram(npts, pImpl->mData32i.data(), x);
-    }
+    getData(0, npts, *xIn);
 }
 
 void Trace::getData(const int length, int *xIn[]) const
 {
-    if (pImpl->mPrecision == Precision::UNKNOWN)
-    {
-        throw std::runtime_error("Data was never set\n");
-    }
     auto npts = getNumberOfSamples();
     if (length < npts)
     {
         throw std::invalid_argument("length = "
-                                  + std::to_string(npts)
+                                  + std::to_string(length)
                                   + " must be at least = "
                                   + std::to_string(npts) + "\n");
     }
-    if (npts < 1){return;}
-    auto x = *xIn;
-    if (x == nullptr){ throw std::invalid_argument("x is NULL\n");}
-    // Copy the data
-    if (pImpl->mPrecision == Precision::INT32)
-    {
-        copySeismogram(npts, pImpl->mData32i.data(), x);
-    }
-    else if (pImpl->mPrecision == Precision::FLOAT64)
-    {
-        convertSeismogram(npts, pImpl->mData64f.data(), x);
-    }
-    else //if (pImpl->mPrecision == Precision::FLOAT32)
-    {
-        convertSeismogram(npts, pImpl->mData32f.data(), x);
-    }
+    getData(0, npts, *xIn);
+}
+
+// Data getters - ranges converted into the caller's buffer
+void Trace::getData(const int offset, const int nSamples, double x[]) const
+{
+    pImpl->checkSampleRange(offset, nSamples, x);
+    pImpl->getSamples(offset, nSamples, x);
+}
+
+void Trace::getData(const int offset, const int nSamples, float x[]) const
+{
+    pImpl->checkSampleRange(offset, nSamples, x);
+    pImpl->getSamples(offset, nSamples, x);
+}
+
+void Trace::getData(const int offset, const int nSamples, int x[]) const
+{
+    pImpl->checkSampleRange(offset, nSamples, x);
+    pImpl->getSamples(offset, nSamples, x);
+}
+
+// Data getters - views
+SampleView<int> Trace::getDataView32i() const
+{
+    return SampleView<int> (getDataPointer32i(),
+                            static_cast<size_t> (getNumberOfSamples()));
+}
+
+SampleView<float> Trace::getDataView32f() const
+{
+    return SampleView<float> (getDataPointer32f(),
+                              static_cast<size_t> (getNumberOfSamples()));
+}
+
+SampleView<double> Trace::getDataView64f() const
+{
+    return SampleView<double> (getDataPointer64f(),
+                               static_cast<size_t> (getNumberOfSamples()));
 }
 
 const int *Trace::getDataPointer32i() const
@@ -522,7 +1425,7 @@ const int *Trace::getDataPointer32i() const
     {
         throw std::runtime_error("Precision is not 32 bit integer\n");
     }
-    return pImpl->mData32i.data();
+    return pImpl->mData.data<int> ();
 }
 
 const float *Trace::getDataPointer32f() const
@@ -535,7 +1438,7 @@ const float *Trace::getDataPointer32f() const
     {
         throw std::runtime_error("Precision is not 32 bit float\n");
     }
-    return pImpl->mData32f.data();
+    return pImpl->mData.data<float> ();
 }
 
 const double *Trace::getDataPointer64f() const
@@ -548,5 +1451,5 @@ const double *Trace::getDataPointer64f() const
     {
         throw std::runtime_error("Precision is not 64 bit float\n");
     }
-    return pImpl->mData64f.data();
+    return pImpl->mData.data<double> ();
 }
@@ -1,16 +1,22 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <vector>
 #include <string>
 #include <algorithm>
-#include <libmseed.h>
-#include "temblor/private/filesystem.hpp"
+#include <exception>
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include "temblor/utilities/time.hpp"
-#include "temblor/dataReaders/miniseed/traceGroup.hpp"
-#include "temblor/dataReaders/miniseed/sncl.hpp"
-#include "temblor/dataReaders/miniseed/trace.hpp"
+#include "temblor/seismicDataIO/miniseed/traceGroup.hpp"
+#include "temblor/seismicDataIO/miniseed/recordIndex.hpp"
+#include "temblor/seismicDataIO/miniseed/sncl.hpp"
+#include "temblor/seismicDataIO/miniseed/trace.hpp"
 
-using namespace Temblor::DataReaders::MiniSEED;
+using namespace Temblor::SeismicDataIO::MiniSEED;
 
 namespace
 {
@@ -28,8 +34,193 @@ std::string sncl2str(const SNCL &sncl)
 class TraceGroup::TraceGroupImpl
 {
 public:
+    TraceGroupImpl() = default;
+    /// Copy constructor.  The mutex and decodes in flight are not copied.
+    TraceGroupImpl(const TraceGroupImpl &impl)
+    {
+        std::lock_guard<std::mutex> lock(impl.mMutex);
+        mIndex = impl.mIndex;
+        mSNCLs = impl.mSNCLs;
+        mSNCLIndex = impl.mSNCLIndex;
+        mSetTraces = impl.mSetTraces;
+        mCache = impl.mCache;
+        mStatistics = impl.mStatistics;
+        mCacheSize = impl.mCacheSize;
+        mNumberOfThreads = impl.mNumberOfThreads;
+        // The list positions must refer to this class's list
+        mLRUPosition.resize(mCache.size(), mLRU.end());
+        for (const auto &index : impl.mLRU)
+        {
+            mLRUPosition[index] = mLRU.insert(mLRU.end(), index);
+        }
+    }
+    /// Releases the traces.  The cache size and threads are retained.
+    void clear() noexcept
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIndex = nullptr;
+        mSNCLs.clear();
+        mSNCLIndex.clear();
+        mSetTraces.clear();
+        mCache.clear();
+        mLRU.clear();
+        mLRUPosition.clear();
+        mInFlight.clear();
+        mStatistics = CacheStatistics();
+        mGeneration = mGeneration + 1;
+    }
+    /// Appends an uncached slot for a new trace
+    void addSlot()
+    {
+        mCache.push_back(nullptr);
+        mLRUPosition.push_back(mLRU.end());
+    }
+    /// Finds the index of the SNCL
+    int findSNCL(const SNCL &sncl) const noexcept
+    {
+        auto idx = mSNCLIndex.find(sncl);
+        if (idx == mSNCLIndex.end()){return -1;}
+        return idx->second;
+    }
+    /// Removes a trace from the cache
+    void uncache(const int index) noexcept
+    {
+        if (!mCache[index]){return;}
+        mStatistics.bytes = mStatistics.bytes - getSize(*mCache[index]);
+        mStatistics.nTraces = mStatistics.nTraces - 1;
+        mCache[index] = nullptr;
+        mLRU.erase(mLRUPosition[index]);
+        mLRUPosition[index] = mLRU.end();
+    }
+    /// Marks a cached trace as the most recently used
+    void touch(const int index) noexcept
+    {
+        mLRU.splice(mLRU.begin(), mLRU, mLRUPosition[index]);
+    }
+    /// Evicts the least recently used traces, which are at the back of the
+    /// list, until the cache holds no more than nBytes
+    void evict(const size_t nBytes) noexcept
+    {
+        while (mStatistics.bytes > nBytes && !mLRU.empty())
+        {
+            uncache(mLRU.back());
+            mStatistics.evictions = mStatistics.evictions + 1;
+        }
+    }
+    /// Gets the trace.  A trace that is not cached is decoded from the file
+    /// and, if lcache is true, cached.  Only cached requests are counted.
+    /// The lock is released while decoding so that other traces can be
+    /// served.  Concurrent requests for a trace that is being decoded wait
+    /// for that decode.
+    std::shared_ptr<const Trace> getTrace(const int index, const bool lcache)
+    {
+        using TraceHandle = std::shared_ptr<const Trace>;
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mSetTraces[index]){return mSetTraces[index];}
+        if (mCache[index])
+        {
+            if (lcache)
+            {
+                touch(index);
+                mStatistics.hits = mStatistics.hits + 1;
+            }
+            return mCache[index];
+        }
+        auto inFlight = mInFlight.find(index);
+        if (inFlight != mInFlight.end())
+        {
+            auto future = inFlight->second;
+            if (lcache){mStatistics.hits = mStatistics.hits + 1;}
+            lock.unlock();
+            return future.get();
+        }
+        std::promise<TraceHandle> promise;
+        mInFlight.emplace(index, promise.get_future().share());
+        if (lcache){mStatistics.misses = mStatistics.misses + 1;}
+        auto recordIndex = mIndex;
+        auto sncl = mSNCLs[index];
+        auto generation = mGeneration;
+        auto nThreads = mNumberOfThreads;
+        lock.unlock();
+        TraceHandle result;
+        try
+        {
+            Trace trace;
+            trace.setNumberOfThreads(nThreads);
+            trace.read(*recordIndex, sncl);
+            result = std::make_shared<const Trace> (std::move(trace));
+        }
+        catch (...)
+        {
+            lock.lock();
+            if (generation == mGeneration){mInFlight.erase(index);}
+            lock.unlock();
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        lock.lock();
+        // The group may have been cleared or the trace replaced meanwhile
+        if (generation == mGeneration)
+        {
+            mInFlight.erase(index);
+            auto nBytes = getSize(*result);
+            if (lcache && !mSetTraces[index] && nBytes <= mCacheSize)
+            {
+                evict(mCacheSize - nBytes);
+                mCache[index] = result;
+                mLRUPosition[index] = mLRU.insert(mLRU.begin(), index);
+                mStatistics.bytes = mStatistics.bytes + nBytes;
+                mStatistics.nTraces = mStatistics.nTraces + 1;
+            }
+        }
+        lock.unlock();
+        promise.set_value(result);
+        return result;
+    }
+    /// The bytes of samples in a trace
+    static size_t getSize(const Trace &trace) noexcept
+    {
+        auto nSamples = static_cast<size_t> (trace.getNumberOfSamples());
+        try
+        {
+            if (trace.getPrecision() == Precision::FLOAT64)
+            {
+                return nSamples*sizeof(double);
+            }
+        }
+        catch (...)
+        {
+            return 0;
+        }
+        return nSamples*sizeof(int);
+    }
+
+    /// The record index of the file.  Decodes hold a reference so the
+    /// index outlives a concurrent clear().
+    std::shared_ptr<const RecordIndex> mIndex;
+    /// The SNCLs in the file followed by the SNCLs added with setTrace.
+    /// The following vectors are indexed like this vector.
     std::vector<SNCL> mSNCLs;
-    std::vector<Trace> mTraces;
+    /// Maps a SNCL to its index in mSNCLs
+    std::unordered_map<SNCL, int> mSNCLIndex;
+    /// Traces added with setTrace.  These are not part of the cache.
+    std::vector<std::shared_ptr<const Trace>> mSetTraces;
+    /// The decoded traces.  This is NULL if the trace is not cached.
+    std::vector<std::shared_ptr<const Trace>> mCache;
+    /// The cached traces from the most to the least recently used
+    std::list<int> mLRU;
+    /// The position of a cached trace in mLRU
+    std::vector<std::list<int>::iterator> mLRUPosition;
+    /// The traces being decoded
+    std::unordered_map<int, std::shared_future<std::shared_ptr<const Trace>>>
+        mInFlight;
+    CacheStatistics mStatistics;
+    /// Protects the cache in const getters
+    mutable std::mutex mMutex;
+    /// Incremented by clear() so that decodes begun before it are not cached
+    uint64_t mGeneration = 0;
+    size_t mCacheSize = size_t {1} << 30;
+    int mNumberOfThreads = 1;
 };
 
 /// Constructor
@@ -72,95 +263,189 @@ TraceGroup::~TraceGroup() = default;
 /// Clear data off the class
 void TraceGroup::clear() noexcept
 {
-    pImpl->mSNCLs.clear();
-    pImpl->mTraces.clear();
+    pImpl->clear();
+}
+
+/// Threads
+void TraceGroup::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int TraceGroup::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Cache
+void TraceGroup::setCacheSize(const size_t nBytes) noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mCacheSize = nBytes;
+    pImpl->evict(nBytes);
+}
+
+size_t TraceGroup::getCacheSize() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mCacheSize;
+}
+
+CacheStatistics TraceGroup::getCacheStatistics() const noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    return pImpl->mStatistics;
+}
+
+void TraceGroup::resetCacheStatistics() noexcept
+{
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mStatistics.hits = 0;
+    pImpl->mStatistics.misses = 0;
+    pImpl->mStatistics.evictions = 0;
 }
 
 /// Read the traces
 void TraceGroup::read(const std::string &fileName)
 {
     clear();
-#if TEMBLOR_USE_FILESYSTEM == 1
-    if (!fs::exists(fileName))
+    // Index the file.  The samples are decoded on demand.
+    RecordIndex index;
+    index.load(fileName);
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    pImpl->mSNCLs = index.getSNCLs();
+    pImpl->mIndex = std::make_shared<const RecordIndex> (std::move(index));
+    auto nTraces = pImpl->mSNCLs.size();
+    pImpl->mSNCLIndex.reserve(nTraces);
+    for (size_t i=0; i<nTraces; ++i)
     {
-        std::string errmsg = "miniSEED file = " + fileName
-                          + " does not exist\n";
-        throw std::invalid_argument(errmsg);
+        pImpl->mSNCLIndex.emplace(pImpl->mSNCLs[i], static_cast<int> (i));
     }
-#endif
-    // Load the trace list
-    MS3TraceList *mstl = nullptr;
-    constexpr uint32_t flags = 0;
-    constexpr int8_t verbose = 0;
-    constexpr int splitversion = 0;
-    int retcode = MS_NOERROR;
-    retcode = ms3_readtracelist(&mstl, fileName.c_str(), NULL,
-                                splitversion, flags, verbose);
-    if (retcode != MS_NOERROR)
-    {
-        auto error = std::string(ms_errorstr(retcode));
-        throw std::invalid_argument("Encountered error: " + error
-                                  + " when reading: " + fileName);
-    }
-    // Unpack the SNCLs
-    auto id = mstl->traces;
-    while (id)
-    {
-        // Extract the SNCL from the miniseed archive
-        std::string network(11, 0);
-        std::string station(11, 0);
-        std::string channel(11, 0);
-        std::string location(11, 0);
-        retcode = ms_sid2nslc(id->sid,
-                              network.data(), station.data(),
-                              location.data(), channel.data());
-        if (retcode != MS_NOERROR)
-        {
-            std::string error = std::string(ms_errorstr(retcode));
-            throw std::invalid_argument("Encountered error: " + error
-                                      + " when unpacking: " + fileName);
-        }
-        // Create the SNCL
-        SNCL sncl;
-        sncl.setNetwork(network);
-        sncl.setStation(station);
-        sncl.setChannel(channel);
-        if (strnlen(location.c_str(), location.size()) > 0)
-        {
-            sncl.setLocationCode(location);
-        }
-        // Add the SNCL?
-        auto idx = std::find(pImpl->mSNCLs.begin(), pImpl->mSNCLs.end(), sncl);
-        if (idx == pImpl->mSNCLs.end()){pImpl->mSNCLs.push_back(sncl);}
-        // Update the pointer to trace IDs
-        id = id->next; 
-    }
-    // Clean up
-    if (mstl){mstl3_free(&mstl, 0);}
-    // Load the data
-    pImpl->mTraces.resize(pImpl->mSNCLs.size());
-    int i = 0;
-    for (auto sncl : pImpl->mSNCLs)
+    pImpl->mSetTraces.resize(nTraces);
+    pImpl->mCache.resize(nTraces);
+    pImpl->mLRUPosition.resize(nTraces, pImpl->mLRU.end());
+}
+
+/// Write the traces
+void TraceGroup::write(const std::string &fileName,
+                       const int recordLength,
+                       const FormatVersion formatVersion,
+                       const Encoding encoding) const
+{
+    if (pImpl->mSNCLs.empty())
     {
-        try
+        throw std::invalid_argument("No traces to write\n");
+    }
+    // The traces are written to a temporary file that replaces the file
+    // only once every trace was written so that a failure does not
+    // destroy an existing file
+    auto temporaryFileName = fileName + ".tmp";
+    std::ofstream outfile(temporaryFileName,
+                          std::ofstream::binary | std::ofstream::trunc);
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not open " + temporaryFileName
+                               + "\n");
+    }
+    // Traces that are not cached are decoded but not cached so that writing
+    // does not flush the cache.  Batches of traces are packed in parallel
+    // and written in order.  A lone trace packs its segments in parallel.
+    auto nTraces = static_cast<int> (pImpl->mSNCLs.size());
+    auto batchSize = std::min(nTraces, pImpl->mNumberOfThreads);
+    auto packThreads = (batchSize > 1) ? 1 : pImpl->mNumberOfThreads;
+    std::vector<std::vector<char>> records(batchSize);
+    try
+    {
+        for (int i0=0; i0<nTraces; i0=i0+batchSize)
         {
-            pImpl->mTraces[i].read(fileName, sncl);
+            auto i1 = std::min(nTraces, i0 + batchSize);
+            std::exception_ptr error = nullptr;
+            #pragma omp parallel for num_threads(i1 - i0) schedule(static, 1)
+            for (int it=i0; it<i1; ++it)
+            {
+                try
+                {
+                    auto trace = pImpl->getTrace(it, false);
+                    records[it - i0] = trace->pack(recordLength,
+                                                   formatVersion, encoding,
+                                                   packThreads);
+                }
+                catch (...)
+                {
+                    #pragma omp critical(MiniSEEDTraceGroupWrite)
+                    {
+                        if (!error){error = std::current_exception();}
+                    }
+                }
+            }
+            if (error){std::rethrow_exception(error);}
+            for (int it=i0; it<i1; ++it)
+            {
+                auto &buffer = records[it - i0];
+                outfile.write(buffer.data(),
+                              static_cast<std::streamsize> (buffer.size()));
+                std::vector<char>().swap(buffer);
+            }
+            if (!outfile)
+            {
+                throw std::runtime_error("Could not write "
+                                       + temporaryFileName + "\n");
+            }
         }
-        catch (const std::exception &e)
+        outfile.close();
+        if (!outfile)
         {
-            clear();
-            throw std::invalid_argument(e.what()); 
+            throw std::runtime_error("Could not write "
+                                   + temporaryFileName + "\n");
         }
-        i = i + 1;
+    }
+    catch (...)
+    {
+        outfile.close();
+        std::remove(temporaryFileName.c_str());
+        throw;
+    }
+    if (std::rename(temporaryFileName.c_str(), fileName.c_str()) != 0)
+    {
+        std::remove(temporaryFileName.c_str());
+        throw std::runtime_error("Could not rename " + temporaryFileName
+                               + " to " + fileName + "\n");
     }
 }
 
+/// Add a trace
+void TraceGroup::setTrace(const Trace &trace)
+{
+    auto sncl = trace.getSNCL();
+    if (sncl.isEmpty())
+    {
+        throw std::invalid_argument("Trace's SNCL not set\n");
+    }
+    auto handle = std::make_shared<const Trace> (trace);
+    std::lock_guard<std::mutex> lock(pImpl->mMutex);
+    auto index = pImpl->findSNCL(sncl);
+    if (index >= 0)
+    {
+        pImpl->uncache(index);
+        pImpl->mSetTraces[index] = handle;
+        return;
+    }
+    pImpl->mSNCLIndex.emplace(sncl, static_cast<int> (pImpl->mSNCLs.size()));
+    pImpl->mSNCLs.push_back(sncl);
+    pImpl->mSetTraces.push_back(handle);
+    pImpl->addSlot();
+}
+
 /// Check if the SNCL exists
 bool TraceGroup::haveSNCL(const SNCL &sncl) const noexcept
 {
-    auto idx = std::find(pImpl->mSNCLs.begin(), pImpl->mSNCLs.end(), sncl);
-    if (idx == pImpl->mSNCLs.end()){return false;}
-    return true;
+    return (pImpl->findSNCL(sncl) >= 0);
 }
 
 /// Get the SNCLs
@@ -171,21 +456,24 @@ std::vector<SNCL> TraceGroup::getSNCLs() const noexcept
 
 /// Get the trace
 Trace TraceGroup::getTrace(const SNCL &sncl) const
+{
+    return *getSharedTrace(sncl);
+}
+
+std::shared_ptr<const Trace> TraceGroup::getSharedTrace(const SNCL &sncl) const
 {
     /// Check the SNCL exists
-    auto snclPtr = std::find(pImpl->mSNCLs.begin(), pImpl->mSNCLs.end(), sncl);
-    if (snclPtr == pImpl->mSNCLs.end())
+    auto index = pImpl->findSNCL(sncl);
+    if (index < 0)
     {
         std::string errmsg = "SNCL = " + sncl2str(sncl)
                            + " is not loaded\n";
         throw std::invalid_argument(errmsg);
     }
-    // Get the corresponding position and return that element of trace vector
-    auto index = std::distance(pImpl->mSNCLs.begin(), snclPtr); 
-    return pImpl->mTraces[index];
+    return pImpl->getTrace(index, true);
 }
 
 int TraceGroup::getNumberOfTraces() const noexcept
 {
-    return static_cast<int> (pImpl->mTraces.size());
+    return static_cast<int> (pImpl->mSNCLs.size());
 }
@@ -0,0 +1,456 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <stdexcept>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/sac/catalog.hpp"
+#include "temblor/seismicDataIO/sac/header.hpp"
+
+using namespace Temblor::SeismicDataIO::SAC;
+
+namespace
+{
+
+constexpr int N_PICKS = 10;
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Converts a character header variable to a string.  Undefined variables
+/// are empty.
+std::string toString(const std::string &value)
+{
+    auto result = value.substr(0, value.find('\0'));
+    while (!result.empty() && result.back() == ' '){result.pop_back();}
+    if (result == "-12345"){result.clear();}
+    return result;
+}
+
+/// Converts a floating point header variable.  Undefined variables are NaN.
+double toDouble(const double value) noexcept
+{
+    if (value == -12345){return NaN;}
+    return value;
+}
+
+/// Gets the reference time of the header in UTC seconds since the epoch
+double getReferenceTime(const Header &header) noexcept
+{
+    int year   = header.getHeader(Integer::NZYEAR);
+    int jday   = header.getHeader(Integer::NZJDAY);
+    int hour   = header.getHeader(Integer::NZHOUR);
+    int minute = header.getHeader(Integer::NZMIN);
+    int isec   = header.getHeader(Integer::NZSEC);
+    int msec   = header.getHeader(Integer::NZMSEC);
+    if (year   ==-12345 || jday ==-12345 || hour ==-12345 ||
+        minute ==-12345 || isec ==-12345 || msec ==-12345)
+    {
+        return NaN;
+    }
+    try
+    {
+        Temblor::Utilities::Time time;
+        time.setYear(year);
+        time.setJulianDay(jday);
+        time.setHour(hour);
+        time.setMinute(minute);
+        time.setSecond(isec);
+        time.setMicroSecond(msec*1000);
+        return time.getEpochalTime();
+    }
+    catch (...)
+    {
+        return NaN;
+    }
+}
+
+/// Reorders a column
+template<typename T>
+void permute(const std::vector<int> &permutation, std::vector<T> *column)
+{
+    std::vector<T> result;
+    result.reserve(permutation.size());
+    for (const auto &i : permutation)
+    {
+        result.push_back(std::move((*column)[i]));
+    }
+    *column = std::move(result);
+}
+
+/// Orders numbers with NaNs last
+struct LessNaNLast
+{
+    template<typename T>
+    bool operator()(const T lhs, const T rhs) const noexcept
+    {
+        if (std::isnan(static_cast<double> (lhs))){return false;}
+        if (std::isnan(static_cast<double> (rhs))){return true;}
+        return lhs < rhs;
+    }
+};
+
+}
+
+class Catalog::CatalogImpl
+{
+public:
+    /// Sizes every column
+    void resize(const size_t n)
+    {
+        mFileNames.resize(n);
+        mNetworks.resize(n);
+        mStations.resize(n);
+        mChannels.resize(n);
+        mLocationCodes.resize(n);
+        mStartTimes.resize(n);
+        mNumberOfSamples.resize(n);
+        mSamplingPeriods.resize(n);
+        mEventLatitudes.resize(n);
+        mEventLongitudes.resize(n);
+        for (auto &picks : mPicks){picks.resize(n);}
+    }
+    /// Reorders every column
+    void permute(const std::vector<int> &permutation)
+    {
+        ::permute(permutation, &mFileNames);
+        ::permute(permutation, &mNetworks);
+        ::permute(permutation, &mStations);
+        ::permute(permutation, &mChannels);
+        ::permute(permutation, &mLocationCodes);
+        ::permute(permutation, &mStartTimes);
+        ::permute(permutation, &mNumberOfSamples);
+        ::permute(permutation, &mSamplingPeriods);
+        ::permute(permutation, &mEventLatitudes);
+        ::permute(permutation, &mEventLongitudes);
+        for (auto &picks : mPicks){::permute(permutation, &picks);}
+    }
+    /// Fills a row from a header
+    void setRow(const int row, const Header &header)
+    {
+        mNetworks[row] = toString(header.getHeader(Character::KNETWK));
+        mStations[row] = toString(header.getHeader(Character::KSTNM));
+        mChannels[row] = toString(header.getHeader(Character::KCMPNM));
+        mLocationCodes[row] = toString(header.getHeader(Character::KHOLE));
+        auto referenceTime = getReferenceTime(header);
+        mStartTimes[row] = referenceTime
+                         + toDouble(header.getHeader(Double::B));
+        mNumberOfSamples[row] = header.getHeader(Integer::NPTS);
+        mSamplingPeriods[row] = toDouble(header.getHeader(Double::DELTA));
+        mEventLatitudes[row] = toDouble(header.getHeader(Double::EVLA));
+        mEventLongitudes[row] = toDouble(header.getHeader(Double::EVLO));
+        constexpr std::array<Double, N_PICKS> picks{Double::T0, Double::T1,
+                                                    Double::T2, Double::T3,
+                                                    Double::T4, Double::T5,
+                                                    Double::T6, Double::T7,
+                                                    Double::T8, Double::T9};
+        for (int ip=0; ip<N_PICKS; ++ip)
+        {
+            mPicks[ip][row] = referenceTime
+                            + toDouble(header.getHeader(picks[ip]));
+        }
+    }
+
+    std::vector<std::string> mFileNames;
+    std::vector<std::string> mNetworks;
+    std::vector<std::string> mStations;
+    std::vector<std::string> mChannels;
+    std::vector<std::string> mLocationCodes;
+    std::vector<double> mStartTimes;
+    std::vector<int> mNumberOfSamples;
+    std::vector<double> mSamplingPeriods;
+    std::vector<double> mEventLatitudes;
+    std::vector<double> mEventLongitudes;
+    std::array<std::vector<double>, N_PICKS> mPicks;
+    int mNumberOfFilesSkipped = 0;
+    int mNumberOfThreads = 1;
+};
+
+/// Constructor
+Catalog::Catalog() :
+    pImpl(std::make_unique<CatalogImpl> ())
+{
+}
+
+/// Copy constructor
+Catalog::Catalog(const Catalog &catalog)
+{
+    *this = catalog;
+}
+
+/// Move constructor
+Catalog::Catalog(Catalog &&catalog) noexcept
+{
+    *this = std::move(catalog);
+}
+
+/// Copy assignment
+Catalog& Catalog::operator=(const Catalog &catalog)
+{
+    if (&catalog == this){return *this;}
+    pImpl = std::make_unique<CatalogImpl> (*catalog.pImpl);
+    return *this;
+}
+
+/// Move assignment
+Catalog& Catalog::operator=(Catalog &&catalog) noexcept
+{
+    if (&catalog == this){return *this;}
+    pImpl = std::move(catalog.pImpl);
+    return *this;
+}
+
+/// Destructor
+Catalog::~Catalog() = default;
+
+/// Clears the catalog
+void Catalog::clear() noexcept
+{
+    auto nThreads = pImpl->mNumberOfThreads;
+    pImpl = std::make_unique<CatalogImpl> ();
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+/// Threads
+void Catalog::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int Catalog::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Scans a directory
+void Catalog::scan(const std::string &directory)
+{
+#if TEMBLOR_USE_FILESYSTEM == 1
+    if (!fs::is_directory(directory))
+    {
+        throw std::invalid_argument("Directory = " + directory
+                                  + " does not exist\n");
+    }
+    clear();
+    // Find the files.  The directory entries know their type so this does
+    // not stat each file.
+    auto &fileNames = pImpl->mFileNames;
+    for (const auto &entry :
+         fs::recursive_directory_iterator(
+             directory, fs::directory_options::skip_permission_denied))
+    {
+        if (!entry.is_regular_file()){continue;}
+        fileNames.push_back(entry.path().string());
+    }
+    std::sort(fileNames.begin(), fileNames.end());
+    // Read the headers
+    auto nFiles = static_cast<int> (fileNames.size());
+    pImpl->resize(fileNames.size());
+    std::vector<char> lfailed(nFiles, 0);
+    #pragma omp parallel for num_threads(pImpl->mNumberOfThreads) \
+            schedule(dynamic, 64)
+    for (int ifile=0; ifile<nFiles; ++ifile)
+    {
+        try
+        {
+            Header header;
+            header.read(fileNames[ifile]);
+            pImpl->setRow(ifile, header);
+        }
+        catch (...)
+        {
+            lfailed[ifile] = 1;
+        }
+    }
+    // Drop the files that are not SAC files
+    std::vector<int> rows;
+    rows.reserve(fileNames.size());
+    for (int ifile=0; ifile<nFiles; ++ifile)
+    {
+        if (!lfailed[ifile]){rows.push_back(ifile);}
+    }
+    pImpl->mNumberOfFilesSkipped = nFiles - static_cast<int> (rows.size());
+    if (pImpl->mNumberOfFilesSkipped > 0){pImpl->permute(rows);}
+#else
+    throw std::runtime_error("Filesystem library required to scan "
+                           + directory + "\n");
+#endif
+}
+
+int Catalog::getNumberOfFilesSkipped() const noexcept
+{
+    return pImpl->mNumberOfFilesSkipped;
+}
+
+int Catalog::getNumberOfRows() const noexcept
+{
+    return static_cast<int> (pImpl->mFileNames.size());
+}
+
+/// Columns
+const std::vector<std::string>& Catalog::getFileNames() const noexcept
+{
+    return pImpl->mFileNames;
+}
+
+const std::vector<std::string>& Catalog::getNetworks() const noexcept
+{
+    return pImpl->mNetworks;
+}
+
+const std::vector<std::string>& Catalog::getStations() const noexcept
+{
+    return pImpl->mStations;
+}
+
+const std::vector<std::string>& Catalog::getChannels() const noexcept
+{
+    return pImpl->mChannels;
+}
+
+const std::vector<std::string>& Catalog::getLocationCodes() const noexcept
+{
+    return pImpl->mLocationCodes;
+}
+
+const std::vector<double>& Catalog::getStartTimes() const noexcept
+{
+    return pImpl->mStartTimes;
+}
+
+const std::vector<int>& Catalog::getNumberOfSamples() const noexcept
+{
+    return pImpl->mNumberOfSamples;
+}
+
+const std::vector<double>& Catalog::getSamplingPeriods() const noexcept
+{
+    return pImpl->mSamplingPeriods;
+}
+
+const std::vector<double>& Catalog::getEventLatitudes() const noexcept
+{
+    return pImpl->mEventLatitudes;
+}
+
+const std::vector<double>& Catalog::getEventLongitudes() const noexcept
+{
+    return pImpl->mEventLongitudes;
+}
+
+const std::vector<double>& Catalog::getPicks(const int pick) const
+{
+    if (pick < 0 || pick >= N_PICKS)
+    {
+        throw std::invalid_argument("pick = " + std::to_string(pick)
+                                  + " must be in range [0,9]\n");
+    }
+    return pImpl->mPicks[pick];
+}
+
+/// Filter
+void Catalog::filter(const std::function<bool (const Catalog &, int)> &keep)
+{
+    std::vector<int> rows;
+    rows.reserve(pImpl->mFileNames.size());
+    for (int row=0; row<getNumberOfRows(); ++row)
+    {
+        if (keep(*this, row)){rows.push_back(row);}
+    }
+    if (static_cast<int> (rows.size()) == getNumberOfRows()){return;}
+    pImpl->permute(rows);
+}
+
+/// Sort
+void Catalog::sort(const CatalogColumn column, const bool ascending)
+{
+    std::vector<int> rows(pImpl->mFileNames.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    // Sorts the rows by a key.  Descending orders reverse the comparison
+    // so that ties keep their order and NaNs stay last.
+    auto sortBy = [&](const auto &key)
+    {
+        std::stable_sort(rows.begin(), rows.end(),
+                         [&](const int lhs, const int rhs)
+                         {
+                             if (ascending)
+                             {
+                                 return LessNaNLast()(key[lhs], key[rhs]);
+                             }
+                             return LessNaNLast()(-key[lhs], -key[rhs]);
+                         });
+    };
+    auto sortByString = [&](const auto &key)
+    {
+        std::stable_sort(rows.begin(), rows.end(),
+                         [&](const int lhs, const int rhs)
+                         {
+                             if (ascending){return key[lhs] < key[rhs];}
+                             return key[rhs] < key[lhs];
+                         });
+    };
+    if (column == CatalogColumn::FILE_NAME)
+    {
+        sortByString(pImpl->mFileNames);
+    }
+    else if (column == CatalogColumn::SNCL)
+    {
+        std::vector<std::array<const std::string *, 4>> sncls;
+        sncls.reserve(rows.size());
+        for (size_t i=0; i<rows.size(); ++i)
+        {
+            sncls.push_back({&pImpl->mNetworks[i], &pImpl->mStations[i],
+                             &pImpl->mChannels[i], &pImpl->mLocationCodes[i]});
+        }
+        auto less = [](const std::array<const std::string *, 4> &lhs,
+                       const std::array<const std::string *, 4> &rhs)
+        {
+            for (int k=0; k<4; ++k)
+            {
+                if (*lhs[k] < *rhs[k]){return true;}
+                if (*rhs[k] < *lhs[k]){return false;}
+            }
+            return false;
+        };
+        std::stable_sort(rows.begin(), rows.end(),
+                         [&](const int lhs, const int rhs)
+                         {
+                             if (ascending)
+                             {
+                                 return less(sncls[lhs], sncls[rhs]);
+                             }
+                             return less(sncls[rhs], sncls[lhs]);
+                         });
+    }
+    else if (column == CatalogColumn::START_TIME)
+    {
+        sortBy(pImpl->mStartTimes);
+    }
+    else if (column == CatalogColumn::NUMBER_OF_SAMPLES)
+    {
+        sortBy(pImpl->mNumberOfSamples);
+    }
+    else if (column == CatalogColumn::SAMPLING_PERIOD)
+    {
+        sortBy(pImpl->mSamplingPeriods);
+    }
+    else if (column == CatalogColumn::EVENT_LATITUDE)
+    {
+        sortBy(pImpl->mEventLatitudes);
+    }
+    else if (column == CatalogColumn::EVENT_LONGITUDE)
+    {
+        sortBy(pImpl->mEventLongitudes);
+    }
+    pImpl->permute(rows);
+}
@@ -1,18 +1,81 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
+#include <cerrno>
+#include <cmath>
 #include <string>
+#include <vector>
+#include <array>
 #include <algorithm>
-#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include "temblor/private/filesystem.hpp"
+#include "temblor/private/mappedFile.hpp"
+#include "temblor/private/alignedBuffer.hpp"
+#include "temblor/private/sampleConversion.hpp"
+#include "temblor/private/byteSwap.hpp"
 #include "temblor/utilities/time.hpp"
 #include "temblor/seismicDataIO/sac/waveform.hpp"
 #include "temblor/seismicDataIO/sac/header.hpp"
 
 using namespace Temblor::SeismicDataIO::SAC;
 
-static double *alignedAllocDouble(const int npts);
+namespace
+{
+
+/// The number of samples packed per write when the samples must be
+/// converted
+constexpr int WRITE_BLOCK_SIZE = 16384;
+
+/// Writes the vectors in full.  This returns false if the write fails.
+bool writevFully(const int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0)
+    {
+        auto nwritten = writev(fd, iov, iovcnt);
+        if (nwritten < 0)
+        {
+            if (errno == EINTR){continue;}
+            return false;
+        }
+        // Skip the vectors that were written and advance a partial one
+        auto n = static_cast<size_t> (nwritten);
+        while (iovcnt > 0 && n >= iov->iov_len)
+        {
+            n = n - iov->iov_len;
+            iov = iov + 1;
+            iovcnt = iovcnt - 1;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = static_cast<char *> (iov->iov_base) + n;
+            iov->iov_len = iov->iov_len - n;
+        }
+    }
+    return true;
+}
+
+/// Reads nbytes starting at offset.  This returns false if the file is
+/// too short or cannot be read.
+bool preadFully(const int fd, char *buffer, size_t nbytes, off_t offset)
+{
+    while (nbytes > 0)
+    {
+        auto nread = pread(fd, buffer, nbytes, offset);
+        if (nread <= 0){return false;}
+        buffer = buffer + nread;
+        nbytes = nbytes - static_cast<size_t> (nread);
+        offset = offset + nread;
+    }
+    return true;
+}
+
+
+}
 
 class Waveform::WaveformImpl
 {
@@ -37,46 +100,61 @@ public:
         // Turns out b =-12345 is okay but looks screwy when plotted
         mHeader.setHeader(Double::B, 0);
     }
-    WaveformImpl(const WaveformImpl &waveform)
-    {
-        *this = waveform;
-    } 
+    /// Copy constructor
+    WaveformImpl(const WaveformImpl &waveform) = default;
     /// Copy assignment
-    WaveformImpl& operator=(const WaveformImpl &waveform)
-    {
-        if (&waveform == this){return *this;}
-        // Release old memory
-        clear();
-        mHeader = waveform.mHeader;
-        int npts = mHeader.getHeader(Integer::NPTS);
-        if (npts > 0 && waveform.mData)
-        {
-            mData = alignedAllocDouble(npts);
-            auto nbytes = static_cast<size_t> (npts)*sizeof(double);
-            std::memcpy(mData, waveform.mData, nbytes);
-        }
-        return *this;
-    }
+    WaveformImpl& operator=(const WaveformImpl &waveform) = default;
     /// Destructor
-    ~WaveformImpl()
-    {
-        clear();
-    }
+    ~WaveformImpl() = default;
     void freeData()
     {
-        if (mData){free(mData);}
+        mData.clear();
         mHeader.setHeader(Integer::NPTS, 0);
-        mData = nullptr;
     }
     void clear()
     {
         freeData();
         mHeader.clear();
     }
+    /// Sizes the sample buffer at the storage precision
+    void allocateSamples(const int npts)
+    {
+        auto sampleSize = mPrecision == Precision::FLOAT32 ?
+                          sizeof(float) : sizeof(double);
+        mData.allocate(static_cast<size_t> (npts)*sampleSize);
+    }
+    /// Copies samples into the buffer at the storage precision
+    template<typename T>
+    void setSamples(const int npts, const T x[])
+    {
+        allocateSamples(npts);
+        if (mPrecision == Precision::FLOAT32)
+        {
+            Temblor::Private::convertSamples(npts, x, mData.data<float> ());
+        }
+        else
+        {
+            Temblor::Private::convertSamples(npts, x, mData.data<double> ());
+        }
+    }
+    /// Copies samples out of the buffer
+    template<typename T>
+    void getSamples(const int npts, T y[]) const
+    {
+        if (mPrecision == Precision::FLOAT32)
+        {
+            Temblor::Private::convertSamples(npts, mData.data<float> (), y);
+        }
+        else
+        {
+            Temblor::Private::convertSamples(npts, mData.data<double> (), y);
+        }
+    }
 
 //private:
     class Header mHeader;
-    double *mData = nullptr;
+    Temblor::Private::AlignedBuffer mData;
+    Precision mPrecision = Precision::FLOAT64;
 };
 
 /// Constructor
@@ -122,8 +200,35 @@ Waveform::~Waveform() = default;
 void Waveform::clear() noexcept
 {
     pImpl->mHeader.clear();
-    if (pImpl->mData){free(pImpl->mData);}
-    pImpl->mData = nullptr;
+    pImpl->mData.clear();
+}
+
+/// Sets the sample precision
+void Waveform::setPrecision(const Precision precision)
+{
+    if (precision == pImpl->mPrecision){return;}
+    if (pImpl->mData.size() == 0)
+    {
+        pImpl->mPrecision = precision;
+        return;
+    }
+    auto npts = getNumberOfSamples();
+    auto data = std::move(pImpl->mData);
+    pImpl->mPrecision = precision;
+    if (precision == Precision::FLOAT32)
+    {
+        pImpl->setSamples(npts, data.data<double> ());
+    }
+    else
+    {
+        pImpl->setSamples(npts, data.data<float> ());
+    }
+}
+
+/// Gets the sample precision
+Precision Waveform::getPrecision() const noexcept
+{
+    return pImpl->mPrecision;
 }
 
 /// Loads a waveform
@@ -137,11 +242,10 @@ void Waveform::read(const std::string &fileName)
         throw std::invalid_argument(errmsg);
     }
 #endif
-    // Read the binary file
-    std::ifstream sacfl(fileName, std::ios::in | std::ios::binary);
-    std::vector<char> buffer(std::istreambuf_iterator<char> (sacfl), {});
-    sacfl.close();
-    size_t nbytes = buffer.size();
+    // Map the binary file
+    Temblor::Private::MappedFile sacfl(fileName);
+    sacfl.adviseSequential();
+    size_t nbytes = sacfl.size();
     if (nbytes < 632)
     {
         std::string errmsg = "SAC file has less than 632 bytes; nbytes = "
@@ -149,66 +253,168 @@ void Waveform::read(const std::string &fileName)
         throw std::invalid_argument(errmsg);
     }
     // Figure out the byte order
-    const char *cdat = buffer.data();
-    union
-    {
-        char c4[4];
-        int npts;
-    };
-    std::memcpy(c4, &cdat[316], 4*sizeof(char));
-    size_t nbytesEst = static_cast<size_t> (npts)*sizeof(float) + 632;
-    bool lswap = false;
-    if (nbytesEst != nbytes)
-    {
-        std::reverse(c4, c4+4);
-        nbytesEst = static_cast<size_t> (npts)*sizeof(float) + 632;
-        if (nbytesEst != nbytes)
-        {
-            std::string errmsg = "Cannot determine endianness of file";
-            throw std::invalid_argument(errmsg);
-        }
-        lswap = true;
-    }
+    const char *cdat = sacfl.data();
+    bool lswap = Header::isByteSwapped(cdat);
     // Unpack the header (this will check npts and delta are valid)
     try
     {
         pImpl->mHeader.setFromBinaryHeader(cdat, lswap);
+        // Version 7 files follow the data with double precision variables
+        int npts = getNumberOfSamples();
+        auto dataBytes = 632 + sizeof(float)*static_cast<size_t> (npts);
+        bool haveFooter = (getHeader(Integer::NVHDR) == 7);
+        if (nbytes != dataBytes + (haveFooter ? 176 : 0))
+        {
+            throw std::invalid_argument("SAC file size does not match npts");
+        }
+        if (haveFooter)
+        {
+            pImpl->mHeader.setFromBinaryFooter(cdat + dataBytes, lswap);
+        }
     }
     catch (const std::invalid_argument &ia)
     {
         pImpl->mHeader.clear();
         throw std::invalid_argument(ia);
     }
-    // Unpack the data
-    pImpl->mData = alignedAllocDouble(npts);
+    int npts = getNumberOfSamples();
+    // Unpack the data straight from the map.  The map is page aligned so
+    // the samples at byte 632 are aligned to a float.
     if (!lswap)
     {
-        auto fdata = reinterpret_cast<const float *> (buffer.data() + 632);
-        #pragma omp simd
-        for (auto i=0; i<npts; i++)
+        auto fdata = reinterpret_cast<const float *> (cdat + 632);
+        pImpl->setSamples(npts, fdata);
+    }
+    else
+    {
+        pImpl->allocateSamples(npts);
+        if (pImpl->mPrecision == Precision::FLOAT32)
+        {
+            Temblor::Private::unpackSwapped32(npts, cdat + 632,
+                                              pImpl->mData.data<float> ());
+        }
+        else
         {
-            pImpl->mData[i] = static_cast<double> (fdata[i]);
+            Temblor::Private::unpackSwapped32(npts, cdat + 632,
+                                              pImpl->mData.data<double> ());
         }
     }
-    else
+}
+
+/// Loads the part of a waveform in a time window
+void Waveform::read(const std::string &fileName,
+                    const Utilities::Time &t0, const Utilities::Time &t1)
+{
+    clear();
+    if (t1.getEpochalTime() < t0.getEpochalTime())
     {
-        // Reverse the byte order
-        union
+        throw std::invalid_argument("t1 cannot precede t0\n");
+    }
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::string errmsg = "SAC file = " + fileName + " does not exist";
+        throw std::invalid_argument(errmsg);
+    }
+    try
+    {
+        // Read the header and find the samples in the window
+        std::array<char, 632> cheader;
+        struct stat fileStatus;
+        if (fstat(fd, &fileStatus) != 0 ||
+            !preadFully(fd, cheader.data(), cheader.size(), 0))
         {
-            char crev[4];
-            float f4;
-        };
-        for (auto i=0; i<npts; i++)
+            throw std::invalid_argument("SAC file " + fileName
+                                      + " does not have 632 bytes\n");
+        }
+        auto lswap = Header::isByteSwapped(cheader.data());
+        pImpl->mHeader.setFromBinaryHeader(cheader.data(), lswap);
+        int npts = getNumberOfSamples();
+        auto dataBytes = 632 + sizeof(float)*static_cast<size_t> (npts);
+        bool haveFooter = (getHeader(Integer::NVHDR) == 7);
+        auto nbytes = static_cast<size_t> (fileStatus.st_size);
+        if (nbytes < dataBytes + (haveFooter ? 176 : 0))
         {
-            auto indx = 632 + 4*i;
-            crev[0] = cdat[indx+3];
-            crev[1] = cdat[indx+2];
-            crev[2] = cdat[indx+1];
-            crev[3] = cdat[indx+0];
-            //std::reverse_copy(&cdat[632+4*i], &cdat[632+4*i]+4, crev);
-            pImpl->mData[i] = static_cast<double> (f4);
+            throw std::invalid_argument("SAC file " + fileName
+                                      + " is missing samples\n");
         }
+        if (haveFooter)
+        {
+            std::array<char, 176> cfooter;
+            if (!preadFully(fd, cfooter.data(), cfooter.size(),
+                            static_cast<off_t> (dataBytes)))
+            {
+                throw std::invalid_argument("Failed to read footer\n");
+            }
+            pImpl->mHeader.setFromBinaryFooter(cfooter.data(), lswap);
+        }
+        double dt = getSamplingPeriod();
+        double startTime = getStartTime().getEpochalTime();
+        // Tolerate round off in the epochal times, which are only good to
+        // about a microsecond, so a window that starts or ends on a sample
+        // keeps that sample
+        constexpr double tol = 1.e-3;
+        auto i0 = static_cast<int64_t>
+                  (std::ceil((t0.getEpochalTime() - startTime)/dt - tol));
+        auto i1 = static_cast<int64_t>
+                  (std::floor((t1.getEpochalTime() - startTime)/dt + tol));
+        i0 = std::max(int64_t {0}, i0);
+        i1 = std::min(static_cast<int64_t> (npts) - 1, i1);
+        if (i1 < i0)
+        {
+            throw std::invalid_argument("No data in time window\n");
+        }
+        // Read only the samples in the window
+        auto nWindow = static_cast<int> (i1 - i0 + 1);
+        auto nWindowBytes = sizeof(float)*static_cast<size_t> (nWindow);
+        auto offset = static_cast<off_t> (632 + sizeof(float)*i0);
+        pImpl->allocateSamples(nWindow);
+        if (!lswap && pImpl->mPrecision == Precision::FLOAT32)
+        {
+            if (!preadFully(fd, pImpl->mData.data<char> (), nWindowBytes,
+                            offset))
+            {
+                throw std::invalid_argument("Failed to read samples\n");
+            }
+        }
+        else
+        {
+            std::vector<char> cdata(nWindowBytes);
+            if (!preadFully(fd, cdata.data(), nWindowBytes, offset))
+            {
+                throw std::invalid_argument("Failed to read samples\n");
+            }
+            if (!lswap)
+            {
+                Temblor::Private::convertSamples(
+                    nWindow, reinterpret_cast<const float *> (cdata.data()),
+                    pImpl->mData.data<double> ());
+            }
+            else if (pImpl->mPrecision == Precision::FLOAT32)
+            {
+                Temblor::Private::unpackSwapped32(nWindow, cdata.data(),
+                                                  pImpl->mData.data<float> ());
+            }
+            else
+            {
+                Temblor::Private::unpackSwapped32(nWindow, cdata.data(),
+                                                  pImpl->mData.data<double> ());
+            }
+        }
+        // Shift the header to the window
+        auto b = pImpl->mHeader.getHeader(Double::B) + i0*dt;
+        pImpl->mHeader.setHeader(Double::B, b);
+        pImpl->mHeader.setHeader(Double::E, b + (nWindow - 1)*dt);
+        pImpl->mHeader.setHeader(Integer::NPTS, nWindow);
+    }
+    catch (...)
+    {
+        close(fd);
+        pImpl->mData.clear();
+        pImpl->mHeader.clear();
+        throw;
     }
+    close(fd);
 }
 
 /// Writes a waveform
@@ -232,43 +438,117 @@ void Waveform::write(const std::string &fileName, const bool lswap) const
         }
     }
 #endif
-    // Pack the header
+    // Pack the header and footer
     int npts = getNumberOfSamples();
-    size_t nbytes = 632 + sizeof(float)*static_cast<size_t> (npts);
-    std::vector<char> cdata(nbytes);
-    pImpl->mHeader.getBinaryHeader(cdata.data(), lswap);
-    // Pack the data
-    if (!lswap)
+    bool haveFooter = (getHeader(Integer::NVHDR) == 7);
+    std::array<char, 632> cheader;
+    std::array<char, 176> cfooter;
+    pImpl->mHeader.getBinaryHeader(cheader.data(), lswap);
+    if (haveFooter)
+    {
+        pImpl->mHeader.getBinaryFooter(cfooter.data(), lswap);
+    }
+    int fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw std::invalid_argument("Failed to open " + fileName + "\n");
+    }
+    // Gather the header, a block of samples, and the footer into one
+    // writev call.  Native float samples are written straight from the
+    // buffer.  Otherwise they are packed a block at a time so that the
+    // file is never staged in memory.
+    std::array<struct iovec, 3> iov;
+    bool lwritten = true;
+    if (!lswap && pImpl->mPrecision == Precision::FLOAT32)
+    {
+        iov[0] = {cheader.data(), cheader.size()};
+        iov[1] = {pImpl->mData.data<char> (),
+                  sizeof(float)*static_cast<size_t> (npts)};
+        iov[2] = {cfooter.data(), haveFooter ? cfooter.size() : 0};
+        lwritten = writevFully(fd, iov.data(), 3);
+    }
+    else
     {
-        auto fdata = reinterpret_cast<float *> (cdata.data() + 632);
-        #pragma omp simd
-        for (auto i=0; i<npts; ++i)
+        Temblor::Private::AlignedBuffer block;
+        block.allocate(sizeof(float)*std::min(npts, WRITE_BLOCK_SIZE));
+        for (int i0=0; i0<npts && lwritten; i0=i0+WRITE_BLOCK_SIZE)
         {
-            fdata[i] = static_cast<float> (pImpl->mData[i]);
+            auto n = std::min(WRITE_BLOCK_SIZE, npts - i0);
+            if (!lswap)
+            {
+                Temblor::Private::convertSamples(
+                    n, pImpl->mData.data<double> () + i0,
+                    block.data<float> ());
+            }
+            else if (pImpl->mPrecision == Precision::FLOAT32)
+            {
+                Temblor::Private::packSwapped32(
+                    n, pImpl->mData.data<float> () + i0, block.data<char> ());
+            }
+            else
+            {
+                Temblor::Private::packSwapped32(
+                    n, pImpl->mData.data<double> () + i0, block.data<char> ());
+            }
+            bool lfirst = (i0 == 0);
+            bool llast = (i0 + n == npts);
+            iov[0] = {cheader.data(), lfirst ? cheader.size() : 0};
+            iov[1] = {block.data<char> (), sizeof(float)*n};
+            iov[2] = {cfooter.data(),
+                      llast && haveFooter ? cfooter.size() : 0};
+            lwritten = writevFully(fd, iov.data(), 3);
         }
     }
-    else
+    if (close(fd) != 0){lwritten = false;}
+    if (!lwritten)
     {
-        union
+        throw std::runtime_error("Failed to write " + fileName + "\n");
+    }
+}
+
+/// Writes many waveforms
+void Waveform::writeMany(const std::vector<Waveform> &waveforms,
+                         const std::vector<std::string> &fileNames,
+                         const bool lswap, const int nThreads)
+{
+    if (waveforms.size() != fileNames.size())
+    {
+        throw std::invalid_argument("Number of waveforms = "
+                                  + std::to_string(waveforms.size())
+                                  + " must equal number of file names = "
+                                  + std::to_string(fileNames.size()) + "\n");
+    }
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    auto nWaveforms = static_cast<int> (waveforms.size());
+    int nFailed = 0;
+    std::string error;
+    #pragma omp parallel for num_threads(nThreads) schedule(dynamic)
+    for (int i=0; i<nWaveforms; ++i)
+    {
+        try
         {
-            char c4[4];
-            float f4; 
-        };
-        for (int i=0; i<npts; ++i)
+            waveforms[i].write(fileNames[i], lswap);
+        }
+        catch (const std::exception &e)
         {
-            f4 = static_cast<float> (pImpl->mData[i]);
-            auto indx = 632 + i*4;
-            cdata[indx]   = c4[3];
-            cdata[indx+1] = c4[2];
-            cdata[indx+2] = c4[1];
-            cdata[indx+3] = c4[0];
+            #pragma omp critical(SACWriteMany)
+            {
+                if (nFailed == 0){error = e.what();}
+                nFailed = nFailed + 1;
+            }
         }
     }
-    // Write it 
-    std::ofstream outfile(fileName,
-                          std::ofstream::binary | std::ofstream::trunc);
-    outfile.write(cdata.data(), nbytes);
-    outfile.close();
+    if (nFailed > 0)
+    {
+        throw std::runtime_error("Failed to write " + std::to_string(nFailed)
+                               + " of " + std::to_string(nWaveforms)
+                               + " waveforms; e.g., " + error);
+    }
 }
 
 /// Gets the trace start time
@@ -398,14 +678,22 @@ bool Waveform::isValid() const noexcept
     if (!pImpl){return false;}
     if (getSamplingPeriod() <= 0){return false;}
     if (getNumberOfSamples() < 0){return false;}
-    if (pImpl->mData == nullptr){return false;}
+    if (pImpl->mData.size() == 0){return false;}
     return true;
 }
 
 /// Gets a pointer to the data
 const double *Waveform::getDataPointer() const noexcept
 {
-    return pImpl->mData;
+    if (pImpl->mPrecision != Precision::FLOAT64){return nullptr;}
+    return pImpl->mData.data<double> ();
+}
+
+/// Gets a pointer to the float data
+const float *Waveform::getDataPointer32f() const noexcept
+{
+    if (pImpl->mPrecision != Precision::FLOAT32){return nullptr;}
+    return pImpl->mData.data<float> ();
 }
 
 /// Get a copy of the data
@@ -419,7 +707,7 @@ void Waveform::getData(const int npts, double *dataIn[]) const
                                   + std::to_string(n) + "\n");
     }
     double *data = *dataIn;
-    std::copy(pImpl->mData, pImpl->mData+n, data); 
+    pImpl->getSamples(n, data);
 }
 
 void Waveform::getData(const int npts, float *dataIn[]) const
@@ -432,15 +720,14 @@ void Waveform::getData(const int npts, float *dataIn[]) const
                                   + std::to_string(n) + "\n");
     }
     float *data = *dataIn;
-    #pragma omp simd
-    for (int i=0; i<n; ++i){data[i] = static_cast<float> (pImpl->mData[i]);}
+    pImpl->getSamples(n, data);
 }
 
 /// Gets a copy of the data
 std::vector<double> Waveform::getData() const noexcept
 {
     int npts = getNumberOfSamples();
-    if (npts > 0 && pImpl->mData)
+    if (npts > 0 && pImpl->mData.size() > 0)
     {
         std::vector<double> data(npts);
         double *dataPtr = data.data();
@@ -468,21 +755,22 @@ void Waveform::setData(const int npts, const double x[])
         throw std::invalid_argument("x is NULL");
     }
     pImpl->mHeader.setHeader(Integer::NPTS, npts);
-    pImpl->mData = alignedAllocDouble(npts);
-    std::memcpy(pImpl->mData, x, static_cast<size_t> (npts)*sizeof(double));
+    pImpl->setSamples(npts, x);
 }
 
-//============================================================================//
-
-static double *alignedAllocDouble(const int npts)
+/// Sets the waveform data
+void Waveform::setData(const int npts, const float x[])
 {
-    size_t nbytes = static_cast<size_t> (npts)*sizeof(double);
-#ifndef __OSX__ //ALIGNED_ALLOC
-    void *dataTemp = malloc(nbytes);
-    posix_memalign(&dataTemp, 64, nbytes);
-    auto data = static_cast<double *> (dataTemp);
-#else
-    double *data = static_cast<double *> (std::aligned_alloc(64, nbytes));
-#endif
-    return data;
+    pImpl->freeData();
+    if (npts <= 0)
+    {
+        throw std::invalid_argument("npts = " + std::to_string(npts)
+                                  + " must be positive\n");
+    }
+    if (x == nullptr)
+    {
+        throw std::invalid_argument("x is NULL");
+    }
+    pImpl->mHeader.setHeader(Integer::NPTS, npts);
+    pImpl->setSamples(npts, x);
 }
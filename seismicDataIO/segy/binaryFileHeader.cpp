@@ -1,100 +1,62 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <algorithm>
-#include "temblor/dataReaders/segy/binaryFileHeader.hpp"
+#include <stdexcept>
+#include "temblor/private/byteSwap.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
 
-using namespace Temblor::DataReaders::SEGY;
+using namespace Temblor::SeismicDataIO::SEGY;
 
 namespace
 {
 
-inline uint16_t unpackUInt16t(const char c2[2], const bool lswap = false)
-{
-    union
-    {
-        char cpad2[2];
-        uint16_t i2;
-    };
-    if (!lswap)
-    {
-        cpad2[0] = c2[0];
-        cpad2[1] = c2[1];
-    }
-    else
-    {
-        cpad2[0] = c2[1];
-        cpad2[1] = c2[0];
-    }
-    return i2;
-}
-
-inline uint32_t unpackUInt32t(const char c4[4], const bool lswap = false)
-{
-    union
-    {
-        char cpad4[4];
-        uint32_t i4; 
-    };
-    if (!lswap)
-    {
-        cpad4[0] = c4[0];
-        cpad4[1] = c4[1];
-        cpad4[2] = c4[2];
-        cpad4[3] = c4[3];
-    }
-    else
-    {
-        cpad4[0] = c4[3];
-        cpad4[1] = c4[2];
-        cpad4[2] = c4[1];
-        cpad4[3] = c4[0];
-    }
-    return i4;
-}
+constexpr bool MACHINE_IS_LITTLE_ENDIAN
+    = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+/// Bytes 3297-3300 hold this constant so readers can infer the byte order
+constexpr uint32_t INTEGER_CONSTANT = 0x01020304;
 
 }
 
 class BinaryFileHeader::BinaryFileHeaderImpl
 {
 public:
-/*
-    BinaryFileHeaderImpl(const BinaryFileHeaderImpl &header)
-    {
-        *this = header;
-    }
-
-    //BinaryFileHeaderImpl&
-    //operator=(const BinaryFileHeaderImpl &header) = default;
-*/
     uint32_t mJobID = 0;
     uint32_t mLineNumber = 0;
     uint32_t mReelNumber = 0;
     uint16_t mNumberOfTracesPerEnsemble = 0;
+    uint16_t mNumberOfAuxiliaryTracesPerEnsemble = 0;
     uint16_t mSampleInterval = 0;
+    uint16_t mOriginalSampleInterval = 0;
     uint16_t mNumberOfSamplesPerTrace = 0;
     uint16_t mNumberOfOriginalSamplesPerTrace = 0;
     uint16_t mDataFormat = 0;
     uint16_t mEnsembleFold = 0;
-    uint16_t mStartingSweepFrequency = 0;
-    uint16_t mEndingSweepFrequency = 0;
+    int16_t mTraceSortingCode = 0;
+    uint16_t mVerticalSumCode = 0;
+    int16_t mStartingSweepFrequency = 0;
+    int16_t mEndingSweepFrequency = 0;
+    uint16_t mSweepLength = 0;
+    int16_t mMeasurementSystem = 0;
     uint16_t mVibratoryPolarityCode = 0;
     uint32_t mExtendedNumberOfTracesPerEnsemble = 0;
+    uint32_t mExtendedNumberOfAuxiliaryTracesPerEnsemble = 0;
     uint32_t mExtendedNumberOfSamplesPerTrace = 0;
+    double mExtendedSampleInterval = 0;
     uint32_t mExtendedOriginalNumberOfSamplesPerTrace = 0;
     uint32_t mExtendedEnsembleFold = 0;
-    uint32_t mIntegerConstant = 169090601; // Works as a magic number
-    uint32_t mUnassigned = 0;
     uint8_t mMajorRevision = 0;
     uint8_t mMinorRevision = 0;
     uint16_t mFixedTraceFlag = 0;
-    uint16_t mNumberOfExtendedTextHeaders = 0;
-    uint32_t mMaximumNumberOfExtraTraceHeaders = 0;
+    int16_t mNumberOfExtendedTextHeaders = 0;
+    int32_t mMaximumNumberOfExtraTraceHeaders = 0;
     uint16_t mTimeCode = 0;
     uint64_t mNumberOfTracesInFile = 0;
     uint64_t mOffset = 0;
-    uint32_t mNumberOfTrailerStanzas = 0;
+    int32_t mNumberOfTrailerStanzas = 0;
+    bool mLittleEndian = false;
 };
 
 /// Constructor
@@ -139,22 +101,195 @@ void BinaryFileHeader::setBinaryHeader(const char header[400])
 {
     if (header == nullptr)
     {
-        throw std::invalid_argument("Header is NULL");
+        throw std::invalid_argument("Header is NULL\n");
     }
-    BinaryFileHeader hdr;
-    uint32_t jobID       = unpackUInt32t(&header[0]);
-    uint32_t lineNumber  = unpackUInt32t(&header[4]);
-    uint32_t reelNumber  = unpackUInt32t(&header[8]);
-    uint16_t nEnsemble   = unpackUInt16t(&header[10]);
-    uint16_t nSampleInt  = unpackUInt16t(&header[12]);
-    uint16_t nSamples    = unpackUInt16t(&header[14]);
-    hdr.setJobIdentificationNumber(jobID);
-    hdr.setLineNumber(lineNumber);
-    hdr.setReelNumber(reelNumber);
-    hdr.setNumberOfTracesPerEnsemble(nEnsemble);
-    hdr.setSampleInterval(nSampleInt);
-    hdr.setNumberOfSamplesPerTrace(nSamples);
-    *this = hdr;
+    using Temblor::Private::unpackScalar;
+    // Infer the byte order from the integer constant.  Older files leave
+    // this zero and are big-endian.
+    auto constant = unpackScalar<uint32_t> (&header[96], false);
+    bool lswap = MACHINE_IS_LITTLE_ENDIAN;
+    if (constant == INTEGER_CONSTANT)
+    {
+        lswap = false;
+    }
+    else if (__builtin_bswap32(constant) == INTEGER_CONSTANT)
+    {
+        lswap = true;
+    }
+    BinaryFileHeaderImpl hdr;
+    hdr.mLittleEndian = (MACHINE_IS_LITTLE_ENDIAN != lswap);
+    hdr.mJobID = unpackScalar<uint32_t> (&header[0], lswap);
+    hdr.mLineNumber = unpackScalar<uint32_t> (&header[4], lswap);
+    hdr.mReelNumber = unpackScalar<uint32_t> (&header[8], lswap);
+    hdr.mNumberOfTracesPerEnsemble
+        = unpackScalar<uint16_t> (&header[12], lswap);
+    hdr.mNumberOfAuxiliaryTracesPerEnsemble
+        = unpackScalar<uint16_t> (&header[14], lswap);
+    hdr.mSampleInterval = unpackScalar<uint16_t> (&header[16], lswap);
+    hdr.mOriginalSampleInterval = unpackScalar<uint16_t> (&header[18], lswap);
+    hdr.mNumberOfSamplesPerTrace
+        = unpackScalar<uint16_t> (&header[20], lswap);
+    hdr.mNumberOfOriginalSamplesPerTrace
+        = unpackScalar<uint16_t> (&header[22], lswap);
+    hdr.mDataFormat = unpackScalar<uint16_t> (&header[24], lswap);
+    hdr.mEnsembleFold = unpackScalar<uint16_t> (&header[26], lswap);
+    hdr.mTraceSortingCode = unpackScalar<int16_t> (&header[28], lswap);
+    hdr.mVerticalSumCode = unpackScalar<uint16_t> (&header[30], lswap);
+    hdr.mStartingSweepFrequency = unpackScalar<int16_t> (&header[32], lswap);
+    hdr.mEndingSweepFrequency = unpackScalar<int16_t> (&header[34], lswap);
+    hdr.mSweepLength = unpackScalar<uint16_t> (&header[36], lswap);
+    hdr.mMeasurementSystem = unpackScalar<int16_t> (&header[54], lswap);
+    hdr.mVibratoryPolarityCode = unpackScalar<uint16_t> (&header[58], lswap);
+    hdr.mMajorRevision = static_cast<uint8_t> (header[300]);
+    hdr.mMinorRevision = static_cast<uint8_t> (header[301]);
+    // The remaining fields were introduced in revisions 1 and 2
+    if (hdr.mMajorRevision >= 1)
+    {
+        hdr.mFixedTraceFlag = unpackScalar<uint16_t> (&header[302], lswap);
+        hdr.mNumberOfExtendedTextHeaders
+            = unpackScalar<int16_t> (&header[304], lswap);
+    }
+    else
+    {
+        hdr.mFixedTraceFlag = 1;
+    }
+    if (hdr.mMajorRevision >= 2)
+    {
+        hdr.mExtendedNumberOfTracesPerEnsemble
+            = unpackScalar<uint32_t> (&header[60], lswap);
+        hdr.mExtendedNumberOfAuxiliaryTracesPerEnsemble
+            = unpackScalar<uint32_t> (&header[64], lswap);
+        hdr.mExtendedNumberOfSamplesPerTrace
+            = unpackScalar<uint32_t> (&header[68], lswap);
+        hdr.mExtendedSampleInterval
+            = unpackScalar<double> (&header[72], lswap);
+        hdr.mExtendedOriginalNumberOfSamplesPerTrace
+            = unpackScalar<uint32_t> (&header[88], lswap);
+        hdr.mExtendedEnsembleFold
+            = unpackScalar<uint32_t> (&header[92], lswap);
+        hdr.mMaximumNumberOfExtraTraceHeaders
+            = unpackScalar<int32_t> (&header[306], lswap);
+        hdr.mTimeCode = unpackScalar<uint16_t> (&header[310], lswap);
+        hdr.mNumberOfTracesInFile
+            = unpackScalar<uint64_t> (&header[312], lswap);
+        hdr.mOffset = unpackScalar<uint64_t> (&header[320], lswap);
+        hdr.mNumberOfTrailerStanzas
+            = unpackScalar<int32_t> (&header[328], lswap);
+    }
+    if (hdr.mNumberOfExtendedTextHeaders < -1)
+    {
+        throw std::invalid_argument("Number of extended textual headers = "
+                      + std::to_string(hdr.mNumberOfExtendedTextHeaders)
+                      + " must be at least -1\n");
+    }
+    if (hdr.mMaximumNumberOfExtraTraceHeaders < 0)
+    {
+        throw std::invalid_argument(
+            "Number of additional trace headers cannot be negative\n");
+    }
+    *pImpl = hdr;
+}
+
+/// Pack a binary file header
+void BinaryFileHeader::getBinaryHeader(char header[400]) const
+{
+    if (header == nullptr)
+    {
+        throw std::invalid_argument("Header is NULL\n");
+    }
+    using Temblor::Private::packScalar;
+    constexpr auto lswap = MACHINE_IS_LITTLE_ENDIAN;
+    std::memset(header, 0, 400);
+    packScalar(pImpl->mJobID, &header[0], lswap);
+    packScalar(pImpl->mLineNumber, &header[4], lswap);
+    packScalar(pImpl->mReelNumber, &header[8], lswap);
+    packScalar(pImpl->mNumberOfTracesPerEnsemble, &header[12], lswap);
+    packScalar(pImpl->mNumberOfAuxiliaryTracesPerEnsemble, &header[14],
+               lswap);
+    packScalar(pImpl->mSampleInterval, &header[16], lswap);
+    packScalar(pImpl->mOriginalSampleInterval, &header[18], lswap);
+    packScalar(pImpl->mNumberOfSamplesPerTrace, &header[20], lswap);
+    packScalar(pImpl->mNumberOfOriginalSamplesPerTrace, &header[22], lswap);
+    packScalar(pImpl->mDataFormat, &header[24], lswap);
+    packScalar(pImpl->mEnsembleFold, &header[26], lswap);
+    packScalar(pImpl->mTraceSortingCode, &header[28], lswap);
+    packScalar(pImpl->mVerticalSumCode, &header[30], lswap);
+    packScalar(pImpl->mStartingSweepFrequency, &header[32], lswap);
+    packScalar(pImpl->mEndingSweepFrequency, &header[34], lswap);
+    packScalar(pImpl->mSweepLength, &header[36], lswap);
+    packScalar(pImpl->mMeasurementSystem, &header[54], lswap);
+    packScalar(pImpl->mVibratoryPolarityCode, &header[58], lswap);
+    packScalar(pImpl->mExtendedNumberOfTracesPerEnsemble, &header[60],
+               lswap);
+    packScalar(pImpl->mExtendedNumberOfAuxiliaryTracesPerEnsemble,
+               &header[64], lswap);
+    packScalar(pImpl->mExtendedNumberOfSamplesPerTrace, &header[68], lswap);
+    packScalar(pImpl->mExtendedSampleInterval, &header[72], lswap);
+    packScalar(pImpl->mExtendedOriginalNumberOfSamplesPerTrace, &header[88],
+               lswap);
+    packScalar(pImpl->mExtendedEnsembleFold, &header[92], lswap);
+    packScalar(INTEGER_CONSTANT, &header[96], lswap);
+    header[300] = static_cast<char> (pImpl->mMajorRevision);
+    header[301] = static_cast<char> (pImpl->mMinorRevision);
+    packScalar(pImpl->mFixedTraceFlag, &header[302], lswap);
+    packScalar(pImpl->mNumberOfExtendedTextHeaders, &header[304], lswap);
+    packScalar(pImpl->mMaximumNumberOfExtraTraceHeaders, &header[306],
+               lswap);
+    packScalar(pImpl->mTimeCode, &header[310], lswap);
+    packScalar(pImpl->mNumberOfTracesInFile, &header[312], lswap);
+    packScalar(pImpl->mOffset, &header[320], lswap);
+    packScalar(pImpl->mNumberOfTrailerStanzas, &header[328], lswap);
+}
+
+/// Byte order
+bool BinaryFileHeader::isLittleEndian() const noexcept
+{
+    return pImpl->mLittleEndian;
+}
+
+/// Revision
+uint8_t BinaryFileHeader::getMajorRevision() const noexcept
+{
+    return pImpl->mMajorRevision;
+}
+uint8_t BinaryFileHeader::getMinorRevision() const noexcept
+{
+    return pImpl->mMinorRevision;
+}
+
+/// File layout
+void BinaryFileHeader::setFixedLengthTraces(const bool fixedLength) noexcept
+{
+    pImpl->mFixedTraceFlag = fixedLength ? 1 : 0;
+}
+bool BinaryFileHeader::haveFixedLengthTraces() const noexcept
+{
+    return pImpl->mMajorRevision == 0 || pImpl->mFixedTraceFlag == 1;
+}
+int BinaryFileHeader::getNumberOfExtendedTextualHeaders() const noexcept
+{
+    return pImpl->mNumberOfExtendedTextHeaders;
+}
+int BinaryFileHeader::getMaximumNumberOfAdditionalTraceHeaders()
+    const noexcept
+{
+    return pImpl->mMaximumNumberOfExtraTraceHeaders;
+}
+void BinaryFileHeader::setNumberOfTracesInFile(const uint64_t nTraces) noexcept
+{
+    pImpl->mNumberOfTracesInFile = nTraces;
+}
+uint64_t BinaryFileHeader::getNumberOfTracesInFile() const noexcept
+{
+    return pImpl->mNumberOfTracesInFile;
+}
+uint64_t BinaryFileHeader::getFirstTraceOffset() const noexcept
+{
+    return pImpl->mOffset;
+}
+int BinaryFileHeader::getNumberOfDataTrailerStanzas() const noexcept
+{
+    return pImpl->mNumberOfTrailerStanzas;
 }
 
 /// Job ID number
@@ -268,23 +403,75 @@ DataFormat BinaryFileHeader::getDataFormat() const
     return dataFormat; 
 }
 
+/// Ensemble fold
+void BinaryFileHeader::setNumberOfTracesPerEnsembleFold(
+    const uint16_t nTracesPerFold)
+{
+    pImpl->mExtendedEnsembleFold = 0;
+    pImpl->mEnsembleFold = nTracesPerFold;
+}
+uint16_t BinaryFileHeader::getNumberOfTracesPerEnsembleFold() const
+{
+    return pImpl->mEnsembleFold;
+}
+
+/// Trace sorting code
+void BinaryFileHeader::setTraceSortingCode(
+    const TraceSortingCode traceSortingCode) noexcept
+{
+    pImpl->mTraceSortingCode = static_cast<int16_t> (traceSortingCode);
+}
+TraceSortingCode BinaryFileHeader::getTraceSortingCode() const noexcept
+{
+    if (pImpl->mTraceSortingCode < 0 || pImpl->mTraceSortingCode > 9)
+    {
+        return TraceSortingCode::UNKNOWN;
+    }
+    return static_cast<TraceSortingCode> (pImpl->mTraceSortingCode);
+}
+
+/// Vertical sum code
+void BinaryFileHeader::setVerticalSumCode(const uint16_t verticalSumCode)
+{
+    if (verticalSumCode < 1 || verticalSumCode > 32767)
+    {
+        throw std::invalid_argument("Vertical sum code = "
+                                  + std::to_string(verticalSumCode)
+                                  + " must be in range [1,32767]\n");
+    }
+    pImpl->mVerticalSumCode = verticalSumCode;
+}
+uint16_t BinaryFileHeader::getVerticalSumCode() const noexcept
+{
+    return pImpl->mVerticalSumCode;
+}
+
 /// Sweep frequencies
 void BinaryFileHeader::setStartingSweepFrequency(
-    const uint16_t sweepFrequency) noexcept
+    const int16_t sweepFrequency) noexcept
 {
     pImpl->mStartingSweepFrequency = sweepFrequency;
 }
-uint16_t BinaryFileHeader::getStartingSweepFrequency() const noexcept
+int16_t BinaryFileHeader::getStartingSweepFrequency() const noexcept
 {
     return pImpl->mStartingSweepFrequency;
 }
 void BinaryFileHeader::setEndingSweepFrequency(
-    const uint16_t sweepFrequency) noexcept
+    const int16_t sweepFrequency) noexcept
 {
     pImpl->mEndingSweepFrequency = sweepFrequency;
 }
-uint16_t BinaryFileHeader::getEndingSweepFrequency() const noexcept
+int16_t BinaryFileHeader::getEndingSweepFrequency() const noexcept
 {
     return pImpl->mEndingSweepFrequency;
 }
 
+/// Sweep length
+void BinaryFileHeader::setSweepLength(const uint16_t sweepLength)
+{
+    pImpl->mSweepLength = sweepLength;
+}
+uint16_t BinaryFileHeader::getSweepLength() const noexcept
+{
+    return pImpl->mSweepLength;
+}
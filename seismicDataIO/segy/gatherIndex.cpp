@@ -0,0 +1,965 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "temblor/private/filesystem.hpp"
+#include "temblor/private/indexFile.hpp"
+#include "temblor/private/segySamples.hpp"
+#include "temblor/seismicDataIO/segy/gatherIndex.hpp"
+#include "temblor/seismicDataIO/segy/segy2.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+
+using namespace Temblor::SeismicDataIO::SEGY;
+
+namespace
+{
+
+/// Identifies an index file
+constexpr char MAGIC[8] = {'T', 'M', 'B', 'L', 'S', 'G', 'Y', 'X'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr size_t TRACE_HEADER_SIZE = 240;
+constexpr int N_TRACE_HEADER_FIELDS = 34;
+/// Each row is the trace offset, trace index, number of samples, and keys
+constexpr size_t KEY_COLUMN_OFFSET = 16;
+/// The smallest memory budget
+constexpr size_t MINIMUM_MEMORY = 4096;
+/// The fewest rows buffered for each run during a merge
+constexpr size_t MINIMUM_MERGE_ROWS = 64;
+
+/// Reads nbytes starting at offset.  This returns false if the file is
+/// too short or cannot be read.
+bool preadFully(const int fd, char *buffer, size_t nbytes, off_t offset)
+{
+    while (nbytes > 0)
+    {
+        auto nread = pread(fd, buffer, nbytes, offset);
+        if (nread <= 0){return false;}
+        buffer = buffer + nread;
+        nbytes = nbytes - static_cast<size_t> (nread);
+        offset = offset + nread;
+    }
+    return true;
+}
+
+/// Orders the rows of the index by the sort key columns.  Ties are broken
+/// by the trace index so the order is total and the sort is stable.
+class RowComparator
+{
+public:
+    explicit RowComparator(const std::vector<int> &columns) :
+        mColumns(columns)
+    {
+    }
+    int compare(const char *lhs, const char *rhs) const noexcept
+    {
+        for (const auto &column : mColumns)
+        {
+            auto l = getKey(lhs, column);
+            auto r = getKey(rhs, column);
+            if (l != r){return (l < r) ? -1 : 1;}
+        }
+        auto l = getTrace(lhs);
+        auto r = getTrace(rhs);
+        if (l != r){return (l < r) ? -1 : 1;}
+        return 0;
+    }
+    static int32_t getKey(const char *row, const int column) noexcept
+    {
+        int32_t value;
+        std::memcpy(&value, row + KEY_COLUMN_OFFSET + 4*column,
+                    sizeof(int32_t));
+        return value;
+    }
+    static int32_t getTrace(const char *row) noexcept
+    {
+        int32_t value;
+        std::memcpy(&value, row + 8, sizeof(int32_t));
+        return value;
+    }
+private:
+    std::vector<int> mColumns;
+};
+
+/// A file of sorted rows
+struct Run
+{
+    std::string fileName;
+    uint64_t offset;  // The byte offset of the first row
+    uint64_t nRows;
+};
+
+/// Streams rows from a sorted run through a bounded buffer
+class RunReader
+{
+public:
+    RunReader(const std::string &fileName, const uint64_t offset,
+              const uint64_t nRows, const size_t rowSize,
+              const size_t bufferRows) :
+        mFile(fileName, std::ifstream::binary),
+        mBuffer(std::max<size_t> (1, bufferRows)*rowSize),
+        mRemaining(nRows),
+        mRowSize(rowSize)
+    {
+        if (!mFile)
+        {
+            throw std::runtime_error("Could not open " + fileName + "\n");
+        }
+        mFile.seekg(static_cast<std::streamoff> (offset));
+        fill();
+    }
+    const char *current() const noexcept
+    {
+        return mBuffer.data() + mPosition;
+    }
+    bool empty() const noexcept
+    {
+        return mPosition >= mBuffered;
+    }
+    void advance()
+    {
+        mPosition = mPosition + mRowSize;
+        if (mPosition >= mBuffered){fill();}
+    }
+private:
+    void fill()
+    {
+        auto nRows = std::min<uint64_t> (mRemaining, mBuffer.size()/mRowSize);
+        mPosition = 0;
+        mBuffered = static_cast<size_t> (nRows)*mRowSize;
+        if (mBuffered == 0){return;}
+        mFile.read(mBuffer.data(), static_cast<std::streamsize> (mBuffered));
+        if (!mFile)
+        {
+            throw std::runtime_error("Failed to read sorted run\n");
+        }
+        mRemaining = mRemaining - nRows;
+    }
+    std::ifstream mFile;
+    std::vector<char> mBuffer;
+    uint64_t mRemaining = 0;
+    size_t mRowSize = 0;
+    size_t mPosition = 0;
+    size_t mBuffered = 0;
+};
+
+/// Removes temporary files when sorting finishes or fails
+class TemporaryFiles
+{
+public:
+    ~TemporaryFiles()
+    {
+        for (const auto &fileName : mFileNames){std::remove(fileName.c_str());}
+    }
+    std::string make(const std::string &prefix)
+    {
+        auto fileName = prefix + ".run" + std::to_string(mCounter);
+        mCounter = mCounter + 1;
+        mFileNames.push_back(fileName);
+        return fileName;
+    }
+    void remove(const std::string &fileName)
+    {
+        std::remove(fileName.c_str());
+        mFileNames.erase(std::remove(mFileNames.begin(), mFileNames.end(),
+                                     fileName),
+                         mFileNames.end());
+    }
+    std::vector<std::string> mFileNames;
+    int mCounter = 0;
+};
+
+/// Writes a block of bytes to a stream
+void writeBlock(std::ofstream &outfile, const std::vector<char> &buffer,
+                const size_t nbytes, const std::string &fileName)
+{
+    if (nbytes == 0){return;}
+    outfile.write(buffer.data(), static_cast<std::streamsize> (nbytes));
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not write " + fileName + "\n");
+    }
+}
+
+}
+
+class GatherIndex::GatherIndexImpl
+{
+public:
+    /// The bytes in a row of the index
+    size_t getRowSize() const noexcept
+    {
+        return KEY_COLUMN_OFFSET + 4*mKeys.size();
+    }
+    /// Packs the header.  Space for a sort key per key is reserved so that
+    /// the header's size does not change when the sort keys change.
+    std::vector<char> packHeader(
+        const std::vector<TraceHeaderField> &sortKeys) const
+    {
+        Temblor::Private::IndexWriter writer;
+        writer.putPreamble(MAGIC, FORMAT_VERSION);
+        writer.putString(mSEGYFileName);
+        writer.put(static_cast<int16_t> (mDataFormat));
+        writer.put(static_cast<int16_t> (mNativeSortingCode));
+        writer.put(static_cast<uint8_t> (mLittleEndian));
+        writer.put(static_cast<uint32_t> (mKeys.size()));
+        for (const auto &key : mKeys){writer.put(static_cast<int32_t> (key));}
+        writer.put(static_cast<uint32_t> (sortKeys.size()));
+        for (size_t i=0; i<mKeys.size(); ++i)
+        {
+            int32_t key = -1;
+            if (i < sortKeys.size()){key = static_cast<int32_t> (sortKeys[i]);}
+            writer.put(key);
+        }
+        writer.put(static_cast<uint64_t> (mNumberOfTraces));
+        return writer.mBuffer;
+    }
+    /// Gets the key columns of the given fields
+    std::vector<int> getColumns(const std::vector<TraceHeaderField> &keys)
+        const
+    {
+        if (keys.empty()){throw std::invalid_argument("No sort keys\n");}
+        std::vector<int> columns;
+        for (const auto &key : keys)
+        {
+            auto it = std::find(mKeys.begin(), mKeys.end(), key);
+            if (it == mKeys.end())
+            {
+                throw std::invalid_argument("Sort key "
+                    + std::to_string(static_cast<int> (key))
+                    + " is not indexed\n");
+            }
+            auto column = static_cast<int> (it - mKeys.begin());
+            if (std::find(columns.begin(), columns.end(), column)
+                != columns.end())
+            {
+                throw std::invalid_argument("Duplicate sort key\n");
+            }
+            columns.push_back(column);
+        }
+        return columns;
+    }
+    /// Rows that fit in the memory budget
+    size_t getRowsInMemory() const noexcept
+    {
+        return std::max<size_t> (1, mMaximumMemory/getRowSize());
+    }
+    /// Checks in one streaming pass if the rows are in order
+    bool isSorted(const std::vector<int> &columns) const
+    {
+        RowComparator comparator(columns);
+        RunReader reader(mIndexFileName, mDataOffset,
+                         static_cast<uint64_t> (mNumberOfTraces),
+                         getRowSize(), getRowsInMemory() - 1);
+        std::vector<char> previous(getRowSize());
+        bool havePrevious = false;
+        while (!reader.empty())
+        {
+            if (havePrevious &&
+                comparator.compare(previous.data(), reader.current()) > 0)
+            {
+                return false;
+            }
+            std::memcpy(previous.data(), reader.current(), previous.size());
+            havePrevious = true;
+            reader.advance();
+        }
+        return true;
+    }
+    /// Rewrites the header in place
+    void updateHeader() const
+    {
+        auto header = packHeader(mSortKeys);
+        std::fstream outfile(mIndexFileName, std::fstream::binary
+                           | std::fstream::in | std::fstream::out);
+        if (!outfile)
+        {
+            throw std::runtime_error("Could not open " + mIndexFileName
+                                   + "\n");
+        }
+        outfile.write(header.data(),
+                      static_cast<std::streamsize> (header.size()));
+        if (!outfile)
+        {
+            throw std::runtime_error("Could not write " + mIndexFileName
+                                   + "\n");
+        }
+    }
+    /// Sorts blocks of rows that fit in memory and writes each to a run.
+    /// When all rows fit in one run the header is written before the rows
+    /// so that the run is the finished index.
+    std::vector<Run> makeRuns(const RowComparator &comparator,
+                              const std::vector<char> &header,
+                              TemporaryFiles *temporaryFiles) const
+    {
+        auto rowSize = getRowSize();
+        auto nRows = static_cast<uint64_t> (mNumberOfTraces);
+        // The rows, their sorted copy, and the permutation share the budget
+        auto runRows = std::max<size_t> (1, mMaximumMemory
+                                          /(2*rowSize + sizeof(uint32_t)));
+        bool singleRun = (nRows <= runRows);
+        std::ifstream infile(mIndexFileName, std::ifstream::binary);
+        if (!infile)
+        {
+            throw std::runtime_error("Could not open " + mIndexFileName
+                                   + "\n");
+        }
+        infile.seekg(static_cast<std::streamoff> (mDataOffset));
+        std::vector<char> rows(std::min<uint64_t> (runRows, nRows)*rowSize);
+        std::vector<char> sorted(rows.size());
+        std::vector<uint32_t> permutation;
+        std::vector<Run> runs;
+        for (uint64_t row=0; row<nRows; row=row+runRows)
+        {
+            auto n = static_cast<size_t> (std::min<uint64_t> (runRows,
+                                                              nRows - row));
+            infile.read(rows.data(), static_cast<std::streamsize> (n*rowSize));
+            if (!infile)
+            {
+                throw std::runtime_error("Failed to read "
+                                       + mIndexFileName + "\n");
+            }
+            permutation.resize(n);
+            for (size_t i=0; i<n; ++i)
+            {
+                permutation[i] = static_cast<uint32_t> (i);
+            }
+            std::sort(permutation.begin(), permutation.end(),
+                      [&](const uint32_t lhs, const uint32_t rhs)
+                      {
+                          return comparator.compare(
+                                     rows.data() + lhs*rowSize,
+                                     rows.data() + rhs*rowSize) < 0;
+                      });
+            for (size_t i=0; i<n; ++i)
+            {
+                std::memcpy(sorted.data() + i*rowSize,
+                            rows.data() + permutation[i]*rowSize, rowSize);
+            }
+            Run run{temporaryFiles->make(mIndexFileName), 0, n};
+            std::ofstream outfile(run.fileName, std::ofstream::binary);
+            if (singleRun)
+            {
+                writeBlock(outfile, header, header.size(), run.fileName);
+                run.offset = header.size();
+            }
+            writeBlock(outfile, sorted, n*rowSize, run.fileName);
+            outfile.close();
+            if (!outfile)
+            {
+                throw std::runtime_error("Could not write " + run.fileName
+                                       + "\n");
+            }
+            runs.push_back(run);
+        }
+        return runs;
+    }
+    /// Merges the runs into the output file after the given header
+    Run mergeRuns(const RowComparator &comparator,
+                  const std::vector<Run> &runs,
+                  const std::string &fileName,
+                  const std::vector<char> &header,
+                  const size_t bufferRows) const
+    {
+        auto rowSize = getRowSize();
+        Run output{fileName, header.size(), 0};
+        std::ofstream outfile(fileName, std::ofstream::binary);
+        writeBlock(outfile, header, header.size(), fileName);
+        std::vector<RunReader> readers;
+        readers.reserve(runs.size());
+        for (const auto &run : runs)
+        {
+            readers.emplace_back(run.fileName, run.offset, run.nRows,
+                                 rowSize, bufferRows);
+        }
+        auto greater = [&](const size_t lhs, const size_t rhs)
+        {
+            return comparator.compare(readers[lhs].current(),
+                                      readers[rhs].current()) > 0;
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(greater)>
+            heap(greater);
+        for (size_t i=0; i<readers.size(); ++i)
+        {
+            if (!readers[i].empty()){heap.push(i);}
+        }
+        std::vector<char> buffer(bufferRows*rowSize);
+        size_t nbytes = 0;
+        while (!heap.empty())
+        {
+            auto i = heap.top();
+            heap.pop();
+            std::memcpy(buffer.data() + nbytes, readers[i].current(), rowSize);
+            nbytes = nbytes + rowSize;
+            output.nRows = output.nRows + 1;
+            if (nbytes == buffer.size())
+            {
+                writeBlock(outfile, buffer, nbytes, fileName);
+                nbytes = 0;
+            }
+            readers[i].advance();
+            if (!readers[i].empty()){heap.push(i);}
+        }
+        writeBlock(outfile, buffer, nbytes, fileName);
+        outfile.close();
+        if (!outfile)
+        {
+            throw std::runtime_error("Could not write " + fileName + "\n");
+        }
+        return output;
+    }
+    /// Sorts the runs then merges them until a single run remains.  The
+    /// result replaces the index file.
+    void externalSort(const std::vector<int> &columns,
+                      const std::vector<TraceHeaderField> &keys) const
+    {
+        RowComparator comparator(columns);
+        TemporaryFiles temporaryFiles;
+        auto header = packHeader(keys);
+        auto runs = makeRuns(comparator, header, &temporaryFiles);
+        // A single in-memory run already holds the header and sorted rows
+        if (runs.size() == 1 && runs.front().offset == header.size())
+        {
+            replaceIndex(runs.front().fileName, &temporaryFiles);
+            return;
+        }
+        // Each input and the output get an equal share of the memory
+        auto rowSize = getRowSize();
+        auto fanIn = std::max<size_t> (2, mMaximumMemory
+                                          /(MINIMUM_MERGE_ROWS*rowSize) - 1);
+        auto bufferRows = std::max<size_t> (1, getRowsInMemory()/(fanIn + 1));
+        while (runs.size() > fanIn)
+        {
+            std::vector<Run> merged;
+            for (size_t first=0; first<runs.size(); first=first+fanIn)
+            {
+                auto last = std::min(runs.size(), first + fanIn);
+                std::vector<Run> group(runs.begin() + first,
+                                       runs.begin() + last);
+                merged.push_back(mergeRuns(comparator, group,
+                                           temporaryFiles.make(mIndexFileName),
+                                           {}, bufferRows));
+                for (const auto &run : group)
+                {
+                    temporaryFiles.remove(run.fileName);
+                }
+            }
+            runs = std::move(merged);
+        }
+        auto sortedFileName = temporaryFiles.make(mIndexFileName);
+        mergeRuns(comparator, runs, sortedFileName, header, bufferRows);
+        replaceIndex(sortedFileName, &temporaryFiles);
+    }
+    /// Renames the sorted file over the index file
+    void replaceIndex(const std::string &sortedFileName,
+                      TemporaryFiles *temporaryFiles) const
+    {
+        if (std::rename(sortedFileName.c_str(), mIndexFileName.c_str()) != 0)
+        {
+            throw std::runtime_error("Could not replace "
+                                   + mIndexFileName + "\n");
+        }
+        temporaryFiles->remove(sortedFileName);
+    }
+    /// Binary search for the first row whose gather values are not less
+    /// than (upper = false) or greater than (upper = true) values
+    int64_t search(const int fd, const std::vector<int> &values,
+                   const bool upper) const
+    {
+        auto rowSize = getRowSize();
+        std::vector<char> row(rowSize);
+        int64_t lo = 0;
+        int64_t hi = mNumberOfTraces;
+        while (lo < hi)
+        {
+            auto mid = lo + (hi - lo)/2;
+            if (!preadFully(fd, row.data(), rowSize,
+                            static_cast<off_t> (mDataOffset + mid*rowSize)))
+            {
+                throw std::runtime_error("Failed to read "
+                                       + mIndexFileName + "\n");
+            }
+            int cmp = 0;
+            for (size_t i=0; i<values.size(); ++i)
+            {
+                auto key = RowComparator::getKey(row.data(), mSortColumns[i]);
+                if (key != values[i])
+                {
+                    cmp = (key < values[i]) ? -1 : 1;
+                    break;
+                }
+            }
+            if (cmp < 0 || (upper && cmp == 0))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+    /// Reads the traces of a gather
+    template<typename T>
+    void readGather(const std::vector<int> &values,
+                    std::vector<TraceHeader> *headers,
+                    std::vector<std::vector<T>> *traces) const
+    {
+        auto gather = getGather(values);
+        headers->resize(gather.size());
+        traces->resize(gather.size());
+        if (gather.empty()){return;}
+        int fd = open(mSEGYFileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Could not open " + mSEGYFileName
+                                   + "\n");
+        }
+        auto bytesPerSample
+            = Temblor::Private::getSEGYBytesPerSample(mDataFormat);
+        auto getLength = [&](const IndexedTrace &trace)
+        {
+            return TRACE_HEADER_SIZE
+                 + static_cast<size_t> (trace.nSamples)*bytesPerSample;
+        };
+        std::vector<char> buffer;
+        size_t first = 0;
+        try
+        {
+            // Coalesce traces that are adjacent in the file into one read
+            while (first < gather.size())
+            {
+                auto last = first + 1;
+                auto nbytes = getLength(gather[first]);
+                while (last < gather.size() &&
+                       gather[last].offset
+                       == gather[first].offset
+                        + static_cast<int64_t> (nbytes))
+                {
+                    nbytes = nbytes + getLength(gather[last]);
+                    last = last + 1;
+                }
+                buffer.resize(nbytes);
+                if (!preadFully(fd, buffer.data(), nbytes,
+                                static_cast<off_t> (gather[first].offset)))
+                {
+                    throw std::runtime_error("Failed to read traces from "
+                                           + mSEGYFileName + "\n");
+                }
+                const char *c = buffer.data();
+                for (auto i=first; i<last; ++i)
+                {
+                    auto nSamples = gather[i].nSamples;
+                    (*headers)[i].setBinaryHeader(c, mLittleEndian);
+                    (*traces)[i].resize(nSamples);
+                    Temblor::Private::unpackSEGYSamples(
+                        nSamples, c + TRACE_HEADER_SIZE, mDataFormat,
+                        mLittleEndian, (*traces)[i].data());
+                    c = c + getLength(gather[i]);
+                }
+                first = last;
+            }
+        }
+        catch (...)
+        {
+            close(fd);
+            throw;
+        }
+        close(fd);
+    }
+    /// Finds a gather
+    std::vector<IndexedTrace> getGather(const std::vector<int> &values) const
+    {
+        if (mSortKeys.empty())
+        {
+            throw std::invalid_argument("Index is not sorted\n");
+        }
+        if (values.empty() || values.size() > mSortKeys.size())
+        {
+            throw std::invalid_argument("Number of values = "
+                + std::to_string(values.size()) + " must be in range [1,"
+                + std::to_string(mSortKeys.size()) + "]\n");
+        }
+        std::vector<IndexedTrace> gather;
+        int fd = open(mIndexFileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Could not open " + mIndexFileName
+                                   + "\n");
+        }
+        try
+        {
+            auto first = search(fd, values, false);
+            auto last = search(fd, values, true);
+            auto rowSize = getRowSize();
+            std::vector<char> rows(static_cast<size_t> (last - first)*rowSize);
+            if (!preadFully(fd, rows.data(), rows.size(),
+                            static_cast<off_t> (mDataOffset + first*rowSize)))
+            {
+                throw std::runtime_error("Failed to read "
+                                       + mIndexFileName + "\n");
+            }
+            gather.resize(static_cast<size_t> (last - first));
+            for (size_t i=0; i<gather.size(); ++i)
+            {
+                auto row = rows.data() + i*rowSize;
+                std::memcpy(&gather[i].offset, row, sizeof(int64_t));
+                std::memcpy(&gather[i].trace, row + 8, sizeof(int32_t));
+                std::memcpy(&gather[i].nSamples, row + 12, sizeof(int32_t));
+                gather[i].keys.resize(mKeys.size());
+                for (size_t k=0; k<mKeys.size(); ++k)
+                {
+                    gather[i].keys[k]
+                        = RowComparator::getKey(row, static_cast<int> (k));
+                }
+            }
+        }
+        catch (...)
+        {
+            close(fd);
+            throw;
+        }
+        close(fd);
+        return gather;
+    }
+
+    std::string mIndexFileName;
+    std::string mSEGYFileName;
+    std::vector<TraceHeaderField> mKeys;
+    std::vector<TraceHeaderField> mSortKeys;
+    std::vector<int> mSortColumns;
+    size_t mMaximumMemory = 256*1024*1024;
+    uint64_t mDataOffset = 0;
+    int mNumberOfTraces = 0;
+    DataFormat mDataFormat = DataFormat::IBM_FLOAT;
+    TraceSortingCode mNativeSortingCode = TraceSortingCode::UNKNOWN;
+    bool mLittleEndian = false;
+};
+
+/// Constructors
+GatherIndex::GatherIndex() :
+    pImpl(std::make_unique<GatherIndexImpl> ())
+{
+}
+
+GatherIndex::GatherIndex(const GatherIndex &index)
+{
+    *this = index;
+}
+
+GatherIndex::GatherIndex(GatherIndex &&index) noexcept
+{
+    *this = std::move(index);
+}
+
+/// Operators
+GatherIndex& GatherIndex::operator=(const GatherIndex &index)
+{
+    if (&index == this){return *this;}
+    pImpl = std::make_unique<GatherIndexImpl> (*index.pImpl);
+    return *this;
+}
+
+GatherIndex& GatherIndex::operator=(GatherIndex &&index) noexcept
+{
+    if (&index == this){return *this;}
+    pImpl = std::move(index.pImpl);
+    return *this;
+}
+
+/// Destructor
+GatherIndex::~GatherIndex() = default;
+
+void GatherIndex::clear() noexcept
+{
+    auto maximumMemory = pImpl->mMaximumMemory;
+    pImpl = std::make_unique<GatherIndexImpl> ();
+    pImpl->mMaximumMemory = maximumMemory;
+}
+
+/// Memory
+void GatherIndex::setMaximumMemory(const size_t nBytes)
+{
+    if (nBytes < MINIMUM_MEMORY)
+    {
+        throw std::invalid_argument("Maximum memory = "
+                                  + std::to_string(nBytes)
+                                  + " must be at least "
+                                  + std::to_string(MINIMUM_MEMORY) + "\n");
+    }
+    pImpl->mMaximumMemory = nBytes;
+}
+
+size_t GatherIndex::getMaximumMemory() const noexcept
+{
+    return pImpl->mMaximumMemory;
+}
+
+/// Indexing
+void GatherIndex::build(const std::string &segyFileName,
+                        const std::vector<TraceHeaderField> &keys,
+                        const std::string &indexFileName)
+{
+    if (keys.empty()){throw std::invalid_argument("No keys to index\n");}
+    for (size_t i=0; i<keys.size(); ++i)
+    {
+        auto key = static_cast<int> (keys[i]);
+        if (key < 0 || key >= N_TRACE_HEADER_FIELDS)
+        {
+            throw std::invalid_argument("Invalid key "
+                                      + std::to_string(key) + "\n");
+        }
+        if (std::find(keys.begin() + i + 1, keys.end(), keys[i])
+            != keys.end())
+        {
+            throw std::invalid_argument("Duplicate key "
+                                      + std::to_string(key) + "\n");
+        }
+    }
+    Segy2 segy;
+    segy.read(segyFileName);
+    auto binaryHeader = segy.getBinaryFileHeader();
+    auto maximumMemory = pImpl->mMaximumMemory;
+    GatherIndexImpl impl;
+    impl.mMaximumMemory = maximumMemory;
+    impl.mIndexFileName = indexFileName;
+    impl.mSEGYFileName = segyFileName;
+#if TEMBLOR_USE_FILESYSTEM == 1
+    impl.mSEGYFileName = fs::absolute(segyFileName).string();
+#endif
+    impl.mKeys = keys;
+    impl.mNumberOfTraces = segy.getNumberOfTraces();
+    impl.mDataFormat = binaryHeader.getDataFormat();
+    impl.mNativeSortingCode = binaryHeader.getTraceSortingCode();
+    impl.mLittleEndian = binaryHeader.isLittleEndian();
+    auto header = impl.packHeader(impl.mSortKeys);
+    impl.mDataOffset = header.size();
+    std::ofstream outfile(indexFileName, std::ofstream::binary);
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not open " + indexFileName + "\n");
+    }
+    writeBlock(outfile, header, header.size(), indexFileName);
+    // Extract the keys a block of rows at a time
+    auto rowSize = impl.getRowSize();
+    std::vector<char> rows(std::min<size_t> (impl.getRowsInMemory(),
+                                             std::max(1, impl.mNumberOfTraces))
+                          *rowSize);
+    size_t nbytes = 0;
+    for (int trace=0; trace<impl.mNumberOfTraces; ++trace)
+    {
+        auto traceHeader = segy.getTraceHeader(trace);
+        auto row = rows.data() + nbytes;
+        auto offset = static_cast<int64_t> (segy.getTraceOffset(trace));
+        auto nSamples = static_cast<int32_t> (segy.getNumberOfSamples(trace));
+        std::memcpy(row, &offset, sizeof(int64_t));
+        std::memcpy(row + 8, &trace, sizeof(int32_t));
+        std::memcpy(row + 12, &nSamples, sizeof(int32_t));
+        for (size_t k=0; k<keys.size(); ++k)
+        {
+            auto value = static_cast<int32_t> (traceHeader.getHeader(keys[k]));
+            std::memcpy(row + KEY_COLUMN_OFFSET + 4*k, &value,
+                        sizeof(int32_t));
+        }
+        nbytes = nbytes + rowSize;
+        if (nbytes == rows.size())
+        {
+            writeBlock(outfile, rows, nbytes, indexFileName);
+            nbytes = 0;
+        }
+    }
+    writeBlock(outfile, rows, nbytes, indexFileName);
+    outfile.close();
+    if (!outfile)
+    {
+        throw std::runtime_error("Could not write " + indexFileName + "\n");
+    }
+    *pImpl = std::move(impl);
+}
+
+void GatherIndex::load(const std::string &indexFileName)
+{
+    std::ifstream infile(indexFileName, std::ifstream::binary);
+    if (!infile)
+    {
+        throw std::invalid_argument("Index file = " + indexFileName
+                                  + " does not exist\n");
+    }
+    infile.seekg(0, std::ifstream::end);
+    auto fileSize = static_cast<uint64_t> (infile.tellg());
+    infile.seekg(0, std::ifstream::beg);
+    // The header is small so read at most 64 kB of it
+    std::vector<char> buffer(std::min<uint64_t> (fileSize, 65536));
+    infile.read(buffer.data(), static_cast<std::streamsize> (buffer.size()));
+    infile.close();
+    Temblor::Private::IndexReader reader(buffer);
+    reader.checkPreamble(MAGIC, FORMAT_VERSION, indexFileName);
+    GatherIndexImpl impl;
+    impl.mMaximumMemory = pImpl->mMaximumMemory;
+    impl.mIndexFileName = indexFileName;
+    impl.mSEGYFileName = reader.getString();
+    impl.mDataFormat = static_cast<DataFormat> (reader.get<int16_t> ());
+    impl.mNativeSortingCode
+        = static_cast<TraceSortingCode> (reader.get<int16_t> ());
+    impl.mLittleEndian = (reader.get<uint8_t> () != 0);
+    auto nKeys = reader.get<uint32_t> ();
+    if (nKeys < 1 || nKeys > N_TRACE_HEADER_FIELDS)
+    {
+        throw std::invalid_argument("Invalid number of keys\n");
+    }
+    for (uint32_t i=0; i<nKeys; ++i)
+    {
+        auto key = reader.get<int32_t> ();
+        if (key < 0 || key >= N_TRACE_HEADER_FIELDS)
+        {
+            throw std::invalid_argument("Invalid key\n");
+        }
+        impl.mKeys.push_back(static_cast<TraceHeaderField> (key));
+    }
+    auto nSortKeys = reader.get<uint32_t> ();
+    if (nSortKeys > nKeys)
+    {
+        throw std::invalid_argument("Invalid number of sort keys\n");
+    }
+    for (uint32_t i=0; i<nKeys; ++i)
+    {
+        auto key = reader.get<int32_t> ();
+        if (i < nSortKeys)
+        {
+            impl.mSortKeys.push_back(static_cast<TraceHeaderField> (key));
+        }
+    }
+    if (!impl.mSortKeys.empty())
+    {
+        impl.mSortColumns = impl.getColumns(impl.mSortKeys);
+    }
+    auto nTraces = reader.get<uint64_t> ();
+    impl.mDataOffset = reader.getOffset();
+    if (nTraces > INT32_MAX ||
+        fileSize != impl.mDataOffset + nTraces*impl.getRowSize())
+    {
+        throw std::invalid_argument("Index file is truncated\n");
+    }
+    impl.mNumberOfTraces = static_cast<int> (nTraces);
+    *pImpl = std::move(impl);
+}
+
+std::string GatherIndex::getSEGYFileName() const noexcept
+{
+    return pImpl->mSEGYFileName;
+}
+
+std::vector<TraceHeaderField> GatherIndex::getKeys() const noexcept
+{
+    return pImpl->mKeys;
+}
+
+int GatherIndex::getNumberOfTraces() const noexcept
+{
+    return pImpl->mNumberOfTraces;
+}
+
+/// Sorting
+TraceSortingCode GatherIndex::getNativeSortingCode() const noexcept
+{
+    return pImpl->mNativeSortingCode;
+}
+
+std::vector<TraceHeaderField> GatherIndex::getSortKeys(
+    const TraceSortingCode code)
+{
+    switch (code)
+    {
+        case TraceSortingCode::AS_REOCORDED:
+            return {TraceHeaderField::FIELD_RECORD_NUMBER,
+                    TraceHeaderField::TRACE_NUMBER_IN_FIELD_RECORD};
+        case TraceSortingCode::COMMON_DEPTH_POINT:
+        case TraceSortingCode::COMMON_SOURCE_POINT:
+        case TraceSortingCode::COMMON_RECEIVER_POINT:
+        case TraceSortingCode::COMMON_OFFSET_POINT:
+        case TraceSortingCode::COMMON_MID_POINT:
+        case TraceSortingCode::COMMON_CONVERSION_POINT:
+            return {TraceHeaderField::ENSEMBLE_NUMBER,
+                    TraceHeaderField::TRACE_NUMBER_IN_ENSEMBLE};
+        default:
+            return {};
+    }
+}
+
+std::vector<TraceHeaderField> GatherIndex::getSortKeys() const noexcept
+{
+    return pImpl->mSortKeys;
+}
+
+bool GatherIndex::sort(const std::vector<TraceHeaderField> &keys)
+{
+    if (pImpl->mIndexFileName.empty())
+    {
+        throw std::runtime_error("Index not loaded\n");
+    }
+    auto columns = pImpl->getColumns(keys);
+    if (keys == pImpl->mSortKeys){return false;}
+    // Traces written in the native order of these keys need not be sorted.
+    // The header is not trusted so the order is verified.
+    auto nativeKeys = getSortKeys(pImpl->mNativeSortingCode);
+    if (pImpl->mSortKeys.empty() && !nativeKeys.empty() &&
+        keys.front() == nativeKeys.front() && pImpl->isSorted(columns))
+    {
+        pImpl->mSortKeys = keys;
+        pImpl->mSortColumns = columns;
+        pImpl->updateHeader();
+        return false;
+    }
+    pImpl->externalSort(columns, keys);
+    pImpl->mSortKeys = keys;
+    pImpl->mSortColumns = columns;
+    return true;
+}
+
+bool GatherIndex::sort(const TraceSortingCode code)
+{
+    auto keys = getSortKeys(code);
+    if (keys.empty())
+    {
+        throw std::invalid_argument("Sorting code has no sort keys\n");
+    }
+    return sort(keys);
+}
+
+/// Gathers
+std::vector<IndexedTrace> GatherIndex::getGather(
+    const std::vector<int> &values) const
+{
+    return pImpl->getGather(values);
+}
+
+void GatherIndex::readGather(const std::vector<int> &values,
+                             std::vector<TraceHeader> *headers,
+                             std::vector<std::vector<double>> *traces) const
+{
+    if (headers == nullptr || traces == nullptr)
+    {
+        throw std::invalid_argument("headers and traces cannot be NULL\n");
+    }
+    pImpl->readGather(values, headers, traces);
+}
+
+void GatherIndex::readGather(const std::vector<int> &values,
+                             std::vector<TraceHeader> *headers,
+                             std::vector<std::vector<float>> *traces) const
+{
+    if (headers == nullptr || traces == nullptr)
+    {
+        throw std::invalid_argument("headers and traces cannot be NULL\n");
+    }
+    pImpl->readGather(values, headers, traces);
+}
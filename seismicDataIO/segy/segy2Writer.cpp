@@ -0,0 +1,487 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include "temblor/private/alignedBuffer.hpp"
+#include "temblor/private/byteSwap.hpp"
+#include "temblor/private/ebcdic.hpp"
+#include "temblor/private/segySamples.hpp"
+#include "temblor/seismicDataIO/segy/segy2Writer.hpp"
+#include "temblor/seismicDataIO/segy/binaryFileHeader.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+
+using namespace Temblor::SeismicDataIO::SEGY;
+
+namespace
+{
+
+constexpr bool MACHINE_IS_LITTLE_ENDIAN
+    = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+constexpr size_t TEXTUAL_HEADER_SIZE = 3200;
+constexpr size_t BINARY_HEADER_SIZE = 400;
+constexpr size_t TRACE_HEADER_SIZE = 240;
+/// The smallest write buffer
+constexpr size_t MINIMUM_BUFFER_SIZE = 64*1024;
+
+/// Writes nbytes.  This returns false if the bytes cannot be written.
+bool writeFully(const int fd, const char *buffer, size_t nbytes)
+{
+    while (nbytes > 0)
+    {
+        auto nwritten = ::write(fd, buffer, nbytes);
+        if (nwritten < 0)
+        {
+            if (errno == EINTR){continue;}
+            return false;
+        }
+        buffer = buffer + nwritten;
+        nbytes = nbytes - static_cast<size_t> (nwritten);
+    }
+    return true;
+}
+
+}
+
+class Segy2Writer::Segy2WriterImpl
+{
+public:
+    /// The bytes in a packed trace
+    size_t getTraceLength(const size_t npts) const noexcept
+    {
+        return TRACE_HEADER_SIZE + npts*mBytesPerSample;
+    }
+    /// Checks that a file is open
+    void checkOpen() const
+    {
+        if (mFileDescriptor < 0)
+        {
+            throw std::runtime_error("No file is open\n");
+        }
+    }
+    /// Checks the number of samples in a trace
+    void checkNumberOfSamples(const int64_t npts) const
+    {
+        if (npts < 0 || npts > UINT16_MAX)
+        {
+            throw std::invalid_argument("npts = " + std::to_string(npts)
+                                      + " must be in range [0,65535]\n");
+        }
+        if (mFixedLength && npts != mNumberOfSamplesPerTrace)
+        {
+            throw std::invalid_argument("npts = " + std::to_string(npts)
+                + " must equal the fixed trace length = "
+                + std::to_string(mNumberOfSamplesPerTrace) + "\n");
+        }
+    }
+    /// Packs the trace header and samples of a trace in the file's format
+    template<typename T>
+    void packTrace(const TraceHeader &header, const int npts, const T x[],
+                   char *trace) const
+    {
+        constexpr auto lswap = MACHINE_IS_LITTLE_ENDIAN;
+        header.getBinaryHeader(trace);
+        Temblor::Private::packScalar(static_cast<uint16_t> (npts),
+                                     trace + 114, lswap);
+        if (header.getHeader(TraceHeaderField::SAMPLE_INTERVAL) == 0)
+        {
+            Temblor::Private::packScalar(mSampleInterval, trace + 116, lswap);
+        }
+        Temblor::Private::packSEGYSamples(npts, x, mDataFormat,
+                                          trace + TRACE_HEADER_SIZE);
+    }
+    /// The buffer being filled
+    Temblor::Private::AlignedBuffer &getCurrentBuffer() noexcept
+    {
+        return mBuffers[mCurrent];
+    }
+    /// The filled buffer that has yet to be written
+    Temblor::Private::AlignedBuffer &getPendingBuffer() noexcept
+    {
+        return mBuffers[1 - mCurrent];
+    }
+    /// Writes a buffer to the file
+    void writeBuffer(const Temblor::Private::AlignedBuffer &buffer,
+                     const size_t nbytes)
+    {
+        if (!writeFully(mFileDescriptor, buffer.data<char> (), nbytes))
+        {
+            throw std::runtime_error("Failed to write " + mFileName + "\n");
+        }
+    }
+    /// Writes the pending buffer then makes the current buffer pending
+    void rotate()
+    {
+        if (mPendingBytes > 0)
+        {
+            writeBuffer(getPendingBuffer(), mPendingBytes);
+        }
+        mPendingBytes = mUsedBytes;
+        mCurrent = 1 - mCurrent;
+        mUsedBytes = 0;
+        if (getCurrentBuffer().size() < mBufferSize)
+        {
+            getCurrentBuffer().allocate(mBufferSize);
+        }
+    }
+    /// Makes room for nbytes in the current buffer
+    void reserve(const size_t nbytes)
+    {
+        if (mUsedBytes + nbytes <= getCurrentBuffer().size()){return;}
+        if (mUsedBytes > 0){rotate();}
+        if (nbytes > getCurrentBuffer().size())
+        {
+            getCurrentBuffer().allocate(nbytes);
+        }
+    }
+    /// Appends a trace.  This is serial: the trace is packed on the
+    /// calling thread and a full buffer is written synchronously.
+    template<typename T>
+    void write(const TraceHeader &header, const int npts, const T x[])
+    {
+        checkOpen();
+        checkNumberOfSamples(npts);
+        if (npts > 0 && x == nullptr)
+        {
+            throw std::invalid_argument("x is NULL\n");
+        }
+        auto nbytes = getTraceLength(npts);
+        reserve(nbytes);
+        packTrace(header, npts, x,
+                  getCurrentBuffer().template data<char> () + mUsedBytes);
+        mUsedBytes = mUsedBytes + nbytes;
+        mNumberOfTraces = mNumberOfTraces + 1;
+    }
+    /// Appends a batch of traces.  Each buffer's worth of traces is packed
+    /// in parallel while one thread writes the previous buffer.
+    template<typename T>
+    void write(const std::vector<TraceHeader> &headers,
+               const std::vector<std::vector<T>> &traces)
+    {
+        checkOpen();
+        if (headers.size() != traces.size())
+        {
+            throw std::invalid_argument("Number of headers = "
+                                      + std::to_string(headers.size())
+                                      + " must equal number of traces = "
+                                      + std::to_string(traces.size()) + "\n");
+        }
+        auto nTraces = static_cast<int64_t> (traces.size());
+        std::vector<size_t> offsets(nTraces + 1, 0);
+        for (int64_t i=0; i<nTraces; ++i)
+        {
+            auto npts = static_cast<int64_t> (traces[i].size());
+            checkNumberOfSamples(npts);
+            offsets[i + 1] = offsets[i] + getTraceLength(npts);
+        }
+        int64_t first = 0;
+        while (first < nTraces)
+        {
+            // Find the traces that fit in the current buffer
+            auto available = getCurrentBuffer().size() - mUsedBytes;
+            auto last = std::upper_bound(offsets.begin() + first + 1,
+                                         offsets.end(),
+                                         offsets[first] + available)
+                      - offsets.begin() - 1;
+            if (last == first)
+            {
+                reserve(offsets[first + 1] - offsets[first]);
+                continue;
+            }
+            auto buffer = getCurrentBuffer().template data<char> ()
+                        + mUsedBytes;
+            auto offset0 = offsets[first];
+            const auto pending = getPendingBuffer().template data<char> ();
+            auto nPendingBytes = mPendingBytes;
+            auto fd = mFileDescriptor;
+            bool lwritten = true;
+            #pragma omp parallel num_threads(mNumberOfThreads)
+            {
+                #pragma omp single nowait
+                if (nPendingBytes > 0)
+                {
+                    lwritten = writeFully(fd, pending, nPendingBytes);
+                }
+                #pragma omp for schedule(dynamic, 16)
+                for (int64_t i=first; i<last; ++i)
+                {
+                    auto npts = static_cast<int> (traces[i].size());
+                    packTrace(headers[i], npts, traces[i].data(),
+                              buffer + (offsets[i] - offset0));
+                }
+            }
+            mPendingBytes = 0;
+            if (!lwritten)
+            {
+                throw std::runtime_error("Failed to write " + mFileName
+                                       + "\n");
+            }
+            mUsedBytes = mUsedBytes + (offsets[last] - offsets[first]);
+            mNumberOfTraces = mNumberOfTraces + (last - first);
+            first = last;
+            // The buffer is full so write it while the next one is packed
+            if (first < nTraces){rotate();}
+        }
+    }
+    /// Flushes the buffers, sets the trace count, and closes the file
+    void close()
+    {
+        if (mFileDescriptor < 0){return;}
+        bool lwritten = true;
+        try
+        {
+            if (mPendingBytes > 0)
+            {
+                writeBuffer(getPendingBuffer(), mPendingBytes);
+            }
+            if (mUsedBytes > 0)
+            {
+                writeBuffer(getCurrentBuffer(), mUsedBytes);
+            }
+        }
+        catch (...)
+        {
+            lwritten = false;
+        }
+        if (lwritten && mMajorRevision >= 2)
+        {
+            std::array<char, 8> nTraces;
+            Temblor::Private::packScalar(mNumberOfTraces, nTraces.data(),
+                                         MACHINE_IS_LITTLE_ENDIAN);
+            auto offset = static_cast<off_t> (TEXTUAL_HEADER_SIZE + 312);
+            lwritten = (pwrite(mFileDescriptor, nTraces.data(),
+                               nTraces.size(), offset)
+                        == static_cast<ssize_t> (nTraces.size()));
+        }
+        if (::close(mFileDescriptor) != 0){lwritten = false;}
+        mFileDescriptor = -1;
+        mPendingBytes = 0;
+        mUsedBytes = 0;
+        mBuffers[0].clear();
+        mBuffers[1].clear();
+        if (!lwritten)
+        {
+            throw std::runtime_error("Failed to write " + mFileName + "\n");
+        }
+    }
+
+    std::array<Temblor::Private::AlignedBuffer, 2> mBuffers;
+    std::string mFileName;
+    size_t mBufferSize = 16*1024*1024;
+    size_t mBytesPerSample = 4;
+    /// The bytes packed into the current buffer
+    size_t mUsedBytes = 0;
+    /// The bytes in the other buffer that have yet to be written
+    size_t mPendingBytes = 0;
+    uint64_t mNumberOfTraces = 0;
+    int mFileDescriptor = -1;
+    int mCurrent = 0;
+    int mNumberOfThreads = 1;
+    int64_t mNumberOfSamplesPerTrace = 0;
+    uint16_t mSampleInterval = 0;
+    DataFormat mDataFormat = DataFormat::IBM_FLOAT;
+    uint8_t mMajorRevision = 2;
+    bool mFixedLength = false;
+};
+
+/// Constructors
+Segy2Writer::Segy2Writer() :
+    pImpl(std::make_unique<Segy2WriterImpl> ())
+{
+}
+
+Segy2Writer::Segy2Writer(Segy2Writer &&writer) noexcept
+{
+    *this = std::move(writer);
+}
+
+/// Operators
+Segy2Writer& Segy2Writer::operator=(Segy2Writer &&writer) noexcept
+{
+    if (&writer == this){return *this;}
+    if (pImpl)
+    {
+        try
+        {
+            pImpl->close();
+        }
+        catch (...)
+        {
+        }
+    }
+    pImpl = std::move(writer.pImpl);
+    return *this;
+}
+
+/// Destructor
+Segy2Writer::~Segy2Writer()
+{
+    if (!pImpl){return;}
+    try
+    {
+        pImpl->close();
+    }
+    catch (const std::exception &e)
+    {
+        fprintf(stderr, "%s: %s", __func__, e.what());
+    }
+}
+
+/// Threads
+void Segy2Writer::setNumberOfThreads(const int nThreads)
+{
+    if (nThreads < 1)
+    {
+        throw std::invalid_argument("Number of threads = "
+                                  + std::to_string(nThreads)
+                                  + " must be positive\n");
+    }
+    pImpl->mNumberOfThreads = nThreads;
+}
+
+int Segy2Writer::getNumberOfThreads() const noexcept
+{
+    return pImpl->mNumberOfThreads;
+}
+
+/// Buffer size
+void Segy2Writer::setBufferSize(const size_t nBytes)
+{
+    if (nBytes < MINIMUM_BUFFER_SIZE)
+    {
+        throw std::invalid_argument("Buffer size = " + std::to_string(nBytes)
+                                  + " must be at least "
+                                  + std::to_string(MINIMUM_BUFFER_SIZE)
+                                  + "\n");
+    }
+    pImpl->mBufferSize = nBytes;
+}
+
+size_t Segy2Writer::getBufferSize() const noexcept
+{
+    return pImpl->mBufferSize;
+}
+
+/// Opens the file and writes the file headers
+void Segy2Writer::open(const std::string &fileName,
+                       const BinaryFileHeader &binaryHeader,
+                       const std::string &textualHeader)
+{
+    close();
+    DataFormat dataFormat;
+    try
+    {
+        dataFormat = binaryHeader.getDataFormat();
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument("Unsupported data format\n");
+    }
+    if (binaryHeader.getNumberOfExtendedTextualHeaders() != 0)
+    {
+        throw std::invalid_argument(
+            "Extended textual headers are not supported\n");
+    }
+    if (binaryHeader.getMaximumNumberOfAdditionalTraceHeaders() != 0)
+    {
+        throw std::invalid_argument(
+            "Additional trace headers are not supported\n");
+    }
+    if (binaryHeader.getNumberOfDataTrailerStanzas() != 0)
+    {
+        throw std::invalid_argument("Data trailers are not supported\n");
+    }
+    auto firstTraceOffset = binaryHeader.getFirstTraceOffset();
+    if (firstTraceOffset != 0 &&
+        firstTraceOffset != TEXTUAL_HEADER_SIZE + BINARY_HEADER_SIZE)
+    {
+        throw std::invalid_argument("First trace offset must be 3600\n");
+    }
+    bool fixedLength = binaryHeader.haveFixedLengthTraces();
+    auto nSamplesPerTrace = binaryHeader.getNumberOfSamplesPerTrace();
+    if (fixedLength && (nSamplesPerTrace < 1 || nSamplesPerTrace > UINT16_MAX))
+    {
+        throw std::invalid_argument(
+            "Fixed length traces require the number of samples\n");
+    }
+    // Pack the file headers
+    std::array<char, TEXTUAL_HEADER_SIZE + BINARY_HEADER_SIZE> headers;
+    std::array<char, TEXTUAL_HEADER_SIZE> asciiHeader;
+    asciiHeader.fill(' ');
+    std::copy(textualHeader.begin(),
+              textualHeader.begin()
+            + std::min(textualHeader.size(), TEXTUAL_HEADER_SIZE),
+              asciiHeader.begin());
+    Temblor::Private::convertToEBCDICHeader(asciiHeader.data(),
+                                            headers.data());
+    binaryHeader.getBinaryHeader(headers.data() + TEXTUAL_HEADER_SIZE);
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open " + fileName + "\n");
+    }
+    pImpl->mFileDescriptor = fd;
+    pImpl->mFileName = fileName;
+    pImpl->mDataFormat = dataFormat;
+    pImpl->mBytesPerSample
+        = Temblor::Private::getSEGYBytesPerSample(dataFormat);
+    pImpl->mFixedLength = fixedLength;
+    pImpl->mNumberOfSamplesPerTrace = nSamplesPerTrace;
+    pImpl->mSampleInterval = binaryHeader.getSampleInterval();
+    pImpl->mMajorRevision = binaryHeader.getMajorRevision();
+    pImpl->mNumberOfTraces = 0;
+    pImpl->mCurrent = 0;
+    pImpl->mPendingBytes = 0;
+    pImpl->mBuffers[0].allocate(pImpl->mBufferSize);
+    pImpl->mBuffers[1].allocate(pImpl->mBufferSize);
+    std::copy(headers.begin(), headers.end(),
+              pImpl->mBuffers[0].data<char> ());
+    pImpl->mUsedBytes = headers.size();
+}
+
+bool Segy2Writer::isOpen() const noexcept
+{
+    return pImpl->mFileDescriptor >= 0;
+}
+
+/// Traces
+void Segy2Writer::write(const TraceHeader &header, const int npts,
+                        const double x[])
+{
+    pImpl->write(header, npts, x);
+}
+
+void Segy2Writer::write(const TraceHeader &header, const int npts,
+                        const float x[])
+{
+    pImpl->write(header, npts, x);
+}
+
+void Segy2Writer::write(const std::vector<TraceHeader> &headers,
+                        const std::vector<std::vector<double>> &traces)
+{
+    pImpl->write(headers, traces);
+}
+
+void Segy2Writer::write(const std::vector<TraceHeader> &headers,
+                        const std::vector<std::vector<float>> &traces)
+{
+    pImpl->write(headers, traces);
+}
+
+uint64_t Segy2Writer::getNumberOfTracesWritten() const noexcept
+{
+    return pImpl->mNumberOfTraces;
+}
+
+void Segy2Writer::close()
+{
+    pImpl->close();
+}
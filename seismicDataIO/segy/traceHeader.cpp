@@ -0,0 +1,225 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <array>
+#include <utility>
+#include <stdexcept>
+#include "temblor/private/byteSwap.hpp"
+#include "temblor/utilities/time.hpp"
+#include "temblor/seismicDataIO/segy/traceHeader.hpp"
+
+using namespace Temblor::SeismicDataIO::SEGY;
+
+namespace
+{
+
+constexpr bool MACHINE_IS_LITTLE_ENDIAN
+    = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+/// The location of a field in the 240-byte trace header
+struct FieldLayout
+{
+    int offset;
+    int size;
+    bool isUnsigned;
+};
+
+/// The layout of each TraceHeaderField in order of the enum
+constexpr std::array<FieldLayout, 34> FIELD_LAYOUT{{
+    {  0, 4, false}, // TRACE_SEQUENCE_NUMBER_IN_LINE
+    {  4, 4, false}, // TRACE_SEQUENCE_NUMBER_IN_FILE
+    {  8, 4, false}, // FIELD_RECORD_NUMBER
+    { 12, 4, false}, // TRACE_NUMBER_IN_FIELD_RECORD
+    { 16, 4, false}, // ENERGY_SOURCE_POINT_NUMBER
+    { 20, 4, false}, // ENSEMBLE_NUMBER
+    { 24, 4, false}, // TRACE_NUMBER_IN_ENSEMBLE
+    { 28, 2, false}, // TRACE_IDENTIFICATION_CODE
+    { 36, 4, false}, // SOURCE_RECEIVER_OFFSET
+    { 40, 4, false}, // RECEIVER_GROUP_ELEVATION
+    { 44, 4, false}, // SURFACE_ELEVATION_AT_SOURCE
+    { 48, 4, false}, // SOURCE_DEPTH
+    { 68, 2, false}, // ELEVATION_SCALAR
+    { 70, 2, false}, // COORDINATE_SCALAR
+    { 72, 4, false}, // SOURCE_X
+    { 76, 4, false}, // SOURCE_Y
+    { 80, 4, false}, // GROUP_X
+    { 84, 4, false}, // GROUP_Y
+    { 88, 2, false}, // COORDINATE_UNITS
+    {108, 2, false}, // DELAY_RECORDING_TIME
+    {114, 2, true},  // NUMBER_OF_SAMPLES
+    {116, 2, true},  // SAMPLE_INTERVAL
+    {156, 2, false}, // YEAR
+    {158, 2, false}, // DAY_OF_YEAR
+    {160, 2, false}, // HOUR
+    {162, 2, false}, // MINUTE
+    {164, 2, false}, // SECOND
+    {166, 2, false}, // TIME_BASIS_CODE
+    {180, 4, false}, // CDP_X
+    {184, 4, false}, // CDP_Y
+    {188, 4, false}, // INLINE_NUMBER
+    {192, 4, false}, // CROSSLINE_NUMBER
+    {196, 4, false}, // SHOTPOINT_NUMBER
+    {200, 2, false}  // SHOTPOINT_SCALAR
+}};
+
+/// Reverses the bytes of every enumerated field
+void swapFields(char header[240]) noexcept
+{
+    for (const auto &layout : FIELD_LAYOUT)
+    {
+        auto c = header + layout.offset;
+        for (int i=0; i<layout.size/2; ++i)
+        {
+            std::swap(c[i], c[layout.size - 1 - i]);
+        }
+    }
+}
+
+}
+
+class TraceHeader::TraceHeaderImpl
+{
+public:
+    TraceHeaderImpl()
+    {
+        mHeader.fill(0);
+    }
+    /// The header in big-endian byte order
+    std::array<char, 240> mHeader;
+};
+
+/// Constructor
+TraceHeader::TraceHeader() :
+    pImpl(std::make_unique<TraceHeaderImpl> ())
+{
+}
+
+TraceHeader::TraceHeader(const TraceHeader &header)
+{
+    *this = header;
+}
+
+TraceHeader::TraceHeader(TraceHeader &&header) noexcept
+{
+    *this = std::move(header);
+}
+
+/// Operators
+TraceHeader& TraceHeader::operator=(const TraceHeader &header)
+{
+    if (&header == this){return *this;}
+    pImpl = std::make_unique<TraceHeaderImpl> (*header.pImpl);
+    return *this;
+}
+
+TraceHeader& TraceHeader::operator=(TraceHeader &&header) noexcept
+{
+    if (&header == this){return *this;}
+    pImpl = std::move(header.pImpl);
+    return *this;
+}
+
+/// Destructor
+TraceHeader::~TraceHeader() = default;
+
+void TraceHeader::clear() noexcept
+{
+    pImpl->mHeader.fill(0);
+}
+
+/// Unpack/pack the header
+void TraceHeader::setBinaryHeader(const char header[240],
+                                  const bool littleEndian) noexcept
+{
+    std::memcpy(pImpl->mHeader.data(), header, 240);
+    if (littleEndian){swapFields(pImpl->mHeader.data());}
+}
+
+void TraceHeader::getBinaryHeader(char header[240],
+                                  const bool littleEndian) const noexcept
+{
+    std::memcpy(header, pImpl->mHeader.data(), 240);
+    if (littleEndian){swapFields(header);}
+}
+
+/// Header fields
+void TraceHeader::setHeader(const TraceHeaderField field, const int value)
+{
+    const auto &layout = FIELD_LAYOUT[static_cast<int> (field)];
+    auto c = pImpl->mHeader.data() + layout.offset;
+    constexpr auto lswap = MACHINE_IS_LITTLE_ENDIAN;
+    if (layout.size == 4)
+    {
+        Temblor::Private::packScalar(static_cast<int32_t> (value), c, lswap);
+    }
+    else if (layout.isUnsigned)
+    {
+        if (value < 0 || value > UINT16_MAX)
+        {
+            throw std::invalid_argument("Value = " + std::to_string(value)
+                                      + " must be in range [0,65535]\n");
+        }
+        Temblor::Private::packScalar(static_cast<uint16_t> (value), c, lswap);
+    }
+    else
+    {
+        if (value < INT16_MIN || value > INT16_MAX)
+        {
+            throw std::invalid_argument("Value = " + std::to_string(value)
+                                      + " must be in range [-32768,32767]\n");
+        }
+        Temblor::Private::packScalar(static_cast<int16_t> (value), c, lswap);
+    }
+}
+
+int TraceHeader::getHeader(const TraceHeaderField field) const noexcept
+{
+    const auto &layout = FIELD_LAYOUT[static_cast<int> (field)];
+    auto c = pImpl->mHeader.data() + layout.offset;
+    constexpr auto lswap = MACHINE_IS_LITTLE_ENDIAN;
+    if (layout.size == 4)
+    {
+        return Temblor::Private::unpackScalar<int32_t> (c, lswap);
+    }
+    if (layout.isUnsigned)
+    {
+        return Temblor::Private::unpackScalar<uint16_t> (c, lswap);
+    }
+    return Temblor::Private::unpackScalar<int16_t> (c, lswap);
+}
+
+/// Sampling period
+double TraceHeader::getSamplingPeriod() const
+{
+    auto sampleInterval = getHeader(TraceHeaderField::SAMPLE_INTERVAL);
+    if (sampleInterval <= 0)
+    {
+        throw std::runtime_error("Sample interval not set\n");
+    }
+    return sampleInterval*1.e-6;
+}
+
+/// Start time
+Temblor::Utilities::Time TraceHeader::getStartTime() const
+{
+    auto year = getHeader(TraceHeaderField::YEAR);
+    auto jday = getHeader(TraceHeaderField::DAY_OF_YEAR);
+    if (year <= 0 || jday <= 0)
+    {
+        throw std::runtime_error("Trace start time is not set\n");
+    }
+    Temblor::Utilities::Time startTime;
+    startTime.setYear(year);
+    startTime.setJulianDay(jday);
+    startTime.setHour(getHeader(TraceHeaderField::HOUR));
+    startTime.setMinute(getHeader(TraceHeaderField::MINUTE));
+    startTime.setSecond(getHeader(TraceHeaderField::SECOND));
+    auto delay = getHeader(TraceHeaderField::DELAY_RECORDING_TIME);
+    if (delay != 0)
+    {
+        startTime.setEpochalTime(startTime.getEpochalTime() + delay*1.e-3);
+    }
+    return startTime;
+}